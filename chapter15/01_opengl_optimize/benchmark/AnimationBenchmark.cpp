@@ -0,0 +1,576 @@
+/* headless benchmark of the CPU animation pipeline, needs no window or GPU */
+#include <vector>
+#include <string>
+#include <memory>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <glm/glm.hpp>
+
+#include "GltfModel.h"
+#include "GltfInstance.h"
+#include "GltfPose.h"
+#include "GltfPosePool.h"
+#include "AnimationLOD.h"
+#include "ModelSettings.h"
+#include "OGLRenderData.h"
+#include "WorkerPool.h"
+#include "SimdMath.h"
+#include "Timer.h"
+#include "AllocationTracker.h"
+#include "Logger.h"
+
+namespace {
+  /* fixed step of the benchmark clock, independent of the real frame time */
+  constexpr float FRAME_TIME_STEP = 1.0f / 60.0f;
+  /* camera of the animation LOD, above the middle of the instance area */
+  const glm::vec3 LOD_CAMERA_POS = glm::vec3(0.0f, 10.0f, 0.0f);
+  constexpr int LOD_FIELD_OF_VIEW = 60;
+  /* poses per clip for the compression report */
+  constexpr int NUM_CLIP_SAMPLES = 2000;
+
+  struct BenchmarkConfig {
+    std::string modelFilename = "assets/Woman.gltf";
+    int numInstances = 1000;
+    int numFrames = 500;
+    int numWarmupFrames = 20;
+    /* 0 uses all hardware threads */
+    int numThreads = 1;
+    ikMode ik = ikMode::ccd;
+    /* linear, dualquat or mixed (every second instance uses dual quaternions) */
+    std::string skinning = "mixed";
+    /* fadeinout plays one clip, crossfade and additive blend two clips per instance */
+    blendMode blending = blendMode::fadeinout;
+    bool useBakedClips = true;
+    /* 0 keeps all keys and channels */
+    float clipKeyTolerance = 0.0001f;
+    /* 0 keeps the float keyframes */
+    float clipMaxError = 0.0005f;
+    /* skeleton LOD level of all instances, only used without IK */
+    int skeletonLODLevel = 0;
+    /* instance updates per frame through the animation LOD, 0 updates all every frame */
+    int animUpdateBudget = 0;
+    std::string jsonFilename{};
+  };
+
+  struct StageStats {
+    std::string name;
+    float mean = 0.0f;
+    float p50 = 0.0f;
+    float p99 = 0.0f;
+  };
+
+  void printUsage(const char *programName) {
+    Logger::log(1, "usage: %s [--model file] [--instances n] [--frames n] [--warmup n]\n"
+      "  [--threads n (0 = all)] [--ik off|ccd|fabrik] [--skinning linear|dualquat|mixed]\n"
+      "  [--blend fadeinout|crossfade|additive] [--no-baked]\n"
+      "  [--key-tolerance t (0 = all keys)] [--max-error e (0 = float keys)]\n"
+      "  [--skeleton-lod level (0 to 3, needs --ik off)]\n"
+      "  [--anim-budget n (instance updates per frame, 0 = all)] [--json file]\n",
+      programName);
+  }
+
+  bool parseArgs(int argc, char *argv[], BenchmarkConfig &config) {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      if (arg == "--no-baked") {
+        config.useBakedClips = false;
+        continue;
+      }
+
+      if (i + 1 >= argc) {
+        Logger::log(1, "%s error: missing value for '%s'\n", __FUNCTION__, arg.c_str());
+        return false;
+      }
+      std::string value = argv[++i];
+
+      if (arg == "--model") {
+        config.modelFilename = value;
+      } else if (arg == "--instances") {
+        config.numInstances = std::max(std::atoi(value.c_str()), 1);
+      } else if (arg == "--frames") {
+        config.numFrames = std::max(std::atoi(value.c_str()), 1);
+      } else if (arg == "--warmup") {
+        config.numWarmupFrames = std::max(std::atoi(value.c_str()), 0);
+      } else if (arg == "--threads") {
+        config.numThreads = std::max(std::atoi(value.c_str()), 0);
+      } else if (arg == "--ik") {
+        if (value == "off") {
+          config.ik = ikMode::off;
+        } else if (value == "ccd") {
+          config.ik = ikMode::ccd;
+        } else if (value == "fabrik") {
+          config.ik = ikMode::fabrik;
+        } else {
+          Logger::log(1, "%s error: unknown IK mode '%s'\n", __FUNCTION__, value.c_str());
+          return false;
+        }
+      } else if (arg == "--skinning") {
+        if (value != "linear" && value != "dualquat" && value != "mixed") {
+          Logger::log(1, "%s error: unknown skinning mode '%s'\n", __FUNCTION__,
+            value.c_str());
+          return false;
+        }
+        config.skinning = value;
+      } else if (arg == "--blend") {
+        if (value == "fadeinout") {
+          config.blending = blendMode::fadeinout;
+        } else if (value == "crossfade") {
+          config.blending = blendMode::crossfade;
+        } else if (value == "additive") {
+          config.blending = blendMode::additive;
+        } else {
+          Logger::log(1, "%s error: unknown blend mode '%s'\n", __FUNCTION__, value.c_str());
+          return false;
+        }
+      } else if (arg == "--key-tolerance") {
+        config.clipKeyTolerance = std::max(static_cast<float>(std::atof(value.c_str())), 0.0f);
+      } else if (arg == "--max-error") {
+        config.clipMaxError = std::max(static_cast<float>(std::atof(value.c_str())), 0.0f);
+      } else if (arg == "--skeleton-lod") {
+        config.skeletonLODLevel = std::clamp(std::atoi(value.c_str()), 0,
+          GltfSkeleton::NUM_LOD_LEVELS - 1);
+      } else if (arg == "--anim-budget") {
+        config.animUpdateBudget = std::max(std::atoi(value.c_str()), 0);
+      } else if (arg == "--json") {
+        config.jsonFilename = value;
+      } else {
+        Logger::log(1, "%s error: unknown argument '%s'\n", __FUNCTION__, arg.c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::string getBlendModeName(blendMode mode) {
+    switch (mode) {
+      case blendMode::crossfade:
+        return "crossfade";
+      case blendMode::additive:
+        return "additive";
+      default:
+        return "fadeinout";
+    }
+  }
+
+  std::string getIkModeName(ikMode mode) {
+    switch (mode) {
+      case ikMode::ccd:
+        return "ccd";
+      case ikMode::fabrik:
+        return "fabrik";
+      default:
+        return "off";
+    }
+  }
+
+  /* nearest-rank percentile of the sorted frame times */
+  float getPercentile(const std::vector<float> &sortedTimes, float percentile) {
+    int rank = static_cast<int>(std::ceil(percentile * sortedTimes.size()));
+    return sortedTimes.at(std::clamp(rank - 1, 0, static_cast<int>(sortedTimes.size()) - 1));
+  }
+
+  StageStats getStats(std::string name, std::vector<float> times) {
+    StageStats stats{};
+    stats.name = name;
+
+    std::sort(times.begin(), times.end());
+    for (const auto time : times) {
+      stats.mean += time;
+    }
+    stats.mean /= static_cast<float>(times.size());
+    stats.p50 = getPercentile(times, 0.50f);
+    stats.p99 = getPercentile(times, 0.99f);
+    return stats;
+  }
+
+  /* samples every clip with the optimized and the loaded keys, the report shows
+   * the memory, the sampling speed and the largest node position difference */
+  void reportClipOptimization(std::shared_ptr<GltfModel> model,
+      std::shared_ptr<GltfModel> referenceModel) {
+    model->setUseBakedClips(false);
+    referenceModel->setUseBakedClips(false);
+
+    std::vector<std::shared_ptr<GltfAnimationClip>> clips = model->getAnimClips();
+    std::vector<std::shared_ptr<GltfAnimationClip>> referenceClips =
+      referenceModel->getAnimClips();
+
+    GltfPose pose{};
+    GltfPose referencePose{};
+    pose.init(model->getSkeleton());
+    referencePose.init(referenceModel->getSkeleton());
+    int nodeCount = model->getSkeleton()->getNodeCount();
+
+    Timer sampleTimer{};
+    Logger::log(1, "%-16s %10s %10s %12s %12s %12s\n", "clip", "loaded B", "optim. B",
+      "loaded M/s", "optim. M/s", "max error");
+
+    for (size_t c = 0; c < clips.size(); ++c) {
+      float endTime = clips.at(c)->getClipEndTime();
+
+      GltfAnimationCursor cursor{};
+      sampleTimer.start();
+      for (int i = 0; i < NUM_CLIP_SAMPLES; ++i) {
+        clips.at(c)->sampleAnimationFrame(pose.getLocalPose(), i * endTime / NUM_CLIP_SAMPLES,
+          cursor);
+      }
+      float optimizedTime = sampleTimer.stop();
+
+      GltfAnimationCursor referenceCursor{};
+      sampleTimer.start();
+      for (int i = 0; i < NUM_CLIP_SAMPLES; ++i) {
+        referenceClips.at(c)->sampleAnimationFrame(referencePose.getLocalPose(),
+          i * endTime / NUM_CLIP_SAMPLES, referenceCursor);
+      }
+      float loadedTime = sampleTimer.stop();
+
+      float maxError = 0.0f;
+      for (int i = 0; i < NUM_CLIP_SAMPLES; ++i) {
+        float time = i * endTime / NUM_CLIP_SAMPLES;
+        pose.resetToBindPose();
+        referencePose.resetToBindPose();
+        clips.at(c)->sampleAnimationFrame(pose.getLocalPose(), time, cursor);
+        referenceClips.at(c)->sampleAnimationFrame(referencePose.getLocalPose(), time,
+          referenceCursor);
+        pose.updateNodeMatrices();
+        referencePose.updateNodeMatrices();
+
+        for (int node = 0; node < nodeCount; ++node) {
+          maxError = std::max(maxError, glm::length(glm::vec3(pose.getNodeMatrix(node)[3]) -
+            glm::vec3(referencePose.getNodeMatrix(node)[3])));
+        }
+      }
+
+      /* million sampled poses per second */
+      Logger::log(1, "%-16s %10i %10i %12.3f %12.3f %12.6f\n",
+        clips.at(c)->getClipName().c_str(), referenceClips.at(c)->getDataSize(),
+        clips.at(c)->getDataSize(), NUM_CLIP_SAMPLES / (loadedTime * 1000.0f),
+        NUM_CLIP_SAMPLES / (optimizedTime * 1000.0f), maxError);
+    }
+  }
+
+  /* JSON string contents, quotes, backslashes and control characters escaped */
+  std::string escapeJson(const std::string &text) {
+    std::string escaped;
+    for (const char c : text) {
+      switch (c) {
+        case '"':
+          escaped += "\\\"";
+          break;
+        case '\\':
+          escaped += "\\\\";
+          break;
+        case '\n':
+          escaped += "\\n";
+          break;
+        case '\r':
+          escaped += "\\r";
+          break;
+        case '\t':
+          escaped += "\\t";
+          break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            char code[7];
+            std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+            escaped += code;
+          } else {
+            escaped += c;
+          }
+          break;
+      }
+    }
+    return escaped;
+  }
+
+  bool writeJson(const BenchmarkConfig &config, int numThreads,
+      const std::vector<StageStats> &stages, float instancesPerSecond,
+      size_t maxFrameAllocations) {
+    std::FILE *jsonFile = std::fopen(config.jsonFilename.c_str(), "w");
+    if (!jsonFile) {
+      Logger::log(1, "%s error: could not open '%s' for writing\n", __FUNCTION__,
+        config.jsonFilename.c_str());
+      return false;
+    }
+
+    std::fprintf(jsonFile, "{\n");
+    std::fprintf(jsonFile, "  \"model\": \"%s\",\n", escapeJson(config.modelFilename).c_str());
+    std::fprintf(jsonFile, "  \"instances\": %i,\n", config.numInstances);
+    std::fprintf(jsonFile, "  \"frames\": %i,\n", config.numFrames);
+    std::fprintf(jsonFile, "  \"threads\": %i,\n", numThreads);
+    std::fprintf(jsonFile, "  \"ik\": \"%s\",\n", escapeJson(getIkModeName(config.ik)).c_str());
+    std::fprintf(jsonFile, "  \"skinning\": \"%s\",\n", escapeJson(config.skinning).c_str());
+    std::fprintf(jsonFile, "  \"blending\": \"%s\",\n",
+      escapeJson(getBlendModeName(config.blending)).c_str());
+    std::fprintf(jsonFile, "  \"baked_clips\": %s,\n", config.useBakedClips ? "true" : "false");
+    std::fprintf(jsonFile, "  \"clip_key_tolerance\": %g,\n", config.clipKeyTolerance);
+    std::fprintf(jsonFile, "  \"clip_max_error\": %g,\n", config.clipMaxError);
+    std::fprintf(jsonFile, "  \"skeleton_lod\": %i,\n", config.skeletonLODLevel);
+    std::fprintf(jsonFile, "  \"anim_update_budget\": %i,\n", config.animUpdateBudget);
+    std::fprintf(jsonFile, "  \"simd\": \"%s\",\n",
+      escapeJson(SimdMath::getSimdLevelName(SimdMath::getSimdLevel())).c_str());
+    std::fprintf(jsonFile, "  \"stages_ms\": {\n");
+    for (size_t i = 0; i < stages.size(); ++i) {
+      std::fprintf(jsonFile, "    \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f }%s\n",
+        escapeJson(stages.at(i).name).c_str(), stages.at(i).mean, stages.at(i).p50,
+        stages.at(i).p99, i + 1 < stages.size() ? "," : "");
+    }
+    std::fprintf(jsonFile, "  },\n");
+    std::fprintf(jsonFile, "  \"instances_per_second\": %.1f,\n", instancesPerSecond);
+    std::fprintf(jsonFile, "  \"max_frame_allocations\": %zu\n", maxFrameAllocations);
+    std::fprintf(jsonFile, "}\n");
+
+    std::fclose(jsonFile);
+    return true;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  BenchmarkConfig config{};
+  if (!parseArgs(argc, argv, config)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  OGLRenderData renderData{};
+  renderData.rdUseBakedClips = config.useBakedClips;
+  renderData.rdOptimizeClips = config.clipKeyTolerance > 0.0f;
+  renderData.rdClipKeyTolerance = config.clipKeyTolerance;
+  renderData.rdCompressClips = config.clipMaxError > 0.0f;
+  renderData.rdClipCompressionMaxError = config.clipMaxError;
+
+  std::shared_ptr<GltfModel> model = std::make_shared<GltfModel>();
+  if (!model->loadModelData(renderData, config.modelFilename)) {
+    Logger::log(1, "%s error: could not load glTF model '%s'\n", __FUNCTION__,
+      config.modelFilename.c_str());
+    return 1;
+  }
+
+  if (renderData.rdOptimizeClips || renderData.rdCompressClips) {
+    OGLRenderData referenceRenderData = renderData;
+    referenceRenderData.rdOptimizeClips = false;
+    referenceRenderData.rdCompressClips = false;
+    std::shared_ptr<GltfModel> referenceModel = std::make_shared<GltfModel>();
+    if (!referenceModel->loadModelData(referenceRenderData, config.modelFilename)) {
+      Logger::log(1, "%s error: could not load reference model '%s'\n", __FUNCTION__,
+        config.modelFilename.c_str());
+      return 1;
+    }
+    reportClipOptimization(model, referenceModel);
+    model->setUseBakedClips(config.useBakedClips);
+  }
+
+  /* same placement and random settings as the renderers, but repeatable */
+  std::srand(1234);
+  std::vector<std::shared_ptr<GltfInstance>> instances{};
+  for (int i = 0; i < config.numInstances; ++i) {
+    int xPos = std::rand() % 150 - 75;
+    int zPos = std::rand() % 150 - 75;
+    std::shared_ptr<GltfInstance> instance = std::make_shared<GltfInstance>(model,
+      glm::vec2(static_cast<float>(xPos), static_cast<float>(zPos)), true);
+
+    ModelSettings settings = instance->getInstanceSettings();
+    settings.msIkMode = config.ik;
+    if (config.skinning == "dualquat" || (config.skinning == "mixed" && i % 2 == 1)) {
+      settings.msVertexSkinningMode = skinningMode::dualQuat;
+    } else {
+      settings.msVertexSkinningMode = skinningMode::linear;
+    }
+
+    /* blend into the next clip, additive splits the skeleton in the middle */
+    settings.msBlendingMode = config.blending;
+    settings.msCrossBlendDestAnimClip = (settings.msAnimClip + 1) % model->getAnimClips().size();
+    settings.msAnimCrossBlendFactor = 0.5f;
+    if (config.blending == blendMode::additive) {
+      std::shared_ptr<GltfSkeleton> skeleton = model->getSkeleton();
+      settings.msSkelSplitNode = skeleton->getGltfNodeNum(skeleton->getNodeCount() / 2);
+    }
+    instance->setInstanceSettings(settings);
+    instance->setSkeletonLODLevel(config.skeletonLODLevel);
+    instance->checkForUpdates();
+
+    instances.emplace_back(instance);
+  }
+
+  int numThreads = config.numThreads > 0 ? config.numThreads :
+    static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+  WorkerPool workerPool{};
+  workerPool.init(numThreads);
+  workerPool.runOnEachThread([&]() { GltfPosePool::reserve(model->getSkeleton()); });
+
+  /* destination of the joint data, laid out like the SSBOs of the renderers */
+  int jointMatrixSize = instances.at(0)->getJointMatrixSize();
+  int jointDualQuatSize = instances.at(0)->getJointDualQuatsSize();
+  std::vector<glm::mat4> jointMatrices(config.numInstances * jointMatrixSize);
+  std::vector<glm::mat2x4> jointDualQuats(config.numInstances * jointDualQuatSize);
+
+  /* a budget below the number of near instances must still reach the far instances */
+  AnimationLOD animationLOD{};
+  animationLOD.init(config.numInstances);
+  animationLOD.setUpdateBudget(config.animUpdateBudget);
+  std::vector<bool> instanceVisible(config.numInstances, true);
+  std::vector<int> framesSinceUpdate(config.numInstances, 0);
+  int maxFramesSinceUpdate[AnimationLOD::NUM_LOD_LEVELS] = {};
+
+  std::vector<float> animationTimes{};
+  std::vector<float> ikTimes{};
+  std::vector<float> jointTimes{};
+  std::vector<float> frameTimes{};
+  animationTimes.reserve(config.numFrames);
+  ikTimes.reserve(config.numFrames);
+  jointTimes.reserve(config.numFrames);
+  frameTimes.reserve(config.numFrames);
+
+  Logger::log(1, "%s: %i instances, %i frames (+%i warmup), %i thread(s), IK %s, "
+    "%s skinning, %s blending, %s clips, skeleton LOD %i, update budget %i, SIMD %s\n",
+    __FUNCTION__, config.numInstances, config.numFrames, config.numWarmupFrames, numThreads,
+    getIkModeName(config.ik).c_str(), config.skinning.c_str(),
+    getBlendModeName(config.blending).c_str(), config.useBakedClips ? "baked" : "keyframe",
+    config.skeletonLODLevel, config.animUpdateBudget,
+    SimdMath::getSimdLevelName(SimdMath::getSimdLevel()).c_str());
+
+  Timer stageTimer{};
+
+  /* the warmup frames fill the caches and scratch buffers, later frames must not allocate */
+  AllocationTracker::setEnabled(true);
+  size_t totalFrameAllocations = 0;
+  size_t maxFrameAllocations = 0;
+  size_t maxFrameAllocatedBytes = 0;
+
+  for (int frame = 0; frame < config.numWarmupFrames + config.numFrames; ++frame) {
+    AllocationTracker::resetCounters();
+
+    stageTimer.start();
+    if (config.animUpdateBudget > 0) {
+      animationLOD.selectInstances(instances, instanceVisible, LOD_CAMERA_POS,
+        LOD_FIELD_OF_VIEW, FRAME_TIME_STEP, -1);
+      const std::vector<int> &updateList = animationLOD.getUpdateList();
+      workerPool.parallelFor(updateList.size(), [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+          int index = updateList.at(i);
+          instances.at(index)->updateAnimation(animationLOD.getDeltaTime(index));
+        }
+      });
+    } else {
+      workerPool.parallelFor(instances.size(), [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+          instances.at(i)->updateAnimation(FRAME_TIME_STEP);
+        }
+      });
+    }
+    float animationTime = stageTimer.stop();
+
+    if (config.animUpdateBudget > 0) {
+      for (auto &frames : framesSinceUpdate) {
+        ++frames;
+      }
+      for (const auto index : animationLOD.getUpdateList()) {
+        framesSinceUpdate.at(index) = 0;
+      }
+    }
+
+    stageTimer.start();
+    workerPool.parallelFor(instances.size(), [&](size_t start, size_t end) {
+      for (size_t i = start; i < end; ++i) {
+        instances.at(i)->solveIK();
+      }
+    });
+    float ikTime = stageTimer.stop();
+
+    stageTimer.start();
+    workerPool.parallelFor(instances.size(), [&](size_t start, size_t end) {
+      for (size_t i = start; i < end; ++i) {
+        if (instances.at(i)->getInstanceSettings().msVertexSkinningMode ==
+            skinningMode::dualQuat) {
+          instances.at(i)->copyJointDualQuats(jointDualQuats.data() + i * jointDualQuatSize);
+        } else {
+          instances.at(i)->copyJointMatrices(jointMatrices.data() + i * jointMatrixSize);
+        }
+      }
+    });
+    float jointTime = stageTimer.stop();
+
+    size_t frameAllocations = AllocationTracker::getAllocationCount();
+    size_t frameAllocatedBytes = AllocationTracker::getAllocatedBytes();
+
+    if (frame < config.numWarmupFrames) {
+      continue;
+    }
+    totalFrameAllocations += frameAllocations;
+    maxFrameAllocations = std::max(maxFrameAllocations, frameAllocations);
+    maxFrameAllocatedBytes = std::max(maxFrameAllocatedBytes, frameAllocatedBytes);
+    animationTimes.emplace_back(animationTime);
+    ikTimes.emplace_back(ikTime);
+    jointTimes.emplace_back(jointTime);
+    frameTimes.emplace_back(animationTime + ikTime + jointTime);
+
+    if (config.animUpdateBudget > 0) {
+      for (int i = 0; i < config.numInstances; ++i) {
+        int level = animationLOD.getLODLevel(i);
+        maxFramesSinceUpdate[level] = std::max(maxFramesSinceUpdate[level],
+          framesSinceUpdate.at(i));
+      }
+    }
+  }
+
+  AllocationTracker::setEnabled(false);
+  workerPool.cleanup();
+
+  std::vector<StageStats> stages{};
+  stages.emplace_back(getStats("animation", animationTimes));
+  stages.emplace_back(getStats("ik", ikTimes));
+  stages.emplace_back(getStats("joint_data", jointTimes));
+  stages.emplace_back(getStats("frame", frameTimes));
+
+  float instancesPerSecond = config.numInstances / (stages.back().mean / 1000.0f);
+
+  Logger::log(1, "%-12s %10s %10s %10s\n", "stage (ms)", "mean", "p50", "p99");
+  for (const auto &stage : stages) {
+    Logger::log(1, "%-12s %10.4f %10.4f %10.4f\n", stage.name.c_str(), stage.mean,
+      stage.p50, stage.p99);
+  }
+  Logger::log(1, "throughput: %.1f instances/s\n", instancesPerSecond);
+  Logger::log(1, "allocations: %zu in %i frames, max %zu (%zu bytes) per frame\n",
+    totalFrameAllocations, config.numFrames, maxFrameAllocations, maxFrameAllocatedBytes);
+
+  bool frozenInstances = false;
+  if (config.animUpdateBudget > 0) {
+    Logger::log(1, "animation LOD: budget %i, most frames between updates per level:",
+      config.animUpdateBudget);
+    for (int level = 0; level < AnimationLOD::NUM_LOD_LEVELS; ++level) {
+      Logger::log(1, " %i: %i (%i instances)", level, maxFramesSinceUpdate[level],
+        animationLOD.getInstanceCount(level));
+      /* an instance without any update in the measured frames is frozen */
+      frozenInstances = frozenInstances || maxFramesSinceUpdate[level] >= config.numFrames;
+    }
+    Logger::log(1, "\n");
+  }
+
+  /* keep the results alive */
+  float checksum = jointMatrices.at(0)[3][0] + jointDualQuats.back()[1][0];
+  Logger::log(2, "%s: checksum %f\n", __FUNCTION__, checksum);
+
+  if (!config.jsonFilename.empty()) {
+    if (!writeJson(config, numThreads, stages, instancesPerSecond, maxFrameAllocations)) {
+      return 1;
+    }
+    Logger::log(1, "%s: results written to '%s'\n", __FUNCTION__, config.jsonFilename.c_str());
+  }
+
+  if (frozenInstances) {
+    Logger::log(1, "%s error: the update budget starves instances of the far levels\n",
+      __FUNCTION__);
+    return 1;
+  }
+
+  /* a steady state frame must not touch the heap, fail to flag the regression */
+  if (totalFrameAllocations > 0) {
+    Logger::log(1, "%s error: %zu heap allocations after the warmup frames\n", __FUNCTION__,
+      totalFrameAllocations);
+    return 1;
+  }
+
+  return 0;
+}
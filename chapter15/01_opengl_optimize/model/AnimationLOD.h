@@ -0,0 +1,57 @@
+/* animation update rate level of detail, far instances are animated less often */
+#pragma once
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "GltfInstance.h"
+#include "LODDistances.h"
+
+class AnimationLOD {
+  public:
+    /* level n updates every 2^n frames */
+    static constexpr int NUM_LOD_LEVELS = LODDistances::NUM_LOD_LEVELS;
+
+    void init(int numInstances);
+
+    void setEnabled(bool enabled);
+    /* camera distances where the levels 1 to 3 start, for a 60 degree field of view */
+    void setDistances(float lod1Distance, float lod2Distance, float lod3Distance);
+    /* maximum number of instance updates per frame, 0 updates all due instances */
+    void setUpdateBudget(int maxUpdates);
+    /* instances outside of the view are animated at the lowest rate */
+    void setReduceCulledUpdates(bool reduceUpdates);
+
+    /* picks the instances to animate in this frame, forcedInstance always updates,
+     * visibleInstances is the culling result of the last frame */
+    void selectInstances(const std::vector<std::shared_ptr<GltfInstance>> &instances,
+      const std::vector<bool> &visibleInstances, glm::vec3 cameraPos, int fieldOfView,
+      float deltaTime, int forcedInstance);
+
+    const std::vector<int> &getUpdateList();
+    /* time since the last update of a selected instance, for updateAnimation() */
+    float getDeltaTime(int instanceIndex);
+
+    /* level of the instance in the last selection */
+    int getLODLevel(int instanceIndex);
+    int getInstanceCount(int level);
+    int getUpdateCount(int level);
+
+  private:
+    bool mEnabled = true;
+    LODDistances mDistances{ 30.0f, 60.0f, 90.0f };
+    int mUpdateBudget = 0;
+    bool mReduceCulledUpdates = true;
+    unsigned int mFrameCount = 0;
+
+    std::vector<int> mLODLevels{};
+    std::vector<int> mFramesSinceUpdate{};
+    std::vector<float> mPendingTimes{};
+    std::vector<float> mDeltaTimes{};
+
+    std::vector<int> mCandidates{};
+    std::vector<int> mUpdateList{};
+
+    int mInstanceCounts[NUM_LOD_LEVELS] = {};
+    int mUpdateCounts[NUM_LOD_LEVELS] = {};
+};
@@ -1,7 +1,7 @@
 #include "CoordArrowsModel.h"
 #include "Logger.h"
 
-OGLMesh CoordArrowsModel::getVertexData() {
+const OGLMesh &CoordArrowsModel::getVertexData() {
   if (mVertexData.vertices.size() == 0) {
     init();
   }
@@ -7,7 +7,7 @@
 
 class CoordArrowsModel {
   public:
-    OGLMesh getVertexData();
+    const OGLMesh &getVertexData();
 
   private:
     void init();
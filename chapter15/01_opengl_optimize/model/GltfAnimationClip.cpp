@@ -1,70 +1,703 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
 #include "GltfAnimationClip.h"
+#include "SimdMath.h"
+#include "Logger.h"
+
+namespace {
+  /* stack buffer size for the interpolated values of the baked tracks */
+  constexpr int BAKED_BATCH_SIZE = 64;
+
+  /* stable order by the skeleton LOD level of the target nodes, highest level first */
+  template <typename T>
+  void sortTracksByLOD(std::vector<int> &nodes, std::vector<T> &values,
+      const std::vector<int> &nodeLevels) {
+    std::vector<size_t> order(nodes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return nodeLevels.at(nodes.at(a)) > nodeLevels.at(nodes.at(b));
+    });
+
+    std::vector<int> sortedNodes{};
+    std::vector<T> sortedValues{};
+    for (const auto index : order) {
+      sortedNodes.push_back(nodes.at(index));
+      sortedValues.push_back(values.at(index));
+    }
+    nodes.swap(sortedNodes);
+    values.swap(sortedValues);
+  }
+
+  /* the tracks of a sorted list that are still evaluated at the level */
+  int countLODTracks(const std::vector<int> &nodes, const std::vector<int> &nodeLevels,
+      int level) {
+    if (nodeLevels.empty()) {
+      return nodes.size();
+    }
+    int count = 0;
+    while (count < static_cast<int>(nodes.size()) && nodeLevels.at(nodes.at(count)) >= level) {
+      ++count;
+    }
+    return count;
+  }
+
+  /* replaces the frames by packed quats if all decoded rotations are within maxError */
+  bool packBakedQuats(std::vector<glm::quat> &values, float maxError,
+      std::vector<GltfPackedQuat> &packedValues) {
+    if (values.empty()) {
+      return false;
+    }
+
+    std::vector<GltfPackedQuat> packed(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      packed.at(i) = GltfTrackCompression::packQuat(values.at(i));
+      glm::quat unpacked = GltfTrackCompression::unpackQuat(packed.at(i));
+      if (GltfTrackCompression::getQuatError(glm::normalize(values.at(i)), unpacked) >
+          maxError) {
+        return false;
+      }
+    }
+
+    packedValues.swap(packed);
+    values.clear();
+    values.shrink_to_fit();
+    return true;
+  }
+
+  /* frame blocks of numTracks values, quantized to the value range of each track */
+  bool packBakedVec3s(std::vector<glm::vec3> &values, int numTracks, float maxError,
+      std::vector<GltfPackedVec3> &packedValues, std::vector<glm::vec3> &rangeMins,
+      std::vector<glm::vec3> &rangeExtents) {
+    if (numTracks == 0) {
+      return false;
+    }
+
+    std::vector<glm::vec3> mins(values.begin(), values.begin() + numTracks);
+    std::vector<glm::vec3> maxs(values.begin(), values.begin() + numTracks);
+    for (size_t i = 0; i < values.size(); ++i) {
+      mins.at(i % numTracks) = glm::min(mins.at(i % numTracks), values.at(i));
+      maxs.at(i % numTracks) = glm::max(maxs.at(i % numTracks), values.at(i));
+    }
+    std::vector<glm::vec3> extents(numTracks);
+    for (int i = 0; i < numTracks; ++i) {
+      extents.at(i) = maxs.at(i) - mins.at(i);
+    }
+
+    std::vector<GltfPackedVec3> packed(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      int track = i % numTracks;
+      packed.at(i) = GltfTrackCompression::packVec3(values.at(i), mins.at(track),
+        extents.at(track));
+      glm::vec3 unpacked = GltfTrackCompression::unpackVec3(packed.at(i), mins.at(track),
+        extents.at(track));
+      if (GltfTrackCompression::getVec3Error(values.at(i), unpacked) > maxError) {
+        return false;
+      }
+    }
+
+    packedValues.swap(packed);
+    rangeMins.swap(mins);
+    rangeExtents.swap(extents);
+    values.clear();
+    values.shrink_to_fit();
+    return true;
+  }
+
+  /* nlerp of the first count tracks between two frames, packed frames are unpacked first;
+   * nlerp is enough, the frames are close together */
+  void sampleBakedQuats(const std::vector<glm::quat> &values,
+      const std::vector<GltfPackedQuat> &packedValues, const std::vector<int> &nodes,
+      int frame, float interp, int count, std::vector<glm::quat> &poseValues) {
+    int numTracks = nodes.size();
+    glm::quat prevValues[BAKED_BATCH_SIZE];
+    glm::quat nextValues[BAKED_BATCH_SIZE];
+    glm::quat results[BAKED_BATCH_SIZE];
+
+    for (int start = 0; start < count; start += BAKED_BATCH_SIZE) {
+      int batchCount = std::min(count - start, BAKED_BATCH_SIZE);
+      const glm::quat *prev = prevValues;
+      const glm::quat *next = nextValues;
+      if (packedValues.empty()) {
+        prev = values.data() + frame * numTracks + start;
+        next = prev + numTracks;
+      } else {
+        const GltfPackedQuat *prevPacked = packedValues.data() + frame * numTracks + start;
+        const GltfPackedQuat *nextPacked = prevPacked + numTracks;
+        for (int i = 0; i < batchCount; ++i) {
+          prevValues[i] = GltfTrackCompression::unpackQuat(prevPacked[i]);
+          nextValues[i] = GltfTrackCompression::unpackQuat(nextPacked[i]);
+        }
+      }
+      SimdMath::nlerpQuats(prev, next, interp, results, batchCount);
+      for (int i = 0; i < batchCount; ++i) {
+        poseValues[nodes[start + i]] = results[i];
+      }
+    }
+  }
+
+  void sampleBakedVec3s(const std::vector<glm::vec3> &values,
+      const std::vector<GltfPackedVec3> &packedValues, const std::vector<glm::vec3> &rangeMins,
+      const std::vector<glm::vec3> &rangeExtents, const std::vector<int> &nodes, int frame,
+      float interp, int count, std::vector<glm::vec3> &poseValues) {
+    int numTracks = nodes.size();
+    glm::vec3 prevValues[BAKED_BATCH_SIZE];
+    glm::vec3 nextValues[BAKED_BATCH_SIZE];
+    glm::vec3 results[BAKED_BATCH_SIZE];
+
+    for (int start = 0; start < count; start += BAKED_BATCH_SIZE) {
+      int batchCount = std::min(count - start, BAKED_BATCH_SIZE);
+      const glm::vec3 *prev = prevValues;
+      const glm::vec3 *next = nextValues;
+      if (packedValues.empty()) {
+        prev = values.data() + frame * numTracks + start;
+        next = prev + numTracks;
+      } else {
+        const GltfPackedVec3 *prevPacked = packedValues.data() + frame * numTracks + start;
+        const GltfPackedVec3 *nextPacked = prevPacked + numTracks;
+        for (int i = 0; i < batchCount; ++i) {
+          prevValues[i] = GltfTrackCompression::unpackVec3(prevPacked[i],
+            rangeMins[start + i], rangeExtents[start + i]);
+          nextValues[i] = GltfTrackCompression::unpackVec3(nextPacked[i],
+            rangeMins[start + i], rangeExtents[start + i]);
+        }
+      }
+      SimdMath::lerpVec3s(prev, next, interp, results, batchCount);
+      for (int i = 0; i < batchCount; ++i) {
+        poseValues[nodes[start + i]] = results[i];
+      }
+    }
+  }
+}
 
 GltfAnimationClip::GltfAnimationClip(std::string name) : mClipName(name) {}
 
 void GltfAnimationClip::addChannel(std::shared_ptr<tinygltf::Model> model,
-    tinygltf::Animation anim, tinygltf::AnimationChannel channel) {
+    tinygltf::Animation anim, tinygltf::AnimationChannel channel, int targetNode) {
   std::shared_ptr<GltfAnimationChannel> chan = std::make_shared<GltfAnimationChannel>();
-  chan->loadChannelData(model, anim, channel);
-  mAnimationChannels.push_back(chan);
+  chan->loadChannelData(model, anim, channel, targetNode);
+
+  mClipEndTime = std::max(mClipEndTime, chan->getMaxTime());
+  addKeyedChannel(chan);
 }
 
-void GltfAnimationClip::setAnimationFrame(std::vector<std::shared_ptr<GltfNode>> nodes,
-    std::vector<bool> additiveMask, float time) {
-  for (auto &channel : mAnimationChannels) {
+void GltfAnimationClip::addKeyedChannel(std::shared_ptr<GltfAnimationChannel> channel) {
+  /* the channels of a node or skeleton are usually keyed at the same times */
+  std::shared_ptr<GltfAnimationTimeline> channelTimeline = channel->getTimeline();
+  auto timelineIter = std::find_if(mTimelines.begin(), mTimelines.end(),
+    [&](const std::shared_ptr<GltfAnimationTimeline> &timeline) {
+      return timeline->isEqual(*channelTimeline);
+    });
+
+  if (timelineIter == mTimelines.end()) {
+    mChannelTimelines.push_back(mTimelines.size());
+    mTimelines.push_back(channelTimeline);
+  } else {
+    mChannelTimelines.push_back(timelineIter - mTimelines.begin());
+    channel->setTimeline(*timelineIter);
+  }
+
+  mAnimationChannels.push_back(channel);
+}
+
+void GltfAnimationClip::setChannels(std::vector<std::shared_ptr<GltfAnimationChannel>> channels) {
+  mAnimationChannels.clear();
+  mTimelines.clear();
+  mChannelTimelines.clear();
+  for (const auto &channel : channels) {
+    addKeyedChannel(channel);
+  }
+  updateLODTrackCounts();
+}
+
+void GltfAnimationClip::extractConstantTracks(float tolerance) {
+  std::vector<std::shared_ptr<GltfAnimationChannel>> keyedChannels{};
+  GltfKeySegment firstKey{};
+
+  for (const auto &channel : mAnimationChannels) {
+    if (!channel->isConstant(tolerance)) {
+      keyedChannels.push_back(channel);
+      continue;
+    }
+
     int targetNode = channel->getTargetNode();
-    /* do not change if masked out */
-    if (additiveMask.at(targetNode)) {
-      switch(channel->getTargetPath()) {
-        case ETargetPath::ROTATION:
-          nodes.at(targetNode)->setRotation(channel->getRotation(time));
-          break;
-        case ETargetPath::TRANSLATION:
-          nodes.at(targetNode)->setTranslation(channel->getTranslation(time));
-          break;
-        case ETargetPath::SCALE:
-          nodes.at(targetNode)->setScale(channel->getScaling(time));
-          break;
+    switch(channel->getTargetPath()) {
+      case ETargetPath::ROTATION:
+        mConstantRotationNodes.push_back(targetNode);
+        mConstantRotations.push_back(channel->getRotation(firstKey));
+        break;
+      case ETargetPath::TRANSLATION:
+        mConstantTranslationNodes.push_back(targetNode);
+        mConstantTranslations.push_back(channel->getTranslation(firstKey));
+        break;
+      case ETargetPath::SCALE:
+        mConstantScaleNodes.push_back(targetNode);
+        mConstantScales.push_back(channel->getScaling(firstKey));
+        break;
+    }
+  }
+
+  setChannels(keyedChannels);
+}
+
+std::vector<bool> GltfAnimationClip::getBindPoseTracks(ETargetPath path,
+    const std::vector<glm::vec3> &bindValues, float tolerance) {
+  std::vector<bool> bindPoseTracks(bindValues.size(), true);
+  if (path == ETargetPath::ROTATION) {
+    Logger::log(1, "%s error: only translations and scales are supported\n", __FUNCTION__);
+    bindPoseTracks.assign(bindValues.size(), false);
+    return bindPoseTracks;
+  }
+
+  for (const auto &channel : mAnimationChannels) {
+    if (channel->getTargetPath() == path) {
+      bindPoseTracks.at(channel->getTargetNode()) = false;
+    }
+  }
+
+  const std::vector<int> &nodes = path == ETargetPath::TRANSLATION ?
+    mConstantTranslationNodes : mConstantScaleNodes;
+  const std::vector<glm::vec3> &values = path == ETargetPath::TRANSLATION ?
+    mConstantTranslations : mConstantScales;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    glm::vec3 difference = glm::abs(values.at(i) - bindValues.at(nodes.at(i)));
+    if (std::max(difference.x, std::max(difference.y, difference.z)) > tolerance) {
+      bindPoseTracks.at(nodes.at(i)) = false;
+    }
+  }
+  return bindPoseTracks;
+}
+
+void GltfAnimationClip::removeConstantTracks(ETargetPath path, const std::vector<bool> &nodes) {
+  auto removeTracks = [&](std::vector<int> &trackNodes, auto &trackValues) {
+    size_t numKept = 0;
+    for (size_t i = 0; i < trackNodes.size(); ++i) {
+      if (nodes.at(trackNodes.at(i))) {
+        continue;
+      }
+      trackNodes.at(numKept) = trackNodes.at(i);
+      trackValues.at(numKept) = trackValues.at(i);
+      ++numKept;
+    }
+    trackNodes.resize(numKept);
+    trackValues.resize(numKept);
+  };
+
+  switch(path) {
+    case ETargetPath::ROTATION:
+      removeTracks(mConstantRotationNodes, mConstantRotations);
+      break;
+    case ETargetPath::TRANSLATION:
+      removeTracks(mConstantTranslationNodes, mConstantTranslations);
+      break;
+    case ETargetPath::SCALE:
+      removeTracks(mConstantScaleNodes, mConstantScales);
+      break;
+  }
+  updateLODTrackCounts();
+}
+
+int GltfAnimationClip::reduceKeys(float tolerance) {
+  int numRemovedKeys = 0;
+
+  for (const auto &channel : mAnimationChannels) {
+    if (channel->getInterpolationType() == EInterpolationType::CUBICSPLINE) {
+      continue;
+    }
+    std::shared_ptr<GltfAnimationTimeline> timeline = channel->getTimeline();
+    int keyCount = timeline->getKeyCount();
+    if (keyCount < 3) {
+      continue;
+    }
+
+    /* extend the segment of the last kept key while it still reproduces the skipped keys */
+    std::vector<int> keptKeys{0};
+    for (int key = 1; key < keyCount - 1; ++key) {
+      if (!canSkipKeys(*channel, *timeline, keptKeys.back(), key + 1, tolerance)) {
+        keptKeys.push_back(key);
+      }
+    }
+    keptKeys.push_back(keyCount - 1);
+
+    /* an own timeline costs a segment search per frame, worth it for sparse channels only */
+    if (static_cast<int>(keptKeys.size()) * 2 > keyCount) {
+      continue;
+    }
+
+    std::vector<float> keptKeyTimes{};
+    for (const auto key : keptKeys) {
+      keptKeyTimes.push_back(timeline->getKeyTime(key));
+    }
+    channel->keepKeys(keptKeys, std::make_shared<GltfAnimationTimeline>(keptKeyTimes));
+    numRemovedKeys += keyCount - keptKeys.size();
+  }
+
+  /* reduced timelines may still be equal */
+  setChannels(mAnimationChannels);
+  return numRemovedKeys;
+}
+
+void GltfAnimationClip::setSkeletonLODs(const GltfSkeleton &skeleton) {
+  if (mBakedFrameCount > 0) {
+    Logger::log(1, "%s error: clip '%s' is already baked\n", __FUNCTION__, mClipName.c_str());
+    return;
+  }
+  mNodeLODLevels = skeleton.getLODMaxLevels();
+
+  std::vector<std::shared_ptr<GltfAnimationChannel>> channels = mAnimationChannels;
+  std::stable_sort(channels.begin(), channels.end(),
+    [&](const std::shared_ptr<GltfAnimationChannel> &a,
+        const std::shared_ptr<GltfAnimationChannel> &b) {
+      return mNodeLODLevels.at(a->getTargetNode()) > mNodeLODLevels.at(b->getTargetNode());
+    });
+  sortTracksByLOD(mConstantRotationNodes, mConstantRotations, mNodeLODLevels);
+  sortTracksByLOD(mConstantTranslationNodes, mConstantTranslations, mNodeLODLevels);
+  sortTracksByLOD(mConstantScaleNodes, mConstantScales, mNodeLODLevels);
+
+  /* also updates the track counts */
+  setChannels(channels);
+}
+
+void GltfAnimationClip::updateLODTrackCounts() {
+  for (int level = 0; level < GltfSkeleton::NUM_LOD_LEVELS; ++level) {
+    LODTrackCounts &counts = mLODTrackCounts[level];
+
+    counts.channels = 0;
+    for (const auto &channel : mAnimationChannels) {
+      if (!mNodeLODLevels.empty() && mNodeLODLevels.at(channel->getTargetNode()) < level) {
+        break;
       }
+      ++counts.channels;
     }
+
+    counts.constantRotations = countLODTracks(mConstantRotationNodes, mNodeLODLevels, level);
+    counts.constantTranslations = countLODTracks(mConstantTranslationNodes, mNodeLODLevels,
+      level);
+    counts.constantScales = countLODTracks(mConstantScaleNodes, mNodeLODLevels, level);
+    counts.bakedRotations = countLODTracks(mBakedRotationNodes, mNodeLODLevels, level);
+    counts.bakedTranslations = countLODTracks(mBakedTranslationNodes, mNodeLODLevels, level);
+    counts.bakedScales = countLODTracks(mBakedScaleNodes, mNodeLODLevels, level);
   }
-  /* update all nodes in a single run */
-  for (auto &node : nodes) {
-    if (node) {
-      node->calculateLocalTRSMatrix();
+}
+
+bool GltfAnimationClip::canSkipKeys(GltfAnimationChannel &channel,
+    const GltfAnimationTimeline &timeline, int prevKey, int nextKey, float tolerance) {
+  float prevTime = timeline.getKeyTime(prevKey);
+  float nextTime = timeline.getKeyTime(nextKey);
+
+  GltfKeySegment segment{};
+  segment.prevKey = prevKey;
+  segment.nextKey = nextKey;
+
+  for (int key = prevKey + 1; key < nextKey; ++key) {
+    segment.interpolation = (timeline.getKeyTime(key) - prevTime) / (nextTime - prevTime);
+    if (channel.getKeyError(segment, key) > tolerance) {
+      return false;
     }
   }
+  return true;
+}
+
+void GltfAnimationClip::sampleAnimationFrame(GltfLocalPose &pose, float time) {
+  GltfAnimationCursor cursor{};
+  sampleAnimationFrame(pose, time, cursor);
+}
+
+void GltfAnimationClip::sampleAnimationFrame(GltfLocalPose &pose, float time,
+    GltfAnimationCursor &cursor) {
+  sampleAnimationFrame(pose, time, cursor, 0);
 }
 
-void GltfAnimationClip::blendAnimationFrame(std::vector<std::shared_ptr<GltfNode>> nodes,
-    std::vector<bool> additiveMask, float time, float blendFactor) {
-  for (auto &channel : mAnimationChannels) {
+void GltfAnimationClip::sampleAnimationFrame(GltfLocalPose &pose, float time,
+    GltfAnimationCursor &cursor, int skeletonLODLevel) {
+  const LODTrackCounts &counts = mLODTrackCounts[std::clamp(skeletonLODLevel, 0,
+    GltfSkeleton::NUM_LOD_LEVELS - 1)];
+
+  sampleConstantTracks(pose, counts);
+  if (mUseBakedData) {
+    sampleBakedFrame(pose, time, counts);
+  } else {
+    sampleChannels(pose, time, cursor, counts.channels);
+  }
+}
+
+void GltfAnimationClip::sampleConstantTracks(GltfLocalPose &pose,
+    const LODTrackCounts &counts) {
+  for (int i = 0; i < counts.constantRotations; ++i) {
+    pose.rotations[mConstantRotationNodes[i]] = mConstantRotations[i];
+  }
+  for (int i = 0; i < counts.constantTranslations; ++i) {
+    pose.translations[mConstantTranslationNodes[i]] = mConstantTranslations[i];
+  }
+  for (int i = 0; i < counts.constantScales; ++i) {
+    pose.scales[mConstantScaleNodes[i]] = mConstantScales[i];
+  }
+}
+
+void GltfAnimationClip::sampleChannels(GltfLocalPose &pose, float time,
+    GltfAnimationCursor &cursor, int numChannels) {
+  if (cursor.timelineKeys.size() != mTimelines.size()) {
+    cursor.timelineKeys.assign(mTimelines.size(), 0);
+    cursor.segments.resize(mTimelines.size());
+  }
+
+  for (size_t i = 0; i < mTimelines.size(); ++i) {
+    cursor.segments[i] = mTimelines[i]->findSegment(time, cursor.timelineKeys[i]);
+  }
+
+  for (int i = 0; i < numChannels; ++i) {
+    const std::shared_ptr<GltfAnimationChannel> &channel = mAnimationChannels[i];
     int targetNode = channel->getTargetNode();
-    /* do not change if masked out */
-    if (additiveMask.at(targetNode)) {
-      switch(channel->getTargetPath()) {
-        case ETargetPath::ROTATION:
-          nodes.at(targetNode)->blendRotation(channel->getRotation(time), blendFactor);
-          break;
-        case ETargetPath::TRANSLATION:
-          nodes.at(targetNode)->blendTranslation(channel->getTranslation(time), blendFactor);
-          break;
-        case ETargetPath::SCALE:
-          nodes.at(targetNode)->blendScale(channel->getScaling(time), blendFactor);
-          break;
+    const GltfKeySegment &segment = cursor.segments[mChannelTimelines[i]];
+
+    switch(channel->getTargetPath()) {
+      case ETargetPath::ROTATION:
+        pose.rotations[targetNode] = channel->getRotation(segment);
+        break;
+      case ETargetPath::TRANSLATION:
+        pose.translations[targetNode] = channel->getTranslation(segment);
+        break;
+      case ETargetPath::SCALE:
+        pose.scales[targetNode] = channel->getScaling(segment);
+        break;
+    }
+  }
+}
+
+void GltfAnimationClip::bakeClip(float framesPerSecond) {
+  std::vector<std::shared_ptr<GltfAnimationChannel>> rotationChannels{};
+  std::vector<std::shared_ptr<GltfAnimationChannel>> translationChannels{};
+  std::vector<std::shared_ptr<GltfAnimationChannel>> scaleChannels{};
+
+  /* the split keeps the skeleton LOD order of the channels */
+  for (const auto &channel : mAnimationChannels) {
+    switch(channel->getTargetPath()) {
+      case ETargetPath::ROTATION:
+        rotationChannels.push_back(channel);
+        break;
+      case ETargetPath::TRANSLATION:
+        translationChannels.push_back(channel);
+        break;
+      case ETargetPath::SCALE:
+        scaleChannels.push_back(channel);
+        break;
+    }
+  }
+
+  mBakedRotationNodes.clear();
+  mBakedTranslationNodes.clear();
+  mBakedScaleNodes.clear();
+  for (const auto &channel : rotationChannels) {
+    mBakedRotationNodes.push_back(channel->getTargetNode());
+  }
+  for (const auto &channel : translationChannels) {
+    mBakedTranslationNodes.push_back(channel->getTargetNode());
+  }
+  for (const auto &channel : scaleChannels) {
+    mBakedScaleNodes.push_back(channel->getTargetNode());
+  }
+
+  /* last frame is exactly at the clip end, at least two frames to interpolate */
+  float endTime = getClipEndTime();
+  mBakedFrameRate = framesPerSecond;
+  mBakedFrameCount = std::max(static_cast<int>(std::ceil(endTime * mBakedFrameRate)) + 1, 2);
+
+  size_t numRotations = rotationChannels.size();
+  size_t numTranslations = translationChannels.size();
+  size_t numScales = scaleChannels.size();
+
+  mBakedRotations.resize(mBakedFrameCount * numRotations);
+  mBakedTranslations.resize(mBakedFrameCount * numTranslations);
+  mBakedScales.resize(mBakedFrameCount * numScales);
+
+  for (int frame = 0; frame < mBakedFrameCount; ++frame) {
+    float time = std::min(frame / mBakedFrameRate, endTime);
+
+    for (size_t i = 0; i < numRotations; ++i) {
+      glm::quat rotation = rotationChannels.at(i)->getRotation(time);
+
+      /* keep neighbouring frames in the same hemisphere, no sign check while sampling */
+      if (frame > 0 &&
+          glm::dot(mBakedRotations.at((frame - 1) * numRotations + i), rotation) < 0.0f) {
+        rotation = -rotation;
       }
+      mBakedRotations.at(frame * numRotations + i) = rotation;
+    }
+    for (size_t i = 0; i < numTranslations; ++i) {
+      mBakedTranslations.at(frame * numTranslations + i) =
+        translationChannels.at(i)->getTranslation(time);
+    }
+    for (size_t i = 0; i < numScales; ++i) {
+      mBakedScales.at(frame * numScales + i) = scaleChannels.at(i)->getScaling(time);
     }
   }
-  /* update all nodes in a single run */
-  for (auto &node : nodes) {
-    if (node) {
-      node->calculateLocalTRSMatrix();
+
+  updateLODTrackCounts();
+
+  /* a new bake replaces the quantized frames of an earlier compression */
+  mPackedBakedRotations.clear();
+  mPackedBakedTranslations.clear();
+  mPackedBakedScales.clear();
+  mBakedTranslationMins.clear();
+  mBakedTranslationExtents.clear();
+  mBakedScaleMins.clear();
+  mBakedScaleExtents.clear();
+
+  Logger::log(1, "%s: clip '%s' baked to %i frames at %.0f fps, %i bytes "
+    "(channels: %i bytes, %i timelines)\n", __FUNCTION__, mClipName.c_str(), mBakedFrameCount,
+    mBakedFrameRate, getBakedDataSize(), getDataSize(), mTimelines.size());
+}
+
+void GltfAnimationClip::setUseBakedData(bool useBakedData) {
+  /* a clip without baked frames must use the channels */
+  mUseBakedData = useBakedData && mBakedFrameCount > 0;
+}
+
+void GltfAnimationClip::compressClip(float maxError) {
+  size_t floatDataSize = 0;
+  size_t compressedDataSize = 0;
+
+  int numCompressedTimelines = 0;
+  for (const auto &timeline : mTimelines) {
+    floatDataSize += timeline->getDataSize();
+    if (timeline->compress(maxError)) {
+      ++numCompressedTimelines;
+    }
+    compressedDataSize += timeline->getDataSize();
+  }
+
+  int numCompressedChannels = 0;
+  for (const auto &channel : mAnimationChannels) {
+    floatDataSize += channel->getDataSize();
+    if (channel->compress(maxError)) {
+      ++numCompressedChannels;
     }
+    compressedDataSize += channel->getDataSize();
+  }
+
+  Logger::log(1, "%s: clip '%s' compressed from %i to %i bytes, %i of %i channels and "
+    "%i of %i timelines within max error %g\n", __FUNCTION__, mClipName.c_str(),
+    floatDataSize, compressedDataSize, numCompressedChannels, mAnimationChannels.size(),
+    numCompressedTimelines, mTimelines.size(), maxError);
+
+  /* the baked frames are sampled instead of the keys, they need the same error bound */
+  if (mBakedFrameCount > 0) {
+    size_t floatBakedSize = getBakedDataSize();
+    int numPackedLists = packBakedFrames(maxError);
+    Logger::log(1, "%s: clip '%s' baked frames compressed from %i to %i bytes, %i of 3 "
+      "track lists within max error %g\n", __FUNCTION__, mClipName.c_str(), floatBakedSize,
+      getBakedDataSize(), numPackedLists, maxError);
+  }
+}
+
+int GltfAnimationClip::packBakedFrames(float maxError) {
+  int numPackedLists = 0;
+  if (!mPackedBakedRotations.empty() ||
+      packBakedQuats(mBakedRotations, maxError, mPackedBakedRotations)) {
+    ++numPackedLists;
+  }
+  if (!mPackedBakedTranslations.empty() ||
+      packBakedVec3s(mBakedTranslations, mBakedTranslationNodes.size(), maxError,
+      mPackedBakedTranslations, mBakedTranslationMins, mBakedTranslationExtents)) {
+    ++numPackedLists;
+  }
+  if (!mPackedBakedScales.empty() ||
+      packBakedVec3s(mBakedScales, mBakedScaleNodes.size(), maxError, mPackedBakedScales,
+      mBakedScaleMins, mBakedScaleExtents)) {
+    ++numPackedLists;
+  }
+  return numPackedLists;
+}
+
+size_t GltfAnimationClip::getBakedDataSize() {
+  return mBakedRotations.size() * sizeof(glm::quat) +
+    (mBakedTranslations.size() + mBakedScales.size()) * sizeof(glm::vec3) +
+    mPackedBakedRotations.size() * sizeof(GltfPackedQuat) +
+    (mPackedBakedTranslations.size() + mPackedBakedScales.size()) * sizeof(GltfPackedVec3) +
+    (mBakedTranslationMins.size() + mBakedTranslationExtents.size() +
+    mBakedScaleMins.size() + mBakedScaleExtents.size()) * sizeof(glm::vec3);
+}
+
+size_t GltfAnimationClip::getDataSize() {
+  size_t dataSize = 0;
+  for (const auto &timeline : mTimelines) {
+    dataSize += timeline->getDataSize();
+  }
+  for (const auto &channel : mAnimationChannels) {
+    dataSize += channel->getDataSize();
+  }
+  dataSize += mConstantRotations.size() * sizeof(glm::quat) +
+    (mConstantTranslations.size() + mConstantScales.size()) * sizeof(glm::vec3);
+  return dataSize;
+}
+
+int GltfAnimationClip::getBakedFrameCount() {
+  return mBakedFrameCount;
+}
+
+float GltfAnimationClip::getBakedFrameRate() {
+  return mBakedFrameRate;
+}
+
+void GltfAnimationClip::copyBakedFrame(int frame, glm::quat *rotations,
+    glm::vec3 *translations, glm::vec3 *scales) {
+  if (frame < 0 || frame >= mBakedFrameCount) {
+    Logger::log(1, "%s error: frame %i is out of range for clip '%s'\n", __FUNCTION__, frame,
+      mClipName.c_str());
+    return;
+  }
+
+  for (size_t i = 0; i < mConstantRotationNodes.size(); ++i) {
+    rotations[mConstantRotationNodes[i]] = mConstantRotations[i];
+  }
+  for (size_t i = 0; i < mConstantTranslationNodes.size(); ++i) {
+    translations[mConstantTranslationNodes[i]] = mConstantTranslations[i];
+  }
+  for (size_t i = 0; i < mConstantScaleNodes.size(); ++i) {
+    scales[mConstantScaleNodes[i]] = mConstantScales[i];
+  }
+
+  int numRotations = mBakedRotationNodes.size();
+  int numTranslations = mBakedTranslationNodes.size();
+  int numScales = mBakedScaleNodes.size();
+
+  for (int i = 0; i < numRotations; ++i) {
+    int index = frame * numRotations + i;
+    rotations[mBakedRotationNodes[i]] = mPackedBakedRotations.empty() ? mBakedRotations[index] :
+      GltfTrackCompression::unpackQuat(mPackedBakedRotations[index]);
   }
+  for (int i = 0; i < numTranslations; ++i) {
+    int index = frame * numTranslations + i;
+    translations[mBakedTranslationNodes[i]] = mPackedBakedTranslations.empty() ?
+      mBakedTranslations[index] : GltfTrackCompression::unpackVec3(
+      mPackedBakedTranslations[index], mBakedTranslationMins[i], mBakedTranslationExtents[i]);
+  }
+  for (int i = 0; i < numScales; ++i) {
+    int index = frame * numScales + i;
+    scales[mBakedScaleNodes[i]] = mPackedBakedScales.empty() ? mBakedScales[index] :
+      GltfTrackCompression::unpackVec3(mPackedBakedScales[index], mBakedScaleMins[i],
+      mBakedScaleExtents[i]);
+  }
+}
+
+void GltfAnimationClip::sampleBakedFrame(GltfLocalPose &pose, float time,
+    const LODTrackCounts &counts) {
+  float framePos = std::clamp(time * mBakedFrameRate, 0.0f, mBakedFrameCount - 1.0f);
+  int frame = std::min(static_cast<int>(framePos), mBakedFrameCount - 2);
+  float interp = framePos - frame;
+
+  sampleBakedQuats(mBakedRotations, mPackedBakedRotations, mBakedRotationNodes, frame, interp,
+    counts.bakedRotations, pose.rotations);
+  sampleBakedVec3s(mBakedTranslations, mPackedBakedTranslations, mBakedTranslationMins,
+    mBakedTranslationExtents, mBakedTranslationNodes, frame, interp, counts.bakedTranslations,
+    pose.translations);
+  sampleBakedVec3s(mBakedScales, mPackedBakedScales, mBakedScaleMins, mBakedScaleExtents,
+    mBakedScaleNodes, frame, interp, counts.bakedScales, pose.scales);
 }
 
 float GltfAnimationClip::getClipEndTime() {
-  return mAnimationChannels.at(0)->getMaxTime();;
+  return mClipEndTime;
 }
 
 std::string GltfAnimationClip::getClipName() {
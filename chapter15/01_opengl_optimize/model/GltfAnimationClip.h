@@ -5,25 +5,125 @@
 #include <memory>
 #include <tiny_gltf.h>
 
-#include "GltfNode.h"
+#include "GltfLocalPose.h"
 #include "GltfAnimationChannel.h"
+#include "GltfSkeleton.h"
 
 class GltfAnimationClip {
   public:
     GltfAnimationClip(std::string name);
     void addChannel(std::shared_ptr<tinygltf::Model> model, tinygltf::Animation anim,
-      tinygltf::AnimationChannel channel);
+      tinygltf::AnimationChannel channel, int targetNode);
 
-    void setAnimationFrame(std::vector<std::shared_ptr<GltfNode>> nodes,
-      std::vector<bool> additiveMask, float time);
-    void blendAnimationFrame(std::vector<std::shared_ptr<GltfNode>> nodes,
-      std::vector<bool> additiveMask, float time, float blendFactor);
+    /* writes the values of all tracks of the clip, other nodes keep their values */
+    void sampleAnimationFrame(GltfLocalPose &pose, float time);
+    /* same as above, the cursor keeps the last key segments of the caller */
+    void sampleAnimationFrame(GltfLocalPose &pose, float time, GltfAnimationCursor &cursor);
+    /* only the tracks of the nodes evaluated by the skeleton LOD level */
+    void sampleAnimationFrame(GltfLocalPose &pose, float time, GltfAnimationCursor &cursor,
+      int skeletonLODLevel);
+
+    /* load-time optimization, channels that never change become constants, the
+     * keys that the neighbours interpolate within the tolerance are removed */
+    void extractConstantTracks(float tolerance);
+    /* per node, true if the clip does not move the node from the bind values */
+    std::vector<bool> getBindPoseTracks(ETargetPath path,
+      const std::vector<glm::vec3> &bindValues, float tolerance);
+    void removeConstantTracks(ETargetPath path, const std::vector<bool> &nodes);
+    int reduceKeys(float tolerance);
+    /* sorts the tracks by the skeleton LOD levels of their nodes, done before baking */
+    void setSkeletonLODs(const GltfSkeleton &skeleton);
+
+    /* resample all channels to a fixed rate, a sample is then a single index lookup */
+    void bakeClip(float framesPerSecond);
+    void setUseBakedData(bool useBakedData);
+
+    /* quantize the keyframe data and the baked frames within maxError, done after baking */
+    void compressClip(float maxError);
+    /* keyframe data of the channels and timelines, without the baked frames */
+    size_t getDataSize();
+
+    int getBakedFrameCount();
+    float getBakedFrameRate();
+    /* one value per node, nodes without a track keep the values already in the arrays */
+    void copyBakedFrame(int frame, glm::quat *rotations, glm::vec3 *translations,
+      glm::vec3 *scales);
 
     float getClipEndTime();
     std::string getClipName();
 
   private:
+    void addKeyedChannel(std::shared_ptr<GltfAnimationChannel> channel);
+    void setChannels(std::vector<std::shared_ptr<GltfAnimationChannel>> channels);
+    bool canSkipKeys(GltfAnimationChannel &channel, const GltfAnimationTimeline &timeline,
+      int prevKey, int nextKey, float tolerance);
+
+    void updateLODTrackCounts();
+
+    /* number of tracks per list that a skeleton LOD level samples */
+    struct LODTrackCounts {
+      int channels = 0;
+      int constantRotations = 0;
+      int constantTranslations = 0;
+      int constantScales = 0;
+      int bakedRotations = 0;
+      int bakedTranslations = 0;
+      int bakedScales = 0;
+    };
+
+    void sampleConstantTracks(GltfLocalPose &pose, const LODTrackCounts &counts);
+    void sampleChannels(GltfLocalPose &pose, float time, GltfAnimationCursor &cursor,
+      int numChannels);
+    void sampleBakedFrame(GltfLocalPose &pose, float time, const LODTrackCounts &counts);
+
+    /* replaces the float frames of each track list that stays within maxError,
+     * returns the number of packed lists */
+    int packBakedFrames(float maxError);
+    size_t getBakedDataSize();
+
     std::vector<std::shared_ptr<GltfAnimationChannel>> mAnimationChannels{};
 
+    /* unique key times of the channels, one segment search per timeline */
+    std::vector<std::shared_ptr<GltfAnimationTimeline>> mTimelines{};
+    std::vector<int> mChannelTimelines{};
+
+    /* tracks without keys, set without a search or an interpolation */
+    std::vector<int> mConstantRotationNodes{};
+    std::vector<glm::quat> mConstantRotations{};
+    std::vector<int> mConstantTranslationNodes{};
+    std::vector<glm::vec3> mConstantTranslations{};
+    std::vector<int> mConstantScaleNodes{};
+    std::vector<glm::vec3> mConstantScales{};
+
     std::string mClipName;
+    float mClipEndTime = 0.0f;
+
+    bool mUseBakedData = false;
+    float mBakedFrameRate = 0.0f;
+    int mBakedFrameCount = 0;
+
+    /* target nodes of the baked tracks */
+    std::vector<int> mBakedRotationNodes{};
+    std::vector<int> mBakedTranslationNodes{};
+    std::vector<int> mBakedScaleNodes{};
+
+    /* one block per frame, containing the values of all tracks */
+    std::vector<glm::quat> mBakedRotations{};
+    std::vector<glm::vec3> mBakedTranslations{};
+    std::vector<glm::vec3> mBakedScales{};
+
+    /* quantized frames, same layout as the float frames, value ranges per track; a list is
+     * either packed or float, a root translation with a large range may need the floats */
+    std::vector<GltfPackedQuat> mPackedBakedRotations{};
+    std::vector<GltfPackedVec3> mPackedBakedTranslations{};
+    std::vector<GltfPackedVec3> mPackedBakedScales{};
+    std::vector<glm::vec3> mBakedTranslationMins{};
+    std::vector<glm::vec3> mBakedTranslationExtents{};
+    std::vector<glm::vec3> mBakedScaleMins{};
+    std::vector<glm::vec3> mBakedScaleExtents{};
+
+    /* highest skeleton LOD level per node, all tracks are sorted by it in descending order,
+     * so a level samples the first tracks of each list; empty samples all tracks */
+    std::vector<int> mNodeLODLevels{};
+    LODTrackCounts mLODTrackCounts[GltfSkeleton::NUM_LOD_LEVELS]{};
 };
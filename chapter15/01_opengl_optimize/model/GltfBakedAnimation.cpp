@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <glm/gtx/dual_quaternion.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+
+#include "GltfBakedAnimation.h"
+#include "GltfPose.h"
+#include "Logger.h"
+
+bool GltfBakedAnimation::bake(std::shared_ptr<GltfModel> model, float framesPerSecond) {
+  std::shared_ptr<GltfSkeleton> skeleton = model->getSkeleton();
+  std::vector<std::shared_ptr<GltfAnimationClip>> clips = model->getAnimClips();
+  if (clips.empty()) {
+    Logger::log(1, "%s error: model '%s' has no clips to bake\n", __FUNCTION__,
+      model->getModelFilename().c_str());
+    return false;
+  }
+
+  int nodeCount = skeleton->getNodeCount();
+  mJointCount = skeleton->getJointCount();
+
+  /* model space, the instances add their world transform in the vertex shader */
+  GltfPose pose{};
+  pose.init(skeleton);
+
+  mClipInfos.clear();
+  mJointMatrices.clear();
+  mJointDualQuats.clear();
+
+  glm::quat orientation;
+  glm::vec3 scale;
+  glm::vec3 translation;
+  glm::vec3 skew;
+  glm::vec4 perspective;
+  glm::dualquat dq;
+
+  /* the bind pose is part of the bounds, the fades of the GPU animation start there */
+  pose.resetToBindPose();
+  pose.updateNodeMatrices();
+  glm::vec3 minPos = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 maxPos = glm::vec3(std::numeric_limits<float>::lowest());
+  for (int i = 0; i < nodeCount; ++i) {
+    minPos = glm::min(minPos, glm::vec3(pose.getNodeMatrix(i)[3]));
+    maxPos = glm::max(maxPos, glm::vec3(pose.getNodeMatrix(i)[3]));
+  }
+
+  for (const auto &clip : clips) {
+    float endTime = clip->getClipEndTime();
+
+    GltfBakedClipInfo info{};
+    info.frameOffset = mJointMatrices.size() / mJointCount;
+    info.frameCount = std::max(static_cast<int>(std::ceil(endTime * framesPerSecond)) + 1, 2);
+    info.frameRate = framesPerSecond;
+    mClipInfos.emplace_back(info);
+
+    for (int frame = 0; frame < info.frameCount; ++frame) {
+      float time = std::min(frame / framesPerSecond, endTime);
+
+      /* nodes without a track stay in the bind pose, like a full fade in */
+      pose.resetToBindPose();
+      clip->sampleAnimationFrame(pose.getLocalPose(), time);
+      pose.updateNodeMatrices();
+
+      size_t frameStart = mJointMatrices.size();
+      mJointMatrices.resize(frameStart + mJointCount, glm::mat4(1.0f));
+      mJointDualQuats.resize(frameStart + mJointCount, glm::mat2x4(0.0f));
+
+      for (int i = 0; i < nodeCount; ++i) {
+        glm::vec3 nodePos = glm::vec3(pose.getNodeMatrix(i)[3]);
+        minPos = glm::min(minPos, nodePos);
+        maxPos = glm::max(maxPos, nodePos);
+
+        int jointNum = skeleton->getJointNum(i);
+        if (jointNum < 0) {
+          continue;
+        }
+
+        glm::mat4 jointMatrix = pose.getNodeMatrix(i) * skeleton->getInverseBindMatrix(jointNum);
+        mJointMatrices.at(frameStart + jointNum) = jointMatrix;
+
+        if (!glm::decompose(jointMatrix, scale, orientation, translation, skew, perspective)) {
+          Logger::log(1, "%s error: could not decompose matrix for node %i\n", __FUNCTION__,
+            skeleton->getGltfNodeNum(i));
+          continue;
+        }
+        dq[0] = orientation;
+        dq[1] = glm::quat(0.0, translation.x, translation.y, translation.z) * orientation * 0.5f;
+        glm::mat2x4 jointDualQuat = glm::mat2x4_cast(dq);
+
+        /* keep neighbouring frames in the same hemisphere, the shader interpolates linearly */
+        if (frame > 0) {
+          const glm::mat2x4 &prevDualQuat = mJointDualQuats.at(frameStart - mJointCount + jointNum);
+          if (glm::dot(prevDualQuat[0], jointDualQuat[0]) < 0.0f) {
+            jointDualQuat[0] = -jointDualQuat[0];
+            jointDualQuat[1] = -jointDualQuat[1];
+          }
+        }
+        mJointDualQuats.at(frameStart + jointNum) = jointDualQuat;
+      }
+    }
+  }
+
+  glm::vec3 center = (minPos + maxPos) * 0.5f;
+  mBoundingSphere = glm::vec4(center, glm::length(maxPos - center));
+
+  size_t bakedDataSize = mJointMatrices.size() * sizeof(glm::mat4) +
+    mJointDualQuats.size() * sizeof(glm::mat2x4);
+  Logger::log(1, "%s: baked %i clips to %i frames at %.0f fps, %i bytes\n", __FUNCTION__,
+    mClipInfos.size(), mJointMatrices.size() / mJointCount, framesPerSecond, bakedDataSize);
+  return true;
+}
+
+bool GltfBakedAnimation::canPlay(const ModelSettings &settings) {
+  return settings.msIkMode == ikMode::off && !settings.msDrawSkeleton &&
+    settings.msBlendingMode == blendMode::fadeinout && settings.msAnimBlendFactor >= 1.0f;
+}
+
+int GltfBakedAnimation::getJointCount() {
+  return mJointCount;
+}
+
+const std::vector<GltfBakedClipInfo> &GltfBakedAnimation::getClipInfos() {
+  return mClipInfos;
+}
+
+const std::vector<glm::mat4> &GltfBakedAnimation::getJointMatrices() {
+  return mJointMatrices;
+}
+
+const std::vector<glm::mat2x4> &GltfBakedAnimation::getJointDualQuats() {
+  return mJointDualQuats;
+}
+
+glm::vec4 GltfBakedAnimation::getBoundingSphere() {
+  return mBoundingSphere;
+}
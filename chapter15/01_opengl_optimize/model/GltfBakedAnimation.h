@@ -0,0 +1,42 @@
+/* final joint data of all clips, sampled at a fixed rate for crowd instances
+ * that only loop a clip, skinning fetches and interpolates the frames */
+#pragma once
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "GltfModel.h"
+#include "ModelSettings.h"
+
+struct GltfBakedClipInfo {
+  /* first frame of the clip, in frames of jointCount entries */
+  int frameOffset;
+  int frameCount;
+  float frameRate;
+  int padding;
+};
+
+class GltfBakedAnimation {
+  public:
+    bool bake(std::shared_ptr<GltfModel> model, float framesPerSecond);
+
+    /* no IK, no blending and no skeleton lines, the pose is only a function of clip and time */
+    static bool canPlay(const ModelSettings &settings);
+
+    int getJointCount();
+    const std::vector<GltfBakedClipInfo> &getClipInfos();
+    const std::vector<glm::mat4> &getJointMatrices();
+    const std::vector<glm::mat2x4> &getJointDualQuats();
+    /* model space sphere around the nodes of all baked frames, xyz is the center and
+     * w the radius, the instances posed from the baked data have no CPU pose to bound */
+    glm::vec4 getBoundingSphere();
+
+  private:
+    int mJointCount = 0;
+    std::vector<GltfBakedClipInfo> mClipInfos{};
+    glm::vec4 mBoundingSphere = glm::vec4(0.0f);
+
+    /* frames of all clips, one block of jointCount entries per frame */
+    std::vector<glm::mat4> mJointMatrices{};
+    std::vector<glm::mat2x4> mJointDualQuats{};
+};
@@ -1,4 +1,5 @@
-#include <chrono>
+#include <cmath>
+#include <algorithm>
 #include <glm/gtx/string_cast.hpp>
 #include <glm/gtx/dual_quaternion.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
@@ -6,6 +7,8 @@
 #include <cstdlib> // rand
 
 #include "GltfInstance.h"
+#include "GltfPosePool.h"
+#include "GltfPoseBlender.h"
 #include "Logger.h"
 
 GltfInstance::~GltfInstance() {
@@ -24,49 +27,30 @@ GltfInstance::GltfInstance(std::shared_ptr<GltfModel> model, glm::vec2 worldPos,
 
   mGltfModel = model;
   mModelSettings.msWorldPosition = worldPos;
-  mNodeCount = mGltfModel->getNodeCount();
 
-  mInverseBindMatrices = mGltfModel->getInverseBindMatrices();
-  mNodeToJoint = mGltfModel->getNodeToJoint();
+  /* the skeleton is shared, every instance only has its own pose */
+  mSkeleton = mGltfModel->getSkeleton();
+  mNodeCount = mSkeleton->getNodeCount();
+  mPose.init(mSkeleton);
 
-  mJointMatrices.resize(mInverseBindMatrices.size());
-  mJointDualQuats.resize(mInverseBindMatrices.size());
+  mJointMatrices.resize(mSkeleton->getJointCount());
+  mJointDualQuats.resize(mSkeleton->getJointCount());
 
-  mAdditiveAnimationMask.resize(mNodeCount);
-  mInvertedAdditiveAnimationMask.resize(mNodeCount);
+  mAdditiveAnimationMask.resize(mNodeCount, 1.0f);
+  mSourceNodeWeights.resize(mNodeCount);
+  mDestNodeWeights.resize(mNodeCount);
 
-  std::fill(mAdditiveAnimationMask.begin(), mAdditiveAnimationMask.end(), true);
-  mInvertedAdditiveAnimationMask = mAdditiveAnimationMask;
-  mInvertedAdditiveAnimationMask.flip();
-
-  GltfNodeData nodeData;
-  nodeData = mGltfModel->getGltfNodes();
-  mRootNode = nodeData.rootNode;
-  mRootNode->setWorldPosition(glm::vec3(mModelSettings.msWorldPosition.x, 0.0f,
+  mPose.setWorldPosition(glm::vec3(mModelSettings.msWorldPosition.x, 0.0f,
     mModelSettings.msWorldPosition.y));
 
-  mNodeList = nodeData.nodeList;
-
-  /* reset skeleton split */
-  mModelSettings.msSkelSplitNode = mNodeCount - 1;
+  /* reset skeleton split, settings use the glTF node numbers */
+  mModelSettings.msSkelSplitNode = mSkeleton->getGltfNodeNum(0);
 
-  for (const auto &node : mNodeList) {
-    if (node) {
-      mModelSettings.msSkelNodeNames.push_back(node->getNodeName());
-    } else {
-      mModelSettings.msSkelNodeNames.push_back("(invalid)");
-    }
-  }
-
-  updateNodeMatrices(mRootNode);
-
-  // mRootNode->printTree();
+  updateNodeMatrices();
 
   mAnimClips = mGltfModel->getAnimClips();
-  for (const auto &clip : mAnimClips) {
-    mModelSettings.msClipNames.push_back(clip->getClipName());
-  }
   unsigned int animClipSize = mAnimClips.size();
+  mClipCursors.resize(animClipSize);
 
   /* randomize some settings */
   if (randomize) {
@@ -77,85 +61,101 @@ GltfInstance::GltfInstance(std::shared_ptr<GltfModel> model, glm::vec2 worldPos,
     mModelSettings.msAnimClip = animClip;
     mModelSettings.msAnimSpeed = animClipSpeed;
     mModelSettings.msWorldRotation = glm::vec3(0.0f, initRotation, 0.0f);
-    mRootNode->setWorldRotation(mModelSettings.msWorldRotation);
+    mPose.setWorldRotation(mModelSettings.msWorldRotation);
+    updateNodeMatrices();
+
+    /* do not start all instances of a clip in lockstep */
+    mPlaybackTime = (std::rand() % 1000) / 1000.0f *
+      mAnimClips.at(animClip)->getClipEndTime();
   }
 
+  /* start with the current settings as the last applied state */
+  mLastBlendMode = mModelSettings.msBlendingMode;
+  mLastSkelSplitNode = mModelSettings.msSkelSplitNode;
+  mLastWorldPos = mModelSettings.msWorldPosition;
+  mLastWorldRot = mModelSettings.msWorldRotation;
+  mLastIkTargetPos = mModelSettings.msIkTargetPos;
+  mLastIkMode = mModelSettings.msIkMode;
+  mLastNumIKIterations = mModelSettings.msIkIterations;
+
   /* update initial clips etc */
   checkForUpdates();
 
-  /* get Skeleton data */
-  mSkeletonMesh = std::make_shared<OGLMesh>();
-  mSkeletonMesh->vertices.resize(mNodeCount * 2);
-
   /* set values for inverse kinematics */
   /* hard-code right arm here for startup */
   mModelSettings.msIkEffectorNode = 19;
   mModelSettings.msIkRootNode = 26;
   setInverseKinematicsNodes(mModelSettings.msIkEffectorNode, mModelSettings.msIkRootNode);
   setNumIKIterations(mModelSettings.msIkIterations);
+  mLastIkEffectorNode = mModelSettings.msIkEffectorNode;
+  mLastIkRootNode = mModelSettings.msIkRootNode;
 
   mModelSettings.msIkTargetWorldPos = getWorldRotation() *
     mModelSettings.msIkTargetPos + glm::vec3(worldPos.x, 0.0f, worldPos.y);
 }
 
 void GltfInstance::resetNodeData() {
-  mGltfModel->resetNodeData(mRootNode);
-  updateNodeMatrices(mRootNode);
+  mPose.resetToBindPose();
+  updateNodeMatrices();
 }
 
-std::shared_ptr<OGLMesh> GltfInstance::getSkeleton() {
-  mSkeletonMesh->vertices.clear();
-
-  /* start from Armature child */
-  getSkeletonPerNode(mRootNode->getChilds().at(0));
-  return mSkeletonMesh;
+void GltfInstance::updateNodeMatrices() {
+  int lodLevel = getSkeletonLODLevel();
+  mPose.updateLODNodeMatrices(lodLevel);
+  for (const auto &range : mSkeleton->getLODNodeRanges(lodLevel)) {
+    updateJointData(range.first, range.second);
+  }
+  copyLODJointData(lodLevel);
+  updateBoundingSphere();
 }
 
-void GltfInstance::getSkeletonPerNode(std::shared_ptr<GltfNode> treeNode) {
-  glm::vec3 parentPos = glm::vec3(0.0f);
-  parentPos = glm::vec3(treeNode->getNodeMatrix()[3]);
-
-  OGLVertex parentVertex;
-  parentVertex.position = parentPos;
-  parentVertex.color = glm::vec3(0.0f, 1.0f, 1.0f);
-
-  for (const auto &childNode : treeNode->getChilds()) {
-    glm::vec3 childPos = glm::vec3(0.0f);
-    childPos = glm::vec3(childNode->getNodeMatrix()[3]);
-
-    OGLVertex childVertex;
-    childVertex.position = childPos;
-    childVertex.color = glm::vec3(0.0f, 0.0f, 1.0f);
-    mSkeletonMesh->vertices.emplace_back(parentVertex);
-    mSkeletonMesh->vertices.emplace_back(childVertex);
+void GltfInstance::updateNodeMatrices(int nodeIndex) {
+  mPose.updateNodeMatrices(nodeIndex);
+  updateJointData(nodeIndex, mSkeleton->getSubtreeEnd(nodeIndex));
+  updateBoundingSphere();
+}
 
-    getSkeletonPerNode(childNode);
+void GltfInstance::updateBoundingSphere() {
+  /* the root node is evaluated at every level */
+  int lodLevel = getSkeletonLODLevel();
+  glm::vec3 minPos = glm::vec3(mPose.getNodeMatrix(0)[3]);
+  glm::vec3 maxPos = minPos;
+  for (const auto &range : mSkeleton->getLODNodeRanges(lodLevel)) {
+    for (int i = range.first; i < range.second; ++i) {
+      glm::vec3 nodePos = glm::vec3(mPose.getNodeMatrix(i)[3]);
+      minPos = glm::min(minPos, nodePos);
+      maxPos = glm::max(maxPos, nodePos);
+    }
   }
-}
 
-void GltfInstance::updateNodeMatrices(std::shared_ptr<GltfNode> treeNode) {
-  treeNode->calculateNodeMatrix();
+  /* the node box is cheaper than a minimal sphere and only slightly larger */
+  glm::vec3 center = (minPos + maxPos) * 0.5f;
+  /* the vertices of a removed subtree move rigidly with the node it follows */
+  float radius = glm::length(maxPos - center) + mGltfModel->getBoundsPadding() +
+    mSkeleton->getLODBoundsPadding(lodLevel);
+  mBoundingSphere = glm::vec4(center, radius);
+}
 
+void GltfInstance::updateJointData(int startIndex, int endIndex) {
   if (mModelSettings.msVertexSkinningMode == skinningMode::linear) {
-    updateJointMatrices(treeNode);
+    updateJointMatrices(startIndex, endIndex);
   } else {
-    updateJointDualQuats(treeNode);
-  }
-
-  for (auto& childNode : treeNode->getChilds()) {
-    updateNodeMatrices(childNode);
+    updateJointDualQuats(startIndex, endIndex);
   }
 }
 
-void GltfInstance::updateJointMatrices(std::shared_ptr<GltfNode> treeNode) {
-  int nodeNum = treeNode->getNodeNum();
-  mJointMatrices.at(mNodeToJoint.at(nodeNum)) =
-    treeNode->getNodeMatrix() * mInverseBindMatrices.at(mNodeToJoint.at(nodeNum));
+void GltfInstance::updateJointMatrices(int startIndex, int endIndex) {
+  for (int i = startIndex; i < endIndex; ++i) {
+    int jointNum = mSkeleton->getJointNum(i);
+    if (jointNum < 0) {
+      continue;
+    }
+    mJointMatrices.at(jointNum) = mPose.getNodeMatrix(i) *
+      mSkeleton->getInverseBindMatrix(jointNum);
+  }
 }
 
-void GltfInstance::updateJointDualQuats(std::shared_ptr<GltfNode> treeNode) {
-  int nodeNum = treeNode->getNodeNum();
-
+void GltfInstance::updateJointDualQuats(int startIndex, int endIndex) {
   glm::quat orientation;
   glm::vec3 scale;
   glm::vec3 translation;
@@ -163,16 +163,38 @@ void GltfInstance::updateJointDualQuats(std::shared_ptr<GltfNode> treeNode) {
   glm::vec4 perspective;
   glm::dualquat dq;
 
-  /* extract components from updated node matrix and create dual quaternion */
-  glm::mat4 nodeJointMat = treeNode->getNodeMatrix() *
-    mInverseBindMatrices.at(mNodeToJoint.at(nodeNum));
-  if (glm::decompose(nodeJointMat, scale, orientation, translation, skew, perspective)) {
-    dq[0] = orientation;
-    dq[1] = glm::quat(0.0, translation.x, translation.y, translation.z) * orientation * 0.5f;
-    mJointDualQuats.at(mNodeToJoint.at(nodeNum)) = glm::mat2x4_cast(dq);
+  for (int i = startIndex; i < endIndex; ++i) {
+    int jointNum = mSkeleton->getJointNum(i);
+    if (jointNum < 0) {
+      continue;
+    }
+
+    /* extract components from updated node matrix and create dual quaternion */
+    glm::mat4 nodeJointMat = mPose.getNodeMatrix(i) *
+      mSkeleton->getInverseBindMatrix(jointNum);
+    if (glm::decompose(nodeJointMat, scale, orientation, translation, skew, perspective)) {
+      dq[0] = orientation;
+      dq[1] = glm::quat(0.0, translation.x, translation.y, translation.z) * orientation * 0.5f;
+      mJointDualQuats.at(jointNum) = glm::mat2x4_cast(dq);
+    } else {
+      Logger::log(1, "%s error: could not decompose matrix for node %i\n", __FUNCTION__,
+        mSkeleton->getGltfNodeNum(i));
+    }
+  }
+}
+
+void GltfInstance::copyLODJointData(int level) {
+  /* a removed subtree stays in its bind pose, so its joint data equals the data of the
+   * evaluated joint it hangs from */
+  const std::vector<std::pair<int, int>> &jointCopies = mSkeleton->getLODJointCopies(level);
+  if (mModelSettings.msVertexSkinningMode == skinningMode::linear) {
+    for (const auto &copy : jointCopies) {
+      mJointMatrices[copy.first] = mJointMatrices[copy.second];
+    }
   } else {
-    Logger::log(1, "%s error: could not decompose matrix for node %i\n", __FUNCTION__,
-      nodeNum);
+    for (const auto &copy : jointCopies) {
+      mJointDualQuats[copy.first] = mJointDualQuats[copy.second];
+    }
   }
 }
 
@@ -180,7 +202,7 @@ int GltfInstance::getJointMatrixSize() {
   return mJointMatrices.size();
 }
 
-std::vector<glm::mat4> GltfInstance::getJointMatrices() {
+const std::vector<glm::mat4> &GltfInstance::getJointMatrices() {
   return mJointMatrices;
 }
 
@@ -188,100 +210,115 @@ int GltfInstance::getJointDualQuatsSize() {
   return mJointDualQuats.size();
 }
 
-std::vector<glm::mat2x4> GltfInstance::getJointDualQuats() {
+const std::vector<glm::mat2x4> &GltfInstance::getJointDualQuats() {
   return mJointDualQuats;
 }
 
+void GltfInstance::copyJointMatrices(glm::mat4 *dest) {
+  std::copy(mJointMatrices.begin(), mJointMatrices.end(), dest);
+}
+
+void GltfInstance::copyJointDualQuats(glm::mat2x4 *dest) {
+  std::copy(mJointDualQuats.begin(), mJointDualQuats.end(), dest);
+}
+
 void GltfInstance::checkForUpdates() {
-  static blendMode lastBlendMode = mModelSettings.msBlendingMode;
-  static int skelSplitNode = mModelSettings.msSkelSplitNode;
-  static glm::vec2 worldPos = mModelSettings.msWorldPosition;
-  static glm::vec3 worldRot = mModelSettings.msWorldRotation;
-  static glm::vec3 ikTargetPos = mModelSettings.msIkTargetPos;
-  static ikMode lastIkMode = mModelSettings.msIkMode;
-  static int numIKIterations = mModelSettings.msIkIterations;
-  static int ikEffectorNode = mModelSettings.msIkEffectorNode;
-  static int ikRootNode = mModelSettings.msIkRootNode;
-
-  if (skelSplitNode != mModelSettings.msSkelSplitNode) {
+  if (mLastSkelSplitNode != mModelSettings.msSkelSplitNode) {
     setSkeletonSplitNode(mModelSettings.msSkelSplitNode);
-    skelSplitNode = mModelSettings.msSkelSplitNode;
+    mLastSkelSplitNode = mModelSettings.msSkelSplitNode;
     resetNodeData();
   }
 
-  if (lastBlendMode != mModelSettings.msBlendingMode) {
-    lastBlendMode = mModelSettings.msBlendingMode;
+  if (mLastBlendMode != mModelSettings.msBlendingMode) {
+    mLastBlendMode = mModelSettings.msBlendingMode;
     if (mModelSettings.msBlendingMode != blendMode::additive) {
-      mModelSettings.msSkelSplitNode = mNodeCount - 1;
+      mModelSettings.msSkelSplitNode = mSkeleton->getGltfNodeNum(0);
     }
     resetNodeData();
   }
 
-  if (worldPos != mModelSettings.msWorldPosition) {
-    mRootNode->setWorldPosition(glm::vec3(mModelSettings.msWorldPosition.x, 0.0f,
+  if (mLastWorldPos != mModelSettings.msWorldPosition) {
+    mPose.setWorldPosition(glm::vec3(mModelSettings.msWorldPosition.x, 0.0f,
       mModelSettings.msWorldPosition.y));
-    worldPos = mModelSettings.msWorldPosition;
+    updateNodeMatrices();
+    mLastWorldPos = mModelSettings.msWorldPosition;
     mModelSettings.msIkTargetWorldPos = getWorldRotation() *
-      mModelSettings.msIkTargetPos + glm::vec3(worldPos.x, 0.0f, worldPos.y);
+      mModelSettings.msIkTargetPos + glm::vec3(mLastWorldPos.x, 0.0f, mLastWorldPos.y);
   }
 
-  if (worldRot != mModelSettings.msWorldRotation) {
-    mRootNode->setWorldRotation(mModelSettings.msWorldRotation);
-    worldRot = mModelSettings.msWorldRotation;
+  if (mLastWorldRot != mModelSettings.msWorldRotation) {
+    mPose.setWorldRotation(mModelSettings.msWorldRotation);
+    updateNodeMatrices();
+    mLastWorldRot = mModelSettings.msWorldRotation;
     mModelSettings.msIkTargetWorldPos = getWorldRotation() *
-      mModelSettings.msIkTargetPos + glm::vec3(worldPos.x, 0.0f, worldPos.y);
+      mModelSettings.msIkTargetPos + glm::vec3(mLastWorldPos.x, 0.0f, mLastWorldPos.y);
   }
 
-  if (ikTargetPos != mModelSettings.msIkTargetPos) {
-    ikTargetPos = mModelSettings.msIkTargetPos;
+  if (mLastIkTargetPos != mModelSettings.msIkTargetPos) {
+    mLastIkTargetPos = mModelSettings.msIkTargetPos;
     mModelSettings.msIkTargetWorldPos = getWorldRotation() *
-      mModelSettings.msIkTargetPos + glm::vec3(worldPos.x, 0.0f, worldPos.y);
+      mModelSettings.msIkTargetPos + glm::vec3(mLastWorldPos.x, 0.0f, mLastWorldPos.y);
   }
 
-  if (lastIkMode != mModelSettings.msIkMode) {
+  if (mLastIkMode != mModelSettings.msIkMode) {
     resetNodeData();
-    lastIkMode = mModelSettings.msIkMode;
+    mLastIkMode = mModelSettings.msIkMode;
   }
 
-  if (numIKIterations != mModelSettings.msIkIterations) {
+  if (mLastNumIKIterations != mModelSettings.msIkIterations) {
     setNumIKIterations(mModelSettings.msIkIterations);
     resetNodeData();
-    numIKIterations = mModelSettings.msIkIterations;
+    mLastNumIKIterations = mModelSettings.msIkIterations;
   }
 
-  if (ikEffectorNode != mModelSettings.msIkEffectorNode ||
-      ikRootNode != mModelSettings.msIkRootNode) {
+  if (mLastIkEffectorNode != mModelSettings.msIkEffectorNode ||
+      mLastIkRootNode != mModelSettings.msIkRootNode) {
     setInverseKinematicsNodes(mModelSettings.msIkEffectorNode, mModelSettings.msIkRootNode);
     resetNodeData();
-    ikEffectorNode = mModelSettings.msIkEffectorNode;
-    ikRootNode = mModelSettings.msIkRootNode;
+    mLastIkEffectorNode = mModelSettings.msIkEffectorNode;
+    mLastIkRootNode = mModelSettings.msIkRootNode;
+  }
+}
+
+void GltfInstance::updateAnimation(float deltaTime) {
+  updateAnimationTime(deltaTime);
+
+  if (mModelSettings.msBlendingMode == blendMode::crossfade ||
+      mModelSettings.msBlendingMode == blendMode::additive) {
+    crossBlendAnimationFrame(mModelSettings.msAnimClip,
+      mModelSettings.msCrossBlendDestAnimClip, mModelSettings.msAnimTimePosition,
+      mModelSettings.msAnimCrossBlendFactor);
+  } else {
+    blendAnimationFrame(mModelSettings.msAnimClip, mModelSettings.msAnimTimePosition,
+      mModelSettings.msAnimBlendFactor);
   }
 }
 
-void GltfInstance::updateAnimation() {
+void GltfInstance::updateAnimationTime(float deltaTime) {
+  mModelSettings.msAnimEndTime = getAnimationEndTime(mModelSettings.msAnimClip);
+  bool playBackward =
+    mModelSettings.msAnimationPlayDirection == replayDirection::backward;
+
+  /* a clip without duration has nothing to wrap around, fmod would return NaN and the
+   * accumulated playback time would never recover */
+  if (mModelSettings.msAnimEndTime <= 0.0f) {
+    mPlaybackTime = 0.0f;
+    mModelSettings.msAnimTimePosition = 0.0f;
+    return;
+  }
+
   if (mModelSettings.msPlayAnimation) {
-    if (mModelSettings.msBlendingMode == blendMode::crossfade ||
-        mModelSettings.msBlendingMode == blendMode::additive) {
-      playAnimation(mModelSettings.msAnimClip,
-        mModelSettings.msCrossBlendDestAnimClip, mModelSettings.msAnimSpeed,
-        mModelSettings.msAnimCrossBlendFactor,
-        mModelSettings.msAnimationPlayDirection);
-    } else {
-      playAnimation(mModelSettings.msAnimClip, mModelSettings.msAnimSpeed,
-        mModelSettings.msAnimBlendFactor,
-        mModelSettings.msAnimationPlayDirection);
-    }
+    /* a speed change only changes the rate, the clip continues where it is */
+    mPlaybackTime = std::fmod(mPlaybackTime + deltaTime * mModelSettings.msAnimSpeed,
+      mModelSettings.msAnimEndTime);
+    /* keep the time position current, pausing freezes the pose */
+    mModelSettings.msAnimTimePosition = playBackward ?
+      mModelSettings.msAnimEndTime - mPlaybackTime : mPlaybackTime;
   } else {
-    mModelSettings.msAnimEndTime = getAnimationEndTime(mModelSettings.msAnimClip);
-    if (mModelSettings.msBlendingMode == blendMode::crossfade ||
-        mModelSettings.msBlendingMode == blendMode::additive) {
-      crossBlendAnimationFrame(mModelSettings.msAnimClip,
-        mModelSettings.msCrossBlendDestAnimClip, mModelSettings.msAnimTimePosition,
-        mModelSettings.msAnimCrossBlendFactor);
-    } else {
-      blendAnimationFrame(mModelSettings.msAnimClip, mModelSettings.msAnimTimePosition,
-        mModelSettings.msAnimBlendFactor);
-    }
+    /* resume playing from the selected position */
+    mPlaybackTime = playBackward ?
+      mModelSettings.msAnimEndTime - mModelSettings.msAnimTimePosition :
+      mModelSettings.msAnimTimePosition;
   }
 }
 
@@ -299,86 +336,106 @@ void GltfInstance::solveIK() {
   }
 }
 
-void GltfInstance::playAnimation(int animNum, float speedDivider, float blendFactor,
-    replayDirection direction) {
-  double currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
-  if (direction == replayDirection::backward) {
-    blendAnimationFrame(animNum, mAnimClips.at(animNum)->getClipEndTime() -
-      std::fmod(currentTime / 1000.0 * speedDivider,
-      mAnimClips.at(animNum)->getClipEndTime()), blendFactor);
-  } else {
-    blendAnimationFrame(animNum, std::fmod(currentTime / 1000.0 * speedDivider,
-      mAnimClips.at(animNum)->getClipEndTime()), blendFactor);
+void GltfInstance::blendAnimationFrame(int animNum, float time, float blendFactor) {
+  float factor = std::clamp(blendFactor, 0.0f, 1.0f);
+  GltfAnimationCursor &cursor = mClipCursors.at(animNum);
+
+  /* plain playback, the clip samples straight into the pose */
+  if (factor >= 1.0f && mFullAnimationMask) {
+    mPose.resetToBindPose();
+    mAnimClips.at(animNum)->sampleAnimationFrame(mPose.getLocalPose(), time, cursor,
+      getSkeletonLODLevel());
+    updateNodeMatrices();
+    return;
   }
-}
 
-void GltfInstance::playAnimation(int sourceAnimNumber, int destAnimNumber,
-    float speedDivider, float blendFactor, replayDirection direction) {
-  double currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  /* fade from the bind pose to the clip on the masked nodes, the others stay in bind pose */
+  GltfLocalPose &bindPose = GltfPosePool::getBindPose(0, mSkeleton);
+  GltfLocalPose &clipPose = GltfPosePool::getBindPose(1, mSkeleton);
+  mAnimClips.at(animNum)->sampleAnimationFrame(clipPose, time, cursor, getSkeletonLODLevel());
 
-  if (direction == replayDirection::backward) {
-    crossBlendAnimationFrame(sourceAnimNumber, destAnimNumber,
-      mAnimClips.at(sourceAnimNumber)->getClipEndTime() -
-      std::fmod(currentTime / 1000.0 * speedDivider,
-      mAnimClips.at(sourceAnimNumber)->getClipEndTime()), blendFactor);
-  } else {
-    crossBlendAnimationFrame(sourceAnimNumber, destAnimNumber,
-      std::fmod(currentTime / 1000.0 * speedDivider,
-      mAnimClips.at(sourceAnimNumber)->getClipEndTime()), blendFactor);
+  for (int i = 0; i < mNodeCount; ++i) {
+    mSourceNodeWeights[i] = 1.0f - factor * mAdditiveAnimationMask[i];
+    mDestNodeWeights[i] = factor * mAdditiveAnimationMask[i];
   }
-}
 
-void GltfInstance::blendAnimationFrame(int animNum, float time, float blendFactor) {
-  mAnimClips.at(animNum)->blendAnimationFrame(mNodeList, mAdditiveAnimationMask, time,
-    blendFactor);
-  updateNodeMatrices(mRootNode);
+  GltfBlendLayer layers[2];
+  layers[0].pose = &bindPose;
+  layers[0].nodeWeights = mSourceNodeWeights.data();
+  layers[1].pose = &clipPose;
+  layers[1].nodeWeights = mDestNodeWeights.data();
+  GltfPoseBlender::blendPoses(layers, 2, mPose.getLocalPose());
+
+  updateNodeMatrices();
 }
 
 void GltfInstance::crossBlendAnimationFrame(int sourceAnimNumber, int destAnimNumber,
     float time, float blendFactor) {
+  float factor = std::clamp(blendFactor, 0.0f, 1.0f);
 
   float sourceAnimDuration = mAnimClips.at(sourceAnimNumber)->getClipEndTime();
   float destAnimDuration = mAnimClips.at(destAnimNumber)->getClipEndTime();
 
   float scaledTime = time * (destAnimDuration / sourceAnimDuration);
 
-  mAnimClips.at(sourceAnimNumber)->setAnimationFrame(mNodeList, mAdditiveAnimationMask, time);
-  mAnimClips.at(destAnimNumber)->blendAnimationFrame(mNodeList, mAdditiveAnimationMask,
-    scaledTime, blendFactor);
+  /* each clip is sampled once, the blend writes the result in a single pass */
+  GltfLocalPose &sourcePose = GltfPosePool::getBindPose(0, mSkeleton);
+  GltfLocalPose &destPose = GltfPosePool::getBindPose(1, mSkeleton);
+  int lodLevel = getSkeletonLODLevel();
+  mAnimClips.at(sourceAnimNumber)->sampleAnimationFrame(sourcePose, time,
+    mClipCursors.at(sourceAnimNumber), lodLevel);
+  mAnimClips.at(destAnimNumber)->sampleAnimationFrame(destPose, scaledTime,
+    mClipCursors.at(destAnimNumber), lodLevel);
+
+  /* the masked nodes blend from source to dest, the others from dest to source */
+  for (int i = 0; i < mNodeCount; ++i) {
+    float destWeight = mAdditiveAnimationMask[i] > 0.0f ? factor : 1.0f - factor;
+    mSourceNodeWeights[i] = 1.0f - destWeight;
+    mDestNodeWeights[i] = destWeight;
+  }
 
-  mAnimClips.at(destAnimNumber)->setAnimationFrame(mNodeList, mInvertedAdditiveAnimationMask,
-    scaledTime);
-  mAnimClips.at(sourceAnimNumber)->blendAnimationFrame(mNodeList,
-    mInvertedAdditiveAnimationMask, time, blendFactor);
+  GltfBlendLayer layers[2];
+  layers[0].pose = &sourcePose;
+  layers[0].nodeWeights = mSourceNodeWeights.data();
+  layers[1].pose = &destPose;
+  layers[1].nodeWeights = mDestNodeWeights.data();
+  GltfPoseBlender::blendPoses(layers, 2, mPose.getLocalPose());
 
-  updateNodeMatrices(mRootNode);
+  updateNodeMatrices();
 }
 
-void GltfInstance::updateAdditiveMask(std::shared_ptr<GltfNode> treeNode, int splitNodeNum) {
-  /* break chain here */
-  if (treeNode->getNodeNum() == splitNodeNum) {
+void GltfInstance::setSkeletonSplitNode(int nodeNum) {
+  int splitNode = mSkeleton->getNodeIndex(nodeNum);
+  if (splitNode < 0) {
+    Logger::log(1, "%s error: split node %i is not part of the skeleton\n", __FUNCTION__,
+      nodeNum);
     return;
   }
 
-  mAdditiveAnimationMask.at(treeNode->getNodeNum()) = false;
-  for (auto& childNode : treeNode->getChilds()) {
-    updateAdditiveMask(childNode, splitNodeNum);
-  }
+  /* only the subtree of the split node is animated by the first clip */
+  std::fill(mAdditiveAnimationMask.begin(), mAdditiveAnimationMask.end(), 0.0f);
+  std::fill(mAdditiveAnimationMask.begin() + splitNode,
+    mAdditiveAnimationMask.begin() + mSkeleton->getSubtreeEnd(splitNode), 1.0f);
+  mFullAnimationMask = mSkeleton->getSubtreeEnd(splitNode) - splitNode == mNodeCount;
 }
 
-void GltfInstance::setSkeletonSplitNode(int nodeNum) {
-  std::fill(mAdditiveAnimationMask.begin(), mAdditiveAnimationMask.end(), true);
-  updateAdditiveMask(mRootNode, nodeNum);
+void GltfInstance::setSkeletonLODLevel(int level) {
+  mSkeletonLODLevel = std::clamp(level, 0, GltfSkeleton::NUM_LOD_LEVELS - 1);
+}
 
-  mInvertedAdditiveAnimationMask = mAdditiveAnimationMask;
-  mInvertedAdditiveAnimationMask.flip();
+int GltfInstance::getSkeletonLODLevel() {
+  /* the IK chain may contain removed nodes */
+  if (mModelSettings.msIkMode != ikMode::off) {
+    return 0;
+  }
+  return mSkeletonLODLevel;
 }
 
-void GltfInstance::setInstanceSettings(ModelSettings settings) {
+void GltfInstance::setInstanceSettings(const ModelSettings &settings) {
   mModelSettings = settings;
 }
 
-ModelSettings GltfInstance::getInstanceSettings() {
+const ModelSettings &GltfInstance::getInstanceSettings() {
   return mModelSettings;
 }
 
@@ -394,43 +451,45 @@ glm::quat GltfInstance::getWorldRotation() {
   )));
 }
 
+glm::vec4 GltfInstance::getBoundingSphere() {
+  return mBoundingSphere;
+}
+
 float GltfInstance::getAnimationEndTime(int animNum) {
   return mAnimClips.at(animNum)->getClipEndTime();
 }
 
 void GltfInstance::setInverseKinematicsNodes(int effectorNodeNum, int ikChainRootNodeNum) {
-  if (effectorNodeNum < 0 || effectorNodeNum > (mNodeList.size() - 1)) {
+  int effectorNode = mSkeleton->getNodeIndex(effectorNodeNum);
+  if (effectorNode < 0) {
     Logger::log(1, "%s error: effector node %i is out of range\n", __FUNCTION__,
       effectorNodeNum);
     return;
   }
 
-  if (ikChainRootNodeNum < 0 || ikChainRootNodeNum > (mNodeList.size() - 1)) {
+  int ikChainRootNode = mSkeleton->getNodeIndex(ikChainRootNodeNum);
+  if (ikChainRootNode < 0) {
     Logger::log(1, "%s error: IK chaine root node %i is out of range\n", __FUNCTION__,
       ikChainRootNodeNum);
     return;
   }
 
-  std::vector<std::shared_ptr<GltfNode>> ikNodes{};
-  int currentNodeNum = effectorNodeNum;
-
-  ikNodes.insert(ikNodes.begin(), mNodeList.at(effectorNodeNum));
-  while (currentNodeNum != ikChainRootNodeNum) {
-    std::shared_ptr<GltfNode> node = mNodeList.at(currentNodeNum);
-    if (node) {
-      std::shared_ptr<GltfNode> parentNode = node->getParentNode();
-      if (parentNode) {
-        currentNodeNum = parentNode->getNodeNum();
-        ikNodes.push_back(parentNode);
-      } else {
-        /* force stopping on the root node */
-        Logger::log(1, "%s error: reached skeleton root node, stopping\n", __FUNCTION__);
-        break;
-      }
+  std::vector<int> ikNodes{};
+  int currentNode = effectorNode;
+
+  ikNodes.insert(ikNodes.begin(), effectorNode);
+  while (currentNode != ikChainRootNode) {
+    int parentNode = mSkeleton->getParentIndex(currentNode);
+    if (parentNode < 0) {
+      /* force stopping on the root node */
+      Logger::log(1, "%s error: reached skeleton root node, stopping\n", __FUNCTION__);
+      break;
     }
+    currentNode = parentNode;
+    ikNodes.push_back(parentNode);
   }
 
-  mIKSolver.setNodes(ikNodes);
+  mIKSolver.setNodes(mPose, ikNodes);
 }
 
 void GltfInstance::setNumIKIterations(int iterations) {
@@ -438,11 +497,11 @@ void GltfInstance::setNumIKIterations(int iterations) {
 }
 
 void GltfInstance::solveIKByCCD(glm::vec3 target)  {
-  mIKSolver.solveCCD(target);
+  mIKSolver.solveCCD(mPose, target);
   updateNodeMatrices(mIKSolver.getIkChainRootNode());
 }
 
 void GltfInstance::solveIKByFABRIK(glm::vec3 target)  {
-  mIKSolver.solveFABRIK(target);
+  mIKSolver.solveFABRIK(mPose, target);
   updateNodeMatrices(mIKSolver.getIkChainRootNode());
 }
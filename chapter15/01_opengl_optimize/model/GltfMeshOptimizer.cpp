@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#include "GltfMeshOptimizer.h"
+
+namespace {
+  /* simulated LRU cache of the triangle ordering, larger than the real cache */
+  constexpr int FORSYTH_CACHE_SIZE = 32;
+  constexpr float CACHE_DECAY_POWER = 1.5f;
+  constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+  constexpr float VALENCE_BOOST_SCALE = 2.0f;
+  constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+  /* FIFO cache used to find the cluster boundaries of the overdraw sort */
+  constexpr unsigned int CLUSTER_CACHE_SIZE = 16;
+
+  float getVertexScore(int cachePosition, unsigned int remainingTriangles) {
+    if (remainingTriangles == 0) {
+      return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+      if (cachePosition < 3) {
+        /* the vertices of the last triangle get a fixed score, prevents stripping */
+        score = LAST_TRIANGLE_SCORE;
+      } else {
+        float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+        score = std::pow(1.0f - (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+      }
+    }
+
+    /* vertices with only a few triangles left are finished first */
+    score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles),
+      -VALENCE_BOOST_POWER);
+    return score;
+  }
+}
+
+void GltfMeshOptimizer::weldVertices(std::vector<uint32_t> &indices,
+    std::vector<GltfPackedVertex> &vertices) {
+  /* sorting the vertex numbers by their bytes puts the equal vertices next to each other */
+  std::vector<uint32_t> sortedVertices(vertices.size());
+  std::iota(sortedVertices.begin(), sortedVertices.end(), 0);
+  auto compareVertices = [&](uint32_t a, uint32_t b) {
+    return std::memcmp(&vertices.at(a), &vertices.at(b), sizeof(GltfPackedVertex));
+  };
+  std::sort(sortedVertices.begin(), sortedVertices.end(),
+    [&](uint32_t a, uint32_t b) { return compareVertices(a, b) < 0; });
+
+  std::vector<uint32_t> remap(vertices.size());
+  std::vector<GltfPackedVertex> result;
+  result.reserve(vertices.size());
+  for (size_t i = 0; i < sortedVertices.size(); ++i) {
+    uint32_t vertex = sortedVertices.at(i);
+    if (i == 0 || compareVertices(sortedVertices.at(i - 1), vertex) != 0) {
+      result.emplace_back(vertices.at(vertex));
+    }
+    remap.at(vertex) = static_cast<uint32_t>(result.size() - 1);
+  }
+
+  for (uint32_t &index : indices) {
+    index = remap.at(index);
+  }
+  vertices = std::move(result);
+}
+
+void GltfMeshOptimizer::optimizeVertexCache(std::vector<uint32_t> &indices,
+    size_t vertexCount) {
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return;
+  }
+
+  /* triangles of every vertex, the active (not emitted) triangles are in front */
+  std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+  for (const uint32_t index : indices) {
+    ++remainingTriangles.at(index);
+  }
+
+  std::vector<size_t> adjacencyOffsets(vertexCount, 0);
+  for (size_t i = 1; i < vertexCount; ++i) {
+    adjacencyOffsets.at(i) = adjacencyOffsets.at(i - 1) + remainingTriangles.at(i - 1);
+  }
+
+  std::vector<uint32_t> adjacentTriangles(indices.size());
+  std::vector<unsigned int> adjacencyFill(vertexCount, 0);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    uint32_t vertex = indices.at(i);
+    adjacentTriangles.at(adjacencyOffsets.at(vertex) + adjacencyFill.at(vertex)++) =
+      static_cast<uint32_t>(i / 3);
+  }
+
+  std::vector<float> vertexScores(vertexCount);
+  for (size_t i = 0; i < vertexCount; ++i) {
+    vertexScores.at(i) = getVertexScore(-1, remainingTriangles.at(i));
+  }
+
+  std::vector<float> triangleScores(triangleCount);
+  for (size_t i = 0; i < triangleCount; ++i) {
+    triangleScores.at(i) = vertexScores.at(indices.at(i * 3)) +
+      vertexScores.at(indices.at(i * 3 + 1)) + vertexScores.at(indices.at(i * 3 + 2));
+  }
+
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+
+  std::vector<uint32_t> cache;
+  std::vector<uint32_t> newCache;
+  cache.reserve(FORSYTH_CACHE_SIZE + 3);
+  newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+  int bestTriangle = static_cast<int>(std::max_element(triangleScores.begin(),
+    triangleScores.end()) - triangleScores.begin());
+  size_t nextUnemitted = 0;
+
+  for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+    /* no candidate in the cache, continue with the next triangle in input order */
+    if (bestTriangle < 0) {
+      while (emitted.at(nextUnemitted)) {
+        ++nextUnemitted;
+      }
+      bestTriangle = static_cast<int>(nextUnemitted);
+    }
+
+    emitted.at(bestTriangle) = true;
+    newCache.clear();
+    for (int i = 0; i < 3; ++i) {
+      uint32_t vertex = indices.at(bestTriangle * 3 + i);
+      result.emplace_back(vertex);
+      if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end()) {
+        newCache.emplace_back(vertex);
+      }
+
+      /* swap the emitted triangle behind the active triangles of the vertex */
+      size_t begin = adjacencyOffsets.at(vertex);
+      size_t end = begin + remainingTriangles.at(vertex);
+      for (size_t j = begin; j < end; ++j) {
+        if (adjacentTriangles.at(j) == static_cast<uint32_t>(bestTriangle)) {
+          std::swap(adjacentTriangles.at(j), adjacentTriangles.at(end - 1));
+          break;
+        }
+      }
+      --remainingTriangles.at(vertex);
+    }
+
+    for (const uint32_t vertex : cache) {
+      if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end()) {
+        newCache.emplace_back(vertex);
+      }
+    }
+
+    /* update the scores of the cached and the evicted vertices and of their triangles */
+    for (size_t i = 0; i < newCache.size(); ++i) {
+      uint32_t vertex = newCache.at(i);
+      int cachePosition = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+
+      float score = getVertexScore(cachePosition, remainingTriangles.at(vertex));
+      float scoreDiff = score - vertexScores.at(vertex);
+      vertexScores.at(vertex) = score;
+
+      size_t begin = adjacencyOffsets.at(vertex);
+      for (size_t j = begin; j < begin + remainingTriangles.at(vertex); ++j) {
+        triangleScores.at(adjacentTriangles.at(j)) += scoreDiff;
+      }
+    }
+
+    if (newCache.size() > FORSYTH_CACHE_SIZE) {
+      newCache.resize(FORSYTH_CACHE_SIZE);
+    }
+    std::swap(cache, newCache);
+
+    bestTriangle = -1;
+    float bestScore = -1.0f;
+    for (const uint32_t vertex : cache) {
+      size_t begin = adjacencyOffsets.at(vertex);
+      for (size_t j = begin; j < begin + remainingTriangles.at(vertex); ++j) {
+        uint32_t triangle = adjacentTriangles.at(j);
+        if (triangleScores.at(triangle) > bestScore) {
+          bestScore = triangleScores.at(triangle);
+          bestTriangle = static_cast<int>(triangle);
+        }
+      }
+    }
+  }
+
+  indices = std::move(result);
+}
+
+void GltfMeshOptimizer::optimizeOverdraw(std::vector<uint32_t> &indices,
+    const std::vector<GltfPackedVertex> &vertices, float maxACMRIncrease) {
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return;
+  }
+
+  /* a new cluster starts where the cache restarts, the order inside a cluster is kept */
+  std::vector<size_t> clusterStarts;
+  std::vector<size_t> timestamps(vertices.size(), 0);
+  size_t time = CLUSTER_CACHE_SIZE + 1;
+  for (size_t i = 0; i < triangleCount; ++i) {
+    int misses = 0;
+    for (int j = 0; j < 3; ++j) {
+      uint32_t vertex = indices.at(i * 3 + j);
+      if (time - timestamps.at(vertex) > CLUSTER_CACHE_SIZE) {
+        timestamps.at(vertex) = time++;
+        ++misses;
+      }
+    }
+    if (i == 0 || misses == 3) {
+      clusterStarts.emplace_back(i);
+    }
+  }
+  clusterStarts.emplace_back(triangleCount);
+
+  glm::vec3 meshCenter = glm::vec3(0.0f);
+  for (const auto &vertex : vertices) {
+    meshCenter += vertex.position;
+  }
+  meshCenter /= static_cast<float>(vertices.size());
+
+  /* clusters far away from the center and facing outwards hide the others */
+  size_t clusterCount = clusterStarts.size() - 1;
+  std::vector<float> clusterSortKeys(clusterCount);
+  for (size_t i = 0; i < clusterCount; ++i) {
+    glm::vec3 centroid = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);
+    float area = 0.0f;
+
+    for (size_t j = clusterStarts.at(i); j < clusterStarts.at(i + 1); ++j) {
+      const glm::vec3 &p0 = vertices.at(indices.at(j * 3)).position;
+      const glm::vec3 &p1 = vertices.at(indices.at(j * 3 + 1)).position;
+      const glm::vec3 &p2 = vertices.at(indices.at(j * 3 + 2)).position;
+
+      glm::vec3 triangleNormal = glm::cross(p1 - p0, p2 - p0);
+      float triangleArea = glm::length(triangleNormal);
+
+      centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+      normal += triangleNormal;
+      area += triangleArea;
+    }
+
+    centroid = area > 0.0f ? centroid / area : meshCenter;
+    float normalLength = glm::length(normal);
+    clusterSortKeys.at(i) = normalLength > 0.0f ?
+      glm::dot(centroid - meshCenter, normal / normalLength) : 0.0f;
+  }
+
+  std::vector<size_t> clusterOrder(clusterCount);
+  std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+  std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+    [&](size_t a, size_t b) { return clusterSortKeys.at(a) > clusterSortKeys.at(b); });
+
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+  for (const size_t cluster : clusterOrder) {
+    result.insert(result.end(), indices.begin() + clusterStarts.at(cluster) * 3,
+      indices.begin() + clusterStarts.at(cluster + 1) * 3);
+  }
+
+  float cacheACMR = getACMR(indices, vertices.size(), CLUSTER_CACHE_SIZE);
+  float sortedACMR = getACMR(result, vertices.size(), CLUSTER_CACHE_SIZE);
+  if (sortedACMR <= cacheACMR * maxACMRIncrease) {
+    indices = std::move(result);
+  }
+}
+
+void GltfMeshOptimizer::optimizeVertexFetch(std::vector<uint32_t> &indices,
+    std::vector<GltfPackedVertex> &vertices) {
+  constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> remap(vertices.size(), unused);
+
+  uint32_t nextVertex = 0;
+  for (uint32_t &index : indices) {
+    if (remap.at(index) == unused) {
+      remap.at(index) = nextVertex++;
+    }
+    index = remap.at(index);
+  }
+  for (uint32_t &newIndex : remap) {
+    if (newIndex == unused) {
+      newIndex = nextVertex++;
+    }
+  }
+
+  std::vector<GltfPackedVertex> result(vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    result.at(remap.at(i)) = vertices.at(i);
+  }
+  vertices = std::move(result);
+}
+
+float GltfMeshOptimizer::getACMR(const std::vector<uint32_t> &indices, size_t vertexCount,
+    unsigned int cacheSize) {
+  if (indices.size() < 3) {
+    return 0.0f;
+  }
+  return static_cast<float>(getCacheMisses(indices, vertexCount, cacheSize)) /
+    (indices.size() / 3);
+}
+
+float GltfMeshOptimizer::getATVR(const std::vector<uint32_t> &indices, size_t vertexCount,
+    unsigned int cacheSize) {
+  std::vector<bool> used(vertexCount, false);
+  size_t usedCount = 0;
+  for (const uint32_t index : indices) {
+    if (!used.at(index)) {
+      used.at(index) = true;
+      ++usedCount;
+    }
+  }
+
+  if (usedCount == 0) {
+    return 0.0f;
+  }
+  return static_cast<float>(getCacheMisses(indices, vertexCount, cacheSize)) / usedCount;
+}
+
+size_t GltfMeshOptimizer::getCacheMisses(const std::vector<uint32_t> &indices,
+    size_t vertexCount, unsigned int cacheSize) {
+  /* a vertex is in the FIFO cache if less than cacheSize misses happened since its own */
+  std::vector<size_t> timestamps(vertexCount, 0);
+  size_t time = cacheSize + 1;
+  size_t misses = 0;
+
+  for (const uint32_t index : indices) {
+    if (time - timestamps.at(index) > cacheSize) {
+      timestamps.at(index) = time++;
+      ++misses;
+    }
+  }
+  return misses;
+}
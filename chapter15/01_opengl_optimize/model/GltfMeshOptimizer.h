@@ -0,0 +1,34 @@
+/* load time reordering of the mesh triangles and vertices */
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "GltfVertexPacking.h"
+
+class GltfMeshOptimizer {
+  public:
+    /* merges bitwise equal packed vertices, glTF exporters often split every face */
+    static void weldVertices(std::vector<uint32_t> &indices,
+      std::vector<GltfPackedVertex> &vertices);
+    /* triangle order for the post-transform vertex cache, Forsyth's linear-speed algorithm */
+    static void optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount);
+    /* sorts clusters of the cache optimized triangles from outside to inside, the order
+     * is kept if the ACMR gets worse than maxACMRIncrease times the cache optimized ACMR */
+    static void optimizeOverdraw(std::vector<uint32_t> &indices,
+      const std::vector<GltfPackedVertex> &vertices, float maxACMRIncrease);
+    /* vertices in order of their first use, unused vertices are moved to the end */
+    static void optimizeVertexFetch(std::vector<uint32_t> &indices,
+      std::vector<GltfPackedVertex> &vertices);
+
+    /* average cache miss ratio (misses per triangle) of a FIFO cache */
+    static float getACMR(const std::vector<uint32_t> &indices, size_t vertexCount,
+      unsigned int cacheSize);
+    /* average transformed vertex ratio (misses per used vertex), 1.0 is the optimum */
+    static float getATVR(const std::vector<uint32_t> &indices, size_t vertexCount,
+      unsigned int cacheSize);
+
+  private:
+    static size_t getCacheMisses(const std::vector<uint32_t> &indices, size_t vertexCount,
+      unsigned int cacheSize);
+};
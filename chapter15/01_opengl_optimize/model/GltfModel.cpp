@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <limits>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/dual_quaternion.hpp>
@@ -18,6 +20,32 @@ bool GltfModel::loadModel(OGLRenderData &renderData,
   Logger::log(1, "%s: glTF model texture '%s' successfully loaded\n", __FUNCTION__,
     modelFilename.c_str());
 
+  if (!loadModelData(renderData, modelFilename)) {
+    return false;
+  }
+
+  glGenVertexArrays(1, &mVAO);
+  glBindVertexArray(mVAO);
+
+  /* extract position, normal, texture coords, and indices */
+  bool vertexResult = createVertexBuffers();
+  bool indexResult = createIndexBuffer();
+
+  glBindVertexArray(0);
+
+  if (!vertexResult || !indexResult) {
+    return false;
+  }
+
+  if (renderData.rdOptimizeMesh) {
+    optimizeMesh(renderData.rdOptimizeOverdraw);
+  }
+  createMeshLODs();
+
+  return true;
+}
+
+bool GltfModel::loadModelData(OGLRenderData &renderData, std::string modelFilename) {
   mModel = std::make_shared<tinygltf::Model>();
 
   tinygltf::TinyGLTF gltfLoader;
@@ -46,24 +74,24 @@ bool GltfModel::loadModel(OGLRenderData &renderData,
 
   mModelFilename = modelFilename;
 
-  glGenVertexArrays(1, &mVAO);
-  glBindVertexArray(mVAO);
-
-  /* extract position, normal, texture coords, and indices */
-  createVertexBuffers();
-  createIndexBuffer();
-
-  glBindVertexArray(0);
-
-  /* extract joints, weights, and invers bind matrices*/
+  /* extract joints and weights */
   getJointData();
   getWeightData();
-  getInvBindMatrices();
 
   mNodeCount = mModel->nodes.size();
 
+  /* flat skeleton in parent-before-child order, plus the invers bind matrices */
+  createSkeleton();
+  getInvBindMatrices();
+  mSkeleton->createLODLevels();
+  calculateBoundsPadding();
+
   /* extract animation data */
-  getAnimations();
+  getAnimations(renderData.rdOptimizeClips ? renderData.rdClipKeyTolerance : 0.0f);
+  if (renderData.rdCompressClips) {
+    compressAnimations(renderData.rdClipCompressionMaxError);
+  }
+  setUseBakedClips(renderData.rdUseBakedClips);
 
   return true;
 }
@@ -76,23 +104,64 @@ int GltfModel::getNodeCount() {
   return mNodeCount;
 }
 
-GltfNodeData GltfModel::getGltfNodes() {
-  GltfNodeData nodeData{};
+std::shared_ptr<GltfSkeleton> GltfModel::getSkeleton() {
+  return mSkeleton;
+}
+
+float GltfModel::getBoundsPadding() {
+  return mBoundsPadding;
+}
 
+void GltfModel::createSkeleton() {
   int rootNodeNum = mModel->scenes.at(0).nodes.at(0);
   Logger::log(2, "%s: model has %i nodes, root node is %i\n", __FUNCTION__,
     mNodeCount, rootNodeNum);
 
-  nodeData.rootNode = GltfNode::createRoot(rootNodeNum);
+  mSkeleton = std::make_shared<GltfSkeleton>();
+  addSkeletonNodes(rootNodeNum, -1);
+
+  mSkeletonNodeNames.assign(mNodeCount, "(invalid)");
+  for (int i = 0; i < mSkeleton->getNodeCount(); ++i) {
+    mSkeletonNodeNames.at(mSkeleton->getGltfNodeNum(i)) = mSkeleton->getNodeName(i);
+  }
 
-  getNodeData(nodeData.rootNode);
-  getNodes(nodeData.rootNode);
+  Logger::log(1, "%s: skeleton has %i nodes\n", __FUNCTION__, mSkeleton->getNodeCount());
+}
 
-  nodeData.nodeList.resize(mNodeCount);
-  nodeData.nodeList.at(rootNodeNum) = nodeData.rootNode;
-  getNodeList(nodeData.nodeList, rootNodeNum);
+void GltfModel::addSkeletonNodes(int nodeNum, int parentIndex) {
+  const tinygltf::Node &node = mModel->nodes.at(nodeNum);
 
-  return nodeData;
+  int jointNum = -1;
+  const tinygltf::Skin &skin = mModel->skins.at(0);
+  auto jointIt = std::find(skin.joints.begin(), skin.joints.end(), nodeNum);
+  if (jointIt != skin.joints.end()) {
+    jointNum = std::distance(skin.joints.begin(), jointIt);
+    Logger::log(2, "%s: joint %i affects node %i\n", __FUNCTION__, jointNum, nodeNum);
+  }
+
+  int index = mSkeleton->addNode(nodeNum, parentIndex, node.name, jointNum);
+
+  glm::vec3 translation = glm::vec3(0.0f);
+  glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+  glm::vec3 scale = glm::vec3(1.0f);
+  if (node.translation.size()) {
+    translation = glm::make_vec3(node.translation.data());
+  }
+  if (node.rotation.size()) {
+    rotation = glm::make_quat(node.rotation.data());
+  }
+  if (node.scale.size()) {
+    scale = glm::make_vec3(node.scale.data());
+  }
+  mSkeleton->setBindPose(index, translation, rotation, scale);
+
+  for (const int childNodeNum : node.children) {
+    /* skip the child node with skin/mesh metadata, confuses skeleton */
+    if (mModel->nodes.at(childNodeNum).skin != -1) {
+      continue;
+    }
+    addSkeletonNodes(childNodeNum, index);
+  }
 }
 
 void GltfModel::getJointData() {
@@ -111,15 +180,6 @@ void GltfModel::getJointData() {
 
   std::memcpy(mJointVec.data(), &buffer.data.at(0) + bufferView.byteOffset,
     bufferView.byteLength);
-
-  mNodeToJoint.resize(mModel->nodes.size());
-
-  const tinygltf::Skin &skin = mModel->skins.at(0);
-  for (int i = 0; i < skin.joints.size(); ++i) {
-    int destinationNode = skin.joints.at(i);
-    mNodeToJoint.at(destinationNode) = i;
-    Logger::log(2, "%s: joint %i affects node %i\n", __FUNCTION__, i, destinationNode);
-  }
 }
 
 void GltfModel::getWeightData() {
@@ -148,205 +208,256 @@ void GltfModel::getInvBindMatrices() {
   const tinygltf::BufferView &bufferView = mModel->bufferViews.at(accessor.bufferView);
   const tinygltf::Buffer &buffer = mModel->buffers.at(bufferView.buffer);
 
-  mInverseBindMatrices.resize(skin.joints.size());
+  std::vector<glm::mat4> inverseBindMatrices(skin.joints.size());
 
-  std::memcpy(mInverseBindMatrices.data(), &buffer.data.at(0) + bufferView.byteOffset,
+  std::memcpy(inverseBindMatrices.data(), &buffer.data.at(0) + bufferView.byteOffset,
     bufferView.byteLength);
+  mSkeleton->setInverseBindMatrices(inverseBindMatrices);
+}
+
+void GltfModel::calculateBoundsPadding() {
+  int positionAccessor = mModel->meshes.at(0).primitives.at(0).attributes.at("POSITION");
+  const tinygltf::Accessor &accessor = mModel->accessors.at(positionAccessor);
+  const tinygltf::BufferView &bufferView = mModel->bufferViews.at(accessor.bufferView);
+  const tinygltf::Buffer &buffer = mModel->buffers.at(bufferView.buffer);
+
+  std::vector<glm::vec3> positions(accessor.count);
+  std::memcpy(positions.data(), &buffer.data.at(0) + bufferView.byteOffset + accessor.byteOffset,
+    accessor.count * sizeof(glm::vec3));
+
+  /* joint positions in the bind pose, the mesh is skinned relative to them */
+  int numJoints = mSkeleton->getJointCount();
+  std::vector<glm::vec3> jointPositions(numJoints);
+  for (int i = 0; i < numJoints; ++i) {
+    jointPositions.at(i) = glm::vec3(glm::inverse(mSkeleton->getInverseBindMatrix(i))[3]);
+  }
+
+  /* the skinned vertices keep roughly their distance to the joint with the largest weight */
+  mBoundsPadding = 0.0f;
+  for (size_t i = 0; i < positions.size() && i < mJointVec.size(); ++i) {
+    const glm::vec4 &weights = mWeightVec.at(i);
+    int mainJoint = 0;
+    for (int j = 1; j < 4; ++j) {
+      if (weights[j] > weights[mainJoint]) {
+        mainJoint = j;
+      }
+    }
+    int jointNum = mJointVec.at(i)[mainJoint];
+    if (jointNum >= numJoints) {
+      continue;
+    }
+    mBoundsPadding = std::max(mBoundsPadding,
+      glm::length(positions.at(i) - jointPositions.at(jointNum)));
+  }
+  Logger::log(1, "%s: bounds padding of the mesh is %f\n", __FUNCTION__, mBoundsPadding);
 }
 
-void GltfModel::getAnimations() {
+void GltfModel::getAnimations(float keyTolerance) {
   for (const auto &anim : mModel->animations) {
     Logger::log(1, "%s: loading animation '%s' with %i channels\n", __FUNCTION__, anim.name.c_str(), anim.channels.size());
     std::shared_ptr<GltfAnimationClip> clip = std::make_shared<GltfAnimationClip>(anim.name);
     for (const auto& channel : anim.channels) {
-      clip->addChannel(mModel, anim, channel);
+      int targetNode = mSkeleton->getNodeIndex(channel.target_node);
+      if (targetNode < 0) {
+        Logger::log(1, "%s: skipping channel for node %i, not part of the skeleton\n",
+          __FUNCTION__, channel.target_node);
+        continue;
+      }
+      clip->addChannel(mModel, anim, channel, targetNode);
     }
     mAnimClips.push_back(clip);
+    mClipNames.push_back(clip->getClipName());
   }
-}
-
-std::vector<std::shared_ptr<GltfAnimationClip>> GltfModel::getAnimClips() {
-  return mAnimClips;
-}
 
-void GltfModel::getNodes(std::shared_ptr<GltfNode> treeNode) {
-  int nodeNum = treeNode->getNodeNum();
-  std::vector<int> childNodes = mModel->nodes.at(nodeNum).children;
-
-  /* remove the child node with skin/mesh metadata, confuses skeleton */
-  auto removeIt = std::remove_if(childNodes.begin(), childNodes.end(),
-    [&](int num) { return mModel->nodes.at(num).skin != -1; }
-  );
-  childNodes.erase(removeIt, childNodes.end());
-
-  treeNode->addChilds(childNodes);
+  if (keyTolerance > 0.0f) {
+    optimizeAnimations(keyTolerance);
+  }
 
-  for (auto &childNode : treeNode->getChilds()) {
-    getNodeData(childNode);
-    getNodes(childNode);
+  /* only the keyed channels are baked, constants are set directly */
+  for (auto &clip : mAnimClips) {
+    clip->setSkeletonLODs(*mSkeleton);
+    clip->bakeClip(mClipBakeFrameRate);
   }
 }
 
-std::vector<std::shared_ptr<GltfNode>> GltfModel::getNodeList(
-    std::vector<std::shared_ptr<GltfNode>> &nodeList, int nodeNum) {
-  for (auto &childNode : nodeList.at(nodeNum)->getChilds()) {
-    int childNodeNum = childNode->getNodeNum();
-    nodeList.at(childNodeNum) = childNode;
-    getNodeList(nodeList, childNodeNum);
+void GltfModel::optimizeAnimations(float keyTolerance) {
+  size_t dataSize = 0;
+  for (auto &clip : mAnimClips) {
+    dataSize += clip->getDataSize();
+    clip->extractConstantTracks(keyTolerance);
   }
 
-  return nodeList;
+  /* translations and scales in the bind pose in all clips are never written, the pose
+   * keeps its bind values for them; IK changes rotations, so these stay constants */
+  int nodeCount = mSkeleton->getNodeCount();
+  std::vector<bool> bindPoseTranslations(nodeCount, true);
+  std::vector<bool> bindPoseScales(nodeCount, true);
+  for (auto &clip : mAnimClips) {
+    std::vector<bool> clipTranslations = clip->getBindPoseTracks(ETargetPath::TRANSLATION,
+      mSkeleton->getBindTranslations(), keyTolerance);
+    std::vector<bool> clipScales = clip->getBindPoseTracks(ETargetPath::SCALE,
+      mSkeleton->getBindScales(), keyTolerance);
+    for (int i = 0; i < nodeCount; ++i) {
+      bindPoseTranslations.at(i) = bindPoseTranslations.at(i) && clipTranslations.at(i);
+      bindPoseScales.at(i) = bindPoseScales.at(i) && clipScales.at(i);
+    }
+  }
+  int numBindPoseTracks = std::count(bindPoseTranslations.begin(), bindPoseTranslations.end(),
+    true) + std::count(bindPoseScales.begin(), bindPoseScales.end(), true);
+
+  size_t optimizedDataSize = 0;
+  int numRemovedKeys = 0;
+  for (auto &clip : mAnimClips) {
+    clip->removeConstantTracks(ETargetPath::TRANSLATION, bindPoseTranslations);
+    clip->removeConstantTracks(ETargetPath::SCALE, bindPoseScales);
+    numRemovedKeys += clip->reduceKeys(keyTolerance);
+    optimizedDataSize += clip->getDataSize();
+  }
+
+  Logger::log(1, "%s: %i bind pose tracks folded, %i keys removed, keyframe data reduced "
+    "from %i to %i bytes\n", __FUNCTION__, numBindPoseTracks, numRemovedKeys, dataSize,
+    optimizedDataSize);
 }
 
-std::vector<glm::mat4> GltfModel::getInverseBindMatrices() {
-  return mInverseBindMatrices;
+std::vector<std::shared_ptr<GltfAnimationClip>> GltfModel::getAnimClips() {
+  return mAnimClips;
 }
 
-std::vector<int> GltfModel::getNodeToJoint() {
-  return mNodeToJoint;
+const std::vector<std::string> &GltfModel::getClipNames() {
+  return mClipNames;
 }
 
-void GltfModel::getNodeData(std::shared_ptr<GltfNode> treeNode) {
-  int nodeNum = treeNode->getNodeNum();
-  const tinygltf::Node &node = mModel->nodes.at(nodeNum);
-  treeNode->setNodeName(node.name);
+const std::vector<std::string> &GltfModel::getSkeletonNodeNames() {
+  return mSkeletonNodeNames;
+}
 
-  if (node.translation.size()) {
-    treeNode->setTranslation(glm::make_vec3(node.translation.data()));
-  } else {
-    treeNode->setTranslation(glm::vec3(0.0f));
+void GltfModel::compressAnimations(float maxError) {
+  size_t floatDataSize = 0;
+  size_t compressedDataSize = 0;
+  for (auto &clip : mAnimClips) {
+    floatDataSize += clip->getDataSize();
+    clip->compressClip(maxError);
+    compressedDataSize += clip->getDataSize();
   }
+  Logger::log(1, "%s: keyframe data of %i clips compressed from %i to %i bytes\n",
+    __FUNCTION__, mAnimClips.size(), floatDataSize, compressedDataSize);
+}
 
-  if (node.rotation.size()) {
-    treeNode->setRotation(glm::make_quat(node.rotation.data()));
-  } else {
-    treeNode->setRotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+void GltfModel::setUseBakedClips(bool useBakedClips) {
+  for (auto &clip : mAnimClips) {
+    clip->setUseBakedData(useBakedClips);
   }
+}
 
-  if (node.scale.size()) {
-    treeNode->setScale(glm::make_vec3(node.scale.data()));
-  } else {
-    treeNode->setScale(glm::vec3(1.0f));
+bool GltfModel::createVertexBuffers() {
+  if (!GltfVertexPacking::packVertices(*mModel, mPackedVertices)) {
+    Logger::log(1, "%s error: could not convert the vertex attributes\n", __FUNCTION__);
+    return false;
   }
 
-  treeNode->calculateNodeMatrix();
-}
-
-void GltfModel::resetNodeData(std::shared_ptr<GltfNode> treeNode) {
-  getNodeData(treeNode);
+  /* one interleaved buffer for position, normal, tex coordinates, joints and weights */
+  glGenBuffers(1, &mVertexVBO);
+  glBindBuffer(GL_ARRAY_BUFFER, mVertexVBO);
+
+  GLsizei stride = sizeof(GltfPackedVertex);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride,
+    (void*) offsetof(GltfPackedVertex, position));
+  glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride,
+    (void*) offsetof(GltfPackedVertex, normal));
+  glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride,
+    (void*) offsetof(GltfPackedVertex, texCoord));
+  /* integer joint numbers, no conversion to float */
+  glVertexAttribIPointer(3, 4, GL_UNSIGNED_BYTE, stride,
+    (void*) offsetof(GltfPackedVertex, joints));
+  glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+    (void*) offsetof(GltfPackedVertex, weights));
 
-  for (auto &childNode : treeNode->getChilds()) {
-    resetNodeData(childNode);
+  for (int i = 0; i < 5; ++i) {
+    glEnableVertexAttribArray(i);
   }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return true;
 }
 
-void GltfModel::createVertexBuffers() {
-  const tinygltf::Primitive &primitives = mModel->meshes.at(0).primitives.at(0);
-  mVertexVBO.resize(primitives.attributes.size());
-  mAttribAccessors.resize(primitives.attributes.size());
+bool GltfModel::createIndexBuffer() {
+  if (!GltfVertexPacking::getIndices(*mModel, mIndices)) {
+    Logger::log(1, "%s error: could not read the vertex indices\n", __FUNCTION__);
+    return false;
+  }
 
-  for (const auto& attrib : primitives.attributes) {
-    const std::string attribType = attrib.first;
-    const int accessorNum = attrib.second;
+  glGenBuffers(1, &mIndexVBO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexVBO);
 
-    const tinygltf::Accessor &accessor = mModel->accessors.at(accessorNum);
-    const tinygltf::BufferView &bufferView = mModel->bufferViews.at(accessor.bufferView);
-    const tinygltf::Buffer &buffer = mModel->buffers.at(bufferView.buffer);
+  /* do NOT unbind the element buffer here */
+  // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  return true;
+}
 
-    if ((attribType.compare("POSITION") != 0) && (attribType.compare("NORMAL") != 0)
-        && (attribType.compare("TEXCOORD_0") != 0) && (attribType.compare("JOINTS_0") != 0)
-        && (attribType.compare("WEIGHTS_0") != 0)) {
-      Logger::log(1, "%s: skipping attribute type %s\n", __FUNCTION__, attribType.c_str());
-      continue;
-    }
+void GltfModel::optimizeMesh(bool optimizeOverdraw) {
+  /* FIFO cache size of the ACMR/ATVR statistics, close to current GPUs */
+  const unsigned int cacheSize = 16;
+  size_t vertexCount = mPackedVertices.size();
+  float acmr = GltfMeshOptimizer::getACMR(mIndices, vertexCount, cacheSize);
+  float atvr = GltfMeshOptimizer::getATVR(mIndices, vertexCount, cacheSize);
+
+  GltfMeshOptimizer::weldVertices(mIndices, mPackedVertices);
+  GltfMeshOptimizer::optimizeVertexCache(mIndices, mPackedVertices.size());
+  if (optimizeOverdraw) {
+    GltfMeshOptimizer::optimizeOverdraw(mIndices, mPackedVertices, 1.05f);
+  }
+  GltfMeshOptimizer::optimizeVertexFetch(mIndices, mPackedVertices);
 
-    Logger::log(1, "%s: data for %s uses accessor %i\n", __FUNCTION__, attribType.c_str(),
-      accessorNum);
-    if (attribType.compare("POSITION") == 0) {
-      int numPositionEntries = accessor.count;
-      Logger::log(1, "%s: loaded %i vertices from glTF file\n", __FUNCTION__,
-        numPositionEntries);
-    }
+  Logger::log(1, "%s: %i vertices welded to %i, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+    __FUNCTION__, vertexCount, mPackedVertices.size(), acmr,
+    GltfMeshOptimizer::getACMR(mIndices, mPackedVertices.size(), cacheSize), atvr,
+    GltfMeshOptimizer::getATVR(mIndices, mPackedVertices.size(), cacheSize));
+}
 
-    mAttribAccessors.at(attributes.at(attribType)) = accessorNum;
-
-    int dataSize = 1;
-    switch(accessor.type) {
-      case TINYGLTF_TYPE_SCALAR:
-        dataSize = 1;
-        break;
-      case TINYGLTF_TYPE_VEC2:
-        dataSize = 2;
-        break;
-      case TINYGLTF_TYPE_VEC3:
-        dataSize = 3;
-        break;
-      case TINYGLTF_TYPE_VEC4:
-        dataSize = 4;
-        break;
-      default:
-        Logger::log(1, "%s error: accessor %i uses data size %i\n", __FUNCTION__,
-          accessorNum, accessor.type);
-        break;
-    }
+void GltfModel::createMeshLODs() {
+  /* all levels are made from the full mesh, the errors do not add up */
+  std::vector<uint32_t> fullIndices = mIndices;
+  std::vector<uint32_t> lodIndices;
 
-    GLuint dataType = GL_FLOAT;
-    switch(accessor.componentType) {
-      case TINYGLTF_COMPONENT_TYPE_FLOAT:
-        dataType = GL_FLOAT;
-        break;
-      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-        dataType = GL_UNSIGNED_SHORT;
-        break;
-      default:
-        Logger::log(1, "%s error: accessor %i uses unknown data type %i\n", __FUNCTION__,
-          accessorNum, accessor.componentType);
-        break;
-    }
+  mMeshLODs.resize(NUM_MESH_LODS);
+  mMeshLODs.at(0).firstIndex = 0;
+  mMeshLODs.at(0).indexCount = static_cast<uint32_t>(fullIndices.size());
 
-    /* buffers for position, normal and tex coordinates */
-    glGenBuffers(1, &mVertexVBO.at(attributes.at(attribType)));
-    glBindBuffer(GL_ARRAY_BUFFER, mVertexVBO.at(attributes.at(attribType)));
+  for (int i = 1; i < NUM_MESH_LODS; ++i) {
+    size_t targetIndexCount = (fullIndices.size() / 3 >> i) * 3;
+    GltfMeshSimplifier::simplify(fullIndices, mPackedVertices, targetIndexCount, lodIndices);
+    GltfMeshOptimizer::optimizeVertexCache(lodIndices, mPackedVertices.size());
 
-    glVertexAttribPointer(attributes.at(attribType), dataSize, dataType, GL_FALSE,
-      0, (void*) 0);
-    glEnableVertexAttribArray(attributes.at(attribType));
+    mMeshLODs.at(i).firstIndex = static_cast<uint32_t>(mIndices.size());
+    mMeshLODs.at(i).indexCount = static_cast<uint32_t>(lodIndices.size());
+    mIndices.insert(mIndices.end(), lodIndices.begin(), lodIndices.end());
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    Logger::log(1, "%s: mesh LOD %i uses %i of %i triangles\n", __FUNCTION__, i,
+      lodIndices.size() / 3, fullIndices.size() / 3);
   }
 }
 
-void GltfModel::createIndexBuffer() {
-  glGenBuffers(1, &mIndexVBO);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexVBO);
-
-  /* do NOT unbind the element buffer here */
-  // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-}
-
 void GltfModel::uploadVertexBuffers() {
-  for (int i = 0; i < 5; ++i) {
-    const tinygltf::Accessor& accessor = mModel->accessors.at(mAttribAccessors.at(i));
-    const tinygltf::BufferView& bufferView = mModel->bufferViews.at(accessor.bufferView);
-    const tinygltf::Buffer& buffer = mModel->buffers.at(bufferView.buffer);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mVertexVBO.at(i));
-    glBufferData(GL_ARRAY_BUFFER, bufferView.byteLength,
-     &buffer.data.at(0) + bufferView.byteOffset, GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-  }
+  glBindBuffer(GL_ARRAY_BUFFER, mVertexVBO);
+  glBufferData(GL_ARRAY_BUFFER, mPackedVertices.size() * sizeof(GltfPackedVertex),
+    mPackedVertices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void GltfModel::uploadIndexBuffer() {
-  /* buffer for vertex indices */
-  const tinygltf::Primitive& primitives = mModel->meshes.at(0).primitives.at(0);
-  const tinygltf::Accessor& indexAccessor = mModel->accessors.at(primitives.indices);
-  const tinygltf::BufferView& indexBufferView = mModel->bufferViews.at(indexAccessor.bufferView);
-  const tinygltf::Buffer& indexBuffer = mModel->buffers.at(indexBufferView.buffer);
-
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexVBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferView.byteLength,
-    &indexBuffer.data.at(0) + indexBufferView.byteOffset, GL_STATIC_DRAW);
+
+  /* half of the index data for all meshes with up to 64k vertices */
+  if (mPackedVertices.size() <= std::numeric_limits<uint16_t>::max() + 1) {
+    std::vector<uint16_t> shortIndices(mIndices.begin(), mIndices.end());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t),
+      shortIndices.data(), GL_STATIC_DRAW);
+    mIndexType = GL_UNSIGNED_SHORT;
+  } else {
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mIndices.size() * sizeof(uint32_t),
+      mIndices.data(), GL_STATIC_DRAW);
+    mIndexType = GL_UNSIGNED_INT;
+  }
 }
 
 int GltfModel::getTriangleCount() {
@@ -365,9 +476,12 @@ int GltfModel::getTriangleCount() {
   return triangles;
 }
 
+int GltfModel::getLODTriangleCount(int lodLevel) {
+  return mMeshLODs.at(lodLevel).indexCount / 3;
+}
+
 void GltfModel::draw() {
   const tinygltf::Primitive &primitives = mModel->meshes.at(0).primitives.at(0);
-  const tinygltf::Accessor &indexAccessor = mModel->accessors.at(primitives.indices);
 
   GLuint drawMode = GL_TRIANGLES;
   switch (primitives.mode) {
@@ -381,14 +495,17 @@ void GltfModel::draw() {
 
   mTex.bind();
   glBindVertexArray(mVAO);
-  glDrawElements(drawMode, indexAccessor.count, indexAccessor.componentType, nullptr);
+  glDrawElements(drawMode, mMeshLODs.at(0).indexCount, mIndexType, nullptr);
   glBindVertexArray(0);
   mTex.unbind();
 }
 
-void GltfModel::drawInstanced(int instanceCount) {
+void GltfModel::drawInstanced(int instanceCount, int lodLevel, int baseInstance) {
+  if (instanceCount == 0) {
+    return;
+  }
+
   const tinygltf::Primitive &primitives = mModel->meshes.at(0).primitives.at(0);
-  const tinygltf::Accessor &indexAccessor = mModel->accessors.at(primitives.indices);
 
   GLuint drawMode = GL_TRIANGLES;
   switch (primitives.mode) {
@@ -402,14 +519,17 @@ void GltfModel::drawInstanced(int instanceCount) {
 
   mTex.bind();
   glBindVertexArray(mVAO);
-  glDrawElementsInstanced(drawMode, indexAccessor.count, indexAccessor.componentType, nullptr,
-    instanceCount);
+  const GltfMeshLOD &meshLOD = mMeshLODs.at(lodLevel);
+  size_t indexSize = mIndexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+  glDrawElementsInstancedBaseInstance(drawMode, meshLOD.indexCount, mIndexType,
+    reinterpret_cast<const void *>(meshLOD.firstIndex * indexSize), instanceCount,
+    baseInstance);
   glBindVertexArray(0);
   mTex.unbind();
 }
 
 void GltfModel::cleanup() {
-  glDeleteBuffers(mVertexVBO.size(), mVertexVBO.data());
+  glDeleteBuffers(1, &mVertexVBO);
   glDeleteBuffers(1, &mVAO);
   glDeleteBuffers(1, &mIndexVBO);
   mTex.cleanup();
@@ -3,56 +3,75 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <map>
 #include <glad/glad.h>
 #include <tiny_gltf.h>
 
 #include "Texture.h"
-#include "GltfNode.h"
+#include "GltfSkeleton.h"
 #include "GltfAnimationClip.h"
+#include "GltfVertexPacking.h"
+#include "GltfMeshOptimizer.h"
+#include "GltfMeshSimplifier.h"
 
 #include "OGLRenderData.h"
 
-struct GltfNodeData {
-    std::shared_ptr<GltfNode> rootNode;
-    std::vector<std::shared_ptr<GltfNode>> nodeList;
+/* range of one distance level inside the shared index buffer */
+struct GltfMeshLOD {
+  uint32_t firstIndex = 0;
+  uint32_t indexCount = 0;
 };
 
 class GltfModel {
   public:
+    /* full mesh plus three levels, each with about half of the triangles of the previous one */
+    static constexpr int NUM_MESH_LODS = 4;
+
     bool loadModel(OGLRenderData &renderData, std::string modelFilename,
       std::string textureFilename);
+    /* CPU side only (skeleton, skin and clips), no texture and no GL buffers */
+    bool loadModelData(OGLRenderData &renderData, std::string modelFilename);
     void draw();
-    void drawInstanced(int instanceCount);
+    /* the instances start at baseInstance, the shaders add gl_BaseInstance to their index */
+    void drawInstanced(int instanceCount, int lodLevel, int baseInstance);
     void cleanup();
 
     std::string getModelFilename();
     int getNodeCount();
-    GltfNodeData getGltfNodes();
+    std::shared_ptr<GltfSkeleton> getSkeleton();
+    /* largest distance of a vertex from its main joint, grows the node bounds to the mesh */
+    float getBoundsPadding();
     int getTriangleCount();
+    int getLODTriangleCount(int lodLevel);
 
     void uploadVertexBuffers();
     void uploadIndexBuffer();
 
-    std::vector<glm::mat4> getInverseBindMatrices();
-    std::vector<int> getNodeToJoint();
 
     std::vector<std::shared_ptr<GltfAnimationClip>> getAnimClips();
-
-    void resetNodeData(std::shared_ptr<GltfNode> treeNode);
+    /* UI data, stored once per model instead of in the settings of every instance */
+    const std::vector<std::string> &getClipNames();
+    /* indexed by the glTF node number, "(invalid)" for nodes outside of the skeleton */
+    const std::vector<std::string> &getSkeletonNodeNames();
+    void setUseBakedClips(bool useBakedClips);
 
   private:
-    void createVertexBuffers();
-    void createIndexBuffer();
+    bool createVertexBuffers();
+    bool createIndexBuffer();
+    /* welds the vertices, reorders triangles and vertices and logs the cache efficiency */
+    void optimizeMesh(bool optimizeOverdraw);
+    /* simplified index lists of the optimized mesh, appended to the full index list */
+    void createMeshLODs();
 
     void getJointData();
     void getWeightData();
     void getInvBindMatrices();
-    void getAnimations();
-    void getNodes(std::shared_ptr<GltfNode> treeNode);
-    void getNodeData(std::shared_ptr<GltfNode> treeNode);
-    std::vector<std::shared_ptr<GltfNode>> getNodeList(std::vector<std::shared_ptr<GltfNode>>
-      &nodeList, int nodeNum);
+    void calculateBoundsPadding();
+    /* keyTolerance 0 keeps the channels as loaded */
+    void getAnimations(float keyTolerance);
+    void optimizeAnimations(float keyTolerance);
+    void compressAnimations(float maxError);
+    void createSkeleton();
+    void addSkeletonNodes(int nodeNum, int parentIndex);
 
     std::string mModelFilename;
     int mNodeCount = 0;
@@ -61,18 +80,28 @@ class GltfModel {
 
     std::vector<glm::tvec4<uint16_t>> mJointVec{};
     std::vector<glm::vec4> mWeightVec{};
-    std::vector<glm::mat4> mInverseBindMatrices{};
+    float mBoundsPadding = 0.0f;
 
-    std::vector<int> mAttribAccessors{};
-    std::vector<int> mNodeToJoint{};
+    /* all attributes interleaved in one stream, converted when the GL buffers are created */
+    std::vector<GltfPackedVertex> mPackedVertices{};
+    /* triangle list of the packed vertices, uploaded with 16 bit if the vertex count fits */
+    std::vector<uint32_t> mIndices{};
+    std::vector<GltfMeshLOD> mMeshLODs{};
 
     std::vector<std::shared_ptr<GltfAnimationClip>> mAnimClips{};
+    /* resample rate of the baked clips, matches the 30 fps keys of the model */
+    float mClipBakeFrameRate = 30.0f;
+
+    /* shared by all instances, they only store their own pose */
+    std::shared_ptr<GltfSkeleton> mSkeleton = nullptr;
+
+    std::vector<std::string> mClipNames{};
+    std::vector<std::string> mSkeletonNodeNames{};
 
     GLuint mVAO = 0;
-    std::vector<GLuint> mVertexVBO{};
+    GLuint mVertexVBO = 0;
     GLuint mIndexVBO = 0;
-    std::map<std::string, GLint> attributes =
-      {{"POSITION", 0}, {"NORMAL", 1}, {"TEXCOORD_0", 2}, {"JOINTS_0", 3}, {"WEIGHTS_0", 4}};
+    GLenum mIndexType = GL_UNSIGNED_INT;
 
     Texture mTex{};
 };
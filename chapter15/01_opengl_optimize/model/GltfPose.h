@@ -0,0 +1,47 @@
+/* per-instance pose of a shared glTF skeleton */
+#pragma once
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "GltfSkeleton.h"
+#include "GltfLocalPose.h"
+
+class GltfPose {
+  public:
+    void init(std::shared_ptr<GltfSkeleton> skeleton);
+    void resetToBindPose();
+
+    /* clips sample into it, blends write their result into it */
+    GltfLocalPose &getLocalPose();
+
+    void blendRotation(int index, glm::quat rotation, float blendFactor);
+
+    glm::quat getLocalRotation(int index);
+    glm::quat getGlobalRotation(int index);
+    glm::vec3 getGlobalPosition(int index);
+
+    void setWorldPosition(glm::vec3 pos);
+    void setWorldRotation(glm::vec3 rot);
+
+    /* single linear pass over all nodes, or over the subtree starting at index */
+    void updateNodeMatrices();
+    void updateNodeMatrices(int index);
+    /* only the node ranges evaluated by the skeleton LOD level, the others keep their matrix */
+    void updateLODNodeMatrices(int level);
+    glm::mat4 getNodeMatrix(int index);
+
+  private:
+    void updateNodeMatrixRange(int startIndex, int endIndex);
+
+    std::shared_ptr<GltfSkeleton> mSkeleton = nullptr;
+
+    GltfLocalPose mLocalPose{};
+
+    std::vector<glm::mat4> mNodeMatrices{};
+
+    glm::vec3 mWorldPosition = glm::vec3(0.0f);
+    glm::quat mWorldRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::mat4 mWorldTRMatrix = glm::mat4(1.0f);
+};
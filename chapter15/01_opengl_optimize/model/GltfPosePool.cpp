@@ -0,0 +1,28 @@
+#include "GltfPosePool.h"
+#include "Logger.h"
+
+GltfLocalPose *GltfPosePool::getPoses() {
+  /* sized on first use, the copies of the bind pose reuse the memory */
+  thread_local GltfLocalPose poses[NUM_SLOTS];
+  return poses;
+}
+
+GltfLocalPose &GltfPosePool::getBindPose(int slot,
+    const std::shared_ptr<GltfSkeleton> &skeleton) {
+  if (slot < 0 || slot >= NUM_SLOTS) {
+    Logger::log(1, "%s error: invalid pose slot %i\n", __FUNCTION__, slot);
+    slot = 0;
+  }
+
+  GltfLocalPose &pose = getPoses()[slot];
+  pose.translations = skeleton->getBindTranslations();
+  pose.rotations = skeleton->getBindRotations();
+  pose.scales = skeleton->getBindScales();
+  return pose;
+}
+
+void GltfPosePool::reserve(const std::shared_ptr<GltfSkeleton> &skeleton) {
+  for (int i = 0; i < NUM_SLOTS; ++i) {
+    getBindPose(i, skeleton);
+  }
+}
@@ -0,0 +1,22 @@
+/* scratch poses for sampling and blending, one set per thread, reused every frame */
+#pragma once
+#include <vector>
+#include <memory>
+
+#include "GltfLocalPose.h"
+#include "GltfSkeleton.h"
+
+class GltfPosePool {
+  public:
+    /* a two clip blend needs two poses */
+    static constexpr int NUM_SLOTS = 2;
+
+    /* reset to the bind pose, valid until the same slot is requested again by the thread */
+    static GltfLocalPose &getBindPose(int slot, const std::shared_ptr<GltfSkeleton> &skeleton);
+
+    /* allocates the scratch memory of the calling thread up front */
+    static void reserve(const std::shared_ptr<GltfSkeleton> &skeleton);
+
+  private:
+    static GltfLocalPose *getPoses();
+};
@@ -0,0 +1,21 @@
+/* camera distances of the far levels, shared by the animation and the mesh level of detail */
+#pragma once
+#include <glm/glm.hpp>
+
+class LODDistances {
+  public:
+    /* level 0 below the first distance, level 3 beyond the last one */
+    static constexpr int NUM_LOD_LEVELS = 4;
+
+    LODDistances(float lod1Distance, float lod2Distance, float lod3Distance);
+
+    /* camera distances where the levels 1 to 3 start, for a 60 degree field of view */
+    void setDistances(float lod1Distance, float lod2Distance, float lod3Distance);
+
+    /* a narrow field of view magnifies the instances, moving the level boundaries out */
+    static float getFieldOfViewScale(int fieldOfView);
+    int getLevel(glm::vec2 worldPos, glm::vec3 cameraPos, float fovScale) const;
+
+  private:
+    float mDistances[NUM_LOD_LEVELS - 1];
+};
@@ -0,0 +1,35 @@
+#include <algorithm>
+
+#include "MeshLOD.h"
+
+void MeshLOD::setEnabled(bool enabled) {
+  mEnabled = enabled;
+}
+
+void MeshLOD::setDistances(float lod1Distance, float lod2Distance, float lod3Distance) {
+  mDistances.setDistances(lod1Distance, lod2Distance, lod3Distance);
+}
+
+void MeshLOD::selectLevels(const std::vector<std::shared_ptr<GltfInstance>> &instances,
+    glm::vec3 cameraPos, int fieldOfView, int forcedInstance) {
+  mLODLevels.resize(instances.size());
+  if (!mEnabled) {
+    std::fill(mLODLevels.begin(), mLODLevels.end(), 0);
+    return;
+  }
+
+  /* the projected size of an instance shrinks with the distance */
+  float fovScale = LODDistances::getFieldOfViewScale(fieldOfView);
+
+  for (size_t i = 0; i < instances.size(); ++i) {
+    int level = 0;
+    if (static_cast<int>(i) != forcedInstance) {
+      level = mDistances.getLevel(instances.at(i)->getWorldPosition(), cameraPos, fovScale);
+    }
+    mLODLevels.at(i) = level;
+  }
+}
+
+int MeshLOD::getLevel(int instanceIndex) {
+  return mLODLevels.at(instanceIndex);
+}
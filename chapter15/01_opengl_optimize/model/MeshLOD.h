@@ -0,0 +1,30 @@
+/* mesh level of detail, far instances are drawn with the simplified index lists */
+#pragma once
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "GltfInstance.h"
+#include "LODDistances.h"
+
+class MeshLOD {
+  public:
+    static constexpr int NUM_LOD_LEVELS = GltfModel::NUM_MESH_LODS;
+    static_assert(NUM_LOD_LEVELS == LODDistances::NUM_LOD_LEVELS,
+      "every distance level needs a mesh level");
+
+    void setEnabled(bool enabled);
+    /* camera distances where the levels 1 to 3 start, for a 60 degree field of view */
+    void setDistances(float lod1Distance, float lod2Distance, float lod3Distance);
+
+    /* level of every instance in this frame, forcedInstance always uses the full mesh */
+    void selectLevels(const std::vector<std::shared_ptr<GltfInstance>> &instances,
+      glm::vec3 cameraPos, int fieldOfView, int forcedInstance);
+    int getLevel(int instanceIndex);
+
+  private:
+    bool mEnabled = true;
+    LODDistances mDistances{ 20.0f, 40.0f, 70.0f };
+
+    std::vector<int> mLODLevels{};
+};
@@ -0,0 +1,164 @@
+#include <cmath>
+
+#include "DebugDraw.h"
+#include "Logger.h"
+
+bool DebugDraw::init(unsigned int maxVertices, int numRegions) {
+  mMaxVertices = maxVertices;
+  mVertexCount = 0;
+  mCurrentRegion = 0;
+  mRegionFences.resize(numRegions, nullptr);
+
+  size_t bufferSize = static_cast<size_t>(mMaxVertices) * numRegions * sizeof(OGLVertex);
+  GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  glGenVertexArrays(1, &mVAO);
+  glGenBuffers(1, &mVertexVBO);
+
+  glBindVertexArray(mVAO);
+
+  glBindBuffer(GL_ARRAY_BUFFER, mVertexVBO);
+  glBufferStorage(GL_ARRAY_BUFFER, bufferSize, NULL, flags);
+  mMappedData = static_cast<OGLVertex*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bufferSize, flags));
+
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(OGLVertex), (void*) offsetof(OGLVertex, position));
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(OGLVertex), (void*) offsetof(OGLVertex, color));
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(OGLVertex), (void*) offsetof(OGLVertex, uv));
+
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glEnableVertexAttribArray(2);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+
+  if (!mMappedData) {
+    Logger::log(1, "%s error: could not map debug line buffer (size %i bytes)\n", __FUNCTION__,
+      bufferSize);
+    return false;
+  }
+
+  mCirclePoints.resize(SPHERE_SEGMENTS);
+  for (int i = 0; i < SPHERE_SEGMENTS; ++i) {
+    float angle = glm::radians(360.0f) * i / SPHERE_SEGMENTS;
+    mCirclePoints.at(i) = glm::vec2(std::cos(angle), std::sin(angle));
+  }
+
+  Logger::log(1, "%s: debug line buffer (%i x %i vertices) initialized\n", __FUNCTION__,
+    numRegions, mMaxVertices);
+  return true;
+}
+
+void DebugDraw::beginFrame() {
+  GLsync &fence = mRegionFences.at(mCurrentRegion);
+  if (fence) {
+    /* flush on the first try only, the commands are on their way afterwards */
+    GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+      GLenum result = glClientWaitSync(fence, waitFlags, 1000000);
+      if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+        break;
+      }
+      if (result == GL_WAIT_FAILED) {
+        Logger::log(1, "%s error: waiting for region %i failed\n", __FUNCTION__,
+          mCurrentRegion);
+        break;
+      }
+      waitFlags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+  mVertexCount = 0;
+}
+
+OGLVertex *DebugDraw::allocateVertices(unsigned int vertexCount) {
+  if (mVertexCount + vertexCount > mMaxVertices) {
+    if (!mOverflowLogged) {
+      Logger::log(1, "%s error: more than %i debug line vertices in one frame, lines dropped\n",
+        __FUNCTION__, mMaxVertices);
+      mOverflowLogged = true;
+    }
+    return nullptr;
+  }
+
+  OGLVertex *vertices = mMappedData + mCurrentRegion * mMaxVertices + mVertexCount;
+  mVertexCount += vertexCount;
+  return vertices;
+}
+
+void DebugDraw::addLine(glm::vec3 start, glm::vec3 end, glm::vec3 color) {
+  OGLVertex *vertices = allocateVertices(2);
+  if (!vertices) {
+    return;
+  }
+  vertices[0] = { start, color, glm::vec2(0.0f) };
+  vertices[1] = { end, color, glm::vec2(0.0f) };
+}
+
+void DebugDraw::addLines(const OGLMesh &lines, glm::quat rotation, glm::vec3 translation,
+    float colorScale) {
+  OGLVertex *vertices = allocateVertices(lines.vertices.size());
+  if (!vertices) {
+    return;
+  }
+  for (const auto &vertex : lines.vertices) {
+    *vertices++ = { rotation * vertex.position + translation, vertex.color * colorScale,
+      vertex.uv };
+  }
+}
+
+void DebugDraw::addSphere(glm::vec4 sphere, glm::vec3 color) {
+  OGLVertex *vertices = allocateVertices(SPHERE_VERTEX_COUNT);
+  if (!vertices) {
+    return;
+  }
+
+  glm::vec3 center = glm::vec3(sphere);
+  for (int i = 0; i < SPHERE_SEGMENTS; ++i) {
+    glm::vec2 start = mCirclePoints.at(i) * sphere.w;
+    glm::vec2 end = mCirclePoints.at((i + 1) % SPHERE_SEGMENTS) * sphere.w;
+
+    /* XY, XZ and YZ planes */
+    *vertices++ = { center + glm::vec3(start.x, start.y, 0.0f), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(end.x, end.y, 0.0f), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(start.x, 0.0f, start.y), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(end.x, 0.0f, end.y), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(0.0f, start.x, start.y), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(0.0f, end.x, end.y), color, glm::vec2(0.0f) };
+  }
+}
+
+unsigned int DebugDraw::getVertexCount() {
+  return mVertexCount;
+}
+
+void DebugDraw::draw() {
+  if (mVertexCount > 0) {
+    glBindVertexArray(mVAO);
+    glDrawArrays(GL_LINES, mCurrentRegion * mMaxVertices, mVertexCount);
+    glBindVertexArray(0);
+  }
+
+  mRegionFences.at(mCurrentRegion) = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  mCurrentRegion = (mCurrentRegion + 1) % mRegionFences.size();
+}
+
+void DebugDraw::cleanup() {
+  for (auto &fence : mRegionFences) {
+    if (fence) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  if (mMappedData) {
+    glBindBuffer(GL_ARRAY_BUFFER, mVertexVBO);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    mMappedData = nullptr;
+  }
+
+  glDeleteBuffers(1, &mVertexVBO);
+  glDeleteVertexArrays(1, &mVAO);
+}
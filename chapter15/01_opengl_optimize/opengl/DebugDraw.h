@@ -0,0 +1,51 @@
+/* batched debug lines, written straight into a persistently mapped ring buffer
+ * every frame fills its own region, guarded by a fence until the GPU has drawn it */
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <glad/glad.h>
+
+#include "OGLRenderData.h"
+
+class DebugDraw {
+  public:
+    /* three circles around the axes per sphere */
+    static constexpr int SPHERE_SEGMENTS = 16;
+    static constexpr unsigned int SPHERE_VERTEX_COUNT = 3 * SPHERE_SEGMENTS * 2;
+
+    /* maxVertices per frame, the buffer is never resized afterwards */
+    bool init(unsigned int maxVertices, int numRegions);
+    /* waits until the GPU has finished drawing the region of this frame */
+    void beginFrame();
+
+    void addLine(glm::vec3 start, glm::vec3 end, glm::vec3 color);
+    /* line list, rotated and moved into place, the colors are scaled */
+    void addLines(const OGLMesh &lines, glm::quat rotation, glm::vec3 translation,
+      float colorScale);
+    /* xyz is the center and w the radius */
+    void addSphere(glm::vec4 sphere, glm::vec3 color);
+
+    unsigned int getVertexCount();
+    /* draws the lines of this frame, fences the region and switches to the next one */
+    void draw();
+    void cleanup();
+
+  private:
+    /* returns nullptr if the region of the frame is full */
+    OGLVertex *allocateVertices(unsigned int vertexCount);
+
+    GLuint mVAO = 0;
+    GLuint mVertexVBO = 0;
+    OGLVertex *mMappedData = nullptr;
+
+    unsigned int mMaxVertices = 0;
+    unsigned int mVertexCount = 0;
+    bool mOverflowLogged = false;
+
+    int mCurrentRegion = 0;
+    std::vector<GLsync> mRegionFences{};
+
+    /* unit circle, avoids the trigonometry per sphere */
+    std::vector<glm::vec2> mCirclePoints{};
+};
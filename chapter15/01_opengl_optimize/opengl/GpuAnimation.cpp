@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "GpuAnimation.h"
+#include "Logger.h"
+
+namespace {
+  /* must match local_size_x of the compute shaders */
+  constexpr int WORK_GROUP_SIZE = 64;
+  /* same number of slices as the joint buffers */
+  constexpr int NUM_INSTANCE_BUFFER_SLICES = 3;
+
+  /* the structs must match the std430 layout of the compute shaders */
+  struct ClipInfo {
+    int sampleOffset;
+    int frameCount;
+    float frameRate;
+    int padding;
+  };
+
+  struct NodeData {
+    glm::mat4 inverseBindMatrix;
+    glm::vec4 bindRotation;
+    glm::vec4 bindTranslation;
+    glm::vec4 bindScale;
+    int parent;
+    int jointNum;
+    int padding0;
+    int padding1;
+  };
+
+  struct AnimInstance {
+    glm::mat4 worldMatrix;
+    int sourceClip;
+    int destClip;
+    float sourceTime;
+    float destTime;
+    float blendFactor;
+    int crossBlend;
+    int maskStart;
+    int maskEnd;
+    int jointOffset;
+    int dualQuat;
+    int padding0;
+    int padding1;
+  };
+
+  void dispatchInvocations(int numInvocations) {
+    glDispatchCompute((numInvocations + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1, 1);
+  }
+}
+
+bool GpuAnimation::init(std::shared_ptr<GltfModel> model, int maxInstances) {
+  mGltfModel = model;
+  mSkeleton = mGltfModel->getSkeleton();
+  mAnimClips = mGltfModel->getAnimClips();
+  mMaxInstances = maxInstances;
+
+  if (!mSampleShader.loadComputeShader("shader/anim_sample.comp")) {
+    Logger::log(1, "%s: animation sample compute shader loading failed\n", __FUNCTION__);
+    return false;
+  }
+  if (!mHierarchyShader.loadComputeShader("shader/anim_hierarchy.comp")) {
+    Logger::log(1, "%s: animation hierarchy compute shader loading failed\n", __FUNCTION__);
+    return false;
+  }
+  if (!mHierarchyShader.getUniformLocation("aLevel")) {
+    Logger::log(1, "%s: failed to get level uniform for animation hierarchy compute shader\n",
+      __FUNCTION__);
+    return false;
+  }
+  if (!mJointShader.loadComputeShader("shader/anim_joints.comp")) {
+    Logger::log(1, "%s: animation joint compute shader loading failed\n", __FUNCTION__);
+    return false;
+  }
+
+  if (!uploadSkeleton() || !uploadClips()) {
+    return false;
+  }
+
+  if (!mInstanceBuffer.initPersistent(mMaxInstances * sizeof(AnimInstance),
+      NUM_INSTANCE_BUFFER_SLICES)) {
+    Logger::log(1, "%s error: could not create animation instance buffer\n", __FUNCTION__);
+    return false;
+  }
+
+  /* local node matrices of all instances, made global in place */
+  mNodeMatrixBuffer.init(mMaxInstances * mSkeleton->getNodeCount() * sizeof(glm::mat4));
+
+  Logger::log(1, "%s: GPU animation for %i instances initialized\n", __FUNCTION__,
+    mMaxInstances);
+  return true;
+}
+
+bool GpuAnimation::uploadSkeleton() {
+  int nodeCount = mSkeleton->getNodeCount();
+  const std::vector<int> &parents = mSkeleton->getParentIndices();
+  const std::vector<glm::quat> &bindRotations = mSkeleton->getBindRotations();
+  const std::vector<glm::vec3> &bindTranslations = mSkeleton->getBindTranslations();
+  const std::vector<glm::vec3> &bindScales = mSkeleton->getBindScales();
+
+  std::vector<NodeData> nodes(nodeCount);
+  std::vector<int> depths(nodeCount, 0);
+  for (int i = 0; i < nodeCount; ++i) {
+    NodeData &node = nodes.at(i);
+    node.parent = parents.at(i);
+    node.jointNum = mSkeleton->getJointNum(i);
+    node.inverseBindMatrix = node.jointNum < 0 ? glm::mat4(1.0f) :
+      mSkeleton->getInverseBindMatrix(node.jointNum);
+    node.bindRotation = glm::vec4(bindRotations.at(i).x, bindRotations.at(i).y,
+      bindRotations.at(i).z, bindRotations.at(i).w);
+    node.bindTranslation = glm::vec4(bindTranslations.at(i), 0.0f);
+    node.bindScale = glm::vec4(bindScales.at(i), 0.0f);
+
+    /* parents are always stored before their children */
+    depths.at(i) = node.parent < 0 ? 0 : depths.at(node.parent) + 1;
+  }
+
+  int numLevels = *std::max_element(depths.begin(), depths.end()) + 1;
+  mLevelSizes.assign(numLevels, 0);
+  for (const auto depth : depths) {
+    ++mLevelSizes.at(depth);
+  }
+
+  /* level start offsets plus the end offset, then the nodes of each level */
+  std::vector<int> levelData(numLevels + 1 + nodeCount);
+  int offset = numLevels + 1;
+  for (int level = 0; level < numLevels; ++level) {
+    levelData.at(level) = offset;
+    offset += mLevelSizes.at(level);
+  }
+  levelData.at(numLevels) = offset;
+
+  std::vector<int> levelPos(levelData.begin(), levelData.begin() + numLevels);
+  for (int i = 0; i < nodeCount; ++i) {
+    levelData.at(levelPos.at(depths.at(i))++) = i;
+  }
+
+  size_t nodeDataSize = nodes.size() * sizeof(NodeData);
+  mNodeBuffer.init(nodeDataSize);
+  mNodeBuffer.uploadData(nodes.data(), nodeDataSize, 5);
+
+  size_t levelDataSize = levelData.size() * sizeof(int);
+  mLevelBuffer.init(levelDataSize);
+  mLevelBuffer.uploadData(levelData.data(), levelDataSize, 6);
+
+  Logger::log(1, "%s: uploaded %i nodes in %i levels\n", __FUNCTION__, nodeCount, numLevels);
+  return true;
+}
+
+bool GpuAnimation::uploadClips() {
+  int nodeCount = mSkeleton->getNodeCount();
+
+  std::vector<ClipInfo> clipInfos{};
+  std::vector<glm::vec4> samples{};
+
+  std::vector<glm::quat> rotations{};
+  std::vector<glm::vec3> translations{};
+  std::vector<glm::vec3> scales{};
+
+  for (const auto &clip : mAnimClips) {
+    int frameCount = clip->getBakedFrameCount();
+    if (frameCount < 2) {
+      Logger::log(1, "%s error: clip '%s' is not baked\n", __FUNCTION__,
+        clip->getClipName().c_str());
+      return false;
+    }
+
+    ClipInfo info{};
+    info.sampleOffset = samples.size() / 3;
+    info.frameCount = frameCount;
+    info.frameRate = clip->getBakedFrameRate();
+    clipInfos.emplace_back(info);
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+      /* nodes without a track in the clip stay in the bind pose */
+      rotations = mSkeleton->getBindRotations();
+      translations = mSkeleton->getBindTranslations();
+      scales = mSkeleton->getBindScales();
+      clip->copyBakedFrame(frame, rotations.data(), translations.data(), scales.data());
+
+      for (int i = 0; i < nodeCount; ++i) {
+        samples.emplace_back(rotations.at(i).x, rotations.at(i).y, rotations.at(i).z,
+          rotations.at(i).w);
+        samples.emplace_back(translations.at(i), 0.0f);
+        samples.emplace_back(scales.at(i), 0.0f);
+      }
+    }
+  }
+
+  size_t clipInfoSize = clipInfos.size() * sizeof(ClipInfo);
+  mClipInfoBuffer.init(clipInfoSize);
+  mClipInfoBuffer.uploadData(clipInfos.data(), clipInfoSize, 4);
+
+  size_t sampleSize = samples.size() * sizeof(glm::vec4);
+  mClipSampleBuffer.init(sampleSize);
+  mClipSampleBuffer.uploadData(samples.data(), sampleSize, 3);
+
+  Logger::log(1, "%s: uploaded %i clips, %i bytes of samples\n", __FUNCTION__,
+    clipInfos.size(), sampleSize);
+  return true;
+}
+
+bool GpuAnimation::canAnimate(const ModelSettings &settings) {
+  return settings.msIkMode == ikMode::off && !settings.msDrawSkeleton;
+}
+
+int GpuAnimation::dispatch(const std::vector<std::shared_ptr<GltfInstance>> &instances,
+    const std::vector<bool> &gpuAnimated, const std::vector<int> &jointSlots) {
+  int nodeCount = mSkeleton->getNodeCount();
+  int jointCount = mSkeleton->getJointCount();
+
+  AnimInstance *instanceData = static_cast<AnimInstance*>(mInstanceBuffer.getMappedSlice());
+  int numInstances = 0;
+
+  for (size_t i = 0; i < instances.size() && numInstances < mMaxInstances; ++i) {
+    if (!gpuAnimated.at(i) || jointSlots.at(i) < 0) {
+      continue;
+    }
+
+    const ModelSettings &settings = instances.at(i)->getInstanceSettings();
+    AnimInstance &data = instanceData[numInstances++];
+
+    glm::vec2 worldPos = instances.at(i)->getWorldPosition();
+    data.worldMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(worldPos.x, 0.0f, worldPos.y)) *
+      glm::mat4_cast(instances.at(i)->getWorldRotation());
+
+    data.sourceClip = settings.msAnimClip;
+    data.sourceTime = settings.msAnimTimePosition;
+
+    if (settings.msBlendingMode == blendMode::crossfade ||
+        settings.msBlendingMode == blendMode::additive) {
+      /* same time scaling as the CPU cross blending */
+      float sourceDuration = mAnimClips.at(settings.msAnimClip)->getClipEndTime();
+      float destDuration = mAnimClips.at(settings.msCrossBlendDestAnimClip)->getClipEndTime();
+
+      int splitNode = std::max(mSkeleton->getNodeIndex(settings.msSkelSplitNode), 0);
+      data.crossBlend = 1;
+      data.destClip = settings.msCrossBlendDestAnimClip;
+      data.destTime = settings.msAnimTimePosition * (destDuration / sourceDuration);
+      data.blendFactor = settings.msAnimCrossBlendFactor;
+      data.maskStart = splitNode;
+      data.maskEnd = mSkeleton->getSubtreeEnd(splitNode);
+    } else {
+      data.crossBlend = 0;
+      data.destClip = data.sourceClip;
+      data.destTime = data.sourceTime;
+      data.blendFactor = settings.msAnimBlendFactor;
+      data.maskStart = 0;
+      data.maskEnd = nodeCount;
+    }
+
+    data.jointOffset = jointSlots.at(i) * jointCount;
+    data.dualQuat = settings.msVertexSkinningMode == skinningMode::dualQuat ? 1 : 0;
+  }
+
+  if (numInstances == 0) {
+    return 0;
+  }
+
+  mClipSampleBuffer.bind(3);
+  mClipInfoBuffer.bind(4);
+  mNodeBuffer.bind(5);
+  mLevelBuffer.bind(6);
+  mInstanceBuffer.bindSlice(7, numInstances * sizeof(AnimInstance));
+  mNodeMatrixBuffer.bind(8);
+
+  /* local node matrices */
+  mSampleShader.use();
+  dispatchInvocations(numInstances * nodeCount);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  /* global node matrices, one level after the other */
+  mHierarchyShader.use();
+  for (size_t level = 0; level < mLevelSizes.size(); ++level) {
+    mHierarchyShader.setUniformValue(static_cast<int>(level));
+    dispatchInvocations(numInstances * mLevelSizes.at(level));
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  }
+
+  /* joint matrices or dual quaternions, read by the vertex shaders */
+  mJointShader.use();
+  dispatchInvocations(numInstances * nodeCount);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  mInstanceBuffer.fenceSlice();
+  return numInstances;
+}
+
+void GpuAnimation::cleanup() {
+  mSampleShader.cleanup();
+  mHierarchyShader.cleanup();
+  mJointShader.cleanup();
+
+  mClipSampleBuffer.cleanup();
+  mClipInfoBuffer.cleanup();
+  mNodeBuffer.cleanup();
+  mLevelBuffer.cleanup();
+  mInstanceBuffer.cleanup();
+  mNodeMatrixBuffer.cleanup();
+}
@@ -0,0 +1,51 @@
+/* compute shader animation, samples the baked clips and evaluates the skeleton on the GPU */
+#pragma once
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+
+#include "Shader.h"
+#include "ShaderStorageBuffer.h"
+#include "GltfModel.h"
+#include "GltfInstance.h"
+#include "ModelSettings.h"
+
+class GpuAnimation {
+  public:
+    bool init(std::shared_ptr<GltfModel> model, int maxInstances);
+
+    /* IK and the skeleton lines need the pose on the CPU */
+    static bool canAnimate(const ModelSettings &settings);
+
+    /* writes the joint data of the flagged instances into the joint buffers bound
+     * to 1 and 2, at the joint slots of the instances */
+    int dispatch(const std::vector<std::shared_ptr<GltfInstance>> &instances,
+      const std::vector<bool> &gpuAnimated, const std::vector<int> &jointSlots);
+
+    void cleanup();
+
+  private:
+    bool uploadClips();
+    bool uploadSkeleton();
+    void runShader(Shader &shader, int numInvocations);
+
+    std::shared_ptr<GltfModel> mGltfModel = nullptr;
+    std::shared_ptr<GltfSkeleton> mSkeleton = nullptr;
+    std::vector<std::shared_ptr<GltfAnimationClip>> mAnimClips{};
+    int mMaxInstances = 0;
+
+    Shader mSampleShader{};
+    Shader mHierarchyShader{};
+    Shader mJointShader{};
+
+    ShaderStorageBuffer mClipSampleBuffer{};
+    ShaderStorageBuffer mClipInfoBuffer{};
+    ShaderStorageBuffer mNodeBuffer{};
+    ShaderStorageBuffer mLevelBuffer{};
+    ShaderStorageBuffer mInstanceBuffer{};
+    ShaderStorageBuffer mNodeMatrixBuffer{};
+
+    /* number of nodes per depth level, level 0 contains the roots */
+    std::vector<int> mLevelSizes{};
+};
@@ -18,6 +18,17 @@ struct OGLMesh {
   std::vector<OGLVertex> vertices;
 };
 
+/* per-instance data of the baked crowd animation, std430 layout of the crowd shaders */
+struct OGLCrowdInstance {
+  glm::vec4 worldRotation;
+  glm::vec3 worldPosition;
+  int clip;
+  float time;
+  int padding0;
+  int padding1;
+  int padding2;
+};
+
 enum class skinningMode {
   linear = 0,
   dualQuat
@@ -54,11 +65,17 @@ struct OGLRenderData {
   float rdFrameTime = 0.0f;
   float rdMatrixGenerateTime = 0.0f;
   float rdIKTime = 0.0f;
+  float rdGpuAnimationTime = 0.0f;
   float rdUploadToVBOTime = 0.0f;
   float rdUploadToUBOTime = 0.0f;
   float rdUIGenerateTime = 0.0f;
   float rdUIDrawTime = 0.0f;
 
+  /* heap allocations of the last frame, a steady state frame has none */
+  bool rdTrackAllocations = false;
+  size_t rdFrameAllocations = 0;
+  size_t rdFrameAllocatedBytes = 0;
+
   int rdMoveForward = 0;
   int rdMoveRight = 0;
   int rdMoveUp = 0;
@@ -71,4 +88,70 @@ struct OGLRenderData {
 
   int rdNumberOfInstances = 0;
   int rdCurrentSelectedInstance = 0;
+
+  bool rdUseWorkerThreads = true;
+  int rdNumWorkerThreads = 1;
+  int rdMaxWorkerThreads = 1;
+
+  bool rdUseBakedClips = true;
+  /* constant tracks and redundant keys are removed when the model is loaded */
+  bool rdOptimizeClips = true;
+  float rdClipKeyTolerance = 0.0001f;
+  /* quantized keyframes and baked frames, applied when the model is loaded,
+   * the max error is a load time default, only the benchmark sets it (--max-error) */
+  bool rdCompressClips = true;
+  float rdClipCompressionMaxError = 0.0005f;
+  /* welded vertices in vertex cache order, applied when the model is loaded */
+  bool rdOptimizeMesh = true;
+  /* outer triangle clusters first, only kept if the vertex cache order barely suffers */
+  bool rdOptimizeOverdraw = true;
+
+  /* instances without IK or skeleton lines are animated by compute shaders */
+  bool rdUseGpuAnimation = false;
+  int rdGpuAnimatedInstances = 0;
+
+  /* looping instances without blending play the baked joint data of their clip */
+  bool rdUseBakedCrowd = false;
+  int rdCrowdInstances = 0;
+
+  /* far instances update every 2nd, 4th or 8th frame beyond the three distances */
+  bool rdUseAnimationLOD = true;
+  float rdAnimLODDistance1 = 30.0f;
+  float rdAnimLODDistance2 = 60.0f;
+  float rdAnimLODDistance3 = 90.0f;
+  /* maximum number of animated instances per frame, 0 is unlimited */
+  int rdAnimUpdateBudget = 0;
+  /* per LOD level, filled by the renderer */
+  std::vector<int> rdAnimLODInstances{};
+  std::vector<int> rdAnimLODUpdates{};
+
+  /* far instances are drawn with the simplified meshes beyond the three distances */
+  bool rdUseMeshLOD = true;
+  float rdMeshLODDistance1 = 20.0f;
+  float rdMeshLODDistance2 = 40.0f;
+  float rdMeshLODDistance3 = 70.0f;
+  /* per mesh LOD level, filled by the renderer, rdTriangleCount is the sum of all levels */
+  std::vector<int> rdMeshLODInstances{};
+  std::vector<unsigned int> rdMeshLODTriangles{};
+
+  /* CPU animated instances skip fingers, toes and face joints on the mesh LOD levels */
+  bool rdUseSkeletonLOD = true;
+  /* evaluated joints per skeleton LOD level and the CPU updates of the level in this frame */
+  std::vector<int> rdSkeletonLODJoints{};
+  std::vector<int> rdSkeletonLODUpdates{};
+
+  /* instances with their bounds outside of the view are not uploaded and not drawn */
+  bool rdUseFrustumCulling = true;
+  /* culled instances update every 8th frame, like the last LOD level */
+  bool rdReduceCulledUpdates = true;
+  int rdVisibleInstances = 0;
+  int rdCulledInstances = 0;
+  float rdCullingTime = 0.0f;
+  /* estimate, not measured: the joint data upload time per drawn instance times the
+   * number of culled instances */
+  float rdCullingTimeSavedEstimate = 0.0f;
+
+  /* coordinate arrows are always drawn, the bounds of the visible instances on request */
+  bool rdDrawBoundingSpheres = false;
+  unsigned int rdDebugLineVertices = 0;
 };
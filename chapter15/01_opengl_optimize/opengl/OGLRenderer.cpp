@@ -6,10 +6,20 @@
 
 #include <ctime>
 #include <cstdlib>
+#include <thread>
 
 #include "OGLRenderer.h"
 #include "ModelSettings.h"
 #include "Logger.h"
+#include "GltfPosePool.h"
+
+namespace {
+  /* instances drawn with the same shader and joint data buffer */
+  constexpr int MATRIX_GROUP = 0;
+  constexpr int DUAL_QUAT_GROUP = 1;
+  constexpr int CROWD_MATRIX_GROUP = 2;
+  constexpr int CROWD_DUAL_QUAT_GROUP = 3;
+}
 
 OGLRenderer::OGLRenderer(GLFWwindow *window) {
   mRenderData.rdWindow = window;
@@ -45,9 +55,6 @@ bool OGLRenderer::init(unsigned int width, unsigned int height) {
   }
   Logger::log(1, "%s: framebuffer succesfully initialized\n", __FUNCTION__);
 
-  mVertexBuffer.init();
-  Logger::log(1, "%s: vertex buffer successfully created\n", __FUNCTION__);
-
   size_t uniformMatrixBufferSize = 2 * sizeof(glm::mat4);
   mUniformBuffer.init(uniformMatrixBufferSize);
   Logger::log(1, "%s: matrix uniform buffer (size %i bytes) successfully created\n", __FUNCTION__, uniformMatrixBufferSize);
@@ -77,11 +84,57 @@ bool OGLRenderer::init(unsigned int width, unsigned int height) {
       __FUNCTION__);
     return false;
   }
+
+  if (!mGltfCrowdShader.loadShaders("shader/gltf_crowd.vert", "shader/gltf_gpu.frag")) {
+    Logger::log(1, "%s: glTF crowd shader loading failed\n", __FUNCTION__);
+    return false;
+  }
+  if (!mGltfCrowdShader.getUniformLocation("aModelStride")) {
+    Logger::log(1, "%s: failed to get model stride uniform for glTF crowd shader\n",
+      __FUNCTION__);
+    return false;
+  }
+
+  if (!mGltfCrowdDualQuatShader.loadShaders("shader/gltf_crowd_dquat.vert",
+      "shader/gltf_gpu_dquat.frag")) {
+    Logger::log(1, "%s: glTF crowd dual quat shader loading failed\n", __FUNCTION__);
+    return false;
+  }
+  if (!mGltfCrowdDualQuatShader.getUniformLocation("aModelStride")) {
+    Logger::log(1, "%s: failed to get model stride uniform for glTF crowd dual quat shader\n",
+      __FUNCTION__);
+    return false;
+  }
+
+  if (!mSkeletonShader.loadShaders("shader/skeleton.vert", "shader/line.frag")) {
+    Logger::log(1, "%s: skeleton shader loading failed\n", __FUNCTION__);
+    return false;
+  }
+  if (!mSkeletonShader.getUniformLocation("aModelStride")) {
+    Logger::log(1, "%s: failed to get model stride uniform for skeleton shader\n",
+      __FUNCTION__);
+    return false;
+  }
+
+  if (!mSkeletonDualQuatShader.loadShaders("shader/skeleton_dquat.vert", "shader/line.frag")) {
+    Logger::log(1, "%s: skeleton dual quat shader loading failed\n", __FUNCTION__);
+    return false;
+  }
+  if (!mSkeletonDualQuatShader.getUniformLocation("aModelStride")) {
+    Logger::log(1, "%s: failed to get model stride uniform for skeleton dual quat shader\n",
+      __FUNCTION__);
+    return false;
+  }
   Logger::log(1, "%s: shaders succesfully loaded\n", __FUNCTION__);
 
   mUserInterface.init(mRenderData);
   Logger::log(1, "%s: user interface initialized\n", __FUNCTION__);
 
+  /* the main thread does a share of the animation work too */
+  mRenderData.rdMaxWorkerThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  mRenderData.rdNumWorkerThreads = mRenderData.rdMaxWorkerThreads;
+  mWorkerPool.init(mRenderData.rdNumWorkerThreads);
+
   /* add backface culling and depth test already here */
   glEnable(GL_CULL_FACE);
   glEnable(GL_DEPTH_TEST);
@@ -117,20 +170,110 @@ bool OGLRenderer::init(unsigned int width, unsigned int height) {
 
   mRenderData.rdNumberOfInstances = mGltfInstances.size();
 
+  mAnimationLOD.init(mRenderData.rdNumberOfInstances);
+  mRenderData.rdAnimLODInstances.resize(AnimationLOD::NUM_LOD_LEVELS);
+  mRenderData.rdAnimLODUpdates.resize(AnimationLOD::NUM_LOD_LEVELS);
+  mRenderData.rdMeshLODInstances.resize(MeshLOD::NUM_LOD_LEVELS);
+  mRenderData.rdMeshLODTriangles.resize(MeshLOD::NUM_LOD_LEVELS);
+  mRenderData.rdSkeletonLODUpdates.resize(GltfSkeleton::NUM_LOD_LEVELS);
+  for (int i = 0; i < GltfSkeleton::NUM_LOD_LEVELS; ++i) {
+    mRenderData.rdSkeletonLODJoints.push_back(mGltfModel->getSkeleton()->getLODJointCount(i));
+  }
+
   size_t modelJointMatrixBufferSize = mRenderData.rdNumberOfInstances * mGltfInstances.at(0)->getJointMatrixSize() *
     sizeof(glm::mat4);
   size_t modelJointDualQuatBufferSize = mRenderData.rdNumberOfInstances * mGltfInstances.at(0)->getJointDualQuatsSize() *
      sizeof(glm::mat2x4);
 
-  mGltfShaderStorageBuffer.init(modelJointMatrixBufferSize);
-  Logger::log(1, "%s: glTF joint matrix shader storage buffer (size %i bytes) successfully created\n", __FUNCTION__, modelJointMatrixBufferSize);
+  /* triple buffering, the GPU may still read the joint data of the last two frames */
+  int numBufferSlices = 3;
+
+  if (!mGltfShaderStorageBuffer.initPersistent(modelJointMatrixBufferSize, numBufferSlices)) {
+    Logger::log(1, "%s error: could not create glTF joint matrix shader storage buffer\n",
+      __FUNCTION__);
+    return false;
+  }
+  Logger::log(1, "%s: glTF joint matrix shader storage buffer (%i x %i bytes) successfully created\n", __FUNCTION__, numBufferSlices, modelJointMatrixBufferSize);
+
+  if (!mGltfDualQuatSSBuffer.initPersistent(modelJointDualQuatBufferSize, numBufferSlices)) {
+    Logger::log(1, "%s error: could not create glTF joint dual quaternion shader storage buffer\n",
+      __FUNCTION__);
+    return false;
+  }
+  Logger::log(1, "%s: glTF joint dual quaternions shader storage buffer (%i x %i bytes) successfully created\n", __FUNCTION__, numBufferSlices, modelJointDualQuatBufferSize);
+
+  mInstanceJointSlots.resize(mGltfInstances.size());
+  mInstanceDrawGroups.resize(mGltfInstances.size());
+  mInstanceVisible.resize(mGltfInstances.size(), true);
+  mInstanceBounds.resize(mGltfInstances.size());
 
-  mGltfDualQuatSSBuffer.init(modelJointDualQuatBufferSize);
-  Logger::log(1, "%s: glTF joint dual quaternions shader storage buffer (size %i bytes) successfully created\n", __FUNCTION__, modelJointDualQuatBufferSize);
+  if (!mGpuAnimation.init(mGltfModel, mRenderData.rdNumberOfInstances)) {
+    Logger::log(1, "%s error: could not init GPU animation\n", __FUNCTION__);
+    return false;
+  }
+  mGpuAnimated.resize(mGltfInstances.size());
 
-  /* valid, but emtpy */
-  mLineMesh = std::make_shared<OGLMesh>();
-  Logger::log(1, "%s: line mesh storage initialized\n", __FUNCTION__);
+  /* same rate as the keyframes of the model */
+  if (!mBakedAnimation.bake(mGltfModel, 30.0f)) {
+    Logger::log(1, "%s error: could not bake the crowd animation\n", __FUNCTION__);
+    return false;
+  }
+
+  const std::vector<glm::mat4> &bakedMatrices = mBakedAnimation.getJointMatrices();
+  size_t bakedMatrixSize = bakedMatrices.size() * sizeof(glm::mat4);
+  mBakedJointMatrixBuffer.init(bakedMatrixSize);
+  mBakedJointMatrixBuffer.uploadData(bakedMatrices.data(), bakedMatrixSize, 10);
+
+  const std::vector<glm::mat2x4> &bakedDualQuats = mBakedAnimation.getJointDualQuats();
+  size_t bakedDualQuatSize = bakedDualQuats.size() * sizeof(glm::mat2x4);
+  mBakedJointDualQuatBuffer.init(bakedDualQuatSize);
+  mBakedJointDualQuatBuffer.uploadData(bakedDualQuats.data(), bakedDualQuatSize, 11);
+
+  const std::vector<GltfBakedClipInfo> &bakedClips = mBakedAnimation.getClipInfos();
+  size_t bakedClipSize = bakedClips.size() * sizeof(GltfBakedClipInfo);
+  mBakedClipBuffer.init(bakedClipSize);
+  mBakedClipBuffer.uploadData(bakedClips.data(), bakedClipSize, 12);
+
+  size_t crowdInstanceBufferSize = mRenderData.rdNumberOfInstances * sizeof(OGLCrowdInstance);
+  if (!mCrowdMatrixInstanceBuffer.initPersistent(crowdInstanceBufferSize, numBufferSlices) ||
+      !mCrowdDualQuatInstanceBuffer.initPersistent(crowdInstanceBufferSize, numBufferSlices)) {
+    Logger::log(1, "%s error: could not create crowd instance shader storage buffers\n",
+      __FUNCTION__);
+    return false;
+  }
+  mCrowdInstances.resize(mGltfInstances.size());
+  Logger::log(1, "%s: baked crowd animation (%i bytes) successfully uploaded\n", __FUNCTION__,
+    bakedMatrixSize + bakedDualQuatSize + bakedClipSize);
+
+  /* the bones are the same for all instances, only the joint data differs */
+  std::vector<glm::vec4> boneLines = mGltfModel->getSkeleton()->createBoneLines(1);
+  mSkeletonVertexCount = boneLines.size();
+  size_t boneLineSize = boneLines.size() * sizeof(glm::vec4);
+  mSkeletonBoneBuffer.init(boneLineSize);
+  mSkeletonBoneBuffer.uploadData(boneLines.data(), boneLineSize, 13);
+
+  size_t skeletonInstanceBufferSize = mRenderData.rdNumberOfInstances * sizeof(int);
+  if (!mSkeletonMatrixInstanceBuffer.initPersistent(skeletonInstanceBufferSize,
+        numBufferSlices) ||
+      !mSkeletonDualQuatInstanceBuffer.initPersistent(skeletonInstanceBufferSize,
+        numBufferSlices)) {
+    Logger::log(1, "%s error: could not create skeleton instance shader storage buffers\n",
+      __FUNCTION__);
+    return false;
+  }
+
+  /* the skeleton shaders fetch everything from the buffers, no vertex attributes */
+  glGenVertexArrays(1, &mSkeletonVAO);
+  Logger::log(1, "%s: skeleton bone lines (%i bytes) successfully uploaded\n", __FUNCTION__,
+    boneLineSize);
+
+  /* room for the two coordinate arrows and the bounds of all instances */
+  unsigned int maxDebugVertices = 2 * mCoordArrowsModel.getVertexData().vertices.size() +
+    mRenderData.rdNumberOfInstances * DebugDraw::SPHERE_VERTEX_COUNT;
+  if (!mDebugDraw.init(maxDebugVertices, numBufferSlices)) {
+    Logger::log(1, "%s error: could not init debug lines\n", __FUNCTION__);
+    return false;
+  }
 
   mFrameTimer.start();
 
@@ -152,10 +295,6 @@ void OGLRenderer::setSize(unsigned int width, unsigned int height) {
   Logger::log(1, "%s: resized window to %dx%d\n", __FUNCTION__, width, height);
 }
 
-void OGLRenderer::uploadData(OGLMesh vertexData) {
-  mVertexBuffer.uploadData(vertexData);
-}
-
 void OGLRenderer::handleKeyEvents(int key, int scancode, int action, int mods) {
 }
 
@@ -273,6 +412,12 @@ void OGLRenderer::draw() {
   mRenderData.rdFrameTime = mFrameTimer.stop();
   mFrameTimer.start();
 
+  /* counts of the last frame, including the UI and the event handling */
+  AllocationTracker::setEnabled(mRenderData.rdTrackAllocations);
+  mRenderData.rdFrameAllocations = AllocationTracker::getAllocationCount();
+  mRenderData.rdFrameAllocatedBytes = AllocationTracker::getAllocatedBytes();
+  AllocationTracker::resetCounters();
+
   handleMovementKeys();
 
   /* draw to framebuffer */
@@ -290,141 +435,377 @@ void OGLRenderer::draw() {
 
   mViewMatrix = mCamera.getViewMatrix(mRenderData);
 
-  /* animate and update inverse kinematics */
-  mRenderData.rdIKTime = 0.0f;
-  for (auto &instance : mGltfInstances) {
-    instance->updateAnimation();
+  /* clips are only read during the update, switch the sampling before */
+  mGltfModel->setUseBakedClips(mRenderData.rdUseBakedClips);
 
-    mIKTimer.start();
-    instance->solveIK();
-    mRenderData.rdIKTime += mIKTimer.stop();
+  /* animate and update inverse kinematics, instances are independent of each other */
+  mWorkerPool.setNumThreads(mRenderData.rdUseWorkerThreads ?
+    mRenderData.rdNumWorkerThreads : 1);
+
+  /* new threads get their blend scratch memory before they animate the first instance */
+  if (mScratchThreads != mWorkerPool.getNumThreads()) {
+    std::shared_ptr<GltfSkeleton> skeleton = mGltfModel->getSkeleton();
+    mWorkerPool.runOnEachThread([&]() { GltfPosePool::reserve(skeleton); });
+    mScratchThreads = mWorkerPool.getNumThreads();
   }
 
-  /* save value to avoid changes during later call */
-  int selectedInstance = mRenderData.rdCurrentSelectedInstance;
-  glm::vec2 modelWorldPos = mGltfInstances.at(selectedInstance)->getWorldPosition();
-  glm::quat modelWorldRot = mGltfInstances.at(selectedInstance)->getWorldRotation();
+  /* the CPU poses of the instances are outdated after the GPU posed them */
+  if (mLastUseGpuAnimation != mRenderData.rdUseGpuAnimation ||
+      mLastUseBakedCrowd != mRenderData.rdUseBakedCrowd) {
+    mAnimationLOD.init(mRenderData.rdNumberOfInstances);
+    mLastUseGpuAnimation = mRenderData.rdUseGpuAnimation;
+    mLastUseBakedCrowd = mRenderData.rdUseBakedCrowd;
+  }
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    const ModelSettings &settings = mGltfInstances.at(i)->getInstanceSettings();
+    mCrowdInstances.at(i) = mRenderData.rdUseBakedCrowd &&
+      GltfBakedAnimation::canPlay(settings);
+    mGpuAnimated.at(i) = !mCrowdInstances.at(i) && mRenderData.rdUseGpuAnimation &&
+      GpuAnimation::canAnimate(settings);
+  }
 
-  mLineMesh->vertices.clear();
-
-  /* get gltTF skeleton */
-  mSkeletonLineIndexCount = 0;
-  for (const auto &instance : mGltfInstances) {
-    ModelSettings settings = instance->getInstanceSettings();
-    if (settings.msDrawSkeleton) {
-      std::shared_ptr<OGLMesh> mesh = instance->getSkeleton();
-      mSkeletonLineIndexCount += mesh->vertices.size();
-      mLineMesh->vertices.insert(mLineMesh->vertices.begin(),
-        mesh->vertices.begin(), mesh->vertices.end());
+  /* crowd instances only need the playback time, the shaders interpolate every frame */
+  mWorkerPool.parallelFor(mGltfInstances.size(), [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      if (mCrowdInstances.at(i)) {
+        mGltfInstances.at(i)->updateAnimationTime(mRenderData.rdTickDiff);
+      }
     }
+  });
+
+  /* far instances skip frames, their joint data stays from the last update */
+  mAnimationLOD.setEnabled(mRenderData.rdUseAnimationLOD);
+  mAnimationLOD.setDistances(mRenderData.rdAnimLODDistance1, mRenderData.rdAnimLODDistance2,
+    mRenderData.rdAnimLODDistance3);
+  mAnimationLOD.setUpdateBudget(mRenderData.rdAnimUpdateBudget);
+  mAnimationLOD.setReduceCulledUpdates(mRenderData.rdUseFrustumCulling &&
+    mRenderData.rdReduceCulledUpdates);
+  mAnimationLOD.selectInstances(mGltfInstances, mInstanceVisible,
+    mRenderData.rdCameraWorldPosition, mRenderData.rdFieldOfView, mRenderData.rdTickDiff,
+    mRenderData.rdCurrentSelectedInstance);
+
+  for (int i = 0; i < AnimationLOD::NUM_LOD_LEVELS; ++i) {
+    mRenderData.rdAnimLODInstances.at(i) = mAnimationLOD.getInstanceCount(i);
+    mRenderData.rdAnimLODUpdates.at(i) = mAnimationLOD.getUpdateCount(i);
   }
 
-  /* get coordinate arrows for the IK target of current instance only */
-  mCoordArrowsLineIndexCount = 0;
-  {
-    ModelSettings ikSettings = mGltfInstances.at(selectedInstance)->getInstanceSettings();
-    if (ikSettings.msIkMode == ikMode::ccd ||
-        ikSettings.msIkMode == ikMode::fabrik) {
-      mCoordArrowsMesh = mCoordArrowsModel.getVertexData();
-      mCoordArrowsLineIndexCount += mCoordArrowsMesh.vertices.size();
-      std::for_each(mCoordArrowsMesh.vertices.begin(), mCoordArrowsMesh.vertices.end(),
-        [=](auto &n){
-          n.color /= 2.0f;
-          n.position = modelWorldRot * n.position;
-          n.position += ikSettings.msIkTargetWorldPos;
-      });
-
-      mLineMesh->vertices.insert(mLineMesh->vertices.end(),
-        mCoordArrowsMesh.vertices.begin(), mCoordArrowsMesh.vertices.end());
+  /* the mesh and the skeleton LOD share the distance levels, either one needs them */
+  mMeshLOD.setEnabled(mRenderData.rdUseMeshLOD || mRenderData.rdUseSkeletonLOD);
+  mMeshLOD.setDistances(mRenderData.rdMeshLODDistance1, mRenderData.rdMeshLODDistance2,
+    mRenderData.rdMeshLODDistance3);
+  mMeshLOD.selectLevels(mGltfInstances, mRenderData.rdCameraWorldPosition,
+    mRenderData.rdFieldOfView, mRenderData.rdCurrentSelectedInstance);
+
+  /* all instances advance by the same clock, skipped frames are added to the next update */
+  const std::vector<int> &animUpdateList = mAnimationLOD.getUpdateList();
+  mWorkerPool.parallelFor(animUpdateList.size(), [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      int index = animUpdateList.at(i);
+      if (mCrowdInstances.at(index)) {
+        continue;
+      }
+      if (mGpuAnimated.at(index)) {
+        mGltfInstances.at(index)->updateAnimationTime(mAnimationLOD.getDeltaTime(index));
+      } else {
+        mGltfInstances.at(index)->setSkeletonLODLevel(mRenderData.rdUseSkeletonLOD ?
+          mMeshLOD.getLevel(index) : 0);
+        mGltfInstances.at(index)->updateAnimation(mAnimationLOD.getDeltaTime(index));
+      }
+    }
+  });
+
+  std::fill(mRenderData.rdSkeletonLODUpdates.begin(), mRenderData.rdSkeletonLODUpdates.end(), 0);
+  for (const auto index : animUpdateList) {
+    if (!mCrowdInstances.at(index) && !mGpuAnimated.at(index)) {
+      ++mRenderData.rdSkeletonLODUpdates.at(mGltfInstances.at(index)->getSkeletonLODLevel());
     }
   }
 
-  /* draw coordiante arrows*/
-  mCoordArrowsMesh = mCoordArrowsModel.getVertexData();
-  mCoordArrowsLineIndexCount += mCoordArrowsMesh.vertices.size();
-  std::for_each(mCoordArrowsMesh.vertices.begin(), mCoordArrowsMesh.vertices.end(),
-    [=](auto &n){
-      n.color /= 2.0f;
-      n.position = modelWorldRot * n.position;
-      n.position += glm::vec3(modelWorldPos.x, 0.0f, modelWorldPos.y);
+  mIKTimer.start();
+  mWorkerPool.parallelFor(animUpdateList.size(), [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      mGltfInstances.at(animUpdateList.at(i))->solveIK();
+    }
   });
+  mRenderData.rdIKTime = mIKTimer.stop();
 
-  mLineMesh->vertices.insert(mLineMesh->vertices.end(),
-    mCoordArrowsMesh.vertices.begin(), mCoordArrowsMesh.vertices.end());
+  /* save value to avoid changes during later call */
+  int selectedInstance = mRenderData.rdCurrentSelectedInstance;
+  glm::vec2 modelWorldPos = mGltfInstances.at(selectedInstance)->getWorldPosition();
+  glm::quat modelWorldRot = mGltfInstances.at(selectedInstance)->getWorldRotation();
 
   mRenderData.rdMatrixGenerateTime = mMatrixGenerateTimer.stop();
 
+  /* CPU posed instances are tested with the bounds of their current pose, the baked and
+   * GPU posed instances with the bounds of all baked frames around their world position */
+  mCullingTimer.start();
+  mFrustum.update(mProjectionMatrix, mViewMatrix);
+  glm::vec4 bakedBounds = mBakedAnimation.getBoundingSphere();
+  bakedBounds.w += mGltfModel->getBoundsPadding();
+
+  int culledInstances = 0;
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    bool visible = true;
+    if (mRenderData.rdUseFrustumCulling || mRenderData.rdDrawBoundingSpheres) {
+      glm::vec4 &bounds = mInstanceBounds.at(i);
+      if (mCrowdInstances.at(i) || mGpuAnimated.at(i)) {
+        glm::vec2 worldPos = mGltfInstances.at(i)->getWorldPosition();
+        glm::vec3 center = mGltfInstances.at(i)->getWorldRotation() * glm::vec3(bakedBounds) +
+          glm::vec3(worldPos.x, 0.0f, worldPos.y);
+        bounds = glm::vec4(center, bakedBounds.w);
+      } else {
+        bounds = mGltfInstances.at(i)->getBoundingSphere();
+      }
+      visible = !mRenderData.rdUseFrustumCulling || mFrustum.isSphereVisible(bounds);
+    }
+    mInstanceVisible.at(i) = visible;
+    if (!visible) {
+      ++culledInstances;
+    }
+  }
+  mRenderData.rdVisibleInstances = mGltfInstances.size() - culledInstances;
+  mRenderData.rdCulledInstances = culledInstances;
+  mRenderData.rdCullingTime = mCullingTimer.stop();
+
   mUploadToUBOTimer.start();
-  std::vector<glm::mat4> matrixData;
-  matrixData.push_back(mViewMatrix);
-  matrixData.push_back(mProjectionMatrix);
-  mUniformBuffer.uploadUboData(matrixData, 0);
+  mMatrixData.clear();
+  mMatrixData.push_back(mViewMatrix);
+  mMatrixData.push_back(mProjectionMatrix);
+  mUniformBuffer.uploadUboData(mMatrixData, 0);
+
+  /* far instances are drawn with the simplified meshes */
+  for (auto &groupInstances : mLODInstances) {
+    std::fill(std::begin(groupInstances), std::end(groupInstances), 0);
+  }
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    const ModelSettings &settings = mGltfInstances.at(i)->getInstanceSettings();
+    if (!settings.msDrawModel || !mInstanceVisible.at(i)) {
+      mInstanceDrawGroups.at(i) = -1;
+      continue;
+    }
 
-  mModelJointMatrices.clear();
-  mModelJointDualQuats.clear();
+    bool dualQuat = settings.msVertexSkinningMode == skinningMode::dualQuat;
+    if (mCrowdInstances.at(i)) {
+      mInstanceDrawGroups.at(i) = dualQuat ? CROWD_DUAL_QUAT_GROUP : CROWD_MATRIX_GROUP;
+    } else {
+      mInstanceDrawGroups.at(i) = dualQuat ? DUAL_QUAT_GROUP : MATRIX_GROUP;
+    }
+    int meshLevel = mRenderData.rdUseMeshLOD ? mMeshLOD.getLevel(i) : 0;
+    ++mLODInstances[mInstanceDrawGroups.at(i)][meshLevel];
+  }
 
-  unsigned int matrixInstances = 0;
-  unsigned int dualQuatInstances = 0;
+  /* the levels of a group follow each other, nearest level first */
+  unsigned int groupInstances[NUM_DRAW_GROUPS] = {};
+  unsigned int nextInstances[NUM_DRAW_GROUPS][MeshLOD::NUM_LOD_LEVELS] = {};
   unsigned int numTriangles = 0;
+  std::fill(mRenderData.rdMeshLODInstances.begin(), mRenderData.rdMeshLODInstances.end(), 0);
+  std::fill(mRenderData.rdMeshLODTriangles.begin(), mRenderData.rdMeshLODTriangles.end(), 0);
+  for (int group = 0; group < NUM_DRAW_GROUPS; ++group) {
+    for (int level = 0; level < MeshLOD::NUM_LOD_LEVELS; ++level) {
+      unsigned int levelInstances = mLODInstances[group][level];
+      mLODFirstInstances[group][level] = groupInstances[group];
+      nextInstances[group][level] = groupInstances[group];
+      groupInstances[group] += levelInstances;
+
+      unsigned int levelTriangles = levelInstances * mGltfModel->getLODTriangleCount(level);
+      mRenderData.rdMeshLODInstances.at(level) += levelInstances;
+      mRenderData.rdMeshLODTriangles.at(level) += levelTriangles;
+      numTriangles += levelTriangles;
+    }
+  }
 
-  for (const auto &instance : mGltfInstances) {
-    ModelSettings settings = instance->getInstanceSettings();
-    if (!settings.msDrawModel) {
+  unsigned int matrixInstances = groupInstances[MATRIX_GROUP];
+  unsigned int dualQuatInstances = groupInstances[DUAL_QUAT_GROUP];
+  unsigned int crowdMatrixInstances = groupInstances[CROWD_MATRIX_GROUP];
+  unsigned int crowdDualQuatInstances = groupInstances[CROWD_DUAL_QUAT_GROUP];
+
+  OGLCrowdInstance *crowdMatrixData =
+    static_cast<OGLCrowdInstance*>(mCrowdMatrixInstanceBuffer.getMappedSlice());
+  OGLCrowdInstance *crowdDualQuatData =
+    static_cast<OGLCrowdInstance*>(mCrowdDualQuatInstanceBuffer.getMappedSlice());
+
+  /* instances of the same group are packed in draw order, sorted by their mesh LOD level */
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    int group = mInstanceDrawGroups.at(i);
+    if (group < 0) {
+      mInstanceJointSlots.at(i) = -1;
       continue;
     }
 
-    if (settings.msVertexSkinningMode == skinningMode::dualQuat) {
-      std::vector<glm::mat2x4> quats = instance->getJointDualQuats();
-      mModelJointDualQuats.insert(mModelJointDualQuats.end(),
-        quats.begin(), quats.end());
-      ++dualQuatInstances;
+    int meshLevel = mRenderData.rdUseMeshLOD ? mMeshLOD.getLevel(i) : 0;
+    unsigned int slot = nextInstances[group][meshLevel]++;
+    if (group == CROWD_MATRIX_GROUP || group == CROWD_DUAL_QUAT_GROUP) {
+      /* crowd instances upload a few bytes instead of their joint data */
+      const ModelSettings &settings = mGltfInstances.at(i)->getInstanceSettings();
+      OGLCrowdInstance &crowdData = group == CROWD_DUAL_QUAT_GROUP ?
+        crowdDualQuatData[slot] : crowdMatrixData[slot];
+      glm::vec2 worldPos = mGltfInstances.at(i)->getWorldPosition();
+      glm::quat worldRot = mGltfInstances.at(i)->getWorldRotation();
+      crowdData.worldRotation = glm::vec4(worldRot.x, worldRot.y, worldRot.z, worldRot.w);
+      crowdData.worldPosition = glm::vec3(worldPos.x, 0.0f, worldPos.y);
+      crowdData.clip = settings.msAnimClip;
+      crowdData.time = settings.msAnimTimePosition;
+      mInstanceJointSlots.at(i) = -1;
     } else {
-      std::vector<glm::mat4> mats = instance->getJointMatrices();
-      mModelJointMatrices.insert(mModelJointMatrices.end(),
-        mats.begin(), mats.end());
-      ++matrixInstances;
+      mInstanceJointSlots.at(i) = slot;
     }
-    numTriangles += mGltfModel->getTriangleCount();
   }
 
   mRenderData.rdTriangleCount = numTriangles;
+  mRenderData.rdCrowdInstances = crowdMatrixInstances + crowdDualQuatInstances;
+
+  /* skeletons are posed from the joint data, instances showing only the skeleton
+   * get a slot behind the drawn instances */
+  unsigned int matrixSlots = matrixInstances;
+  unsigned int dualQuatSlots = dualQuatInstances;
+  unsigned int skeletonMatrixInstances = 0;
+  unsigned int skeletonDualQuatInstances = 0;
+
+  int *skeletonMatrixSlots = static_cast<int*>(mSkeletonMatrixInstanceBuffer.getMappedSlice());
+  int *skeletonDualQuatSlots =
+    static_cast<int*>(mSkeletonDualQuatInstanceBuffer.getMappedSlice());
+
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    const ModelSettings &settings = mGltfInstances.at(i)->getInstanceSettings();
+    if (!settings.msDrawSkeleton || !mInstanceVisible.at(i)) {
+      continue;
+    }
 
-  mGltfShaderStorageBuffer.uploadSsboData(mModelJointMatrices, 1);
-  mGltfDualQuatSSBuffer.uploadSsboData(mModelJointDualQuats, 2);
+    bool dualQuat = settings.msVertexSkinningMode == skinningMode::dualQuat;
+    if (!settings.msDrawModel) {
+      mInstanceJointSlots.at(i) = dualQuat ? dualQuatSlots++ : matrixSlots++;
+    }
+    if (dualQuat) {
+      skeletonDualQuatSlots[skeletonDualQuatInstances++] = mInstanceJointSlots.at(i);
+    } else {
+      skeletonMatrixSlots[skeletonMatrixInstances++] = mInstanceJointSlots.at(i);
+    }
+  }
+
+  /* instances write directly into the mapped slices of this frame */
+  int jointMatrixSize = mGltfInstances.at(0)->getJointMatrixSize();
+  int jointDualQuatSize = mGltfInstances.at(0)->getJointDualQuatsSize();
+  glm::mat4 *jointMatrices = static_cast<glm::mat4*>(mGltfShaderStorageBuffer.getMappedSlice());
+  glm::mat2x4 *jointDualQuats = static_cast<glm::mat2x4*>(mGltfDualQuatSSBuffer.getMappedSlice());
+
+  mWorkerPool.parallelFor(mGltfInstances.size(), [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      int slot = mInstanceJointSlots.at(i);
+      if (slot < 0 || mGpuAnimated.at(i)) {
+        continue;
+      }
+      if (mGltfInstances.at(i)->getInstanceSettings().msVertexSkinningMode ==
+          skinningMode::dualQuat) {
+        mGltfInstances.at(i)->copyJointDualQuats(jointDualQuats + slot * jointDualQuatSize);
+      } else {
+        mGltfInstances.at(i)->copyJointMatrices(jointMatrices + slot * jointMatrixSize);
+      }
+    }
+  });
+
+  mGltfShaderStorageBuffer.bindSlice(1, matrixSlots * jointMatrixSize * sizeof(glm::mat4));
+  mGltfDualQuatSSBuffer.bindSlice(2, dualQuatSlots * jointDualQuatSize * sizeof(glm::mat2x4));
+
+  /* the compute shaders fill the remaining slots of the bound joint buffers */
+  mGpuAnimationTimer.start();
+  mRenderData.rdGpuAnimatedInstances = mGpuAnimation.dispatch(mGltfInstances, mGpuAnimated,
+    mInstanceJointSlots);
+  mRenderData.rdGpuAnimationTime = mGpuAnimationTimer.stop();
 
   mRenderData.rdUploadToUBOTime = mUploadToUBOTimer.stop();
 
-  /* upload vertex data */
+  /* estimate only, assumes the culled instances would have cost the same as the drawn ones */
+  unsigned int drawnInstances = matrixInstances + dualQuatInstances + crowdMatrixInstances +
+    crowdDualQuatInstances;
+  mRenderData.rdCullingTimeSavedEstimate = drawnInstances > 0 ?
+    mRenderData.rdUploadToUBOTime / drawnInstances * culledInstances : 0.0f;
+
+  /* the debug lines are written directly into the mapped region of this frame */
   mUploadToVBOTimer.start();
+  mDebugDraw.beginFrame();
+
+  /* coordinate arrows for the IK target of current instance only */
+  const ModelSettings &ikSettings = mGltfInstances.at(selectedInstance)->getInstanceSettings();
+  if (ikSettings.msIkMode == ikMode::ccd || ikSettings.msIkMode == ikMode::fabrik) {
+    mDebugDraw.addLines(mCoordArrowsModel.getVertexData(), modelWorldRot,
+      ikSettings.msIkTargetWorldPos, 0.5f);
+  }
+
+  mDebugDraw.addLines(mCoordArrowsModel.getVertexData(), modelWorldRot,
+    glm::vec3(modelWorldPos.x, 0.0f, modelWorldPos.y), 0.5f);
 
-  uploadData(*mLineMesh);
+  if (mRenderData.rdDrawBoundingSpheres) {
+    for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+      if (mInstanceVisible.at(i)) {
+        mDebugDraw.addSphere(mInstanceBounds.at(i), glm::vec3(0.0f, 0.5f, 0.0f));
+      }
+    }
+  }
+  mRenderData.rdDebugLineVertices = mDebugDraw.getVertexCount();
 
   mRenderData.rdUploadToVBOTime = mUploadToVBOTimer.stop();
 
   /* draw the glTF models */
   mGltfGPUShader.use();
   /* set SSBO stride, identical for ALL models */
-  mGltfGPUShader.setUniformValue(mGltfInstances.at(0)->getJointMatrixSize());
-  mGltfModel->drawInstanced(matrixInstances);
+  mGltfGPUShader.setUniformValue(jointMatrixSize);
+  drawModelLODs(MATRIX_GROUP);
 
   mGltfGPUDualQuatShader.use();
-  mGltfGPUDualQuatShader.setUniformValue(mGltfInstances.at(0)->getJointDualQuatsSize());
-  mGltfModel->drawInstanced(dualQuatInstances);
-
-  /* draw the coordinate arrow WITH depth buffer */
-  if (mCoordArrowsLineIndexCount > 0) {
-    mLineShader.use();
-    mVertexBuffer.bindAndDraw(GL_LINES, mSkeletonLineIndexCount, mCoordArrowsLineIndexCount);
+  mGltfGPUDualQuatShader.setUniformValue(jointDualQuatSize);
+  drawModelLODs(DUAL_QUAT_GROUP);
+
+  /* crowd instances fetch the baked joint data of their clip */
+  mBakedJointMatrixBuffer.bind(10);
+  mBakedJointDualQuatBuffer.bind(11);
+  mBakedClipBuffer.bind(12);
+  if (crowdMatrixInstances > 0) {
+    mCrowdMatrixInstanceBuffer.bindSlice(9, crowdMatrixInstances * sizeof(OGLCrowdInstance));
+    mGltfCrowdShader.use();
+    mGltfCrowdShader.setUniformValue(mBakedAnimation.getJointCount());
+    drawModelLODs(CROWD_MATRIX_GROUP);
   }
+  if (crowdDualQuatInstances > 0) {
+    mCrowdDualQuatInstanceBuffer.bindSlice(9,
+      crowdDualQuatInstances * sizeof(OGLCrowdInstance));
+    mGltfCrowdDualQuatShader.use();
+    mGltfCrowdDualQuatShader.setUniformValue(mBakedAnimation.getJointCount());
+    drawModelLODs(CROWD_DUAL_QUAT_GROUP);
+  }
+
+  /* draw the debug lines WITH depth buffer */
+  mLineShader.use();
+  mDebugDraw.draw();
 
-  /* draw the skeleton, disable depth test to overlay */
-  if (mSkeletonLineIndexCount > 0) {
+  /* draw the skeletons, one instance per skeleton, disable depth test to overlay */
+  if (skeletonMatrixInstances > 0 || skeletonDualQuatInstances > 0) {
     glDisable(GL_DEPTH_TEST);
-    mLineShader.use();
-    mVertexBuffer.bindAndDraw(GL_LINES, 0, mSkeletonLineIndexCount);
+    glBindVertexArray(mSkeletonVAO);
+    mSkeletonBoneBuffer.bind(13);
+    if (skeletonMatrixInstances > 0) {
+      mSkeletonMatrixInstanceBuffer.bindSlice(14, skeletonMatrixInstances * sizeof(int));
+      mSkeletonShader.use();
+      mSkeletonShader.setUniformValue(jointMatrixSize);
+      glDrawArraysInstanced(GL_LINES, 0, mSkeletonVertexCount, skeletonMatrixInstances);
+    }
+    if (skeletonDualQuatInstances > 0) {
+      mSkeletonDualQuatInstanceBuffer.bindSlice(14, skeletonDualQuatInstances * sizeof(int));
+      mSkeletonDualQuatShader.use();
+      mSkeletonDualQuatShader.setUniformValue(jointDualQuatSize);
+      glDrawArraysInstanced(GL_LINES, 0, mSkeletonVertexCount, skeletonDualQuatInstances);
+    }
+    glBindVertexArray(0);
     glEnable(GL_DEPTH_TEST);
   }
 
+  /* the joint data slices of this frame are in use until the draws are done */
+  mGltfShaderStorageBuffer.fenceSlice();
+  mGltfDualQuatSSBuffer.fenceSlice();
+  mCrowdMatrixInstanceBuffer.fenceSlice();
+  mCrowdDualQuatInstanceBuffer.fenceSlice();
+  mSkeletonMatrixInstanceBuffer.fenceSlice();
+  mSkeletonDualQuatInstanceBuffer.fenceSlice();
+
   mFramebuffer.unbind();
 
   /* blit color buffer to screen */
@@ -432,9 +813,11 @@ void OGLRenderer::draw() {
 
   mUIGenerateTimer.start();
 
-  ModelSettings settings = mGltfInstances.at(selectedInstance)->getInstanceSettings();
-  mUserInterface.createFrame(mRenderData, settings);
-  mGltfInstances.at(selectedInstance)->setInstanceSettings(settings);
+  /* plain values only, the UI edits a copy and the names come from the model */
+  mSelectedSettings = mGltfInstances.at(selectedInstance)->getInstanceSettings();
+  mUserInterface.createFrame(mRenderData, mSelectedSettings, mGltfModel->getClipNames(),
+    mGltfModel->getSkeletonNodeNames());
+  mGltfInstances.at(selectedInstance)->setInstanceSettings(mSelectedSettings);
   mGltfInstances.at(selectedInstance)->checkForUpdates();
 
   mRenderData.rdUIGenerateTime = mUIGenerateTimer.stop();
@@ -446,17 +829,40 @@ void OGLRenderer::draw() {
   mLastTickTime = tickTime;
 }
 
+void OGLRenderer::drawModelLODs(int drawGroup) {
+  for (int level = 0; level < MeshLOD::NUM_LOD_LEVELS; ++level) {
+    mGltfModel->drawInstanced(mLODInstances[drawGroup][level], level,
+      mLODFirstInstances[drawGroup][level]);
+  }
+}
+
 void OGLRenderer::cleanup() {
+  mWorkerPool.cleanup();
+  mGpuAnimation.cleanup();
+
   mGltfModel->cleanup();
   mGltfModel.reset();
 
   mGltfGPUDualQuatShader.cleanup();
   mGltfGPUShader.cleanup();
+  mGltfCrowdDualQuatShader.cleanup();
+  mGltfCrowdShader.cleanup();
   mUserInterface.cleanup();
   mLineShader.cleanup();
-  mVertexBuffer.cleanup();
+  mSkeletonShader.cleanup();
+  mSkeletonDualQuatShader.cleanup();
+  mDebugDraw.cleanup();
   mGltfShaderStorageBuffer.cleanup();
   mGltfDualQuatSSBuffer.cleanup();
+  mBakedJointMatrixBuffer.cleanup();
+  mBakedJointDualQuatBuffer.cleanup();
+  mBakedClipBuffer.cleanup();
+  mCrowdMatrixInstanceBuffer.cleanup();
+  mCrowdDualQuatInstanceBuffer.cleanup();
+  mSkeletonBoneBuffer.cleanup();
+  mSkeletonMatrixInstanceBuffer.cleanup();
+  mSkeletonDualQuatInstanceBuffer.cleanup();
+  glDeleteVertexArrays(1, &mSkeletonVAO);
   mUniformBuffer.cleanup();
   mFramebuffer.cleanup();
 }
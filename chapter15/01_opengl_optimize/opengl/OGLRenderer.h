@@ -8,17 +8,24 @@
 #include <GLFW/glfw3.h>
 
 #include "Timer.h"
+#include "AllocationTracker.h"
+#include "WorkerPool.h"
 #include "Framebuffer.h"
-#include "VertexBuffer.h"
+#include "DebugDraw.h"
 #include "Texture.h"
 #include "Shader.h"
 #include "UniformBuffer.h"
 #include "ShaderStorageBuffer.h"
+#include "GpuAnimation.h"
 #include "UserInterface.h"
 #include "Camera.h"
+#include "Frustum.h"
 #include "CoordArrowsModel.h"
 #include "GltfModel.h"
 #include "GltfInstance.h"
+#include "GltfBakedAnimation.h"
+#include "AnimationLOD.h"
+#include "MeshLOD.h"
 
 #include "OGLRenderData.h"
 
@@ -28,7 +35,6 @@ class OGLRenderer {
 
     bool init(unsigned int width, unsigned int height);
     void setSize(unsigned int width, unsigned int height);
-    void uploadData(OGLMesh vertexData);
     void draw();
     void handleKeyEvents(int key, int scancode, int action, int mods);
     void handleMouseButtonEvents(int button, int action, int mods);
@@ -42,6 +48,8 @@ class OGLRenderer {
     Timer mFrameTimer{};
     Timer mMatrixGenerateTimer{};
     Timer mIKTimer{};
+    Timer mCullingTimer{};
+    Timer mGpuAnimationTimer{};
     Timer mUploadToVBOTimer{};
     Timer mUploadToUBOTimer{};
     Timer mUIGenerateTimer{};
@@ -50,27 +58,61 @@ class OGLRenderer {
     Shader mLineShader{};
     Shader mGltfGPUShader{};
     Shader mGltfGPUDualQuatShader{};
+    Shader mGltfCrowdShader{};
+    Shader mGltfCrowdDualQuatShader{};
+    Shader mSkeletonShader{};
+    Shader mSkeletonDualQuatShader{};
 
     Framebuffer mFramebuffer{};
-    VertexBuffer mVertexBuffer{};
+    DebugDraw mDebugDraw{};
     UniformBuffer mUniformBuffer{};
     ShaderStorageBuffer mGltfShaderStorageBuffer{};
     ShaderStorageBuffer mGltfDualQuatSSBuffer{};
+    ShaderStorageBuffer mBakedJointMatrixBuffer{};
+    ShaderStorageBuffer mBakedJointDualQuatBuffer{};
+    ShaderStorageBuffer mBakedClipBuffer{};
+    ShaderStorageBuffer mCrowdMatrixInstanceBuffer{};
+    ShaderStorageBuffer mCrowdDualQuatInstanceBuffer{};
+    ShaderStorageBuffer mSkeletonBoneBuffer{};
+    ShaderStorageBuffer mSkeletonMatrixInstanceBuffer{};
+    ShaderStorageBuffer mSkeletonDualQuatInstanceBuffer{};
     UserInterface mUserInterface{};
     Camera mCamera{};
+    Frustum mFrustum{};
+    WorkerPool mWorkerPool{};
+    AnimationLOD mAnimationLOD{};
+    MeshLOD mMeshLOD{};
+    GpuAnimation mGpuAnimation{};
+    GltfBakedAnimation mBakedAnimation{};
 
     std::shared_ptr<GltfModel> mGltfModel = nullptr;
 
     std::vector<std::shared_ptr<GltfInstance>> mGltfInstances{};
 
-    std::vector<glm::mat4> mModelJointMatrices{};
-    std::vector<glm::mat2x4> mModelJointDualQuats{};
+    /* position of the instance joint data in the SSBO of its skinning mode, -1 if not drawn */
+    std::vector<int> mInstanceJointSlots{};
+    /* matrix, dual quaternion and the two crowd groups, -1 if the model is not drawn */
+    std::vector<int> mInstanceDrawGroups{};
+    /* every group is drawn with one instanced draw per mesh LOD level, the instances
+     * of a level are packed behind each other */
+    static constexpr int NUM_DRAW_GROUPS = 4;
+    unsigned int mLODInstances[NUM_DRAW_GROUPS][MeshLOD::NUM_LOD_LEVELS] = {};
+    unsigned int mLODFirstInstances[NUM_DRAW_GROUPS][MeshLOD::NUM_LOD_LEVELS] = {};
+    /* frustum test result of the last frame, the animation LOD of the next frame uses it */
+    std::vector<bool> mInstanceVisible{};
+    /* bounding spheres used by the culling, only filled if needed */
+    std::vector<glm::vec4> mInstanceBounds{};
+    /* instances posed by the compute shaders in the current frame */
+    std::vector<bool> mGpuAnimated{};
+    bool mLastUseGpuAnimation = false;
+    /* instances drawn from the baked joint data in the current frame */
+    std::vector<bool> mCrowdInstances{};
+    bool mLastUseBakedCrowd = false;
 
     CoordArrowsModel mCoordArrowsModel{};
-    OGLMesh mCoordArrowsMesh{};
-    std::shared_ptr<OGLMesh> mLineMesh = nullptr;
-    unsigned int mSkeletonLineIndexCount = 0;
-    unsigned int mCoordArrowsLineIndexCount = 0;
+    /* bone lines of the model, drawn instanced for all instances showing their skeleton */
+    GLuint mSkeletonVAO = 0;
+    unsigned int mSkeletonVertexCount = 0;
 
     bool mMouseLock = false;
     int mMouseXPos = 0;
@@ -79,9 +121,16 @@ class OGLRenderer {
     double mLastTickTime = 0.0;
 
     void handleMovementKeys();
+    void drawModelLODs(int drawGroup);
 
     /* create identity matrix by default */
     glm::mat4 mViewMatrix = glm::mat4(1.0f);
     glm::mat4 mProjectionMatrix = glm::mat4(1.0f);
+    std::vector<glm::mat4> mMatrixData{};
+
+    /* copy of the selected instance settings for the UI, reused every frame */
+    ModelSettings mSelectedSettings{};
+    /* worker threads with reserved scratch poses */
+    unsigned int mScratchThreads = 0;
 
 };
@@ -20,6 +20,17 @@ bool Shader::loadShaders(std::string vertexShaderFileName, std::string fragmentS
   return true;
 }
 
+bool Shader::loadComputeShader(std::string computeShaderFileName) {
+  Logger::log(1, "%s: loading compute shader '%s'\n", __FUNCTION__, computeShaderFileName.c_str());
+
+  if (!createComputeShaderProgram(computeShaderFileName)) {
+    Logger::log(1, "%s error: compute shader program creation failed\n", __FUNCTION__);
+    return false;
+  }
+
+  return true;
+}
+
 void Shader::use() {
   glUseProgram(mShaderProgram);
 }
@@ -105,6 +116,30 @@ bool Shader::createShaderProgram(std::string vertexShaderFileName, std::string f
   return true;
 }
 
+bool Shader::createComputeShaderProgram(std::string computeShaderFileName) {
+  GLuint computeShader = loadShader(computeShaderFileName, GL_COMPUTE_SHADER);
+  if (!computeShader) {
+    Logger::log(1, "%s: loading of compute shader '%s' failed\n", __FUNCTION__, computeShaderFileName.c_str());
+    return false;
+  }
+
+  mShaderProgram = glCreateProgram();
+  glAttachShader(mShaderProgram, computeShader);
+  glLinkProgram(mShaderProgram);
+
+  if (!checkLinkStats(computeShaderFileName, std::string(), mShaderProgram)) {
+    Logger::log(1, "%s error: program linking from compute shader '%s' failed\n", __FUNCTION__, computeShaderFileName.c_str());
+    glDeleteShader(computeShader);
+    return false;
+  }
+
+  /* it is safe to delete the original shader here */
+  glDeleteShader(computeShader);
+
+  Logger::log(1, "%s: shader program %#x successfully compiled from compute shader '%s'\n", __FUNCTION__, mShaderProgram, computeShaderFileName.c_str());
+  return true;
+}
+
 bool Shader::checkCompileStats(std::string shaderFileName, GLuint shader) {
   GLint isShaderCompiled;
   int logMessageLength;
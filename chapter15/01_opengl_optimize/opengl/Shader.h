@@ -6,6 +6,7 @@
 class Shader {
   public:
     bool loadShaders(std::string vertexShaderFileName, std::string fragmentShaderFileName);
+    bool loadComputeShader(std::string computeShaderFileName);
     void use();
     bool getUniformLocation(std::string uniformName);
     void setUniformValue(int value);
@@ -16,6 +17,7 @@ class Shader {
     GLint mUniformLocation = -1;
 
     bool createShaderProgram(std::string vertexShaderFileName, std::string fragmentShaderFileName);
+    bool createComputeShaderProgram(std::string computeShaderFileName);
     GLuint loadShader(std::string shaderFileName, GLuint shaderType);
     std::string loadFileToString(std::string filename);
     bool checkCompileStats(std::string shaderFileName, GLuint shader);
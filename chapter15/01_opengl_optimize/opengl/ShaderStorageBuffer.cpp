@@ -11,30 +11,100 @@ void ShaderStorageBuffer::init(size_t bufferSize) {
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
 
-void ShaderStorageBuffer::uploadSsboData(std::vector<glm::mat4> bufferData, int bindingPoint) {
-  if (bufferData.size() == 0) {
+void ShaderStorageBuffer::uploadData(const void *data, size_t dataSize, int bindingPoint) {
+  if (dataSize == 0 || dataSize > mBufferSize) {
+    Logger::log(1, "%s error: invalid data size %i for buffer size %i\n", __FUNCTION__,
+      dataSize, mBufferSize);
     return;
   }
-  size_t bufferSize = bufferData.size() * sizeof(glm::mat4);
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, mShaderStorageBuffer);
-  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bufferSize, bufferData.data());
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, dataSize, data);
   glBindBufferRange(GL_SHADER_STORAGE_BUFFER, bindingPoint, mShaderStorageBuffer, 0,
-    bufferSize);
+    dataSize);
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
 
-void ShaderStorageBuffer::uploadSsboData(std::vector<glm::mat2x4> bufferData, int bindingPoint) {
-  if (bufferData.size() == 0) {
-    return;
-  }
-  size_t bufferSize = bufferData.size() * sizeof(glm::mat2x4);
+void ShaderStorageBuffer::bind(int bindingPoint) {
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, mShaderStorageBuffer);
+}
+
+bool ShaderStorageBuffer::initPersistent(size_t sliceSize, int numSlices) {
+  /* slice offsets must respect the binding alignment */
+  GLint offsetAlignment = 1;
+  glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+  mSliceSize = (sliceSize + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+  mBufferSize = mSliceSize * numSlices;
+  mCurrentSlice = 0;
+  mSliceFences.resize(numSlices, nullptr);
+
+  GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  glGenBuffers(1, &mShaderStorageBuffer);
+
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, mShaderStorageBuffer);
-  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bufferSize, bufferData.data());
-  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, bindingPoint, mShaderStorageBuffer, 0,
-    bufferSize);
+  glBufferStorage(GL_SHADER_STORAGE_BUFFER, mBufferSize, NULL, flags);
+  mMappedData = static_cast<char*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, mBufferSize,
+    flags));
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  if (!mMappedData) {
+    Logger::log(1, "%s error: could not map shader storage buffer (size %i bytes)\n",
+      __FUNCTION__, mBufferSize);
+    return false;
+  }
+  return true;
+}
+
+void *ShaderStorageBuffer::getMappedSlice() {
+  GLsync &fence = mSliceFences.at(mCurrentSlice);
+  if (fence) {
+    /* flush on the first try only, the commands are on their way afterwards */
+    GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+      GLenum result = glClientWaitSync(fence, waitFlags, 1000000);
+      if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+        break;
+      }
+      if (result == GL_WAIT_FAILED) {
+        Logger::log(1, "%s error: waiting for slice %i failed\n", __FUNCTION__, mCurrentSlice);
+        break;
+      }
+      waitFlags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+
+  return mMappedData + mCurrentSlice * mSliceSize;
+}
+
+void ShaderStorageBuffer::bindSlice(int bindingPoint, size_t dataSize) {
+  if (dataSize == 0) {
+    return;
+  }
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, bindingPoint, mShaderStorageBuffer,
+    mCurrentSlice * mSliceSize, dataSize);
+}
+
+void ShaderStorageBuffer::fenceSlice() {
+  mSliceFences.at(mCurrentSlice) = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  mCurrentSlice = (mCurrentSlice + 1) % mSliceFences.size();
 }
 
 void ShaderStorageBuffer::cleanup() {
+  for (auto &fence : mSliceFences) {
+    if (fence) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  if (mMappedData) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, mShaderStorageBuffer);
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    mMappedData = nullptr;
+  }
+
   glDeleteBuffers(1, &mShaderStorageBuffer);
 }
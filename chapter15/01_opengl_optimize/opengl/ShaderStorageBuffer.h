@@ -1,17 +1,34 @@
 /* OpenGL shader stroage buffer */
 #pragma once
+#include <cstddef>
 #include <vector>
-#include <glm/glm.hpp>
 #include <glad/glad.h>
 
 class ShaderStorageBuffer {
   public:
     void init(size_t bufferSize);
-    void uploadSsboData(std::vector<glm::mat4> bufferData, int bindingPoint);
-    void uploadSsboData(std::vector<glm::mat2x4> bufferData, int bindingPoint);
+
+    /* for data uploaded once, the buffer stays bound to the binding point */
+    void uploadData(const void *data, size_t dataSize, int bindingPoint);
+    /* binds the whole buffer, e.g. for buffers only written by shaders */
+    void bind(int bindingPoint);
+
+    /* persistently mapped buffer, one slice per frame in flight, guarded by fences */
+    bool initPersistent(size_t sliceSize, int numSlices);
+    /* waits until the GPU has finished reading the current slice */
+    void *getMappedSlice();
+    void bindSlice(int bindingPoint, size_t dataSize);
+    /* call after the last draw call using the slice, switches to the next slice */
+    void fenceSlice();
+
     void cleanup();
 
   private:
     size_t mBufferSize;
     GLuint mShaderStorageBuffer = 0;
+
+    char *mMappedData = nullptr;
+    size_t mSliceSize = 0;
+    int mCurrentSlice = 0;
+    std::vector<GLsync> mSliceFences{};
 };
@@ -11,7 +11,8 @@ void UniformBuffer::init(size_t bufferSize) {
   glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
-void UniformBuffer::uploadUboData(std::vector<glm::mat4> bufferData, int bindingPoint) {
+void UniformBuffer::uploadUboData(const std::vector<glm::mat4> &bufferData,
+    int bindingPoint) {
   if (bufferData.size() == 0) {
     return;
   }
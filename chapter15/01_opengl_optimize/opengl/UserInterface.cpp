@@ -1,4 +1,5 @@
 #include <string>
+#include <cstdio>
 
 #include <glm/glm.hpp>
 #include <glm/gtx/string_cast.hpp>
@@ -32,7 +33,8 @@ void UserInterface::init(OGLRenderData &renderData) {
   mUiDrawValues.resize(mNumUiDrawValues);
 }
 
-void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settings) {
+void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settings,
+    const std::vector<std::string> &clipNames, const std::vector<std::string> &nodeNames) {
   ImGui_ImplOpenGL3_NewFrame();
   ImGui_ImplGlfw_NewFrame();
   ImGui::NewFrame();
@@ -104,7 +106,7 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
   ImGui::BeginGroup();
   ImGui::Text("FPS:");
   ImGui::SameLine();
-  ImGui::Text("%s", std::to_string(mFramesPerSecond).c_str());
+  ImGui::Text("%f", mFramesPerSecond);
   ImGui::EndGroup();
 
   if (ImGui::IsItemHovered()) {
@@ -114,28 +116,41 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
       averageFPS += value;
     }
     averageFPS /= static_cast<float>(mNumFPSValues);
-    std::string fpsOverlay = "now:     " + std::to_string(mFramesPerSecond) + "\n30s avg: " + std::to_string(averageFPS);
+    char fpsOverlay[64];
+    std::snprintf(fpsOverlay, sizeof(fpsOverlay), "now:     %f\n30s avg: %f",
+      mFramesPerSecond, averageFPS);
     ImGui::Text("FPS");
     ImGui::SameLine();
-    ImGui::PlotLines("##FrameTimes", mFPSValues.data(), mFPSValues.size(), fpsOffset, fpsOverlay.c_str(), 0.0f, FLT_MAX,
+    ImGui::PlotLines("##FrameTimes", mFPSValues.data(), mFPSValues.size(), fpsOffset, fpsOverlay, 0.0f, FLT_MAX,
       ImVec2(0, 80));
     ImGui::EndTooltip();
   }
 
+  /* operator new calls of the last frame, the steady state frame has none */
+  if (renderData.rdTrackAllocations) {
+    ImGui::Text("Allocations:");
+    ImGui::SameLine();
+    ImVec4 allocColor = renderData.rdFrameAllocations > 0 ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) :
+      ImVec4(0.3f, 1.0f, 0.3f, 1.0f);
+    ImGui::TextColored(allocColor, "%zu (%zu bytes)", renderData.rdFrameAllocations,
+      renderData.rdFrameAllocatedBytes);
+  }
+
   if (ImGui::CollapsingHeader("Info")) {
+    ImGui::Checkbox("Track Heap Allocations", &renderData.rdTrackAllocations);
+
     ImGui::Text("Triangles:");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdTriangleCount + renderData.rdGltfTriangleCount).c_str());
+    ImGui::Text("%u", renderData.rdTriangleCount + renderData.rdGltfTriangleCount);
 
-    std::string windowDims = std::to_string(renderData.rdWidth) + "x" + std::to_string(renderData.rdHeight);
     ImGui::Text("Window Dimensions:");
     ImGui::SameLine();
-    ImGui::Text("%s", windowDims.c_str());
+    ImGui::Text("%dx%d", renderData.rdWidth, renderData.rdHeight);
 
-    std::string imgWindowPos = std::to_string(static_cast<int>(ImGui::GetWindowPos().x)) + "/" + std::to_string(static_cast<int>(ImGui::GetWindowPos().y));
     ImGui::Text("ImGui Window Position:");
     ImGui::SameLine();
-    ImGui::Text("%s", imgWindowPos.c_str());
+    ImGui::Text("%d/%d", static_cast<int>(ImGui::GetWindowPos().x),
+      static_cast<int>(ImGui::GetWindowPos().y));
   }
 
 
@@ -143,7 +158,7 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
     ImGui::BeginGroup();
     ImGui::Text("Frame Time:");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdFrameTime).c_str());
+    ImGui::Text("%f", renderData.rdFrameTime);
     ImGui::SameLine();
     ImGui::Text("ms");
     ImGui::EndGroup();
@@ -155,19 +170,20 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
         averageFrameTime += value;
       }
       averageFrameTime /= static_cast<float>(mNumMatrixGenerationValues);
-      std::string frameTimeOverlay = "now:     " + std::to_string(renderData.rdFrameTime)
-        + " ms\n30s avg: " + std::to_string(averageFrameTime) + " ms";
+      char frameTimeOverlay[64];
+      std::snprintf(frameTimeOverlay, sizeof(frameTimeOverlay), "now:     %f ms\n30s avg: %f ms",
+        renderData.rdFrameTime, averageFrameTime);
       ImGui::Text("Frame Time       ");
       ImGui::SameLine();
       ImGui::PlotLines("##FrameTime", mFrameTimeValues.data(), mFrameTimeValues.size(), frameTimeOffset,
-        frameTimeOverlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 80));
+        frameTimeOverlay, 0.0f, FLT_MAX, ImVec2(0, 80));
       ImGui::EndTooltip();
     }
 
     ImGui::BeginGroup();
     ImGui::Text("Model Upload Time:");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdUploadToVBOTime).c_str());
+    ImGui::Text("%f", renderData.rdUploadToVBOTime);
     ImGui::SameLine();
     ImGui::Text("ms");
     ImGui::EndGroup();
@@ -179,19 +195,20 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
         averageModelUpload += value;
       }
       averageModelUpload /= static_cast<float>(mNumModelUploadValues);
-      std::string modelUploadOverlay = "now:     " + std::to_string(renderData.rdUploadToVBOTime)
-        + " ms\n30s avg: " + std::to_string(averageModelUpload) + " ms";
+      char modelUploadOverlay[64];
+      std::snprintf(modelUploadOverlay, sizeof(modelUploadOverlay), "now:     %f ms\n30s avg: %f ms",
+        renderData.rdUploadToVBOTime, averageModelUpload);
       ImGui::Text("VBO Upload");
       ImGui::SameLine();
       ImGui::PlotLines("##ModelUploadTimes", mModelUploadValues.data(), mModelUploadValues.size(), modelUploadOffset,
-        modelUploadOverlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 80));
+        modelUploadOverlay, 0.0f, FLT_MAX, ImVec2(0, 80));
       ImGui::EndTooltip();
     }
 
     ImGui::BeginGroup();
     ImGui::Text("Matrix Generation Time:");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdMatrixGenerateTime).c_str());
+    ImGui::Text("%f", renderData.rdMatrixGenerateTime);
     ImGui::SameLine();
     ImGui::Text("ms");
     ImGui::EndGroup();
@@ -203,19 +220,20 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
         averageMatGen += value;
       }
       averageMatGen /= static_cast<float>(mNumMatrixGenerationValues);
-      std::string matrixGenOverlay = "now:     " + std::to_string(renderData.rdMatrixGenerateTime)
-        + " ms\n30s avg: " + std::to_string(averageMatGen) + " ms";
+      char matrixGenOverlay[64];
+      std::snprintf(matrixGenOverlay, sizeof(matrixGenOverlay), "now:     %f ms\n30s avg: %f ms",
+        renderData.rdMatrixGenerateTime, averageMatGen);
       ImGui::Text("Matrix Generation");
       ImGui::SameLine();
       ImGui::PlotLines("##MatrixGenTimes", mMatrixGenerationValues.data(), mMatrixGenerationValues.size(), matrixGenOffset,
-        matrixGenOverlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 80));
+        matrixGenOverlay, 0.0f, FLT_MAX, ImVec2(0, 80));
       ImGui::EndTooltip();
     }
 
     ImGui::BeginGroup();
     ImGui::Text("(IK Generation Time)  :");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdIKTime).c_str());
+    ImGui::Text("%f", renderData.rdIKTime);
     ImGui::SameLine();
     ImGui::Text("ms");
     ImGui::EndGroup();
@@ -227,19 +245,26 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
         averageIKTime += value;
       }
       averageIKTime /= static_cast<float>(mNumIKValues);
-      std::string ikOverlay = "now:     " + std::to_string(renderData.rdIKTime)
-        + " ms\n30s avg: " + std::to_string(averageIKTime) + " ms";
+      char ikOverlay[64];
+      std::snprintf(ikOverlay, sizeof(ikOverlay), "now:     %f ms\n30s avg: %f ms",
+        renderData.rdIKTime, averageIKTime);
       ImGui::Text("(IK Generation)");
       ImGui::SameLine();
       ImGui::PlotLines("##IKTimes", mIKValues.data(), mIKValues.size(), ikOffset,
-        ikOverlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 80));
+        ikOverlay, 0.0f, FLT_MAX, ImVec2(0, 80));
       ImGui::EndTooltip();
     }
 
+    ImGui::Text("(GPU Anim Dispatch)   :");
+    ImGui::SameLine();
+    ImGui::Text("%f", renderData.rdGpuAnimationTime);
+    ImGui::SameLine();
+    ImGui::Text("ms");
+
     ImGui::BeginGroup();
     ImGui::Text("Matrix Upload Time:");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdUploadToUBOTime).c_str());
+    ImGui::Text("%f", renderData.rdUploadToUBOTime);
     ImGui::SameLine();
     ImGui::Text("ms");
     ImGui::EndGroup();
@@ -251,19 +276,20 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
         averageMatrixUpload += value;
       }
       averageMatrixUpload /= static_cast<float>(mNumMatrixUploadValues);
-      std::string matrixUploadOverlay = "now:     " + std::to_string(renderData.rdUploadToVBOTime)
-        + " ms\n30s avg: " + std::to_string(averageMatrixUpload) + " ms";
+      char matrixUploadOverlay[64];
+      std::snprintf(matrixUploadOverlay, sizeof(matrixUploadOverlay), "now:     %f ms\n30s avg: %f ms",
+        renderData.rdUploadToVBOTime, averageMatrixUpload);
       ImGui::Text("UBO Upload");
       ImGui::SameLine();
       ImGui::PlotLines("##MatrixUploadTimes", mMatrixUploadValues.data(), mMatrixUploadValues.size(), matrixUploadOffset,
-        matrixUploadOverlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 80));
+        matrixUploadOverlay, 0.0f, FLT_MAX, ImVec2(0, 80));
       ImGui::EndTooltip();
     }
 
     ImGui::BeginGroup();
     ImGui::Text("UI Generation Time:");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdUIGenerateTime).c_str());
+    ImGui::Text("%f", renderData.rdUIGenerateTime);
     ImGui::SameLine();
     ImGui::Text("ms");
     ImGui::EndGroup();
@@ -275,19 +301,20 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
         averageUiGen += value;
       }
       averageUiGen /= static_cast<float>(mNumUiGenValues);
-      std::string uiGenOverlay = "now:     " + std::to_string(renderData.rdUIGenerateTime)
-        + " ms\n30s avg: " + std::to_string(averageUiGen) + " ms";
+      char uiGenOverlay[64];
+      std::snprintf(uiGenOverlay, sizeof(uiGenOverlay), "now:     %f ms\n30s avg: %f ms",
+        renderData.rdUIGenerateTime, averageUiGen);
       ImGui::Text("UI Generation");
       ImGui::SameLine();
       ImGui::PlotLines("##UIGenTimes", mUiGenValues.data(), mUiGenValues.size(), uiGenOffset,
-        uiGenOverlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 80));
+        uiGenOverlay, 0.0f, FLT_MAX, ImVec2(0, 80));
       ImGui::EndTooltip();
     }
 
     ImGui::BeginGroup();
     ImGui::Text("UI Draw Time:");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdUIDrawTime).c_str());
+    ImGui::Text("%f", renderData.rdUIDrawTime);
     ImGui::SameLine();
     ImGui::Text("ms");
     ImGui::EndGroup();
@@ -299,12 +326,13 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
         averageUiDraw += value;
       }
       averageUiDraw /= static_cast<float>(mNumUiDrawValues);
-      std::string uiDrawOverlay = "now:     " + std::to_string(renderData.rdUIDrawTime)
-        + " ms\n30s avg: " + std::to_string(averageUiDraw) + " ms";
+      char uiDrawOverlay[64];
+      std::snprintf(uiDrawOverlay, sizeof(uiDrawOverlay), "now:     %f ms\n30s avg: %f ms",
+        renderData.rdUIDrawTime, averageUiDraw);
       ImGui::Text("UI Draw");
       ImGui::SameLine();
       ImGui::PlotLines("##UIDrawTimes", mUiDrawValues.data(), mUiDrawValues.size(), uiDrawOffset,
-        uiDrawOverlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 80));
+        uiDrawOverlay, 0.0f, FLT_MAX, ImVec2(0, 80));
       ImGui::EndTooltip();
     }
   }
@@ -312,15 +340,16 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
   if (ImGui::CollapsingHeader("Camera")) {
     ImGui::Text("Camera Position:");
     ImGui::SameLine();
-    ImGui::Text("%s", glm::to_string(renderData.rdCameraWorldPosition).c_str());
+    ImGui::Text("vec3(%f, %f, %f)", renderData.rdCameraWorldPosition.x,
+      renderData.rdCameraWorldPosition.y, renderData.rdCameraWorldPosition.z);
 
     ImGui::Text("View Azimuth:");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdViewAzimuth).c_str());
+    ImGui::Text("%f", renderData.rdViewAzimuth);
 
     ImGui::Text("View Elevation:");
     ImGui::SameLine();
-    ImGui::Text("%s", std::to_string(renderData.rdViewElevation).c_str());
+    ImGui::Text("%f", renderData.rdViewElevation);
 
     ImGui::Text("Field of View");
     ImGui::SameLine();
@@ -330,6 +359,104 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
   if (ImGui::CollapsingHeader("glTF Instances")) {
     ImGui::Text("Model Instances  : %d", renderData.rdNumberOfInstances);
 
+    ImGui::Checkbox("Multithreaded Animation", &renderData.rdUseWorkerThreads);
+    if (!renderData.rdUseWorkerThreads) {
+      ImGui::BeginDisabled();
+    }
+    ImGui::Text("Worker Threads   :");
+    ImGui::SameLine();
+    ImGui::SliderInt("##WORKERTHREADS", &renderData.rdNumWorkerThreads, 1,
+      renderData.rdMaxWorkerThreads, "%d", flags);
+    if (!renderData.rdUseWorkerThreads) {
+      ImGui::EndDisabled();
+    }
+
+    ImGui::Checkbox("Use Baked Clips", &renderData.rdUseBakedClips);
+
+    ImGui::Checkbox("GPU Animation (instances without IK)", &renderData.rdUseGpuAnimation);
+    ImGui::Text("GPU Instances    : %d", renderData.rdGpuAnimatedInstances);
+
+    ImGui::Checkbox("Baked Crowd Animation (looping clips)", &renderData.rdUseBakedCrowd);
+    ImGui::Text("Crowd Instances  : %d", renderData.rdCrowdInstances);
+
+    ImGui::Checkbox("Animation LOD", &renderData.rdUseAnimationLOD);
+    if (!renderData.rdUseAnimationLOD) {
+      ImGui::BeginDisabled();
+    }
+    ImGui::Text("Every 2nd Frame  :");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##ANIMLOD1", &renderData.rdAnimLODDistance1, 5.0f, 200.0f, "%.0f", flags);
+    ImGui::Text("Every 4th Frame  :");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##ANIMLOD2", &renderData.rdAnimLODDistance2,
+      renderData.rdAnimLODDistance1, 200.0f, "%.0f", flags);
+    ImGui::Text("Every 8th Frame  :");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##ANIMLOD3", &renderData.rdAnimLODDistance3,
+      renderData.rdAnimLODDistance2, 200.0f, "%.0f", flags);
+    ImGui::Text("Update Budget    :");
+    ImGui::SameLine();
+    ImGui::SliderInt("##ANIMBUDGET", &renderData.rdAnimUpdateBudget, 0,
+      renderData.rdNumberOfInstances, renderData.rdAnimUpdateBudget ? "%d" : "off", flags);
+    if (!renderData.rdUseAnimationLOD) {
+      ImGui::EndDisabled();
+    }
+
+    /* filled by the renderer after the first frame */
+    for (int i = 0; i < renderData.rdAnimLODUpdates.size(); ++i) {
+      ImGui::Text("LOD %i Updates    : %4d of %4d", i, renderData.rdAnimLODUpdates.at(i),
+        renderData.rdAnimLODInstances.at(i));
+    }
+
+    ImGui::Checkbox("Mesh LOD", &renderData.rdUseMeshLOD);
+    ImGui::Checkbox("Skeleton LOD (same distances)", &renderData.rdUseSkeletonLOD);
+    bool useLODDistances = renderData.rdUseMeshLOD || renderData.rdUseSkeletonLOD;
+    if (!useLODDistances) {
+      ImGui::BeginDisabled();
+    }
+    ImGui::Text("Half Triangles   :");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##MESHLOD1", &renderData.rdMeshLODDistance1, 5.0f, 200.0f, "%.0f", flags);
+    ImGui::Text("Quarter Triangles:");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##MESHLOD2", &renderData.rdMeshLODDistance2,
+      renderData.rdMeshLODDistance1, 200.0f, "%.0f", flags);
+    ImGui::Text("Eighth Triangles :");
+    ImGui::SameLine();
+    ImGui::SliderFloat("##MESHLOD3", &renderData.rdMeshLODDistance3,
+      renderData.rdMeshLODDistance2, 200.0f, "%.0f", flags);
+    if (!useLODDistances) {
+      ImGui::EndDisabled();
+    }
+
+    for (int i = 0; i < renderData.rdMeshLODTriangles.size(); ++i) {
+      ImGui::Text("LOD %i Triangles  : %7u (%4d instances)", i,
+        renderData.rdMeshLODTriangles.at(i), renderData.rdMeshLODInstances.at(i));
+    }
+    for (int i = 0; i < renderData.rdSkeletonLODUpdates.size(); ++i) {
+      ImGui::Text("LOD %i Joints     : %2d of %2d (%4d updates)", i,
+        renderData.rdSkeletonLODJoints.at(i), renderData.rdSkeletonLODJoints.at(0),
+        renderData.rdSkeletonLODUpdates.at(i));
+    }
+
+    ImGui::Checkbox("Frustum Culling", &renderData.rdUseFrustumCulling);
+    if (!renderData.rdUseFrustumCulling) {
+      ImGui::BeginDisabled();
+    }
+    ImGui::Checkbox("Slow Animation of Culled Instances", &renderData.rdReduceCulledUpdates);
+    if (!renderData.rdUseFrustumCulling) {
+      ImGui::EndDisabled();
+    }
+    ImGui::Text("Visible Instances: %4d, %4d culled", renderData.rdVisibleInstances,
+      renderData.rdCulledInstances);
+    ImGui::Text("Culling Time     : %f ms", renderData.rdCullingTime);
+    ImGui::Text("Est. Upload Saved: %f ms", renderData.rdCullingTimeSavedEstimate);
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Estimate: upload time per drawn instance times the culled instances");
+    }
+    ImGui::Checkbox("Draw Bounding Spheres", &renderData.rdDrawBoundingSpheres);
+    ImGui::Text("Debug Line Vertices: %6u", renderData.rdDebugLineVertices);
+
     ImGui::Text("Selected Instance:");
     ImGui::SameLine();
     ImGui::PushButtonRepeat(true);
@@ -403,10 +530,10 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
     ImGui::Text("Clip   ");
     ImGui::SameLine();
     if (ImGui::BeginCombo("##ClipCombo",
-      settings.msClipNames.at(settings.msAnimClip).c_str())) {
-      for (int i = 0; i < settings.msClipNames.size(); ++i) {
+      clipNames.at(settings.msAnimClip).c_str())) {
+      for (int i = 0; i < clipNames.size(); ++i) {
         const bool isSelected = (settings.msAnimClip == i);
-        if (ImGui::Selectable(settings.msClipNames.at(i).c_str(), isSelected)) {
+        if (ImGui::Selectable(clipNames.at(i).c_str(), isSelected)) {
           settings.msAnimClip = i;
         }
 
@@ -459,10 +586,10 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
       ImGui::Text("Dest Clip   ");
       ImGui::SameLine();
       if (ImGui::BeginCombo("##DestClipCombo",
-        settings.msClipNames.at(settings.msCrossBlendDestAnimClip).c_str())) {
-        for (int i = 0; i < settings.msClipNames.size(); ++i) {
+        clipNames.at(settings.msCrossBlendDestAnimClip).c_str())) {
+        for (int i = 0; i < clipNames.size(); ++i) {
           const bool isSelected = (settings.msCrossBlendDestAnimClip == i);
-          if (ImGui::Selectable(settings.msClipNames.at(i).c_str(), isSelected)) {
+          if (ImGui::Selectable(clipNames.at(i).c_str(), isSelected)) {
             settings.msCrossBlendDestAnimClip = i;
           }
 
@@ -483,11 +610,11 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
       ImGui::Text("Split Node  ");
       ImGui::SameLine();
       if (ImGui::BeginCombo("##SplitNodeCombo",
-        settings.msSkelNodeNames.at(settings.msSkelSplitNode).c_str())) {
-        for (int i = 0; i < settings.msSkelNodeNames.size(); ++i) {
-          if (settings.msSkelNodeNames.at(i).compare("(invalid)") != 0) {
+        nodeNames.at(settings.msSkelSplitNode).c_str())) {
+        for (int i = 0; i < nodeNames.size(); ++i) {
+          if (nodeNames.at(i).compare("(invalid)") != 0) {
             const bool isSelected = (settings.msSkelSplitNode == i);
-            if (ImGui::Selectable(settings.msSkelNodeNames.at(i).c_str(), isSelected)) {
+            if (ImGui::Selectable(nodeNames.at(i).c_str(), isSelected)) {
               settings.msSkelSplitNode = i;
             }
 
@@ -532,11 +659,11 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
       ImGui::Text("Effector Node  :");
       ImGui::SameLine();
       if (ImGui::BeginCombo("##EffectorNodeCombo",
-        settings.msSkelNodeNames.at(settings.msIkEffectorNode).c_str())) {
-        for (int i = 0; i < settings.msSkelNodeNames.size(); ++i) {
-          if (settings.msSkelNodeNames.at(i).compare("(invalid)") != 0) {
+        nodeNames.at(settings.msIkEffectorNode).c_str())) {
+        for (int i = 0; i < nodeNames.size(); ++i) {
+          if (nodeNames.at(i).compare("(invalid)") != 0) {
             const bool isSelected = (settings.msIkEffectorNode == i);
-            if (ImGui::Selectable(settings.msSkelNodeNames.at(i).c_str(), isSelected)) {
+            if (ImGui::Selectable(nodeNames.at(i).c_str(), isSelected)) {
               settings.msIkEffectorNode = i;
             }
 
@@ -551,11 +678,11 @@ void UserInterface::createFrame(OGLRenderData &renderData, ModelSettings &settin
       ImGui::Text("IK Root Node   :");
       ImGui::SameLine();
       if (ImGui::BeginCombo("##RootNodeCombo",
-        settings.msSkelNodeNames.at(settings.msIkRootNode).c_str())) {
-        for (int i = 0; i < settings.msSkelNodeNames.size(); ++i) {
-          if (settings.msSkelNodeNames.at(i).compare("(invalid)") != 0) {
+        nodeNames.at(settings.msIkRootNode).c_str())) {
+        for (int i = 0; i < nodeNames.size(); ++i) {
+          if (nodeNames.at(i).compare("(invalid)") != 0) {
             const bool isSelected = (settings.msIkRootNode == i);
-            if (ImGui::Selectable(settings.msSkelNodeNames.at(i).c_str(), isSelected)) {
+            if (ImGui::Selectable(nodeNames.at(i).c_str(), isSelected)) {
               settings.msIkRootNode = i;
             }
 
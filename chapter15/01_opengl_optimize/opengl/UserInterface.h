@@ -1,6 +1,7 @@
 /* Dear ImGui*/
 #pragma once
 #include <vector>
+#include <string>
 
 #include "OGLRenderData.h"
 #include "ModelSettings.h"
@@ -8,7 +9,9 @@
 class UserInterface {
   public:
     void init(OGLRenderData &renderData);
-    void createFrame(OGLRenderData &renderData, ModelSettings &settings);
+    /* the names are owned by the model, the settings only store the indices */
+    void createFrame(OGLRenderData &renderData, ModelSettings &settings,
+      const std::vector<std::string> &clipNames, const std::vector<std::string> &nodeNames);
     void render();
     void cleanup();
 
@@ -0,0 +1,91 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in uvec4 aJointNum;
+layout (location = 4) in vec4 aJointWeight;
+
+layout (location = 0) out vec3 normal;
+layout (location = 1) out vec2 texCoord;
+
+layout (std140, binding = 0) uniform Matrices {
+  mat4 view;
+  mat4 projection;
+};
+
+struct CrowdInstance {
+  vec4 worldRotation;
+  vec3 worldPosition;
+  int clip;
+  float time;
+  int padding0;
+  int padding1;
+  int padding2;
+};
+
+struct BakedClip {
+  int frameOffset;
+  int frameCount;
+  float frameRate;
+  int padding;
+};
+
+layout (std430, binding = 9) readonly buffer CrowdInstances {
+  CrowdInstance crowd[];
+};
+
+// model space joint matrices of all baked frames
+layout (std430, binding = 10) readonly buffer BakedJointMatrices {
+  mat4 bakedMat[];
+};
+
+layout (std430, binding = 12) readonly buffer BakedClips {
+  BakedClip clips[];
+};
+
+// number of joints, the size of a baked frame
+uniform int aModelStride;
+
+vec3 rotate(vec4 q, vec3 v) {
+  return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+mat4 getJointMatrix(int joint, int frameStart, float interp) {
+  mat4 prev = bakedMat[frameStart + joint];
+  mat4 next = bakedMat[frameStart + aModelStride + joint];
+  return prev * (1.0 - interp) + next * interp;
+}
+
+// octahedral encoded normal, the lower hemisphere is folded over the diagonals
+vec3 decodeNormal(vec2 encoded) {
+  vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  float fold = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -fold : fold;
+  n.y += n.y >= 0.0 ? -fold : fold;
+  return normalize(n);
+}
+
+void main() {
+  // the draw of every mesh LOD level starts at its first instance
+  CrowdInstance inst = crowd[gl_BaseInstance + gl_InstanceID];
+  BakedClip clip = clips[inst.clip];
+
+  float framePos = clamp(inst.time * clip.frameRate, 0.0, float(clip.frameCount - 1));
+  int frame = min(int(framePos), clip.frameCount - 2);
+  float interp = framePos - float(frame);
+  int frameStart = (clip.frameOffset + frame) * aModelStride;
+
+  mat4 skinMat =
+    aJointWeight.x * getJointMatrix(int(aJointNum.x), frameStart, interp) +
+    aJointWeight.y * getJointMatrix(int(aJointNum.y), frameStart, interp) +
+    aJointWeight.z * getJointMatrix(int(aJointNum.z), frameStart, interp) +
+    aJointWeight.w * getJointMatrix(int(aJointNum.w), frameStart, interp);
+
+  vec3 worldPos = rotate(inst.worldRotation, vec3(skinMat * vec4(aPos, 1.0))) +
+    inst.worldPosition;
+
+  gl_Position = projection * view * vec4(worldPos, 1.0);
+  normal = rotate(inst.worldRotation,
+    vec3(transpose(inverse(skinMat)) * vec4(decodeNormal(aNormal), 1.0)));
+  texCoord = aTexCoord;
+}
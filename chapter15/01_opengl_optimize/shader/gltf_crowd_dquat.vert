@@ -0,0 +1,139 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in uvec4 aJointNum;
+layout (location = 4) in vec4 aJointWeight;
+
+layout (location = 0) out vec3 normal;
+layout (location = 1) out vec2 texCoord;
+
+layout (std140, binding = 0) uniform Matrices {
+  mat4 view;
+  mat4 projection;
+};
+
+struct CrowdInstance {
+  vec4 worldRotation;
+  vec3 worldPosition;
+  int clip;
+  float time;
+  int padding0;
+  int padding1;
+  int padding2;
+};
+
+struct BakedClip {
+  int frameOffset;
+  int frameCount;
+  float frameRate;
+  int padding;
+};
+
+layout (std430, binding = 9) readonly buffer CrowdInstances {
+  CrowdInstance crowd[];
+};
+
+// model space joint dual quaternions of all baked frames
+layout (std430, binding = 11) readonly buffer BakedJointDualQuats {
+  mat2x4 bakedDQs[];
+};
+
+layout (std430, binding = 12) readonly buffer BakedClips {
+  BakedClip clips[];
+};
+
+// number of joints, the size of a baked frame
+uniform int aModelStride;
+
+vec3 rotate(vec4 q, vec3 v) {
+  return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+// neighbouring frames are baked in the same hemisphere
+mat2x4 getJointDualQuat(int joint, int frameStart, float interp) {
+  mat2x4 prev = bakedDQs[frameStart + joint];
+  mat2x4 next = bakedDQs[frameStart + aModelStride + joint];
+  return prev * (1.0 - interp) + next * interp;
+}
+
+mat2x4 getJointTransform(ivec4 joints, vec4 weights, int frameStart, float interp) {
+  mat2x4 dq0 = getJointDualQuat(joints.x, frameStart, interp);
+  mat2x4 dq1 = getJointDualQuat(joints.y, frameStart, interp);
+  mat2x4 dq2 = getJointDualQuat(joints.z, frameStart, interp);
+  mat2x4 dq3 = getJointDualQuat(joints.w, frameStart, interp);
+
+  // shortest rotation
+  weights.y *= sign(dot(dq0[0], dq1[0]));
+  weights.z *= sign(dot(dq0[0], dq2[0]));
+  weights.w *= sign(dot(dq0[0], dq3[0]));
+
+  // blend
+  mat2x4 result =
+      weights.x * dq0 +
+      weights.y * dq1 +
+      weights.z * dq2 +
+      weights.w * dq3;
+
+  // normalize the dual quaternion
+  float norm = length(result[0]);
+  return result / norm;
+}
+
+mat4 getSkinMat(int frameStart, float interp) {
+  mat2x4 bone = getJointTransform(ivec4(aJointNum), aJointWeight, frameStart, interp);
+
+  vec4 r = bone[0]; // rotation
+  vec4 t = bone[1]; // translation
+
+  return mat4(
+      1.0 - (2.0 * r.y * r.y) - (2.0 * r.z * r.z),
+            (2.0 * r.x * r.y) + (2.0 * r.w * r.z),
+            (2.0 * r.x * r.z) - (2.0 * r.w * r.y),
+      0.0,
+
+            (2.0 * r.x * r.y) - (2.0 * r.w * r.z),
+      1.0 - (2.0 * r.x * r.x) - (2.0 * r.z * r.z),
+            (2.0 * r.y * r.z) + (2.0 * r.w * r.x),
+      0.0,
+
+            (2.0 * r.x * r.z) + (2.0 * r.w * r.y),
+            (2.0 * r.y * r.z) - (2.0 * r.w * r.x),
+      1.0 - (2.0 * r.x * r.x) - (2.0 * r.y * r.y),
+      0.0,
+
+      2.0 * (-t.w * r.x + t.x * r.w - t.y * r.z + t.z * r.y),
+      2.0 * (-t.w * r.y + t.x * r.z + t.y * r.w - t.z * r.x),
+      2.0 * (-t.w * r.z - t.x * r.y + t.y * r.x + t.z * r.w),
+      1);
+}
+
+// octahedral encoded normal, the lower hemisphere is folded over the diagonals
+vec3 decodeNormal(vec2 encoded) {
+  vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  float fold = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -fold : fold;
+  n.y += n.y >= 0.0 ? -fold : fold;
+  return normalize(n);
+}
+
+void main() {
+  // the draw of every mesh LOD level starts at its first instance
+  CrowdInstance inst = crowd[gl_BaseInstance + gl_InstanceID];
+  BakedClip clip = clips[inst.clip];
+
+  float framePos = clamp(inst.time * clip.frameRate, 0.0, float(clip.frameCount - 1));
+  int frame = min(int(framePos), clip.frameCount - 2);
+  float interp = framePos - float(frame);
+  int frameStart = (clip.frameOffset + frame) * aModelStride;
+
+  mat4 skinMat = getSkinMat(frameStart, interp);
+
+  vec3 worldPos = rotate(inst.worldRotation, vec3(skinMat * vec4(aPos, 1.0))) +
+    inst.worldPosition;
+
+  gl_Position = projection * view * vec4(worldPos, 1.0);
+  normal = rotate(inst.worldRotation,
+    vec3(transpose(inverse(skinMat)) * vec4(decodeNormal(aNormal), 1.0)));
+  texCoord = aTexCoord;
+}
@@ -1,8 +1,8 @@
 #version 460 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 1) in vec2 aNormal;
 layout (location = 2) in vec2 aTexCoord;
-layout (location = 3) in vec4 aJointNum;
+layout (location = 3) in uvec4 aJointNum;
 layout (location = 4) in vec4 aJointWeight;
 
 layout (location = 0) out vec3 normal;
@@ -19,14 +19,25 @@ layout (std430, binding = 1) readonly buffer JointMatrices {
 
 uniform int aModelStride;
 
+// octahedral encoded normal, the lower hemisphere is folded over the diagonals
+vec3 decodeNormal(vec2 encoded) {
+  vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  float fold = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -fold : fold;
+  n.y += n.y >= 0.0 ? -fold : fold;
+  return normalize(n);
+}
+
 void main() {
+  // the draw of every mesh LOD level starts at its first instance
+  int instance = gl_BaseInstance + gl_InstanceID;
   mat4 skinMat =
-    aJointWeight.x * jointMat[int(aJointNum.x) + gl_InstanceID * aModelStride] +
-    aJointWeight.y * jointMat[int(aJointNum.y) + gl_InstanceID * aModelStride] +
-    aJointWeight.z * jointMat[int(aJointNum.z) + gl_InstanceID * aModelStride] +
-    aJointWeight.w * jointMat[int(aJointNum.w) + gl_InstanceID * aModelStride];
+    aJointWeight.x * jointMat[int(aJointNum.x) + instance * aModelStride] +
+    aJointWeight.y * jointMat[int(aJointNum.y) + instance * aModelStride] +
+    aJointWeight.z * jointMat[int(aJointNum.z) + instance * aModelStride] +
+    aJointWeight.w * jointMat[int(aJointNum.w) + instance * aModelStride];
 
   gl_Position = projection * view * skinMat * vec4(aPos, 1.0);
-  normal = vec3(transpose(inverse(skinMat)) * vec4(aNormal, 1.0));
+  normal = vec3(transpose(inverse(skinMat)) * vec4(decodeNormal(aNormal), 1.0));
   texCoord = aTexCoord;
 }
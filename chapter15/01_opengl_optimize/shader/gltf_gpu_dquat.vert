@@ -1,8 +1,8 @@
 #version 460 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 1) in vec2 aNormal;
 layout (location = 2) in vec2 aTexCoord;
-layout (location = 3) in vec4 aJointNum;
+layout (location = 3) in uvec4 aJointNum;
 layout (location = 4) in vec4 aJointWeight;
 
 layout (location = 0) out vec3 normal;
@@ -20,11 +20,12 @@ layout (std430, binding = 2) readonly buffer JointDualQuats {
 uniform int aModelStride;
 
 mat2x4 getJointTransform(ivec4 joints, vec4 weights) {
-  // read dual quaterions from buffer
-  mat2x4 dq0 = jointDQs[joints.x + gl_InstanceID * aModelStride];
-  mat2x4 dq1 = jointDQs[joints.y + gl_InstanceID * aModelStride];
-  mat2x4 dq2 = jointDQs[joints.z + gl_InstanceID * aModelStride];
-  mat2x4 dq3 = jointDQs[joints.w + gl_InstanceID * aModelStride];
+  // read dual quaterions from buffer, every mesh LOD level is drawn from its first instance on
+  int instance = gl_BaseInstance + gl_InstanceID;
+  mat2x4 dq0 = jointDQs[joints.x + instance * aModelStride];
+  mat2x4 dq1 = jointDQs[joints.y + instance * aModelStride];
+  mat2x4 dq2 = jointDQs[joints.z + instance * aModelStride];
+  mat2x4 dq3 = jointDQs[joints.w + instance * aModelStride];
 
   // shortest rotation
   weights.y *= sign(dot(dq0[0], dq1[0]));
@@ -71,11 +72,20 @@ mat4 getSkinMat() {
       1);
 }
 
+// octahedral encoded normal, the lower hemisphere is folded over the diagonals
+vec3 decodeNormal(vec2 encoded) {
+  vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  float fold = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -fold : fold;
+  n.y += n.y >= 0.0 ? -fold : fold;
+  return normalize(n);
+}
+
 void main() {
   mat4 skinMat = getSkinMat();
 
   gl_Position = projection * view * skinMat * vec4(aPos, 1.0);
-  normal = vec3(transpose(inverse(skinMat)) * vec4(aNormal, 1.0));
+  normal = vec3(transpose(inverse(skinMat)) * vec4(decodeNormal(aNormal), 1.0));
   texCoord = aTexCoord;
 }
 
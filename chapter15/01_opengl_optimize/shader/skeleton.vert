@@ -0,0 +1,32 @@
+#version 460 core
+layout (location = 0) out vec4 lineColor;
+
+layout (std140, binding = 0) uniform Matrices {
+  mat4 view;
+  mat4 projection;
+};
+
+layout (std430, binding = 1) readonly buffer JointMatrices {
+  mat4 jointMat[];
+};
+
+// two entries per bone, bind pose position in xyz and joint number in w
+layout (std430, binding = 13) readonly buffer BoneLines {
+  vec4 boneLines[];
+};
+
+// joint data slot of each instance showing its skeleton
+layout (std430, binding = 14) readonly buffer SkeletonInstances {
+  int jointSlots[];
+};
+
+uniform int aModelStride;
+
+void main() {
+  vec4 bone = boneLines[gl_VertexID];
+  mat4 jointMatrix = jointMat[int(bone.w) + jointSlots[gl_InstanceID] * aModelStride];
+
+  gl_Position = projection * view * jointMatrix * vec4(bone.xyz, 1.0);
+  // parent end cyan, child end blue
+  lineColor = gl_VertexID % 2 == 0 ? vec4(0.0, 1.0, 1.0, 1.0) : vec4(0.0, 0.0, 1.0, 1.0);
+}
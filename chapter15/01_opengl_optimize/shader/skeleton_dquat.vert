@@ -0,0 +1,41 @@
+#version 460 core
+layout (location = 0) out vec4 lineColor;
+
+layout (std140, binding = 0) uniform Matrices {
+  mat4 view;
+  mat4 projection;
+};
+
+layout (std430, binding = 2) readonly buffer JointDualQuats {
+  mat2x4 jointDQs[];
+};
+
+// two entries per bone, bind pose position in xyz and joint number in w
+layout (std430, binding = 13) readonly buffer BoneLines {
+  vec4 boneLines[];
+};
+
+// joint data slot of each instance showing its skeleton
+layout (std430, binding = 14) readonly buffer SkeletonInstances {
+  int jointSlots[];
+};
+
+uniform int aModelStride;
+
+vec3 transformPosition(mat2x4 dq, vec3 pos) {
+  vec4 r = dq[0]; // rotation
+  vec4 t = dq[1]; // translation
+
+  vec3 rotated = pos + 2.0 * cross(r.xyz, cross(r.xyz, pos) + r.w * pos);
+  vec3 translation = 2.0 * (r.w * t.xyz - t.w * r.xyz + cross(r.xyz, t.xyz));
+  return rotated + translation;
+}
+
+void main() {
+  vec4 bone = boneLines[gl_VertexID];
+  mat2x4 jointDQ = jointDQs[int(bone.w) + jointSlots[gl_InstanceID] * aModelStride];
+
+  gl_Position = projection * view * vec4(transformPosition(jointDQ, bone.xyz), 1.0);
+  // parent end cyan, child end blue
+  lineColor = gl_VertexID % 2 == 0 ? vec4(0.0, 1.0, 1.0, 1.0) : vec4(0.0, 0.0, 1.0, 1.0);
+}
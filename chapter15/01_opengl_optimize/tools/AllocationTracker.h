@@ -0,0 +1,18 @@
+/* counts the heap allocations made through operator new, replaces the global operator */
+#pragma once
+#include <cstddef>
+
+class AllocationTracker {
+  public:
+    /* counting is off by default, the hook only checks the flag then */
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /* allocations since the last reset, of all threads */
+    static size_t getAllocationCount();
+    static size_t getAllocatedBytes();
+    static void resetCounters();
+
+    /* called by the operator new replacement */
+    static void countAllocation(size_t size);
+};
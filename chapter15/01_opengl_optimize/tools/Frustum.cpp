@@ -0,0 +1,27 @@
+#include "Frustum.h"
+
+void Frustum::update(const glm::mat4 &projectionMatrix, const glm::mat4 &viewMatrix) {
+  /* the rows of the combined matrix, glm matrices are column major */
+  glm::mat4 rows = glm::transpose(projectionMatrix * viewMatrix);
+
+  mPlanes[0] = rows[3] + rows[0];
+  mPlanes[1] = rows[3] - rows[0];
+  mPlanes[2] = rows[3] + rows[1];
+  mPlanes[3] = rows[3] - rows[1];
+  mPlanes[4] = rows[3] + rows[2];
+  mPlanes[5] = rows[3] - rows[2];
+
+  /* unit normals, the plane equation returns the distance then */
+  for (auto &plane : mPlanes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+}
+
+bool Frustum::isSphereVisible(const glm::vec4 &sphere) const {
+  for (const auto &plane : mPlanes) {
+    if (glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w < -sphere.w) {
+      return false;
+    }
+  }
+  return true;
+}
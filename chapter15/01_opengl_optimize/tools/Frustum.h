@@ -0,0 +1,15 @@
+/* view frustum planes, instances outside of all six are not drawn */
+#pragma once
+#include <glm/glm.hpp>
+
+class Frustum {
+  public:
+    /* the camera view matrix and the projection of the frame */
+    void update(const glm::mat4 &projectionMatrix, const glm::mat4 &viewMatrix);
+    /* xyz is the world space center, w the radius */
+    bool isSphereVisible(const glm::vec4 &sphere) const;
+
+  private:
+    /* left, right, bottom, top, near, far, normals point inside */
+    glm::vec4 mPlanes[6] = {};
+};
@@ -0,0 +1,823 @@
+#include <algorithm>
+
+#include "SimdMath.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_MATH_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+/* MSVC allows all intrinsics without special compiler flags */
+#define SIMD_TARGET_SSE4
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+/* the kernels access the glm types as plain float arrays */
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+static_assert(sizeof(glm::quat) == 4 * sizeof(float), "glm::quat must be tightly packed");
+static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "glm::mat4 must be tightly packed");
+
+simdLevel SimdMath::mMaxSimdLevel = SimdMath::detectSimdLevel();
+simdLevel SimdMath::mSimdLevel = SimdMath::mMaxSimdLevel;
+
+namespace {
+  /* slerp coefficients from D. Eberly, "A Fast and Accurate Algorithm for Computing SLERP" */
+  constexpr float slerpOnePlusMu = 1.90110745351730037f;
+  constexpr float slerpU[8] = { 1.0f / 3.0f, 1.0f / 10.0f, 1.0f / 21.0f, 1.0f / 36.0f,
+    1.0f / 55.0f, 1.0f / 78.0f, 1.0f / 105.0f, slerpOnePlusMu / 136.0f };
+  constexpr float slerpV[8] = { 1.0f / 3.0f, 2.0f / 5.0f, 3.0f / 7.0f, 4.0f / 9.0f,
+    5.0f / 11.0f, 6.0f / 13.0f, 7.0f / 15.0f, slerpOnePlusMu * 8.0f / 17.0f };
+
+  /* glm may store the quaternion as w,x,y,z instead of x,y,z,w */
+  bool quatWFirst() {
+    glm::quat q = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    return reinterpret_cast<const float*>(&q)[0] == 1.0f;
+  }
+
+  /* replaces sin(t * theta) / sin(theta), cosTheta must be positive */
+  float slerpCoefficient(float t, float cosThetaMinusOne) {
+    float sqrT = t * t;
+    float result = 1.0f;
+    for (int i = 7; i >= 0; --i) {
+      result = 1.0f + (slerpU[i] * sqrT - slerpV[i]) * cosThetaMinusOne * result;
+    }
+    return t * result;
+  }
+
+  void nlerpQuatsScalar(const glm::quat *from, const glm::quat *to, float factor,
+      glm::quat *out, int count) {
+    for (int i = 0; i < count; ++i) {
+      glm::quat target = to[i];
+      if (glm::dot(from[i], target) < 0.0f) {
+        target = -target;
+      }
+      out[i] = glm::normalize(from[i] * (1.0f - factor) + target * factor);
+    }
+  }
+
+  void slerpQuatsScalar(const glm::quat *from, const glm::quat *to, float factor,
+      glm::quat *out, int count) {
+    for (int i = 0; i < count; ++i) {
+      float cosTheta = glm::dot(from[i], to[i]);
+      float sign = 1.0f;
+      if (cosTheta < 0.0f) {
+        cosTheta = -cosTheta;
+        sign = -1.0f;
+      }
+      float fromFactor = slerpCoefficient(1.0f - factor, cosTheta - 1.0f);
+      float toFactor = slerpCoefficient(factor, cosTheta - 1.0f) * sign;
+      out[i] = from[i] * fromFactor + to[i] * toFactor;
+    }
+  }
+
+  void lerpVec3sScalar(const glm::vec3 *from, const glm::vec3 *to, float factor,
+      glm::vec3 *out, int count) {
+    for (int i = 0; i < count; ++i) {
+      out[i] = from[i] + (to[i] - from[i]) * factor;
+    }
+  }
+
+  /* a factor per element, the single factor versions do the math */
+  void nlerpQuatsScalar(const glm::quat *from, const glm::quat *to, const float *factors,
+      glm::quat *out, int count) {
+    for (int i = 0; i < count; ++i) {
+      nlerpQuatsScalar(from + i, to + i, factors[i], out + i, 1);
+    }
+  }
+
+  void slerpQuatsScalar(const glm::quat *from, const glm::quat *to, const float *factors,
+      glm::quat *out, int count) {
+    for (int i = 0; i < count; ++i) {
+      slerpQuatsScalar(from + i, to + i, factors[i], out + i, 1);
+    }
+  }
+
+  void lerpVec3sScalar(const glm::vec3 *from, const glm::vec3 *to, const float *factors,
+      glm::vec3 *out, int count) {
+    for (int i = 0; i < count; ++i) {
+      out[i] = from[i] + (to[i] - from[i]) * factors[i];
+    }
+  }
+
+  void composeTRSMatricesScalar(const glm::vec3 *translations, const glm::quat *rotations,
+      const glm::vec3 *scales, glm::mat4 *out, int count) {
+    for (int i = 0; i < count; ++i) {
+      glm::mat4 matrix = glm::mat4_cast(rotations[i]);
+      matrix[0] *= scales[i].x;
+      matrix[1] *= scales[i].y;
+      matrix[2] *= scales[i].z;
+      matrix[3] = glm::vec4(translations[i], 1.0f);
+      out[i] = matrix;
+    }
+  }
+
+#ifdef SIMD_MATH_X86
+  /* SSE4.1, four joints per iteration, transposed to one register per component */
+  SIMD_TARGET_SSE4
+  inline void loadQuatsSse4(const glm::quat *quats, __m128 &c0, __m128 &c1, __m128 &c2,
+      __m128 &c3) {
+    const float *data = reinterpret_cast<const float*>(quats);
+    c0 = _mm_loadu_ps(data);
+    c1 = _mm_loadu_ps(data + 4);
+    c2 = _mm_loadu_ps(data + 8);
+    c3 = _mm_loadu_ps(data + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+  }
+
+  SIMD_TARGET_SSE4
+  inline void storeQuatsSse4(glm::quat *quats, __m128 c0, __m128 c1, __m128 c2, __m128 c3) {
+    float *data = reinterpret_cast<float*>(quats);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(data, c0);
+    _mm_storeu_ps(data + 4, c1);
+    _mm_storeu_ps(data + 8, c2);
+    _mm_storeu_ps(data + 12, c3);
+  }
+
+  SIMD_TARGET_SSE4
+  inline __m128 slerpCoefficientSse4(__m128 t, __m128 cosThetaMinusOne) {
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 sqrT = _mm_mul_ps(t, t);
+    __m128 result = one;
+    for (int i = 7; i >= 0; --i) {
+      __m128 b = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(slerpU[i]), sqrT), _mm_set1_ps(slerpV[i]));
+      result = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(b, cosThetaMinusOne), result));
+    }
+    return _mm_mul_ps(t, result);
+  }
+
+  /* four joints, toT holds the factor of each joint */
+  SIMD_TARGET_SSE4
+  inline void nlerpQuatBlockSse4(const glm::quat *from, const glm::quat *to, __m128 toT,
+      glm::quat *out) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 signBit = _mm_set1_ps(-0.0f);
+    __m128 fromFactor = _mm_sub_ps(_mm_set1_ps(1.0f), toT);
+
+    __m128 a0, a1, a2, a3, b0, b1, b2, b3;
+    loadQuatsSse4(from, a0, a1, a2, a3);
+    loadQuatsSse4(to, b0, b1, b2, b3);
+
+    __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, b0), _mm_mul_ps(a1, b1)),
+      _mm_add_ps(_mm_mul_ps(a2, b2), _mm_mul_ps(a3, b3)));
+    __m128 factorTo = _mm_blendv_ps(toT, _mm_xor_ps(toT, signBit), _mm_cmplt_ps(dot, zero));
+
+    __m128 r0 = _mm_add_ps(_mm_mul_ps(a0, fromFactor), _mm_mul_ps(b0, factorTo));
+    __m128 r1 = _mm_add_ps(_mm_mul_ps(a1, fromFactor), _mm_mul_ps(b1, factorTo));
+    __m128 r2 = _mm_add_ps(_mm_mul_ps(a2, fromFactor), _mm_mul_ps(b2, factorTo));
+    __m128 r3 = _mm_add_ps(_mm_mul_ps(a3, fromFactor), _mm_mul_ps(b3, factorTo));
+
+    __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, r0), _mm_mul_ps(r1, r1)),
+      _mm_add_ps(_mm_mul_ps(r2, r2), _mm_mul_ps(r3, r3))));
+    storeQuatsSse4(out, _mm_div_ps(r0, length), _mm_div_ps(r1, length),
+      _mm_div_ps(r2, length), _mm_div_ps(r3, length));
+  }
+
+  SIMD_TARGET_SSE4
+  inline void slerpQuatBlockSse4(const glm::quat *from, const glm::quat *to, __m128 toT,
+      glm::quat *out) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 signBit = _mm_set1_ps(-0.0f);
+    __m128 fromT = _mm_sub_ps(one, toT);
+
+    __m128 a0, a1, a2, a3, b0, b1, b2, b3;
+    loadQuatsSse4(from, a0, a1, a2, a3);
+    loadQuatsSse4(to, b0, b1, b2, b3);
+
+    __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, b0), _mm_mul_ps(a1, b1)),
+      _mm_add_ps(_mm_mul_ps(a2, b2), _mm_mul_ps(a3, b3)));
+    __m128 negative = _mm_cmplt_ps(dot, zero);
+    __m128 cosThetaMinusOne = _mm_sub_ps(_mm_andnot_ps(signBit, dot), one);
+
+    __m128 fromFactor = slerpCoefficientSse4(fromT, cosThetaMinusOne);
+    __m128 toFactor = slerpCoefficientSse4(toT, cosThetaMinusOne);
+    toFactor = _mm_blendv_ps(toFactor, _mm_xor_ps(toFactor, signBit), negative);
+
+    storeQuatsSse4(out,
+      _mm_add_ps(_mm_mul_ps(a0, fromFactor), _mm_mul_ps(b0, toFactor)),
+      _mm_add_ps(_mm_mul_ps(a1, fromFactor), _mm_mul_ps(b1, toFactor)),
+      _mm_add_ps(_mm_mul_ps(a2, fromFactor), _mm_mul_ps(b2, toFactor)),
+      _mm_add_ps(_mm_mul_ps(a3, fromFactor), _mm_mul_ps(b3, toFactor)));
+  }
+
+  SIMD_TARGET_SSE4
+  void nlerpQuatsSse4(const glm::quat *from, const glm::quat *to, float factor,
+      glm::quat *out, int count) {
+    __m128 toT = _mm_set1_ps(factor);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      nlerpQuatBlockSse4(from + i, to + i, toT, out + i);
+    }
+    nlerpQuatsScalar(from + i, to + i, factor, out + i, count - i);
+  }
+
+  SIMD_TARGET_SSE4
+  void nlerpQuatsSse4(const glm::quat *from, const glm::quat *to, const float *factors,
+      glm::quat *out, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      nlerpQuatBlockSse4(from + i, to + i, _mm_loadu_ps(factors + i), out + i);
+    }
+    nlerpQuatsScalar(from + i, to + i, factors + i, out + i, count - i);
+  }
+
+  SIMD_TARGET_SSE4
+  void slerpQuatsSse4(const glm::quat *from, const glm::quat *to, float factor,
+      glm::quat *out, int count) {
+    __m128 toT = _mm_set1_ps(factor);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      slerpQuatBlockSse4(from + i, to + i, toT, out + i);
+    }
+    slerpQuatsScalar(from + i, to + i, factor, out + i, count - i);
+  }
+
+  SIMD_TARGET_SSE4
+  void slerpQuatsSse4(const glm::quat *from, const glm::quat *to, const float *factors,
+      glm::quat *out, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      slerpQuatBlockSse4(from + i, to + i, _mm_loadu_ps(factors + i), out + i);
+    }
+    slerpQuatsScalar(from + i, to + i, factors + i, out + i, count - i);
+  }
+
+  SIMD_TARGET_SSE4
+  void lerpVec3sSse4(const glm::vec3 *from, const glm::vec3 *to, float factor,
+      glm::vec3 *out, int count) {
+    const float *fromData = reinterpret_cast<const float*>(from);
+    const float *toData = reinterpret_cast<const float*>(to);
+    float *outData = reinterpret_cast<float*>(out);
+    __m128 t = _mm_set1_ps(factor);
+
+    /* component-wise, the vec3 boundaries do not matter */
+    int numFloats = count * 3;
+    int i = 0;
+    for (; i + 4 <= numFloats; i += 4) {
+      __m128 a = _mm_loadu_ps(fromData + i);
+      __m128 b = _mm_loadu_ps(toData + i);
+      _mm_storeu_ps(outData + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+    }
+    for (; i < numFloats; ++i) {
+      outData[i] = fromData[i] + (toData[i] - fromData[i]) * factor;
+    }
+  }
+
+  SIMD_TARGET_SSE4
+  void lerpVec3sSse4(const glm::vec3 *from, const glm::vec3 *to, const float *factors,
+      glm::vec3 *out, int count) {
+    const float *fromData = reinterpret_cast<const float*>(from);
+    const float *toData = reinterpret_cast<const float*>(to);
+    float *outData = reinterpret_cast<float*>(out);
+
+    /* four vec3 in three registers, the factors are spread to xxxy yyzz zwww */
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m128 t = _mm_loadu_ps(factors + i);
+      __m128 t0 = _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 0, 0, 0));
+      __m128 t1 = _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 1, 1));
+      __m128 t2 = _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 3, 3, 2));
+
+      const float *a = fromData + i * 3;
+      const float *b = toData + i * 3;
+      __m128 a0 = _mm_loadu_ps(a);
+      __m128 a1 = _mm_loadu_ps(a + 4);
+      __m128 a2 = _mm_loadu_ps(a + 8);
+      _mm_storeu_ps(outData + i * 3,
+        _mm_add_ps(a0, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b), a0), t0)));
+      _mm_storeu_ps(outData + i * 3 + 4,
+        _mm_add_ps(a1, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + 4), a1), t1)));
+      _mm_storeu_ps(outData + i * 3 + 8,
+        _mm_add_ps(a2, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + 8), a2), t2)));
+    }
+    lerpVec3sScalar(from + i, to + i, factors + i, out + i, count - i);
+  }
+
+  SIMD_TARGET_SSE4
+  inline void storeMatrixColumnsSse4(glm::mat4 *out, int column, __m128 x, __m128 y,
+      __m128 z, __m128 w) {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(&out[0][column][0], x);
+    _mm_storeu_ps(&out[1][column][0], y);
+    _mm_storeu_ps(&out[2][column][0], z);
+    _mm_storeu_ps(&out[3][column][0], w);
+  }
+
+  SIMD_TARGET_SSE4
+  void composeTRSMatricesSse4(const glm::vec3 *translations, const glm::quat *rotations,
+      const glm::vec3 *scales, glm::mat4 *out, int count) {
+    bool wFirst = quatWFirst();
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 two = _mm_set1_ps(2.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m128 c0, c1, c2, c3;
+      loadQuatsSse4(rotations + i, c0, c1, c2, c3);
+      __m128 qx = wFirst ? c1 : c0;
+      __m128 qy = wFirst ? c2 : c1;
+      __m128 qz = wFirst ? c3 : c2;
+      __m128 qw = wFirst ? c0 : c3;
+
+      const glm::vec3 *t = translations + i;
+      const glm::vec3 *s = scales + i;
+      __m128 tx = _mm_setr_ps(t[0].x, t[1].x, t[2].x, t[3].x);
+      __m128 ty = _mm_setr_ps(t[0].y, t[1].y, t[2].y, t[3].y);
+      __m128 tz = _mm_setr_ps(t[0].z, t[1].z, t[2].z, t[3].z);
+      __m128 sx = _mm_setr_ps(s[0].x, s[1].x, s[2].x, s[3].x);
+      __m128 sy = _mm_setr_ps(s[0].y, s[1].y, s[2].y, s[3].y);
+      __m128 sz = _mm_setr_ps(s[0].z, s[1].z, s[2].z, s[3].z);
+
+      /* same terms as glm::mat3_cast */
+      __m128 xx = _mm_mul_ps(qx, qx);
+      __m128 yy = _mm_mul_ps(qy, qy);
+      __m128 zz = _mm_mul_ps(qz, qz);
+      __m128 xy = _mm_mul_ps(qx, qy);
+      __m128 xz = _mm_mul_ps(qx, qz);
+      __m128 yz = _mm_mul_ps(qy, qz);
+      __m128 wx = _mm_mul_ps(qw, qx);
+      __m128 wy = _mm_mul_ps(qw, qy);
+      __m128 wz = _mm_mul_ps(qw, qz);
+
+      __m128 m00 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+      __m128 m01 = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+      __m128 m02 = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+      __m128 m10 = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+      __m128 m11 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+      __m128 m12 = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+      __m128 m20 = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+      __m128 m21 = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+      __m128 m22 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+      storeMatrixColumnsSse4(out + i, 0, _mm_mul_ps(m00, sx), _mm_mul_ps(m01, sx),
+        _mm_mul_ps(m02, sx), zero);
+      storeMatrixColumnsSse4(out + i, 1, _mm_mul_ps(m10, sy), _mm_mul_ps(m11, sy),
+        _mm_mul_ps(m12, sy), zero);
+      storeMatrixColumnsSse4(out + i, 2, _mm_mul_ps(m20, sz), _mm_mul_ps(m21, sz),
+        _mm_mul_ps(m22, sz), zero);
+      storeMatrixColumnsSse4(out + i, 3, tx, ty, tz, one);
+    }
+    composeTRSMatricesScalar(translations + i, rotations + i, scales + i, out + i, count - i);
+  }
+
+  /* AVX2, eight joints per iteration: joints i..i+3 in the low and i+4..i+7 in the high lane */
+  SIMD_TARGET_AVX2
+  inline __m256 loadLanesAvx2(const float *low, const float *high) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)),
+      _mm_loadu_ps(high), 1);
+  }
+
+  SIMD_TARGET_AVX2
+  inline void storeLanesAvx2(float *low, float *high, __m256 value) {
+    _mm_storeu_ps(low, _mm256_castps256_ps128(value));
+    _mm_storeu_ps(high, _mm256_extractf128_ps(value, 1));
+  }
+
+  /* _MM_TRANSPOSE4_PS on both 128 bit lanes */
+  SIMD_TARGET_AVX2
+  inline void transposeLanesAvx2(__m256 &r0, __m256 &r1, __m256 &r2, __m256 &r3) {
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  }
+
+  SIMD_TARGET_AVX2
+  inline void loadQuatsAvx2(const glm::quat *quats, __m256 &c0, __m256 &c1, __m256 &c2,
+      __m256 &c3) {
+    const float *data = reinterpret_cast<const float*>(quats);
+    c0 = loadLanesAvx2(data, data + 16);
+    c1 = loadLanesAvx2(data + 4, data + 20);
+    c2 = loadLanesAvx2(data + 8, data + 24);
+    c3 = loadLanesAvx2(data + 12, data + 28);
+    transposeLanesAvx2(c0, c1, c2, c3);
+  }
+
+  SIMD_TARGET_AVX2
+  inline void storeQuatsAvx2(glm::quat *quats, __m256 c0, __m256 c1, __m256 c2, __m256 c3) {
+    float *data = reinterpret_cast<float*>(quats);
+    transposeLanesAvx2(c0, c1, c2, c3);
+    storeLanesAvx2(data, data + 16, c0);
+    storeLanesAvx2(data + 4, data + 20, c1);
+    storeLanesAvx2(data + 8, data + 24, c2);
+    storeLanesAvx2(data + 12, data + 28, c3);
+  }
+
+  SIMD_TARGET_AVX2
+  inline __m256 slerpCoefficientAvx2(__m256 t, __m256 cosThetaMinusOne) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 sqrT = _mm256_mul_ps(t, t);
+    __m256 result = one;
+    for (int i = 7; i >= 0; --i) {
+      __m256 b = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(slerpU[i]), sqrT),
+        _mm256_set1_ps(slerpV[i]));
+      result = _mm256_add_ps(one, _mm256_mul_ps(_mm256_mul_ps(b, cosThetaMinusOne), result));
+    }
+    return _mm256_mul_ps(t, result);
+  }
+
+  /* eight joints, the factors are in the same lanes as the joints */
+  SIMD_TARGET_AVX2
+  inline void nlerpQuatBlockAvx2(const glm::quat *from, const glm::quat *to, __m256 toT,
+      glm::quat *out) {
+    __m256 zero = _mm256_setzero_ps();
+    __m256 signBit = _mm256_set1_ps(-0.0f);
+    __m256 fromFactor = _mm256_sub_ps(_mm256_set1_ps(1.0f), toT);
+
+    __m256 a0, a1, a2, a3, b0, b1, b2, b3;
+    loadQuatsAvx2(from, a0, a1, a2, a3);
+    loadQuatsAvx2(to, b0, b1, b2, b3);
+
+    __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a0, b0), _mm256_mul_ps(a1, b1)),
+      _mm256_add_ps(_mm256_mul_ps(a2, b2), _mm256_mul_ps(a3, b3)));
+    __m256 factorTo = _mm256_blendv_ps(toT, _mm256_xor_ps(toT, signBit),
+      _mm256_cmp_ps(dot, zero, _CMP_LT_OQ));
+
+    __m256 r0 = _mm256_add_ps(_mm256_mul_ps(a0, fromFactor), _mm256_mul_ps(b0, factorTo));
+    __m256 r1 = _mm256_add_ps(_mm256_mul_ps(a1, fromFactor), _mm256_mul_ps(b1, factorTo));
+    __m256 r2 = _mm256_add_ps(_mm256_mul_ps(a2, fromFactor), _mm256_mul_ps(b2, factorTo));
+    __m256 r3 = _mm256_add_ps(_mm256_mul_ps(a3, fromFactor), _mm256_mul_ps(b3, factorTo));
+
+    __m256 length = _mm256_sqrt_ps(_mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(r0, r0), _mm256_mul_ps(r1, r1)),
+      _mm256_add_ps(_mm256_mul_ps(r2, r2), _mm256_mul_ps(r3, r3))));
+    storeQuatsAvx2(out, _mm256_div_ps(r0, length), _mm256_div_ps(r1, length),
+      _mm256_div_ps(r2, length), _mm256_div_ps(r3, length));
+  }
+
+  SIMD_TARGET_AVX2
+  inline void slerpQuatBlockAvx2(const glm::quat *from, const glm::quat *to, __m256 toT,
+      glm::quat *out) {
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 signBit = _mm256_set1_ps(-0.0f);
+    __m256 fromT = _mm256_sub_ps(one, toT);
+
+    __m256 a0, a1, a2, a3, b0, b1, b2, b3;
+    loadQuatsAvx2(from, a0, a1, a2, a3);
+    loadQuatsAvx2(to, b0, b1, b2, b3);
+
+    __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a0, b0), _mm256_mul_ps(a1, b1)),
+      _mm256_add_ps(_mm256_mul_ps(a2, b2), _mm256_mul_ps(a3, b3)));
+    __m256 negative = _mm256_cmp_ps(dot, zero, _CMP_LT_OQ);
+    __m256 cosThetaMinusOne = _mm256_sub_ps(_mm256_andnot_ps(signBit, dot), one);
+
+    __m256 fromFactor = slerpCoefficientAvx2(fromT, cosThetaMinusOne);
+    __m256 toFactor = slerpCoefficientAvx2(toT, cosThetaMinusOne);
+    toFactor = _mm256_blendv_ps(toFactor, _mm256_xor_ps(toFactor, signBit), negative);
+
+    storeQuatsAvx2(out,
+      _mm256_add_ps(_mm256_mul_ps(a0, fromFactor), _mm256_mul_ps(b0, toFactor)),
+      _mm256_add_ps(_mm256_mul_ps(a1, fromFactor), _mm256_mul_ps(b1, toFactor)),
+      _mm256_add_ps(_mm256_mul_ps(a2, fromFactor), _mm256_mul_ps(b2, toFactor)),
+      _mm256_add_ps(_mm256_mul_ps(a3, fromFactor), _mm256_mul_ps(b3, toFactor)));
+  }
+
+  SIMD_TARGET_AVX2
+  void nlerpQuatsAvx2(const glm::quat *from, const glm::quat *to, float factor,
+      glm::quat *out, int count) {
+    __m256 toT = _mm256_set1_ps(factor);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+      nlerpQuatBlockAvx2(from + i, to + i, toT, out + i);
+    }
+    nlerpQuatsSse4(from + i, to + i, factor, out + i, count - i);
+  }
+
+  SIMD_TARGET_AVX2
+  void nlerpQuatsAvx2(const glm::quat *from, const glm::quat *to, const float *factors,
+      glm::quat *out, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+      nlerpQuatBlockAvx2(from + i, to + i, _mm256_loadu_ps(factors + i), out + i);
+    }
+    nlerpQuatsSse4(from + i, to + i, factors + i, out + i, count - i);
+  }
+
+  SIMD_TARGET_AVX2
+  void slerpQuatsAvx2(const glm::quat *from, const glm::quat *to, float factor,
+      glm::quat *out, int count) {
+    __m256 toT = _mm256_set1_ps(factor);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+      slerpQuatBlockAvx2(from + i, to + i, toT, out + i);
+    }
+    slerpQuatsSse4(from + i, to + i, factor, out + i, count - i);
+  }
+
+  SIMD_TARGET_AVX2
+  void slerpQuatsAvx2(const glm::quat *from, const glm::quat *to, const float *factors,
+      glm::quat *out, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+      slerpQuatBlockAvx2(from + i, to + i, _mm256_loadu_ps(factors + i), out + i);
+    }
+    slerpQuatsSse4(from + i, to + i, factors + i, out + i, count - i);
+  }
+
+  SIMD_TARGET_AVX2
+  void lerpVec3sAvx2(const glm::vec3 *from, const glm::vec3 *to, float factor,
+      glm::vec3 *out, int count) {
+    const float *fromData = reinterpret_cast<const float*>(from);
+    const float *toData = reinterpret_cast<const float*>(to);
+    float *outData = reinterpret_cast<float*>(out);
+    __m256 t = _mm256_set1_ps(factor);
+
+    int numFloats = count * 3;
+    int i = 0;
+    for (; i + 8 <= numFloats; i += 8) {
+      __m256 a = _mm256_loadu_ps(fromData + i);
+      __m256 b = _mm256_loadu_ps(toData + i);
+      _mm256_storeu_ps(outData + i, _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t)));
+    }
+    for (; i < numFloats; ++i) {
+      outData[i] = fromData[i] + (toData[i] - fromData[i]) * factor;
+    }
+  }
+
+  SIMD_TARGET_AVX2
+  void lerpVec3sAvx2(const glm::vec3 *from, const glm::vec3 *to, const float *factors,
+      glm::vec3 *out, int count) {
+    const float *fromData = reinterpret_cast<const float*>(from);
+    const float *toData = reinterpret_cast<const float*>(to);
+    float *outData = reinterpret_cast<float*>(out);
+    /* eight vec3 in three registers, each float gets the factor of its vec3 */
+    __m256i spread0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+    __m256i spread1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+    __m256i spread2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+      __m256 t = _mm256_loadu_ps(factors + i);
+      const float *a = fromData + i * 3;
+      const float *b = toData + i * 3;
+      float *o = outData + i * 3;
+      __m256 a0 = _mm256_loadu_ps(a);
+      __m256 a1 = _mm256_loadu_ps(a + 8);
+      __m256 a2 = _mm256_loadu_ps(a + 16);
+      _mm256_storeu_ps(o, _mm256_add_ps(a0, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(b), a0),
+        _mm256_permutevar8x32_ps(t, spread0))));
+      _mm256_storeu_ps(o + 8, _mm256_add_ps(a1, _mm256_mul_ps(
+        _mm256_sub_ps(_mm256_loadu_ps(b + 8), a1), _mm256_permutevar8x32_ps(t, spread1))));
+      _mm256_storeu_ps(o + 16, _mm256_add_ps(a2, _mm256_mul_ps(
+        _mm256_sub_ps(_mm256_loadu_ps(b + 16), a2), _mm256_permutevar8x32_ps(t, spread2))));
+    }
+    lerpVec3sSse4(from + i, to + i, factors + i, out + i, count - i);
+  }
+
+  SIMD_TARGET_AVX2
+  inline void storeMatrixColumnsAvx2(glm::mat4 *out, int column, __m256 x, __m256 y,
+      __m256 z, __m256 w) {
+    transposeLanesAvx2(x, y, z, w);
+    storeLanesAvx2(&out[0][column][0], &out[4][column][0], x);
+    storeLanesAvx2(&out[1][column][0], &out[5][column][0], y);
+    storeLanesAvx2(&out[2][column][0], &out[6][column][0], z);
+    storeLanesAvx2(&out[3][column][0], &out[7][column][0], w);
+  }
+
+  SIMD_TARGET_AVX2
+  void composeTRSMatricesAvx2(const glm::vec3 *translations, const glm::quat *rotations,
+      const glm::vec3 *scales, glm::mat4 *out, int count) {
+    bool wFirst = quatWFirst();
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 two = _mm256_set1_ps(2.0f);
+    /* lane n holds joint i + n, for the quaternions and the gathered vec3 components */
+    __m256i vec3Index = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+      __m256 c0, c1, c2, c3;
+      loadQuatsAvx2(rotations + i, c0, c1, c2, c3);
+      __m256 qx = wFirst ? c1 : c0;
+      __m256 qy = wFirst ? c2 : c1;
+      __m256 qz = wFirst ? c3 : c2;
+      __m256 qw = wFirst ? c0 : c3;
+
+      const float *t = reinterpret_cast<const float*>(translations + i);
+      const float *s = reinterpret_cast<const float*>(scales + i);
+      __m256 tx = _mm256_i32gather_ps(t, vec3Index, 4);
+      __m256 ty = _mm256_i32gather_ps(t + 1, vec3Index, 4);
+      __m256 tz = _mm256_i32gather_ps(t + 2, vec3Index, 4);
+      __m256 sx = _mm256_i32gather_ps(s, vec3Index, 4);
+      __m256 sy = _mm256_i32gather_ps(s + 1, vec3Index, 4);
+      __m256 sz = _mm256_i32gather_ps(s + 2, vec3Index, 4);
+
+      __m256 xx = _mm256_mul_ps(qx, qx);
+      __m256 yy = _mm256_mul_ps(qy, qy);
+      __m256 zz = _mm256_mul_ps(qz, qz);
+      __m256 xy = _mm256_mul_ps(qx, qy);
+      __m256 xz = _mm256_mul_ps(qx, qz);
+      __m256 yz = _mm256_mul_ps(qy, qz);
+      __m256 wx = _mm256_mul_ps(qw, qx);
+      __m256 wy = _mm256_mul_ps(qw, qy);
+      __m256 wz = _mm256_mul_ps(qw, qz);
+
+      __m256 m00 = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz)));
+      __m256 m01 = _mm256_mul_ps(two, _mm256_add_ps(xy, wz));
+      __m256 m02 = _mm256_mul_ps(two, _mm256_sub_ps(xz, wy));
+      __m256 m10 = _mm256_mul_ps(two, _mm256_sub_ps(xy, wz));
+      __m256 m11 = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz)));
+      __m256 m12 = _mm256_mul_ps(two, _mm256_add_ps(yz, wx));
+      __m256 m20 = _mm256_mul_ps(two, _mm256_add_ps(xz, wy));
+      __m256 m21 = _mm256_mul_ps(two, _mm256_sub_ps(yz, wx));
+      __m256 m22 = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy)));
+
+      storeMatrixColumnsAvx2(out + i, 0, _mm256_mul_ps(m00, sx), _mm256_mul_ps(m01, sx),
+        _mm256_mul_ps(m02, sx), zero);
+      storeMatrixColumnsAvx2(out + i, 1, _mm256_mul_ps(m10, sy), _mm256_mul_ps(m11, sy),
+        _mm256_mul_ps(m12, sy), zero);
+      storeMatrixColumnsAvx2(out + i, 2, _mm256_mul_ps(m20, sz), _mm256_mul_ps(m21, sz),
+        _mm256_mul_ps(m22, sz), zero);
+      storeMatrixColumnsAvx2(out + i, 3, tx, ty, tz, one);
+    }
+    composeTRSMatricesSse4(translations + i, rotations + i, scales + i, out + i, count - i);
+  }
+#endif
+}
+
+simdLevel SimdMath::detectSimdLevel() {
+#ifdef SIMD_MATH_X86
+  bool hasSse4 = false;
+  bool hasAvx2 = false;
+#if defined(_MSC_VER)
+  int cpuInfo[4];
+  __cpuid(cpuInfo, 0);
+  int maxFunction = cpuInfo[0];
+
+  __cpuid(cpuInfo, 1);
+  hasSse4 = (cpuInfo[2] & (1 << 19)) != 0;
+  /* the OS must save the AVX registers too */
+  bool osSavesYmm = (cpuInfo[2] & (1 << 27)) != 0 && (cpuInfo[2] & (1 << 28)) != 0 &&
+    (_xgetbv(0) & 6) == 6;
+  if (maxFunction >= 7 && osSavesYmm) {
+    __cpuidex(cpuInfo, 7, 0);
+    hasAvx2 = (cpuInfo[1] & (1 << 5)) != 0;
+  }
+#else
+  /* needed as we may run before main() */
+  __builtin_cpu_init();
+  hasSse4 = __builtin_cpu_supports("sse4.1");
+  hasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+  if (hasAvx2 && hasSse4) {
+    return simdLevel::avx2;
+  }
+  if (hasSse4) {
+    return simdLevel::sse4;
+  }
+#endif
+  return simdLevel::scalar;
+}
+
+simdLevel SimdMath::getMaxSimdLevel() {
+  return mMaxSimdLevel;
+}
+
+simdLevel SimdMath::getSimdLevel() {
+  return mSimdLevel;
+}
+
+void SimdMath::setSimdLevel(simdLevel level) {
+  mSimdLevel = std::min(level, mMaxSimdLevel);
+}
+
+std::string SimdMath::getSimdLevelName(simdLevel level) {
+  switch (level) {
+    case simdLevel::avx2:
+      return "AVX2";
+    case simdLevel::sse4:
+      return "SSE4.1";
+    default:
+      return "Scalar";
+  }
+}
+
+void SimdMath::nlerpQuats(const glm::quat *from, const glm::quat *to, float factor,
+    glm::quat *out, int count) {
+  switch (mSimdLevel) {
+#ifdef SIMD_MATH_X86
+    case simdLevel::avx2:
+      nlerpQuatsAvx2(from, to, factor, out, count);
+      break;
+    case simdLevel::sse4:
+      nlerpQuatsSse4(from, to, factor, out, count);
+      break;
+#endif
+    default:
+      nlerpQuatsScalar(from, to, factor, out, count);
+      break;
+  }
+}
+
+void SimdMath::nlerpQuats(const glm::quat *from, const glm::quat *to, const float *factors,
+    glm::quat *out, int count) {
+  switch (mSimdLevel) {
+#ifdef SIMD_MATH_X86
+    case simdLevel::avx2:
+      nlerpQuatsAvx2(from, to, factors, out, count);
+      break;
+    case simdLevel::sse4:
+      nlerpQuatsSse4(from, to, factors, out, count);
+      break;
+#endif
+    default:
+      nlerpQuatsScalar(from, to, factors, out, count);
+      break;
+  }
+}
+
+void SimdMath::slerpQuats(const glm::quat *from, const glm::quat *to, float factor,
+    glm::quat *out, int count) {
+  switch (mSimdLevel) {
+#ifdef SIMD_MATH_X86
+    case simdLevel::avx2:
+      slerpQuatsAvx2(from, to, factor, out, count);
+      break;
+    case simdLevel::sse4:
+      slerpQuatsSse4(from, to, factor, out, count);
+      break;
+#endif
+    default:
+      slerpQuatsScalar(from, to, factor, out, count);
+      break;
+  }
+}
+
+void SimdMath::slerpQuats(const glm::quat *from, const glm::quat *to, const float *factors,
+    glm::quat *out, int count) {
+  switch (mSimdLevel) {
+#ifdef SIMD_MATH_X86
+    case simdLevel::avx2:
+      slerpQuatsAvx2(from, to, factors, out, count);
+      break;
+    case simdLevel::sse4:
+      slerpQuatsSse4(from, to, factors, out, count);
+      break;
+#endif
+    default:
+      slerpQuatsScalar(from, to, factors, out, count);
+      break;
+  }
+}
+
+void SimdMath::lerpVec3s(const glm::vec3 *from, const glm::vec3 *to, float factor,
+    glm::vec3 *out, int count) {
+  switch (mSimdLevel) {
+#ifdef SIMD_MATH_X86
+    case simdLevel::avx2:
+      lerpVec3sAvx2(from, to, factor, out, count);
+      break;
+    case simdLevel::sse4:
+      lerpVec3sSse4(from, to, factor, out, count);
+      break;
+#endif
+    default:
+      lerpVec3sScalar(from, to, factor, out, count);
+      break;
+  }
+}
+
+void SimdMath::lerpVec3s(const glm::vec3 *from, const glm::vec3 *to, const float *factors,
+    glm::vec3 *out, int count) {
+  switch (mSimdLevel) {
+#ifdef SIMD_MATH_X86
+    case simdLevel::avx2:
+      lerpVec3sAvx2(from, to, factors, out, count);
+      break;
+    case simdLevel::sse4:
+      lerpVec3sSse4(from, to, factors, out, count);
+      break;
+#endif
+    default:
+      lerpVec3sScalar(from, to, factors, out, count);
+      break;
+  }
+}
+
+void SimdMath::composeTRSMatrices(const glm::vec3 *translations, const glm::quat *rotations,
+    const glm::vec3 *scales, glm::mat4 *out, int count) {
+  switch (mSimdLevel) {
+#ifdef SIMD_MATH_X86
+    case simdLevel::avx2:
+      composeTRSMatricesAvx2(translations, rotations, scales, out, count);
+      break;
+    case simdLevel::sse4:
+      composeTRSMatricesSse4(translations, rotations, scales, out, count);
+      break;
+#endif
+    default:
+      composeTRSMatricesScalar(translations, rotations, scales, out, count);
+      break;
+  }
+}
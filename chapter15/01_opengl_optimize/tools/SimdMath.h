@@ -0,0 +1,48 @@
+/* batch math kernels for joint data, SSE4.1 / AVX2 / scalar chosen at runtime */
+#pragma once
+#include <string>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+enum class simdLevel {
+  scalar = 0,
+  sse4,
+  avx2
+};
+
+class SimdMath {
+  public:
+    /* best level supported by the CPU, detected once */
+    static simdLevel getMaxSimdLevel();
+    static simdLevel getSimdLevel();
+    /* levels above the supported maximum are clamped */
+    static void setSimdLevel(simdLevel level);
+    static std::string getSimdLevelName(simdLevel level);
+
+    /* out[i] = normalize(from[i] * (1 - factor) + to[i] * factor), shortest path */
+    static void nlerpQuats(const glm::quat *from, const glm::quat *to, float factor,
+      glm::quat *out, int count);
+    /* polynomial slerp approximation, shortest path, max error about 3e-5 */
+    static void slerpQuats(const glm::quat *from, const glm::quat *to, float factor,
+      glm::quat *out, int count);
+    static void lerpVec3s(const glm::vec3 *from, const glm::vec3 *to, float factor,
+      glm::vec3 *out, int count);
+
+    /* the same with a factor per element, for per-joint blend weights */
+    static void nlerpQuats(const glm::quat *from, const glm::quat *to, const float *factors,
+      glm::quat *out, int count);
+    static void slerpQuats(const glm::quat *from, const glm::quat *to, const float *factors,
+      glm::quat *out, int count);
+    static void lerpVec3s(const glm::vec3 *from, const glm::vec3 *to, const float *factors,
+      glm::vec3 *out, int count);
+
+    /* out[i] = T * R * S, without building the three matrices */
+    static void composeTRSMatrices(const glm::vec3 *translations, const glm::quat *rotations,
+      const glm::vec3 *scales, glm::mat4 *out, int count);
+
+  private:
+    static simdLevel detectSimdLevel();
+
+    static simdLevel mMaxSimdLevel;
+    static simdLevel mSimdLevel;
+};
@@ -0,0 +1,64 @@
+/* simple worker pool, splits a range of items across threads */
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <type_traits>
+
+class WorkerPool {
+  public:
+    ~WorkerPool();
+
+    /* numThreads includes the calling thread, 1 runs all jobs on the caller */
+    void init(unsigned int numThreads);
+    void setNumThreads(unsigned int numThreads);
+    unsigned int getNumThreads();
+
+    /* runs jobFunc(start, end) on chunks of [0, numItems) and waits for all chunks, the
+     * job is called through a plain pointer, a std::function would allocate every call */
+    template <typename Func>
+    void parallelFor(size_t numItems, Func &&jobFunc) {
+      runJob(numItems, static_cast<void*>(&jobFunc), [](void *job, size_t start, size_t end) {
+        (*static_cast<std::remove_reference_t<Func>*>(job))(start, end);
+      });
+    }
+
+    /* runs jobFunc() once on every thread of the pool, including the caller, used to
+     * set up the thread_local scratch memory before the frames that must not allocate */
+    template <typename Func>
+    void runOnEachThread(Func &&jobFunc) {
+      runJob(getNumThreads(), static_cast<void*>(&jobFunc), [](void *job, size_t, size_t) {
+        (*static_cast<std::remove_reference_t<Func>*>(job))();
+      }, true);
+    }
+
+    void cleanup();
+
+  private:
+    using JobCall = void (*)(void *job, size_t start, size_t end);
+
+    void runJob(size_t numItems, void *job, JobCall jobCall, bool onEachThread = false);
+    void workerLoop(unsigned int startGeneration);
+    void runChunks();
+
+    std::vector<std::thread> mThreads{};
+
+    std::mutex mMutex;
+    std::condition_variable mStartCondition;
+    std::condition_variable mDoneCondition;
+
+    /* valid while runJob() waits for the chunks */
+    void *mJob = nullptr;
+    JobCall mJobCall = nullptr;
+    /* every thread calls the job once instead of taking chunks */
+    bool mOnEachThread = false;
+    size_t mNumItems = 0;
+    size_t mChunkSize = 1;
+    std::atomic<size_t> mNextItem = 0;
+
+    unsigned int mActiveWorkers = 0;
+    unsigned int mGeneration = 0;
+    bool mShutdown = false;
+};
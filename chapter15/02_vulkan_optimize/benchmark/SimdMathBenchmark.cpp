@@ -0,0 +1,158 @@
+/* microbenchmark of the SimdMath batch kernels against the per-joint glm code */
+#include <vector>
+#include <string>
+#include <random>
+#include <functional>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "SimdMath.h"
+#include "Timer.h"
+#include "Logger.h"
+
+namespace {
+  constexpr int NUM_JOINTS = 1024;
+  constexpr int NUM_ITERATIONS = 2000;
+
+  /* returns nanoseconds per joint, the iteration changes the blend factor */
+  float runBenchmark(std::function<void(int)> func) {
+    /* warm up caches */
+    func(0);
+
+    Timer timer{};
+    timer.start();
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      func(i);
+    }
+    return timer.stop() * 1000000.0f / (NUM_ITERATIONS * NUM_JOINTS);
+  }
+
+  float factorFor(int iteration) {
+    return (iteration % 100) / 100.0f;
+  }
+
+  void printResult(std::string kernelName, float glmTime, std::vector<float> simdTimes) {
+    Logger::log(1, "%-12s glm %7.2f ns", kernelName.c_str(), glmTime);
+    for (size_t i = 0; i < simdTimes.size(); ++i) {
+      Logger::log(1, " | %-6s %7.2f ns (x%.2f)",
+        SimdMath::getSimdLevelName(static_cast<simdLevel>(i)).c_str(), simdTimes.at(i),
+        glmTime / simdTimes.at(i));
+    }
+    Logger::log(1, "\n");
+  }
+}
+
+int main(int argc, char *argv[]) {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+  std::vector<glm::quat> fromQuats(NUM_JOINTS);
+  std::vector<glm::quat> toQuats(NUM_JOINTS);
+  std::vector<glm::quat> outQuats(NUM_JOINTS);
+  std::vector<glm::vec3> fromVecs(NUM_JOINTS);
+  std::vector<glm::vec3> toVecs(NUM_JOINTS);
+  std::vector<glm::vec3> outVecs(NUM_JOINTS);
+  std::vector<glm::mat4> outMatrices(NUM_JOINTS);
+  /* per-joint factors, like the node weights of a masked blend */
+  std::vector<float> factors(NUM_JOINTS);
+
+  for (int i = 0; i < NUM_JOINTS; ++i) {
+    fromQuats.at(i) = glm::normalize(glm::quat(dist(rng), dist(rng), dist(rng), dist(rng)));
+    toQuats.at(i) = glm::normalize(glm::quat(dist(rng), dist(rng), dist(rng), dist(rng)));
+    fromVecs.at(i) = glm::vec3(dist(rng), dist(rng), dist(rng));
+    toVecs.at(i) = glm::vec3(dist(rng), dist(rng), dist(rng)) + 1.5f;
+    factors.at(i) = dist(rng) * 0.5f + 0.5f;
+  }
+
+  simdLevel maxLevel = SimdMath::getMaxSimdLevel();
+  Logger::log(1, "%s: %i joints, %i iterations, best instruction set: %s\n", __FUNCTION__,
+    NUM_JOINTS, NUM_ITERATIONS, SimdMath::getSimdLevelName(maxLevel).c_str());
+
+  /* the glm versions are the per-node code the kernels replace */
+  float glmSlerp = runBenchmark([&](int iteration) {
+    float factor = factorFor(iteration);
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+      outQuats[i] = glm::slerp(fromQuats[i], toQuats[i], factor);
+    }
+  });
+  float glmNlerp = runBenchmark([&](int iteration) {
+    float factor = factorFor(iteration);
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+      glm::quat to = glm::dot(fromQuats[i], toQuats[i]) < 0.0f ? -toQuats[i] : toQuats[i];
+      outQuats[i] = glm::normalize(fromQuats[i] * (1.0f - factor) + to * factor);
+    }
+  });
+  float glmLerp = runBenchmark([&](int iteration) {
+    float factor = factorFor(iteration);
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+      outVecs[i] = fromVecs[i] * (1.0f - factor) + toVecs[i] * factor;
+    }
+  });
+  float glmSlerpFactors = runBenchmark([&](int) {
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+      outQuats[i] = glm::slerp(fromQuats[i], toQuats[i], factors[i]);
+    }
+  });
+  float glmLerpFactors = runBenchmark([&](int) {
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+      outVecs[i] = fromVecs[i] * (1.0f - factors[i]) + toVecs[i] * factors[i];
+    }
+  });
+  float glmTRS = runBenchmark([&](int) {
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+      outMatrices[i] = glm::translate(glm::mat4(1.0f), fromVecs[i]) *
+        glm::mat4_cast(fromQuats[i]) * glm::scale(glm::mat4(1.0f), toVecs[i]);
+    }
+  });
+
+  std::vector<float> simdSlerp{};
+  std::vector<float> simdNlerp{};
+  std::vector<float> simdLerp{};
+  std::vector<float> simdSlerpFactors{};
+  std::vector<float> simdLerpFactors{};
+  std::vector<float> simdTRS{};
+
+  for (int level = 0; level <= static_cast<int>(maxLevel); ++level) {
+    SimdMath::setSimdLevel(static_cast<simdLevel>(level));
+
+    simdSlerp.emplace_back(runBenchmark([&](int iteration) {
+      SimdMath::slerpQuats(fromQuats.data(), toQuats.data(), factorFor(iteration),
+        outQuats.data(), NUM_JOINTS);
+    }));
+    simdNlerp.emplace_back(runBenchmark([&](int iteration) {
+      SimdMath::nlerpQuats(fromQuats.data(), toQuats.data(), factorFor(iteration),
+        outQuats.data(), NUM_JOINTS);
+    }));
+    simdLerp.emplace_back(runBenchmark([&](int iteration) {
+      SimdMath::lerpVec3s(fromVecs.data(), toVecs.data(), factorFor(iteration),
+        outVecs.data(), NUM_JOINTS);
+    }));
+    simdSlerpFactors.emplace_back(runBenchmark([&](int) {
+      SimdMath::slerpQuats(fromQuats.data(), toQuats.data(), factors.data(), outQuats.data(),
+        NUM_JOINTS);
+    }));
+    simdLerpFactors.emplace_back(runBenchmark([&](int) {
+      SimdMath::lerpVec3s(fromVecs.data(), toVecs.data(), factors.data(), outVecs.data(),
+        NUM_JOINTS);
+    }));
+    simdTRS.emplace_back(runBenchmark([&](int) {
+      SimdMath::composeTRSMatrices(fromVecs.data(), fromQuats.data(), toVecs.data(),
+        outMatrices.data(), NUM_JOINTS);
+    }));
+  }
+
+  Logger::log(1, "time per joint:\n");
+  printResult("quat slerp", glmSlerp, simdSlerp);
+  printResult("quat nlerp", glmNlerp, simdNlerp);
+  printResult("vec3 lerp", glmLerp, simdLerp);
+  printResult("slerp/joint", glmSlerpFactors, simdSlerpFactors);
+  printResult("lerp/joint", glmLerpFactors, simdLerpFactors);
+  printResult("TRS matrix", glmTRS, simdTRS);
+
+  /* keep the results alive */
+  float checksum = outQuats.at(0).w + outVecs.at(0).x + outMatrices.at(0)[3][0];
+  Logger::log(2, "%s: checksum %f\n", __FUNCTION__, checksum);
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+
+#include "AnimationLOD.h"
+#include "Logger.h"
+
+void AnimationLOD::init(int numInstances) {
+  mLODLevels.assign(numInstances, 0);
+  /* every instance is due in the first frame */
+  mFramesSinceUpdate.assign(numInstances, 1 << (NUM_LOD_LEVELS - 1));
+  mPendingTimes.assign(numInstances, 0.0f);
+  mDeltaTimes.assign(numInstances, 0.0f);
+
+  mCandidates.reserve(numInstances);
+  mUpdateList.reserve(numInstances);
+  Logger::log(1, "%s: animation LOD initialized for %i instances\n", __FUNCTION__, numInstances);
+}
+
+void AnimationLOD::setEnabled(bool enabled) {
+  mEnabled = enabled;
+}
+
+void AnimationLOD::setDistances(float lod1Distance, float lod2Distance, float lod3Distance) {
+  mDistances.setDistances(lod1Distance, lod2Distance, lod3Distance);
+}
+
+void AnimationLOD::setUpdateBudget(int maxUpdates) {
+  mUpdateBudget = std::max(maxUpdates, 0);
+}
+
+void AnimationLOD::setReduceCulledUpdates(bool reduceUpdates) {
+  mReduceCulledUpdates = reduceUpdates;
+}
+
+void AnimationLOD::selectInstances(const std::vector<std::shared_ptr<GltfInstance>> &instances,
+    const std::vector<bool> &visibleInstances, glm::vec3 cameraPos, int fieldOfView,
+    float deltaTime, int forcedInstance) {
+  int numInstances = static_cast<int>(instances.size());
+  if (static_cast<int>(mLODLevels.size()) != numInstances) {
+    init(numInstances);
+  }
+
+  ++mFrameCount;
+  std::fill(std::begin(mInstanceCounts), std::end(mInstanceCounts), 0);
+  std::fill(std::begin(mUpdateCounts), std::end(mUpdateCounts), 0);
+  mCandidates.clear();
+  mUpdateList.clear();
+
+  float fovScale = LODDistances::getFieldOfViewScale(fieldOfView);
+
+  for (int i = 0; i < numInstances; ++i) {
+    mPendingTimes.at(i) += deltaTime;
+    ++mFramesSinceUpdate.at(i);
+
+    /* the selected instance is edited in the UI, always animate it at full rate */
+    int level = 0;
+    if (mReduceCulledUpdates && i != forcedInstance && !visibleInstances.at(i)) {
+      /* the pose is not seen, it only has to be close enough when the instance appears */
+      level = NUM_LOD_LEVELS - 1;
+    } else if (mEnabled && i != forcedInstance) {
+      level = mDistances.getLevel(instances.at(i)->getWorldPosition(), cameraPos, fovScale);
+    }
+    mLODLevels.at(i) = level;
+    ++mInstanceCounts[level];
+
+    /* stagger the instances of a level over its interval to spread the load evenly,
+     * instances deferred by the budget or moved to a nearer level are due too */
+    int interval = 1 << level;
+    if ((mFrameCount + i) % interval == 0 || mFramesSinceUpdate.at(i) >= interval) {
+      mCandidates.emplace_back(i);
+    }
+  }
+
+  if (mEnabled && mUpdateBudget > 0 && static_cast<int>(mCandidates.size()) > mUpdateBudget) {
+    /* most overdue first, measured in intervals of the own level, so deferred far instances
+     * catch up with the near ones instead of waiting behind them forever; the nearer level
+     * wins a tie */
+    std::nth_element(mCandidates.begin(), mCandidates.begin() + mUpdateBudget,
+        mCandidates.end(), [&](int a, int b) {
+      if ((a == forcedInstance) != (b == forcedInstance)) {
+        return a == forcedInstance;
+      }
+      int levelA = mLODLevels.at(a);
+      int levelB = mLODLevels.at(b);
+      /* framesA / intervalA > framesB / intervalB without the division */
+      int overdueA = mFramesSinceUpdate.at(a) << levelB;
+      int overdueB = mFramesSinceUpdate.at(b) << levelA;
+      if (overdueA != overdueB) {
+        return overdueA > overdueB;
+      }
+      return levelA < levelB;
+    });
+    mCandidates.resize(mUpdateBudget);
+  }
+
+  for (const auto index : mCandidates) {
+    mDeltaTimes.at(index) = mPendingTimes.at(index);
+    mPendingTimes.at(index) = 0.0f;
+    mFramesSinceUpdate.at(index) = 0;
+    ++mUpdateCounts[mLODLevels.at(index)];
+    mUpdateList.emplace_back(index);
+  }
+}
+
+const std::vector<int> &AnimationLOD::getUpdateList() {
+  return mUpdateList;
+}
+
+float AnimationLOD::getDeltaTime(int instanceIndex) {
+  return mDeltaTimes.at(instanceIndex);
+}
+
+int AnimationLOD::getLODLevel(int instanceIndex) {
+  return mLODLevels.at(instanceIndex);
+}
+
+int AnimationLOD::getInstanceCount(int level) {
+  return mInstanceCounts[level];
+}
+
+int AnimationLOD::getUpdateCount(int level) {
+  return mUpdateCounts[level];
+}
@@ -7,7 +7,7 @@
 
 class CoordArrowsModel {
   public:
-    VkMesh getVertexData();
+    const VkMesh &getVertexData();
 
   private:
     void init();
@@ -1,7 +1,26 @@
+#include <algorithm>
+#include <cmath>
+
 #include "GltfAnimationChannel.h"
 
-void GltfAnimationChannel::loadChannelData(std::shared_ptr<tinygltf::Model> model, tinygltf::Animation anim, tinygltf::AnimationChannel channel) {
-  mTargetNode = channel.target_node;
+namespace {
+  template <typename T>
+  std::vector<T> gatherKeys(const std::vector<T> &values, const std::vector<int> &keys) {
+    std::vector<T> keptValues{};
+    if (values.empty()) {
+      return keptValues;
+    }
+    keptValues.reserve(keys.size());
+    for (const auto key : keys) {
+      keptValues.push_back(values.at(key));
+    }
+    return keptValues;
+  }
+}
+
+void GltfAnimationChannel::loadChannelData(std::shared_ptr<tinygltf::Model> model, tinygltf::Animation anim, tinygltf::AnimationChannel channel,
+    int targetNode) {
+  mTargetNode = targetNode;
 
   const tinygltf::Accessor& inputAccessor = model->accessors.at(anim.samplers.at(channel.sampler).input);
   const tinygltf::BufferView& inputBufferView = model->bufferViews.at(inputAccessor.bufferView);
@@ -51,7 +70,7 @@ void GltfAnimationChannel::loadChannelData(std::shared_ptr<tinygltf::Model> mode
 }
 
 void GltfAnimationChannel::setTimings(std::vector<float> timinings) {
-  mTimings = timinings;
+  mTimeline = std::make_shared<GltfAnimationTimeline>(timinings);
 }
 
 void GltfAnimationChannel::setScalings(std::vector<glm::vec3> scalings) {
@@ -74,228 +93,247 @@ ETargetPath GltfAnimationChannel::getTargetPath() {
   return mTargetPath;
 }
 
+std::shared_ptr<GltfAnimationTimeline> GltfAnimationChannel::getTimeline() {
+  return mTimeline;
+}
+
+void GltfAnimationChannel::setTimeline(std::shared_ptr<GltfAnimationTimeline> timeline) {
+  mTimeline = timeline;
+}
+
 glm::vec3 GltfAnimationChannel::getScaling(float time) {
-  if (mScaling.size() == 0) {
-    return glm::vec3(1.0f);
-  }
+  return getScaling(mTimeline->findSegment(time));
+}
 
-  if (time < mTimings.at(0)) {
-    return mScaling.at(0);
-  }
-  if (time > mTimings.at(mTimings.size() - 1)) {
-    return mScaling.at(mScaling.size() - 1);
-  }
+glm::vec3 GltfAnimationChannel::getTranslation(float time) {
+  return getTranslation(mTimeline->findSegment(time));
+}
 
-  /* do a simple binary search in O(log n) instead of a array walk in O(n) */
-  int prevTimeIndex = 0;
-  int nextTimeIndex = mScaling.size() - 1;
-  int midIndex = 0;
-  while (prevTimeIndex <= nextTimeIndex) {
-    midIndex = (prevTimeIndex + nextTimeIndex) / 2;
-    if (time > mTimings.at(midIndex)) {
-      prevTimeIndex = midIndex + 1;
-    } else if (time < mTimings.at(midIndex)) {
-      nextTimeIndex = midIndex - 1;
-    } else {
-      break;
-    }
-  }
+glm::quat GltfAnimationChannel::getRotation(float time) {
+  return getRotation(mTimeline->findSegment(time));
+}
 
-  if (prevTimeIndex == nextTimeIndex) {
-    return mScaling.at(prevTimeIndex);
+glm::vec3 GltfAnimationChannel::getScaling(const GltfKeySegment &segment) {
+  if (mTargetPath != ETargetPath::SCALE) {
+    return glm::vec3(1.0f);
   }
 
-  glm::vec3 finalScale = glm::vec3(1.0f);
   switch(mInterType) {
     case EInterpolationType::STEP:
-        finalScale = mScaling.at(prevTimeIndex);
-      break;
+      return getValueKey(mScaling, segment.prevKey);
     case EInterpolationType::LINEAR:
       {
-        float interpolatedTime = (time - mTimings.at(prevTimeIndex)) /
-          (mTimings.at(nextTimeIndex) - mTimings.at(prevTimeIndex));
-
-        glm::vec3 prevScale = mScaling.at(prevTimeIndex);
-        glm::vec3 nextScale = mScaling.at(nextTimeIndex);
-
-        finalScale = prevScale + interpolatedTime * (nextScale - prevScale);
+        glm::vec3 prevScale = getValueKey(mScaling, segment.prevKey);
+        glm::vec3 nextScale = getValueKey(mScaling, segment.nextKey);
+        return prevScale + segment.interpolation * (nextScale - prevScale);
       }
-      break;
     case EInterpolationType::CUBICSPLINE:
+      return getCubicSplineValue(mScaling, segment);
+  }
+  return glm::vec3(1.0f);
+}
+
+glm::vec3 GltfAnimationChannel::getTranslation(const GltfKeySegment &segment) {
+  if (mTargetPath != ETargetPath::TRANSLATION) {
+    return glm::vec3(0.0f);
+  }
+
+  switch(mInterType) {
+    case EInterpolationType::STEP:
+      return getValueKey(mTranslations, segment.prevKey);
+    case EInterpolationType::LINEAR:
       {
-        /* scale tangents */
-        float deltaTime = mTimings.at(nextTimeIndex) - mTimings.at(prevTimeIndex);
-        glm::vec3 prevTangent = deltaTime * mScaling.at(prevTimeIndex * 3 + 2);
-        glm::vec3 nextTangent = deltaTime * mScaling.at(nextTimeIndex * 3);
-
-        float interpolatedTime = (time - mTimings.at(prevTimeIndex)) /
-          (mTimings.at(nextTimeIndex) - mTimings.at(prevTimeIndex));
-        float interpolatedTimeSq = interpolatedTime * interpolatedTime;
-        float interpolatedTimeCub = interpolatedTimeSq * interpolatedTime;
-
-        glm::vec3 prevPoint = mScaling.at(prevTimeIndex * 3 + 1);
-        glm::vec3 nextPoint = mScaling.at(nextTimeIndex * 3 + 1);
-
-        finalScale =
-          (2 * interpolatedTimeCub - 3 * interpolatedTimeSq + 1) * prevPoint +
-          (interpolatedTimeCub - 2 * interpolatedTimeSq + interpolatedTime) * prevTangent +
-          (-2 * interpolatedTimeCub + 3 * interpolatedTimeSq) * nextPoint +
-          (interpolatedTimeCub - interpolatedTimeSq) * nextTangent;
+        glm::vec3 prevTranslate = getValueKey(mTranslations, segment.prevKey);
+        glm::vec3 nextTranslate = getValueKey(mTranslations, segment.nextKey);
+        return prevTranslate + segment.interpolation * (nextTranslate - prevTranslate);
       }
-      break;
+    case EInterpolationType::CUBICSPLINE:
+      return getCubicSplineValue(mTranslations, segment);
   }
-
-  return finalScale;
+  return glm::vec3(0.0f);
 }
 
-glm::vec3 GltfAnimationChannel::getTranslation(float time) {
-  if (mTranslations.size() == 0) {
-    return glm::vec3(0.0f);
+glm::quat GltfAnimationChannel::getRotation(const GltfKeySegment &segment) {
+  if (mTargetPath != ETargetPath::ROTATION) {
+    return glm::identity<glm::quat>();
+  }
+
+  switch(mInterType) {
+    case EInterpolationType::STEP:
+      return getRotationKey(segment.prevKey);
+    case EInterpolationType::LINEAR:
+      return glm::slerp(getRotationKey(segment.prevKey), getRotationKey(segment.nextKey),
+        segment.interpolation);
+    case EInterpolationType::CUBICSPLINE:
+      return getCubicSplineValue(mRotations, segment);
   }
+  return glm::identity<glm::quat>();
+}
 
-  if (time < mTimings.at(0)) {
-    return mTranslations.at(0);
+glm::quat GltfAnimationChannel::getRotationKey(int key) {
+  if (mPackedRotations.empty()) {
+    return mRotations.at(key);
   }
-  if (time > mTimings.at(mTimings.size() - 1)) {
-    return mTranslations.at(mTranslations.size() - 1);
+  return GltfTrackCompression::unpackQuat(mPackedRotations[key]);
+}
+
+glm::vec3 GltfAnimationChannel::getValueKey(const std::vector<glm::vec3> &values, int key) {
+  if (mPackedValues.empty()) {
+    return values.at(key);
   }
+  return GltfTrackCompression::unpackVec3(mPackedValues[key], mValueRangeMin,
+    mValueRangeExtent);
+}
 
-  int prevTimeIndex = 0;
-  int nextTimeIndex = mTranslations.size() - 1;
-  int midIndex = 0;
-  while (prevTimeIndex <= nextTimeIndex) {
-    midIndex = (prevTimeIndex + nextTimeIndex) / 2;
-    if (time > mTimings.at(midIndex)) {
-      prevTimeIndex = midIndex + 1;
-    } else if (time < mTimings.at(midIndex)) {
-      nextTimeIndex = midIndex - 1;
-    } else {
-      break;
+bool GltfAnimationChannel::isConstant(float tolerance) {
+  GltfKeySegment firstKey{};
+  for (int key = 1; key < mTimeline->getKeyCount(); ++key) {
+    if (getKeyError(firstKey, key) > tolerance) {
+      return false;
     }
   }
+  return true;
+}
 
-  if (prevTimeIndex == nextTimeIndex) {
-    return mTranslations.at(prevTimeIndex);
+float GltfAnimationChannel::getKeyError(const GltfKeySegment &segment, int key) {
+  GltfKeySegment keySegment{};
+  keySegment.prevKey = key;
+  keySegment.nextKey = key;
+
+  switch(mTargetPath) {
+    case ETargetPath::ROTATION:
+      return GltfTrackCompression::getQuatError(getRotation(segment), getRotation(keySegment));
+    case ETargetPath::TRANSLATION:
+      return GltfTrackCompression::getVec3Error(getTranslation(segment),
+        getTranslation(keySegment));
+    case ETargetPath::SCALE:
+      return GltfTrackCompression::getVec3Error(getScaling(segment), getScaling(keySegment));
   }
+  return 0.0f;
+}
 
-  glm::vec3 finalTranslate = glm::vec3(0.0f);
-  switch(mInterType) {
-    case EInterpolationType::STEP:
-        finalTranslate = mTranslations.at(prevTimeIndex);
-      break;
+void GltfAnimationChannel::keepKeys(const std::vector<int> &keys,
+    std::shared_ptr<GltfAnimationTimeline> timeline) {
+  mRotations = gatherKeys(mRotations, keys);
+  mTranslations = gatherKeys(mTranslations, keys);
+  mScaling = gatherKeys(mScaling, keys);
+  mTimeline = timeline;
+}
 
-    case EInterpolationType::LINEAR:
-      {
-        float interpolatedTime = (time - mTimings.at(prevTimeIndex)) /
-          (mTimings.at(nextTimeIndex) - mTimings.at(prevTimeIndex));
+EInterpolationType GltfAnimationChannel::getInterpolationType() {
+  return mInterType;
+}
 
-        glm::vec3 prevTranslate = mTranslations.at(prevTimeIndex);
-        glm::vec3 nextTranslate = mTranslations.at(nextTimeIndex);
+bool GltfAnimationChannel::compress(float maxError) {
+  if (isCompressed() || mInterType == EInterpolationType::CUBICSPLINE) {
+    return isCompressed();
+  }
 
-        finalTranslate = prevTranslate + interpolatedTime *
-          (nextTranslate - prevTranslate);
+  switch(mTargetPath) {
+    case ETargetPath::ROTATION:
+      {
+        std::vector<GltfPackedQuat> packedRotations(mRotations.size());
+        for (size_t i = 0; i < mRotations.size(); ++i) {
+          packedRotations.at(i) = GltfTrackCompression::packQuat(mRotations.at(i));
+
+          glm::quat unpacked = GltfTrackCompression::unpackQuat(packedRotations.at(i));
+          if (GltfTrackCompression::getQuatError(glm::normalize(mRotations.at(i)),
+              unpacked) > maxError) {
+            return false;
+          }
+        }
+
+        mPackedRotations = packedRotations;
+        mRotations.clear();
+        mRotations.shrink_to_fit();
       }
       break;
-    case EInterpolationType::CUBICSPLINE:
-      {
-        /* scale tangents */
-        float deltaTime = mTimings.at(nextTimeIndex) - mTimings.at(prevTimeIndex);
-        glm::vec3 prevTangent = deltaTime * mTranslations.at(prevTimeIndex * 3 + 2);
-        glm::vec3 nextTangent = deltaTime * mTranslations.at(nextTimeIndex * 3);
-
-        float interpolatedTime = (time - mTimings.at(prevTimeIndex)) /
-          (mTimings.at(nextTimeIndex) - mTimings.at(prevTimeIndex));
-        float interpolatedTimeSq = interpolatedTime * interpolatedTime;
-        float interpolatedTimeCub = interpolatedTimeSq * interpolatedTime;
-
-        glm::vec3 prevPoint = mTranslations.at(prevTimeIndex * 3 + 1);
-        glm::vec3 nextPoint = mTranslations.at(nextTimeIndex * 3 + 1);
-
-        finalTranslate =
-          (2 * interpolatedTimeCub - 3 * interpolatedTimeSq + 1) * prevPoint +
-          (interpolatedTimeCub - 2 * interpolatedTimeSq + interpolatedTime) * prevTangent +
-          (-2 * interpolatedTimeCub + 3 * interpolatedTimeSq) * nextPoint +
-          (interpolatedTimeCub - interpolatedTimeSq) * nextTangent;
+    case ETargetPath::TRANSLATION:
+      if (!packValues(mTranslations, maxError)) {
+        return false;
       }
+      mTranslations.clear();
+      mTranslations.shrink_to_fit();
+      break;
+    case ETargetPath::SCALE:
+      if (!packValues(mScaling, maxError)) {
+        return false;
+      }
+      mScaling.clear();
+      mScaling.shrink_to_fit();
       break;
   }
-
-  return finalTranslate;
+  return true;
 }
 
-glm::quat GltfAnimationChannel::getRotation(float time) {
-  if (mRotations.size() == 0) {
-    return glm::identity<glm::quat>();
+bool GltfAnimationChannel::packValues(const std::vector<glm::vec3> &values, float maxError) {
+  if (values.empty()) {
+    return false;
   }
 
-  if (time < mTimings.at(0)) {
-    return mRotations.at(0);
-  }
-  if (time > mTimings.at(mTimings.size() - 1)) {
-    return mRotations.at(mRotations.size() - 1);
+  glm::vec3 rangeMin = values.at(0);
+  glm::vec3 rangeMax = values.at(0);
+  for (const auto &value : values) {
+    rangeMin = glm::min(rangeMin, value);
+    rangeMax = glm::max(rangeMax, value);
   }
+  glm::vec3 rangeExtent = rangeMax - rangeMin;
 
-  int prevTimeIndex = 0;
-  int nextTimeIndex = mRotations.size() - 1;
-  int midIndex = 0;
-  while (prevTimeIndex <= nextTimeIndex) {
-    midIndex = (prevTimeIndex + nextTimeIndex) / 2;
-    if (time > mTimings.at(midIndex)) {
-      prevTimeIndex = midIndex + 1;
-    } else if (time < mTimings.at(midIndex)) {
-      nextTimeIndex = midIndex - 1;
-    } else {
-      break;
-    }
-  }
+  std::vector<GltfPackedVec3> packedValues(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    packedValues.at(i) = GltfTrackCompression::packVec3(values.at(i), rangeMin, rangeExtent);
 
-  if (prevTimeIndex == nextTimeIndex) {
-    return mRotations.at(prevTimeIndex);
+    glm::vec3 unpacked = GltfTrackCompression::unpackVec3(packedValues.at(i), rangeMin,
+      rangeExtent);
+    if (GltfTrackCompression::getVec3Error(unpacked, values.at(i)) > maxError) {
+      return false;
+    }
   }
 
-  glm::quat finalRotate = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-  switch(mInterType) {
-    case EInterpolationType::STEP:
-        finalRotate = mRotations.at(prevTimeIndex);
-      break;
-    case EInterpolationType::LINEAR:
-      {
-        float interpolatedTime = (time - mTimings.at(prevTimeIndex)) /
-          (mTimings.at(nextTimeIndex) - mTimings.at(prevTimeIndex));
+  mPackedValues = packedValues;
+  mValueRangeMin = rangeMin;
+  mValueRangeExtent = rangeExtent;
+  return true;
+}
 
-        glm::quat prevRotate = mRotations.at(prevTimeIndex);
-        glm::quat nextRotate = mRotations.at(nextTimeIndex);
+bool GltfAnimationChannel::isCompressed() {
+  return !mPackedRotations.empty() || !mPackedValues.empty();
+}
 
-        finalRotate = glm::slerp(prevRotate, nextRotate, interpolatedTime);
-      }
-      break;
-    case EInterpolationType::CUBICSPLINE:
-      {
-        /* scale tangents */
-        float deltaTime = mTimings.at(nextTimeIndex) - mTimings.at(prevTimeIndex);
-        glm::quat prevTangent = deltaTime * mRotations.at(prevTimeIndex * 3 + 2);
-        glm::quat nextTangent = deltaTime * mRotations.at(nextTimeIndex * 3);
-
-        float interpolatedTime = (time - mTimings.at(prevTimeIndex)) /
-          (mTimings.at(nextTimeIndex) - mTimings.at(prevTimeIndex));
-        float interpolatedTimeSq = interpolatedTime * interpolatedTime;
-        float interpolatedTimeCub = interpolatedTimeSq * interpolatedTime;
-
-        glm::quat prevPoint = mRotations.at(prevTimeIndex * 3 + 1);
-        glm::quat nextPoint = mRotations.at(nextTimeIndex * 3 + 1);
-
-        finalRotate =
-          (2 * interpolatedTimeCub - 3 * interpolatedTimeSq + 1) * prevPoint +
-          (interpolatedTimeCub - 2 * interpolatedTimeSq + interpolatedTime) * prevTangent +
-          (-2 * interpolatedTimeCub + 3 * interpolatedTimeSq) * nextPoint +
-          (interpolatedTimeCub - interpolatedTimeSq) * nextTangent;
-      }
-      break;
+template <typename T>
+T GltfAnimationChannel::getCubicSplineValue(const std::vector<T> &values,
+    const GltfKeySegment &segment) {
+  /* cubic spline data stores in-tangent, value and out-tangent per key */
+  T prevPoint = values.at(segment.prevKey * 3 + 1);
+  if (segment.prevKey == segment.nextKey) {
+    return prevPoint;
   }
-
-  return finalRotate;
+  T nextPoint = values.at(segment.nextKey * 3 + 1);
+
+  /* scale tangents */
+  float deltaTime = mTimeline->getKeyTime(segment.nextKey) -
+    mTimeline->getKeyTime(segment.prevKey);
+  T prevTangent = deltaTime * values.at(segment.prevKey * 3 + 2);
+  T nextTangent = deltaTime * values.at(segment.nextKey * 3);
+
+  float interpolatedTime = segment.interpolation;
+  float interpolatedTimeSq = interpolatedTime * interpolatedTime;
+  float interpolatedTimeCub = interpolatedTimeSq * interpolatedTime;
+
+  return
+    (2 * interpolatedTimeCub - 3 * interpolatedTimeSq + 1) * prevPoint +
+    (interpolatedTimeCub - 2 * interpolatedTimeSq + interpolatedTime) * prevTangent +
+    (-2 * interpolatedTimeCub + 3 * interpolatedTimeSq) * nextPoint +
+    (interpolatedTimeCub - interpolatedTimeSq) * nextTangent;
 }
 
 float GltfAnimationChannel::getMaxTime() {
-  return mTimings.at(mTimings.size() - 1);
+  return mTimeline->getMaxTime();
+}
+
+size_t GltfAnimationChannel::getDataSize() {
+  /* without the key times, the timeline may be shared with other channels */
+  return mScaling.size() * sizeof(glm::vec3) + mTranslations.size() * sizeof(glm::vec3) +
+    mRotations.size() * sizeof(glm::quat) + mPackedRotations.size() * sizeof(GltfPackedQuat) +
+    mPackedValues.size() * sizeof(GltfPackedVec3);
 }
@@ -7,6 +7,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include "GltfAnimationTimeline.h"
+#include "GltfTrackCompression.h"
+
 enum class ETargetPath {
   ROTATION,
   TRANSLATION,
@@ -21,28 +24,65 @@ enum class EInterpolationType {
 
 class GltfAnimationChannel {
   public:
-    void loadChannelData(std::shared_ptr<tinygltf::Model> model, tinygltf::Animation anim, tinygltf::AnimationChannel channel);
+    void loadChannelData(std::shared_ptr<tinygltf::Model> model, tinygltf::Animation anim, tinygltf::AnimationChannel channel,
+      int targetNode);
 
     int getTargetNode();
     ETargetPath getTargetPath();
 
+    std::shared_ptr<GltfAnimationTimeline> getTimeline();
+    void setTimeline(std::shared_ptr<GltfAnimationTimeline> timeline);
+
     glm::vec3 getScaling(float time);
     glm::vec3 getTranslation(float time);
     glm::quat getRotation(float time);
+
+    /* sample with a segment already found on the timeline */
+    glm::vec3 getScaling(const GltfKeySegment &segment);
+    glm::vec3 getTranslation(const GltfKeySegment &segment);
+    glm::quat getRotation(const GltfKeySegment &segment);
+
+    /* load-time key reduction, done before the compression */
+    bool isConstant(float tolerance);
+    /* largest component difference between a key and the value sampled at its time */
+    float getKeyError(const GltfKeySegment &segment, int key);
+    void keepKeys(const std::vector<int> &keys, std::shared_ptr<GltfAnimationTimeline> timeline);
+    EInterpolationType getInterpolationType();
+
+    /* quantized keys for STEP and LINEAR tracks, the float keys are released
+     * if all decoded keys are within maxError, cubic splines stay floats */
+    bool compress(float maxError);
+    bool isCompressed();
+
     float getMaxTime();
+    size_t getDataSize();
 
   private:
+    /* index of the target node in the skeleton */
     int mTargetNode = -1;
     ETargetPath mTargetPath = ETargetPath::ROTATION;
     EInterpolationType mInterType = EInterpolationType::LINEAR;
 
-    std::vector<float> mTimings{};
+    std::shared_ptr<GltfAnimationTimeline> mTimeline = nullptr;
     std::vector<glm::vec3> mScaling{};
     std::vector<glm::vec3> mTranslations{};
     std::vector<glm::quat> mRotations{};
 
+    /* translations or scales, depending on the target path */
+    std::vector<GltfPackedQuat> mPackedRotations{};
+    std::vector<GltfPackedVec3> mPackedValues{};
+    glm::vec3 mValueRangeMin = glm::vec3(0.0f);
+    glm::vec3 mValueRangeExtent = glm::vec3(0.0f);
+
     void setTimings(std::vector<float> timinings);
     void setScalings(std::vector<glm::vec3> scalings);
     void setTranslations(std::vector<glm::vec3> tranlations);
     void setRotations(std::vector<glm::quat> rotations);
+
+    glm::quat getRotationKey(int key);
+    glm::vec3 getValueKey(const std::vector<glm::vec3> &values, int key);
+    bool packValues(const std::vector<glm::vec3> &values, float maxError);
+
+    template <typename T>
+    T getCubicSplineValue(const std::vector<T> &values, const GltfKeySegment &segment);
 };
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cmath>
+
+#include "GltfAnimationTimeline.h"
+#include "GltfTrackCompression.h"
+
+GltfAnimationTimeline::GltfAnimationTimeline(std::vector<float> keyTimes) :
+  mKeyTimes(keyTimes) {}
+
+GltfKeySegment GltfAnimationTimeline::findSegment(float time, int &cursorKey) const {
+  GltfKeySegment segment{};
+  int lastKey = getKeyCount() - 1;
+
+  if (lastKey <= 0 || time <= getKeyTime(0)) {
+    return segment;
+  }
+  if (time >= getKeyTime(lastKey)) {
+    segment.prevKey = lastKey;
+    segment.nextKey = lastKey;
+    return segment;
+  }
+
+  /* playback moves forward a little per frame, mostly the same or the next segment */
+  int key = std::clamp(cursorKey, 0, lastKey - 1);
+  if (time < getKeyTime(key) || time >= getKeyTime(key + 1)) {
+    if (key + 2 <= lastKey && time >= getKeyTime(key + 1) && time < getKeyTime(key + 2)) {
+      ++key;
+    } else {
+      /* jumps and loop restarts, binary search for the last key not after the time */
+      int low = 0;
+      int high = lastKey;
+      while (high - low > 1) {
+        int mid = (low + high) / 2;
+        if (getKeyTime(mid) <= time) {
+          low = mid;
+        } else {
+          high = mid;
+        }
+      }
+      key = low;
+    }
+  }
+  cursorKey = key;
+
+  float prevTime = getKeyTime(key);
+  segment.prevKey = key;
+  if (time == prevTime) {
+    /* exact hit of a key, use it directly */
+    segment.nextKey = key;
+    return segment;
+  }
+
+  segment.nextKey = key + 1;
+  segment.interpolation = (time - prevTime) / (getKeyTime(key + 1) - prevTime);
+  return segment;
+}
+
+GltfKeySegment GltfAnimationTimeline::findSegment(float time) const {
+  int cursorKey = 0;
+  return findSegment(time, cursorKey);
+}
+
+bool GltfAnimationTimeline::compress(float maxError) {
+  if (isCompressed() || mKeyTimes.size() < 2) {
+    return isCompressed();
+  }
+
+  float keyTimeStart = mKeyTimes.front();
+  float keyTimeExtent = mKeyTimes.back() - keyTimeStart;
+
+  std::vector<uint16_t> packedKeyTimes(mKeyTimes.size());
+  for (size_t i = 0; i < mKeyTimes.size(); ++i) {
+    packedKeyTimes.at(i) = GltfTrackCompression::packTime(mKeyTimes.at(i), keyTimeStart,
+      keyTimeExtent);
+
+    float keyTime = GltfTrackCompression::unpackTime(packedKeyTimes.at(i), keyTimeStart,
+      keyTimeExtent);
+    if (std::fabs(keyTime - mKeyTimes.at(i)) > maxError) {
+      return false;
+    }
+    /* merged keys would make an empty segment */
+    if (i > 0 && packedKeyTimes.at(i) == packedKeyTimes.at(i - 1)) {
+      return false;
+    }
+  }
+
+  mPackedKeyTimes = packedKeyTimes;
+  mKeyTimeStart = keyTimeStart;
+  mKeyTimeExtent = keyTimeExtent;
+  mKeyTimes.clear();
+  mKeyTimes.shrink_to_fit();
+  return true;
+}
+
+bool GltfAnimationTimeline::isCompressed() const {
+  return !mPackedKeyTimes.empty();
+}
+
+bool GltfAnimationTimeline::isEqual(const GltfAnimationTimeline &other) const {
+  if (getKeyCount() != other.getKeyCount()) {
+    return false;
+  }
+  for (int i = 0; i < getKeyCount(); ++i) {
+    if (getKeyTime(i) != other.getKeyTime(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int GltfAnimationTimeline::getKeyCount() const {
+  return isCompressed() ? mPackedKeyTimes.size() : mKeyTimes.size();
+}
+
+float GltfAnimationTimeline::getKeyTime(int key) const {
+  if (isCompressed()) {
+    return GltfTrackCompression::unpackTime(mPackedKeyTimes[key], mKeyTimeStart,
+      mKeyTimeExtent);
+  }
+  return mKeyTimes[key];
+}
+
+float GltfAnimationTimeline::getMaxTime() const {
+  return getKeyTime(getKeyCount() - 1);
+}
+
+size_t GltfAnimationTimeline::getDataSize() const {
+  return mKeyTimes.size() * sizeof(float) + mPackedKeyTimes.size() * sizeof(uint16_t);
+}
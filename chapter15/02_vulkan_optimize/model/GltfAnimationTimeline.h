@@ -0,0 +1,44 @@
+/* key times of animation channels, identical timelines of a clip are shared */
+#pragma once
+#include <vector>
+#include <cstdint>
+
+/* the two keys around a sample time, both keys are equal outside the timeline or on a key */
+struct GltfKeySegment {
+  int prevKey = 0;
+  int nextKey = 0;
+  float interpolation = 0.0f;
+};
+
+/* last segment per timeline of a clip, kept per instance and clip to reuse the
+ * segment of the previous frame */
+struct GltfAnimationCursor {
+  std::vector<int> timelineKeys{};
+  std::vector<GltfKeySegment> segments{};
+};
+
+class GltfAnimationTimeline {
+  public:
+    GltfAnimationTimeline(std::vector<float> keyTimes);
+
+    /* checks the segment of the cursor and the next one before searching */
+    GltfKeySegment findSegment(float time, int &cursorKey) const;
+    GltfKeySegment findSegment(float time) const;
+
+    /* 16 bit key times, kept as floats if a key moves more than maxError seconds */
+    bool compress(float maxError);
+    bool isCompressed() const;
+
+    bool isEqual(const GltfAnimationTimeline &other) const;
+    int getKeyCount() const;
+    float getKeyTime(int key) const;
+    float getMaxTime() const;
+    size_t getDataSize() const;
+
+  private:
+    std::vector<float> mKeyTimes{};
+
+    std::vector<uint16_t> mPackedKeyTimes{};
+    float mKeyTimeStart = 0.0f;
+    float mKeyTimeExtent = 0.0f;
+};
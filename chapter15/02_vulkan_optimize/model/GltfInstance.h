@@ -7,7 +7,8 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "GltfModel.h"
-#include "GltfNode.h"
+#include "GltfSkeleton.h"
+#include "GltfPose.h"
 #include "GltfAnimationClip.h"
 #include "IKSolver.h"
 
@@ -21,66 +22,93 @@ class GltfInstance {
 
     void resetNodeData();
 
-    std::shared_ptr<VkMesh> getSkeleton();
     void setSkeletonSplitNode(int nodeNum);
 
     int getJointMatrixSize();
     int getJointDualQuatsSize();
-    std::vector<glm::mat4> getJointMatrices();
-    std::vector<glm::mat2x4> getJointDualQuats();
-
-    void updateAnimation();
-
-    void setInstanceSettings(ModelSettings settings);
-    ModelSettings getInstanceSettings();
+    const std::vector<glm::mat4> &getJointMatrices();
+    const std::vector<glm::mat2x4> &getJointDualQuats();
+    /* write the joint data straight into the (mapped) destination buffer */
+    void copyJointMatrices(glm::mat4 *dest);
+    void copyJointDualQuats(glm::mat2x4 *dest);
+
+    /* deltaTime is the frame time of the global animation clock, in seconds */
+    void updateAnimation(float deltaTime);
+    /* advances the playback time only, for instances posed outside of the instance */
+    void updateAnimationTime(float deltaTime);
+
+    /* distant instances skip the small joint subtrees, IK always uses the full skeleton */
+    void setSkeletonLODLevel(int level);
+    int getSkeletonLODLevel();
+
+    void setInstanceSettings(const ModelSettings &settings);
+    const ModelSettings &getInstanceSettings();
     void checkForUpdates();
 
     glm::vec2 getWorldPosition();
     glm::quat getWorldRotation();
+    /* world space sphere around the posed nodes plus the mesh padding, xyz is the
+     * center and w the radius, follows every update of the node matrices */
+    glm::vec4 getBoundingSphere();
 
     void solveIK();
     void setInverseKinematicsNodes(int effectorNodeNum, int ikChainRootNodeNum);
     void setNumIKIterations(int iterations);
 
   private:
-    void playAnimation(int animNum, float speedDivider, float blendFactor,
-      replayDirection direction);
-    void playAnimation(int sourceAnimNum, int destAnimNum, float speedDivider,
-      float blendFactor, replayDirection direction);
-
     void blendAnimationFrame(int animNumber, float time, float blendFactor);
     void crossBlendAnimationFrame(int sourceAnimNumber, int destAnimNumber, float time,
       float blendFactor);
 
     float getAnimationEndTime(int animNum);
 
-    void getSkeletonPerNode(std::shared_ptr<GltfNode> treeNode);
-    void updateNodeMatrices(std::shared_ptr<GltfNode> treeNode);
-    void updateJointMatrices(std::shared_ptr<GltfNode> treeNode);
-    void updateJointDualQuats(std::shared_ptr<GltfNode> treeNode);
-    void updateAdditiveMask(std::shared_ptr<GltfNode> treeNode, int splitNodeNum);
+    void updateNodeMatrices();
+    void updateNodeMatrices(int nodeIndex);
+    void updateJointData(int startIndex, int endIndex);
+    void updateBoundingSphere();
+    /* the removed joints follow the nearest evaluated joint */
+    void copyLODJointData(int level);
+    void updateJointMatrices(int startIndex, int endIndex);
+    void updateJointDualQuats(int startIndex, int endIndex);
 
     std::shared_ptr<GltfModel> mGltfModel = nullptr;
-    unsigned int mNodeCount = 0;
+    int mNodeCount = 0;
 
-    /* every model needs its onw set of nodes */
-    std::shared_ptr<GltfNode> mRootNode = nullptr;
-    std::vector<std::shared_ptr<GltfNode>> mNodeList{};
+    /* node indices are in skeleton order */
+    std::shared_ptr<GltfSkeleton> mSkeleton = nullptr;
+    GltfPose mPose{};
 
     std::vector<std::shared_ptr<GltfAnimationClip>> mAnimClips{};
-    std::vector<glm::mat4> mInverseBindMatrices{};
+    /* last key segments per clip, playback time mostly stays in the same segment */
+    std::vector<GltfAnimationCursor> mClipCursors{};
     std::vector<glm::mat4> mJointMatrices{};
     std::vector<glm::mat2x4> mJointDualQuats{};
+    glm::vec4 mBoundingSphere = glm::vec4(0.0f);
+    int mSkeletonLODLevel = 0;
 
-    std::vector<int> mNodeToJoint{};
-
-    std::vector<bool> mAdditiveAnimationMask{};
-    std::vector<bool> mInvertedAdditiveAnimationMask{};
-
-    std::shared_ptr<VkMesh> mSkeletonMesh = nullptr;
+    /* 1.0 for the nodes animated by the first clip, 0.0 for the others */
+    std::vector<float> mAdditiveAnimationMask{};
+    bool mFullAnimationMask = true;
+    /* per node blend weights of the two layers, filled every frame */
+    std::vector<float> mSourceNodeWeights{};
+    std::vector<float> mDestNodeWeights{};
 
     ModelSettings mModelSettings{};
 
+    /* accumulated playback time, already scaled by the replay speed */
+    float mPlaybackTime = 0.0f;
+
+    /* settings applied by the last checkForUpdates() call, per instance */
+    blendMode mLastBlendMode = blendMode::fadeinout;
+    int mLastSkelSplitNode = 0;
+    glm::vec2 mLastWorldPos = glm::vec2(0.0f);
+    glm::vec3 mLastWorldRot = glm::vec3(0.0f);
+    glm::vec3 mLastIkTargetPos = glm::vec3(0.0f);
+    ikMode mLastIkMode = ikMode::off;
+    int mLastNumIKIterations = 0;
+    int mLastIkEffectorNode = 0;
+    int mLastIkRootNode = 0;
+
     IKSolver mIKSolver{};
     void solveIKByCCD(glm::vec3 target);
     void solveIKByFABRIK(glm::vec3 target);
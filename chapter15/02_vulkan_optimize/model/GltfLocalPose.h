@@ -0,0 +1,11 @@
+/* local TRS values of all skeleton nodes, in skeleton order */
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+struct GltfLocalPose {
+  std::vector<glm::vec3> translations{};
+  std::vector<glm::quat> rotations{};
+  std::vector<glm::vec3> scales{};
+};
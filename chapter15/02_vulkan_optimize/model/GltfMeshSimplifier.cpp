@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <glm/gtc/packing.hpp>
+
+#include "GltfMeshSimplifier.h"
+
+namespace {
+  /* keeps the open borders (e.g. the neck of a head mesh) in place */
+  constexpr double BOUNDARY_WEIGHT = 10.0;
+  /* error of a collapse between two completely different skinnings, in units of the
+   * normalized mesh size, pushes the collapses away from the joint borders */
+  constexpr double SKIN_WEIGHT = 1.0e-3;
+  /* cosine of the maximum rotation of a triangle during a collapse */
+  constexpr float MIN_NORMAL_COS = 0.25f;
+  /* texture coordinates vs. normals when picking the vertex copy at the new position */
+  constexpr float TEXCOORD_WEIGHT = 4.0f;
+
+  /* symmetric 4x4 matrix of the summed up squared plane distances */
+  struct Quadric {
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+    double b2 = 0.0, bc = 0.0, bd = 0.0;
+    double c2 = 0.0, cd = 0.0;
+    double d2 = 0.0;
+
+    void addPlane(glm::vec3 normal, float distance, double weight) {
+      double a = normal.x;
+      double b = normal.y;
+      double c = normal.z;
+      double d = distance;
+      a2 += weight * a * a; ab += weight * a * b; ac += weight * a * c; ad += weight * a * d;
+      b2 += weight * b * b; bc += weight * b * c; bd += weight * b * d;
+      c2 += weight * c * c; cd += weight * c * d;
+      d2 += weight * d * d;
+    }
+
+    void add(const Quadric &other) {
+      a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+      b2 += other.b2; bc += other.bc; bd += other.bd;
+      c2 += other.c2; cd += other.cd;
+      d2 += other.d2;
+    }
+
+    double getError(glm::vec3 position) const {
+      double x = position.x;
+      double y = position.y;
+      double z = position.z;
+      return a2 * x * x + b2 * y * y + c2 * z * z + d2 +
+        2.0 * (ab * x * y + ac * x * z + bc * y * z + ad * x + bd * y + cd * z);
+    }
+  };
+
+  /* entries are stale if one of the positions changed after they were queued */
+  struct Collapse {
+    double error;
+    uint32_t from;
+    uint32_t to;
+    uint32_t fromVersion;
+    uint32_t toVersion;
+
+    bool operator>(const Collapse &other) const {
+      return error > other.error;
+    }
+  };
+
+  int getJointWeight(const GltfPackedVertex &vertex, uint8_t joint) {
+    int weight = 0;
+    for (int i = 0; i < 4; ++i) {
+      if (vertex.weights[i] != 0 && vertex.joints[i] == joint) {
+        weight += vertex.weights[i];
+      }
+    }
+    return weight;
+  }
+
+  /* difference of the two weight vectors over all joints, 0.0 to 2.0 */
+  float getSkinDistance(const GltfPackedVertex &a, const GltfPackedVertex &b) {
+    int distance = 0;
+    for (int i = 0; i < 4; ++i) {
+      if (a.weights[i] != 0) {
+        distance += std::abs(a.weights[i] - getJointWeight(b, a.joints[i]));
+      }
+      if (b.weights[i] != 0 && getJointWeight(a, b.joints[i]) == 0) {
+        distance += b.weights[i];
+      }
+    }
+    return distance / 255.0f;
+  }
+
+  glm::vec2 unpackTexCoord(const GltfPackedVertex &vertex) {
+    return glm::vec2(glm::unpackHalf1x16(vertex.texCoord[0]),
+      glm::unpackHalf1x16(vertex.texCoord[1]));
+  }
+}
+
+void GltfMeshSimplifier::simplify(const std::vector<uint32_t> &indices,
+    const std::vector<GltfPackedVertex> &vertices, size_t targetIndexCount,
+    std::vector<uint32_t> &result) {
+  if (indices.size() <= targetIndexCount || vertices.empty()) {
+    result = indices;
+    return;
+  }
+
+  /* the collapses work on the positions, the copies of a vertex along hard edges and
+   * texture seams are moved together */
+  std::vector<uint32_t> sortedVertices(vertices.size());
+  std::iota(sortedVertices.begin(), sortedVertices.end(), 0);
+  auto comparePositions = [&](uint32_t a, uint32_t b) {
+    return std::memcmp(&vertices.at(a).position, &vertices.at(b).position, sizeof(glm::vec3));
+  };
+  std::sort(sortedVertices.begin(), sortedVertices.end(),
+    [&](uint32_t a, uint32_t b) { return comparePositions(a, b) < 0; });
+
+  std::vector<uint32_t> vertexPositions(vertices.size());
+  std::vector<glm::vec3> positions;
+  std::vector<std::vector<uint32_t>> positionVertices;
+  for (size_t i = 0; i < sortedVertices.size(); ++i) {
+    uint32_t vertex = sortedVertices.at(i);
+    if (i == 0 || comparePositions(sortedVertices.at(i - 1), vertex) != 0) {
+      positions.emplace_back(vertices.at(vertex).position);
+      positionVertices.emplace_back();
+    }
+    vertexPositions.at(vertex) = static_cast<uint32_t>(positions.size() - 1);
+    positionVertices.back().emplace_back(vertex);
+  }
+
+  /* errors relative to the mesh size, independent of the units of the model */
+  glm::vec3 minPos = positions.at(0);
+  glm::vec3 maxPos = positions.at(0);
+  for (const glm::vec3 &position : positions) {
+    minPos = glm::min(minPos, position);
+    maxPos = glm::max(maxPos, position);
+  }
+  glm::vec3 extent = maxPos - minPos;
+  float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+  float scale = maxExtent > 0.0f ? 1.0f / maxExtent : 1.0f;
+  for (glm::vec3 &position : positions) {
+    position = (position - minPos) * scale;
+  }
+
+  /* triangles made of position numbers, degenerated triangles are dropped right away */
+  size_t triangleCount = indices.size() / 3;
+  std::vector<uint32_t> triangles(triangleCount * 3);
+  std::vector<bool> removed(triangleCount, false);
+  std::vector<std::vector<uint32_t>> positionTriangles(positions.size());
+  size_t liveTriangles = 0;
+  for (size_t t = 0; t < triangleCount; ++t) {
+    for (int k = 0; k < 3; ++k) {
+      triangles.at(t * 3 + k) = vertexPositions.at(indices.at(t * 3 + k));
+    }
+    uint32_t p0 = triangles.at(t * 3);
+    uint32_t p1 = triangles.at(t * 3 + 1);
+    uint32_t p2 = triangles.at(t * 3 + 2);
+    if (p0 == p1 || p1 == p2 || p2 == p0) {
+      removed.at(t) = true;
+      continue;
+    }
+    positionTriangles.at(p0).emplace_back(static_cast<uint32_t>(t));
+    positionTriangles.at(p1).emplace_back(static_cast<uint32_t>(t));
+    positionTriangles.at(p2).emplace_back(static_cast<uint32_t>(t));
+    ++liveTriangles;
+  }
+
+  auto containsPosition = [&](uint32_t triangle, uint32_t position) {
+    return triangles.at(triangle * 3) == position ||
+      triangles.at(triangle * 3 + 1) == position || triangles.at(triangle * 3 + 2) == position;
+  };
+
+  /* area weighted triangle planes, plus perpendicular planes along the borders */
+  std::vector<Quadric> quadrics(positions.size());
+  for (size_t t = 0; t < triangleCount; ++t) {
+    if (removed.at(t)) {
+      continue;
+    }
+    const glm::vec3 &p0 = positions.at(triangles.at(t * 3));
+    glm::vec3 faceNormal = glm::cross(positions.at(triangles.at(t * 3 + 1)) - p0,
+      positions.at(triangles.at(t * 3 + 2)) - p0);
+    float length = glm::length(faceNormal);
+    if (length == 0.0f) {
+      continue;
+    }
+    faceNormal /= length;
+
+    for (int k = 0; k < 3; ++k) {
+      uint32_t position = triangles.at(t * 3 + k);
+      quadrics.at(position).addPlane(faceNormal, -glm::dot(faceNormal, p0), length * 0.5);
+
+      uint32_t next = triangles.at(t * 3 + (k + 1) % 3);
+      int sharedTriangles = 0;
+      for (const uint32_t triangle : positionTriangles.at(position)) {
+        if (containsPosition(triangle, next)) {
+          ++sharedTriangles;
+        }
+      }
+      if (sharedTriangles != 1) {
+        continue;
+      }
+
+      glm::vec3 edge = positions.at(next) - positions.at(position);
+      glm::vec3 borderNormal = glm::cross(edge, faceNormal);
+      float borderLength = glm::length(borderNormal);
+      if (borderLength == 0.0f) {
+        continue;
+      }
+      borderNormal /= borderLength;
+      float distance = -glm::dot(borderNormal, positions.at(position));
+      double weight = BOUNDARY_WEIGHT * glm::dot(edge, edge);
+      quadrics.at(position).addPlane(borderNormal, distance, weight);
+      quadrics.at(next).addPlane(borderNormal, distance, weight);
+    }
+  }
+
+  std::vector<uint32_t> versions(positions.size(), 0);
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+
+  /* the removed position ends up at the remaining position, no new vertices are created */
+  auto addCollapse = [&](uint32_t from, uint32_t to) {
+    Quadric quadric = quadrics.at(from);
+    quadric.add(quadrics.at(to));
+    double error = quadric.getError(positions.at(to)) + SKIN_WEIGHT *
+      getSkinDistance(vertices.at(positionVertices.at(from).at(0)),
+      vertices.at(positionVertices.at(to).at(0)));
+    collapses.push({error, from, to, versions.at(from), versions.at(to)});
+  };
+
+  auto addCollapses = [&](uint32_t position) {
+    for (const uint32_t triangle : positionTriangles.at(position)) {
+      for (int k = 0; k < 3; ++k) {
+        uint32_t other = triangles.at(triangle * 3 + k);
+        if (other != position) {
+          addCollapse(position, other);
+          addCollapse(other, position);
+        }
+      }
+    }
+  };
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    addCollapses(static_cast<uint32_t>(i));
+  }
+
+  size_t targetTriangles = targetIndexCount / 3;
+  while (liveTriangles > targetTriangles && !collapses.empty()) {
+    Collapse collapse = collapses.top();
+    collapses.pop();
+    if (versions.at(collapse.from) != collapse.fromVersion ||
+        versions.at(collapse.to) != collapse.toVersion) {
+      continue;
+    }
+
+    /* the remaining triangles around the removed position must not fold over */
+    bool folded = false;
+    for (const uint32_t triangle : positionTriangles.at(collapse.from)) {
+      if (removed.at(triangle) || containsPosition(triangle, collapse.to)) {
+        continue;
+      }
+      glm::vec3 corners[3];
+      glm::vec3 movedCorners[3];
+      for (int k = 0; k < 3; ++k) {
+        uint32_t position = triangles.at(triangle * 3 + k);
+        corners[k] = positions.at(position);
+        movedCorners[k] = position == collapse.from ? positions.at(collapse.to) : corners[k];
+      }
+      glm::vec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+      glm::vec3 movedNormal = glm::cross(movedCorners[1] - movedCorners[0],
+        movedCorners[2] - movedCorners[0]);
+      if (glm::dot(normal, movedNormal) <=
+          MIN_NORMAL_COS * glm::length(normal) * glm::length(movedNormal)) {
+        folded = true;
+        break;
+      }
+    }
+    if (folded) {
+      continue;
+    }
+
+    std::vector<uint32_t> &targetTriangleList = positionTriangles.at(collapse.to);
+    for (const uint32_t triangle : positionTriangles.at(collapse.from)) {
+      if (removed.at(triangle)) {
+        continue;
+      }
+      if (containsPosition(triangle, collapse.to)) {
+        removed.at(triangle) = true;
+        --liveTriangles;
+        continue;
+      }
+      for (int k = 0; k < 3; ++k) {
+        if (triangles.at(triangle * 3 + k) == collapse.from) {
+          triangles.at(triangle * 3 + k) = collapse.to;
+        }
+      }
+      targetTriangleList.emplace_back(triangle);
+    }
+    positionTriangles.at(collapse.from).clear();
+    targetTriangleList.erase(std::remove_if(targetTriangleList.begin(),
+      targetTriangleList.end(), [&](uint32_t triangle) { return removed.at(triangle); }),
+      targetTriangleList.end());
+
+    quadrics.at(collapse.to).add(quadrics.at(collapse.from));
+    ++versions.at(collapse.from);
+    ++versions.at(collapse.to);
+    addCollapses(collapse.to);
+  }
+
+  result.clear();
+  result.reserve(liveTriangles * 3);
+  for (size_t t = 0; t < triangleCount; ++t) {
+    if (removed.at(t)) {
+      continue;
+    }
+    for (int k = 0; k < 3; ++k) {
+      uint32_t vertex = indices.at(t * 3 + k);
+      uint32_t position = triangles.at(t * 3 + k);
+      if (vertexPositions.at(vertex) == position) {
+        result.emplace_back(vertex);
+        continue;
+      }
+
+      /* the copy at the new position that looks most like the moved vertex */
+      glm::vec3 normal = GltfVertexPacking::unpackNormal(vertices.at(vertex).normal);
+      glm::vec2 texCoord = unpackTexCoord(vertices.at(vertex));
+      uint32_t bestVertex = positionVertices.at(position).at(0);
+      float bestDistance = std::numeric_limits<float>::max();
+      for (const uint32_t candidate : positionVertices.at(position)) {
+        const GltfPackedVertex &candidateVertex = vertices.at(candidate);
+        float distance = 1.0f - glm::dot(normal,
+          GltfVertexPacking::unpackNormal(candidateVertex.normal)) +
+          TEXCOORD_WEIGHT * glm::length(unpackTexCoord(candidateVertex) - texCoord);
+        if (distance < bestDistance) {
+          bestDistance = distance;
+          bestVertex = candidate;
+        }
+      }
+      result.emplace_back(bestVertex);
+    }
+  }
+}
@@ -0,0 +1,16 @@
+/* load time generation of the reduced index lists for the distance levels of the mesh */
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "GltfVertexPacking.h"
+
+class GltfMeshSimplifier {
+  public:
+    /* quadric error edge collapse onto existing vertices until targetIndexCount is reached,
+     * the vertex data is not touched and every vertex keeps its joints and weights */
+    static void simplify(const std::vector<uint32_t> &indices,
+      const std::vector<GltfPackedVertex> &vertices, size_t targetIndexCount,
+      std::vector<uint32_t> &result);
+};
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <limits>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/dual_quaternion.hpp>
@@ -48,18 +49,39 @@ bool GltfModel::loadModel(VkRenderData &renderData, std::string modelFilename,
 
   mModelFilename = modelFilename;
 
-  createVertexBuffers(renderData);
-  createIndexBuffer(renderData);
+  if (!GltfVertexPacking::packVertices(*mModel, mPackedVertices) ||
+      !GltfVertexPacking::getIndices(*mModel, mIndices)) {
+    Logger::log(1, "%s error: could not convert the mesh data\n", __FUNCTION__);
+    return false;
+  }
+
+  if (renderData.rdOptimizeMesh) {
+    optimizeMesh(renderData.rdOptimizeOverdraw);
+  }
+  createMeshLODs();
+
+  if (!createVertexBuffers(renderData) || !createIndexBuffer(renderData)) {
+    return false;
+  }
 
-  /* extract joints, weights, and invers bind matrices*/
+  /* extract joints and weights */
   getJointData();
   getWeightData();
-  getInvBindMatrices();
 
   mNodeCount = mModel->nodes.size();
 
+  /* flat skeleton in parent-before-child order, plus the invers bind matrices */
+  createSkeleton();
+  getInvBindMatrices();
+  mSkeleton->createLODLevels();
+  calculateBoundsPadding();
+
   /* extract animation data */
-  getAnimations();
+  getAnimations(renderData.rdOptimizeClips ? renderData.rdClipKeyTolerance : 0.0f);
+  if (renderData.rdCompressClips) {
+    compressAnimations(renderData.rdClipCompressionMaxError);
+  }
+  setUseBakedClips(renderData.rdUseBakedClips);
 
   return true;
 }
@@ -72,23 +94,64 @@ int GltfModel::getNodeCount() {
   return mNodeCount;
 }
 
-GltfNodeData GltfModel::getGltfNodes() {
-  GltfNodeData nodeData{};
+std::shared_ptr<GltfSkeleton> GltfModel::getSkeleton() {
+  return mSkeleton;
+}
 
+float GltfModel::getBoundsPadding() {
+  return mBoundsPadding;
+}
+
+void GltfModel::createSkeleton() {
   int rootNodeNum = mModel->scenes.at(0).nodes.at(0);
   Logger::log(2, "%s: model has %i nodes, root node is %i\n", __FUNCTION__,
     mNodeCount, rootNodeNum);
 
-  nodeData.rootNode = GltfNode::createRoot(rootNodeNum);
+  mSkeleton = std::make_shared<GltfSkeleton>();
+  addSkeletonNodes(rootNodeNum, -1);
+
+  mSkeletonNodeNames.assign(mNodeCount, "(invalid)");
+  for (int i = 0; i < mSkeleton->getNodeCount(); ++i) {
+    mSkeletonNodeNames.at(mSkeleton->getGltfNodeNum(i)) = mSkeleton->getNodeName(i);
+  }
+
+  Logger::log(1, "%s: skeleton has %i nodes\n", __FUNCTION__, mSkeleton->getNodeCount());
+}
 
-  getNodeData(nodeData.rootNode);
-  getNodes(nodeData.rootNode);
+void GltfModel::addSkeletonNodes(int nodeNum, int parentIndex) {
+  const tinygltf::Node &node = mModel->nodes.at(nodeNum);
 
-  nodeData.nodeList.resize(mNodeCount);
-  nodeData.nodeList.at(rootNodeNum) = nodeData.rootNode;
-  getNodeList(nodeData.nodeList, rootNodeNum);
+  int jointNum = -1;
+  const tinygltf::Skin &skin = mModel->skins.at(0);
+  auto jointIt = std::find(skin.joints.begin(), skin.joints.end(), nodeNum);
+  if (jointIt != skin.joints.end()) {
+    jointNum = std::distance(skin.joints.begin(), jointIt);
+    Logger::log(2, "%s: joint %i affects node %i\n", __FUNCTION__, jointNum, nodeNum);
+  }
+
+  int index = mSkeleton->addNode(nodeNum, parentIndex, node.name, jointNum);
+
+  glm::vec3 translation = glm::vec3(0.0f);
+  glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+  glm::vec3 scale = glm::vec3(1.0f);
+  if (node.translation.size()) {
+    translation = glm::make_vec3(node.translation.data());
+  }
+  if (node.rotation.size()) {
+    rotation = glm::make_quat(node.rotation.data());
+  }
+  if (node.scale.size()) {
+    scale = glm::make_vec3(node.scale.data());
+  }
+  mSkeleton->setBindPose(index, translation, rotation, scale);
 
-  return nodeData;
+  for (const int childNodeNum : node.children) {
+    /* skip the child node with skin/mesh metadata, confuses skeleton */
+    if (mModel->nodes.at(childNodeNum).skin != -1) {
+      continue;
+    }
+    addSkeletonNodes(childNodeNum, index);
+  }
 }
 
 void GltfModel::getJointData() {
@@ -107,15 +170,6 @@ void GltfModel::getJointData() {
 
   std::memcpy(mJointVec.data(), &buffer.data.at(0) + bufferView.byteOffset,
     bufferView.byteLength);
-
-  mNodeToJoint.resize(mModel->nodes.size());
-
-  const tinygltf::Skin &skin = mModel->skins.at(0);
-  for (int i = 0; i < skin.joints.size(); ++i) {
-    int destinationNode = skin.joints.at(i);
-    mNodeToJoint.at(destinationNode) = i;
-    Logger::log(2, "%s: joint %i affects node %i\n", __FUNCTION__, i, destinationNode);
-  }
 }
 
 void GltfModel::getWeightData() {
@@ -144,157 +198,224 @@ void GltfModel::getInvBindMatrices() {
   const tinygltf::BufferView &bufferView = mModel->bufferViews.at(accessor.bufferView);
   const tinygltf::Buffer &buffer = mModel->buffers.at(bufferView.buffer);
 
-  mInverseBindMatrices.resize(skin.joints.size());
+  std::vector<glm::mat4> inverseBindMatrices(skin.joints.size());
 
-  std::memcpy(mInverseBindMatrices.data(), &buffer.data.at(0) + bufferView.byteOffset,
+  std::memcpy(inverseBindMatrices.data(), &buffer.data.at(0) + bufferView.byteOffset,
     bufferView.byteLength);
+  mSkeleton->setInverseBindMatrices(inverseBindMatrices);
 }
 
-void GltfModel::getAnimations() {
+void GltfModel::calculateBoundsPadding() {
+  int positionAccessor = mModel->meshes.at(0).primitives.at(0).attributes.at("POSITION");
+  const tinygltf::Accessor &accessor = mModel->accessors.at(positionAccessor);
+  const tinygltf::BufferView &bufferView = mModel->bufferViews.at(accessor.bufferView);
+  const tinygltf::Buffer &buffer = mModel->buffers.at(bufferView.buffer);
+
+  std::vector<glm::vec3> positions(accessor.count);
+  std::memcpy(positions.data(), &buffer.data.at(0) + bufferView.byteOffset + accessor.byteOffset,
+    accessor.count * sizeof(glm::vec3));
+
+  /* joint positions in the bind pose, the mesh is skinned relative to them */
+  int numJoints = mSkeleton->getJointCount();
+  std::vector<glm::vec3> jointPositions(numJoints);
+  for (int i = 0; i < numJoints; ++i) {
+    jointPositions.at(i) = glm::vec3(glm::inverse(mSkeleton->getInverseBindMatrix(i))[3]);
+  }
+
+  /* the skinned vertices keep roughly their distance to the joint with the largest weight */
+  mBoundsPadding = 0.0f;
+  for (size_t i = 0; i < positions.size() && i < mJointVec.size(); ++i) {
+    const glm::vec4 &weights = mWeightVec.at(i);
+    int mainJoint = 0;
+    for (int j = 1; j < 4; ++j) {
+      if (weights[j] > weights[mainJoint]) {
+        mainJoint = j;
+      }
+    }
+    int jointNum = mJointVec.at(i)[mainJoint];
+    if (jointNum >= numJoints) {
+      continue;
+    }
+    mBoundsPadding = std::max(mBoundsPadding,
+      glm::length(positions.at(i) - jointPositions.at(jointNum)));
+  }
+  Logger::log(1, "%s: bounds padding of the mesh is %f\n", __FUNCTION__, mBoundsPadding);
+}
+
+void GltfModel::getAnimations(float keyTolerance) {
   for (const auto &anim : mModel->animations) {
     Logger::log(1, "%s: loading animation '%s' with %i channels\n", __FUNCTION__,
       anim.name.c_str(), anim.channels.size());
     std::shared_ptr<GltfAnimationClip> clip = std::make_shared<GltfAnimationClip>(anim.name);
     for (const auto& channel : anim.channels) {
-      clip->addChannel(mModel, anim, channel);
+      int targetNode = mSkeleton->getNodeIndex(channel.target_node);
+      if (targetNode < 0) {
+        Logger::log(1, "%s: skipping channel for node %i, not part of the skeleton\n",
+          __FUNCTION__, channel.target_node);
+        continue;
+      }
+      clip->addChannel(mModel, anim, channel, targetNode);
     }
     mAnimClips.push_back(clip);
+    mClipNames.push_back(clip->getClipName());
   }
-}
-
-std::vector<std::shared_ptr<GltfAnimationClip>> GltfModel::getAnimClips() {
-  return mAnimClips;
-}
 
-void GltfModel::getNodes(std::shared_ptr<GltfNode> treeNode) {
-  int nodeNum = treeNode->getNodeNum();
-  std::vector<int> childNodes = mModel->nodes.at(nodeNum).children;
-
-  /* remove the child node with skin/mesh metadata */
-  auto removeIt = std::remove_if(childNodes.begin(), childNodes.end(),
-    [&](int num) { return mModel->nodes.at(num).skin != -1; }
-  );
-  childNodes.erase(removeIt, childNodes.end());
-
-  treeNode->addChilds(childNodes);
+  if (keyTolerance > 0.0f) {
+    optimizeAnimations(keyTolerance);
+  }
 
-  for (auto &childNode : treeNode->getChilds()) {
-    getNodeData(childNode);
-    getNodes(childNode);
+  /* only the keyed channels are baked, constants are set directly */
+  for (auto &clip : mAnimClips) {
+    clip->setSkeletonLODs(*mSkeleton);
+    clip->bakeClip(mClipBakeFrameRate);
   }
 }
 
-void GltfModel::getNodeData(std::shared_ptr<GltfNode> treeNode) {
-  int nodeNum = treeNode->getNodeNum();
-  const tinygltf::Node& node = mModel->nodes.at(nodeNum);
-  treeNode->setNodeName(node.name);
-
-  if (node.translation.size()) {
-    treeNode->setTranslation(glm::make_vec3(node.translation.data()));
+void GltfModel::optimizeAnimations(float keyTolerance) {
+  size_t dataSize = 0;
+  for (auto &clip : mAnimClips) {
+    dataSize += clip->getDataSize();
+    clip->extractConstantTracks(keyTolerance);
   }
-  if (node.rotation.size()) {
-    treeNode->setRotation(glm::make_quat(node.rotation.data()));
+
+  /* translations and scales in the bind pose in all clips are never written, the pose
+   * keeps its bind values for them; IK changes rotations, so these stay constants */
+  int nodeCount = mSkeleton->getNodeCount();
+  std::vector<bool> bindPoseTranslations(nodeCount, true);
+  std::vector<bool> bindPoseScales(nodeCount, true);
+  for (auto &clip : mAnimClips) {
+    std::vector<bool> clipTranslations = clip->getBindPoseTracks(ETargetPath::TRANSLATION,
+      mSkeleton->getBindTranslations(), keyTolerance);
+    std::vector<bool> clipScales = clip->getBindPoseTracks(ETargetPath::SCALE,
+      mSkeleton->getBindScales(), keyTolerance);
+    for (int i = 0; i < nodeCount; ++i) {
+      bindPoseTranslations.at(i) = bindPoseTranslations.at(i) && clipTranslations.at(i);
+      bindPoseScales.at(i) = bindPoseScales.at(i) && clipScales.at(i);
+    }
   }
-  if (node.scale.size()) {
-    treeNode->setScale(glm::make_vec3(node.scale.data()));
+  int numBindPoseTracks = std::count(bindPoseTranslations.begin(), bindPoseTranslations.end(),
+    true) + std::count(bindPoseScales.begin(), bindPoseScales.end(), true);
+
+  size_t optimizedDataSize = 0;
+  int numRemovedKeys = 0;
+  for (auto &clip : mAnimClips) {
+    clip->removeConstantTracks(ETargetPath::TRANSLATION, bindPoseTranslations);
+    clip->removeConstantTracks(ETargetPath::SCALE, bindPoseScales);
+    numRemovedKeys += clip->reduceKeys(keyTolerance);
+    optimizedDataSize += clip->getDataSize();
   }
 
-  treeNode->calculateNodeMatrix();
+  Logger::log(1, "%s: %i bind pose tracks folded, %i keys removed, keyframe data reduced "
+    "from %i to %i bytes\n", __FUNCTION__, numBindPoseTracks, numRemovedKeys, dataSize,
+    optimizedDataSize);
 }
 
-void GltfModel::resetNodeData(std::shared_ptr<GltfNode> treeNode) {
-  getNodeData(treeNode);
+std::vector<std::shared_ptr<GltfAnimationClip>> GltfModel::getAnimClips() {
+  return mAnimClips;
+}
 
-  for (auto &childNode : treeNode->getChilds()) {
-    resetNodeData(childNode);
-  }
+const std::vector<std::string> &GltfModel::getClipNames() {
+  return mClipNames;
+}
+
+const std::vector<std::string> &GltfModel::getSkeletonNodeNames() {
+  return mSkeletonNodeNames;
 }
 
-std::vector<std::shared_ptr<GltfNode>> GltfModel::getNodeList(
-    std::vector<std::shared_ptr<GltfNode>> &nodeList, int nodeNum) {
-  for (auto &childNode : nodeList.at(nodeNum)->getChilds()) {
-    int childNodeNum = childNode->getNodeNum();
-    nodeList.at(childNodeNum) = childNode;
-    getNodeList(nodeList, childNodeNum);
+void GltfModel::compressAnimations(float maxError) {
+  size_t floatDataSize = 0;
+  size_t compressedDataSize = 0;
+  for (auto &clip : mAnimClips) {
+    floatDataSize += clip->getDataSize();
+    clip->compressClip(maxError);
+    compressedDataSize += clip->getDataSize();
   }
-  return nodeList;
+  Logger::log(1, "%s: keyframe data of %i clips compressed from %i to %i bytes\n",
+    __FUNCTION__, mAnimClips.size(), floatDataSize, compressedDataSize);
 }
 
-std::vector<glm::mat4> GltfModel::getInverseBindMatrices() {
-  return mInverseBindMatrices;
+void GltfModel::setUseBakedClips(bool useBakedClips) {
+  for (auto &clip : mAnimClips) {
+    clip->setUseBakedData(useBakedClips);
+  }
 }
 
-std::vector<int> GltfModel::getNodeToJoint() {
-  return mNodeToJoint;
+bool GltfModel::createVertexBuffers(VkRenderData &renderData) {
+  /* one interleaved buffer for position, normal, tex coordinates, joints and weights */
+  return VertexBuffer::init(renderData, mGltfRenderData.rdGltfVertexBufferData,
+    mPackedVertices.size() * sizeof(GltfPackedVertex));
 }
 
-void GltfModel::createVertexBuffers(VkRenderData &renderData) {
-  const tinygltf::Primitive &primitives = mModel->meshes.at(0).primitives.at(0);
-  mGltfRenderData.rdGltfVertexBufferData.resize(primitives.attributes.size());
-  mAttribAccessors.resize(primitives.attributes.size());
+bool GltfModel::createIndexBuffer(VkRenderData &renderData) {
+  /* half of the index data for all meshes with up to 64k vertices */
+  size_t indexSize = sizeof(uint32_t);
+  mIndexType = VK_INDEX_TYPE_UINT32;
+  if (mPackedVertices.size() <= std::numeric_limits<uint16_t>::max() + 1) {
+    indexSize = sizeof(uint16_t);
+    mIndexType = VK_INDEX_TYPE_UINT16;
+  }
 
-  for (const auto& attrib : primitives.attributes) {
-    const std::string attribType = attrib.first;
-    const int accessorNum = attrib.second;
+  return IndexBuffer::init(renderData, mGltfRenderData.rdGltfIndexBufferData,
+    mIndices.size() * indexSize);
+}
 
-    const tinygltf::Accessor &accessor = mModel->accessors.at(accessorNum);
-    const tinygltf::BufferView &bufferView = mModel->bufferViews.at(accessor.bufferView);
-    const tinygltf::Buffer &buffer = mModel->buffers.at(bufferView.buffer);
+void GltfModel::optimizeMesh(bool optimizeOverdraw) {
+  /* FIFO cache size of the ACMR/ATVR statistics, close to current GPUs */
+  const unsigned int cacheSize = 16;
+  size_t vertexCount = mPackedVertices.size();
+  float acmr = GltfMeshOptimizer::getACMR(mIndices, vertexCount, cacheSize);
+  float atvr = GltfMeshOptimizer::getATVR(mIndices, vertexCount, cacheSize);
+
+  GltfMeshOptimizer::weldVertices(mIndices, mPackedVertices);
+  GltfMeshOptimizer::optimizeVertexCache(mIndices, mPackedVertices.size());
+  if (optimizeOverdraw) {
+    GltfMeshOptimizer::optimizeOverdraw(mIndices, mPackedVertices, 1.05f);
+  }
+  GltfMeshOptimizer::optimizeVertexFetch(mIndices, mPackedVertices);
 
-    if ((attribType.compare("POSITION") != 0) && (attribType.compare("NORMAL") != 0)
-        && (attribType.compare("TEXCOORD_0") != 0) && (attribType.compare("JOINTS_0") != 0)
-        && (attribType.compare("WEIGHTS_0") != 0)) {
-      Logger::log(1, "%s: skipping attribute type %s\n", __FUNCTION__, attribType.c_str());
-      continue;
-    }
+  Logger::log(1, "%s: %i vertices welded to %i, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+    __FUNCTION__, vertexCount, mPackedVertices.size(), acmr,
+    GltfMeshOptimizer::getACMR(mIndices, mPackedVertices.size(), cacheSize), atvr,
+    GltfMeshOptimizer::getATVR(mIndices, mPackedVertices.size(), cacheSize));
+}
 
-    Logger::log(1, "%s: data for %s uses accessor %i\n", __FUNCTION__, attribType.c_str(),
-      accessorNum);
-    if (attribType.compare("POSITION") == 0) {
-      int numPositionEntries = accessor.count;
-      Logger::log(1, "%s: loaded %i vertices from glTF file\n", __FUNCTION__,
-        numPositionEntries);
-    }
+void GltfModel::createMeshLODs() {
+  /* all levels are made from the full mesh, the errors do not add up */
+  std::vector<uint32_t> fullIndices = mIndices;
+  std::vector<uint32_t> lodIndices;
 
-    mAttribAccessors.at(attributes.at(attribType)) = accessorNum;
+  mMeshLODs.resize(NUM_MESH_LODS);
+  mMeshLODs.at(0).firstIndex = 0;
+  mMeshLODs.at(0).indexCount = static_cast<uint32_t>(fullIndices.size());
 
-    /* buffers for position, normal, tex coordinates, joints and weights */
-    VertexBuffer::init(renderData,
-      mGltfRenderData.rdGltfVertexBufferData.at(attributes.at(attribType)),
-      bufferView.byteLength);
-  }
-}
+  for (int i = 1; i < NUM_MESH_LODS; ++i) {
+    size_t targetIndexCount = (fullIndices.size() / 3 >> i) * 3;
+    GltfMeshSimplifier::simplify(fullIndices, mPackedVertices, targetIndexCount, lodIndices);
+    GltfMeshOptimizer::optimizeVertexCache(lodIndices, mPackedVertices.size());
 
-void GltfModel::createIndexBuffer(VkRenderData &renderData) {
-  /* buffer for vertex indices */
-  const tinygltf::Primitive &primitives = mModel->meshes.at(0).primitives.at(0);
-  const tinygltf::Accessor &indexAccessor = mModel->accessors.at(primitives.indices);
-  const tinygltf::BufferView &indexBufferView = mModel->bufferViews.at(indexAccessor.bufferView);
-  const tinygltf::Buffer &indexBuffer = mModel->buffers.at(indexBufferView.buffer);
+    mMeshLODs.at(i).firstIndex = static_cast<uint32_t>(mIndices.size());
+    mMeshLODs.at(i).indexCount = static_cast<uint32_t>(lodIndices.size());
+    mIndices.insert(mIndices.end(), lodIndices.begin(), lodIndices.end());
 
-  IndexBuffer::init(renderData, mGltfRenderData.rdGltfIndexBufferData, indexBufferView.byteLength);
+    Logger::log(1, "%s: mesh LOD %i uses %i of %i triangles\n", __FUNCTION__, i,
+      lodIndices.size() / 3, fullIndices.size() / 3);
+  }
 }
 
 void GltfModel::uploadVertexBuffers(VkRenderData& renderData) {
-  for (int i = 0; i < 5; ++i) {
-    const tinygltf::Accessor& accessor = mModel->accessors.at(mAttribAccessors.at(i));
-    const tinygltf::BufferView& bufferView = mModel->bufferViews.at(accessor.bufferView);
-    const tinygltf::Buffer& buffer = mModel->buffers.at(bufferView.buffer);
-
-    VertexBuffer::uploadData(renderData,
-      mGltfRenderData.rdGltfVertexBufferData.at(i), buffer, bufferView);
-  }
+  VertexBuffer::uploadData(renderData, mGltfRenderData.rdGltfVertexBufferData,
+    mPackedVertices.data(), mPackedVertices.size() * sizeof(GltfPackedVertex));
 }
 
 void GltfModel::uploadIndexBuffer(VkRenderData& renderData) {
-  /* buffer for vertex indices */
-  const tinygltf::Primitive& primitives = mModel->meshes.at(0).primitives.at(0);
-  const tinygltf::Accessor& indexAccessor = mModel->accessors.at(primitives.indices);
-  const tinygltf::BufferView& indexBufferView = mModel->bufferViews.at(indexAccessor.bufferView);
-  const tinygltf::Buffer& indexBuffer = mModel->buffers.at(indexBufferView.buffer);
-
-  IndexBuffer::uploadData(renderData, mGltfRenderData.rdGltfIndexBufferData,
-    indexBuffer, indexBufferView);
+  if (mIndexType == VK_INDEX_TYPE_UINT16) {
+    std::vector<uint16_t> shortIndices(mIndices.begin(), mIndices.end());
+    IndexBuffer::uploadData(renderData, mGltfRenderData.rdGltfIndexBufferData,
+      shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+  } else {
+    IndexBuffer::uploadData(renderData, mGltfRenderData.rdGltfIndexBufferData,
+      mIndices.data(), mIndices.size() * sizeof(uint32_t));
+  }
 }
 
 int GltfModel::getTriangleCount() {
@@ -313,6 +434,10 @@ int GltfModel::getTriangleCount() {
   return triangles;
 }
 
+int GltfModel::getLODTriangleCount(int lodLevel) {
+  return mMeshLODs.at(lodLevel).indexCount / 3;
+}
+
 void GltfModel::draw(VkRenderData &renderData) {
   /* texture */
   vkCmdBindDescriptorSets(renderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -321,20 +446,22 @@ void GltfModel::draw(VkRenderData &renderData) {
 
   /* vertex buffer */
   VkDeviceSize offset = 0;
-  for (int i = 0; i < 5; ++i) {
-    vkCmdBindVertexBuffers(renderData.rdCommandBuffer, i, 1,
-      &mGltfRenderData.rdGltfVertexBufferData.at(i).rdVertexBuffer, &offset);
-  }
+  vkCmdBindVertexBuffers(renderData.rdCommandBuffer, 0, 1,
+    &mGltfRenderData.rdGltfVertexBufferData.rdVertexBuffer, &offset);
 
   /* index buffer */
   vkCmdBindIndexBuffer(renderData.rdCommandBuffer,
-    mGltfRenderData.rdGltfIndexBufferData.rdIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    mGltfRenderData.rdGltfIndexBufferData.rdIndexBuffer, 0, mIndexType);
 
-  vkCmdDrawIndexed(renderData.rdCommandBuffer,
-    static_cast<uint32_t>(getTriangleCount() * 3), 1, 0, 0, 0);
+  vkCmdDrawIndexed(renderData.rdCommandBuffer, mMeshLODs.at(0).indexCount, 1, 0, 0, 0);
 }
 
-void GltfModel::drawInstanced(VkRenderData &renderData, int instanceCount) {
+void GltfModel::drawInstanced(VkRenderData &renderData, int instanceCount, int lodLevel,
+    int firstInstance) {
+  if (instanceCount == 0) {
+    return;
+  }
+
   /* texture */
   vkCmdBindDescriptorSets(renderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
     renderData.rdGltfPipelineLayout, 0, 1,
@@ -342,23 +469,20 @@ void GltfModel::drawInstanced(VkRenderData &renderData, int instanceCount) {
 
   /* vertex buffer */
   VkDeviceSize offset = 0;
-  for (int i = 0; i < 5; ++i) {
-    vkCmdBindVertexBuffers(renderData.rdCommandBuffer, i, 1,
-      &mGltfRenderData.rdGltfVertexBufferData.at(i).rdVertexBuffer, &offset);
-  }
+  vkCmdBindVertexBuffers(renderData.rdCommandBuffer, 0, 1,
+    &mGltfRenderData.rdGltfVertexBufferData.rdVertexBuffer, &offset);
 
   /* index buffer */
   vkCmdBindIndexBuffer(renderData.rdCommandBuffer,
-    mGltfRenderData.rdGltfIndexBufferData.rdIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    mGltfRenderData.rdGltfIndexBufferData.rdIndexBuffer, 0, mIndexType);
 
-  vkCmdDrawIndexed(renderData.rdCommandBuffer,
-    static_cast<uint32_t>(getTriangleCount() * 3), instanceCount, 0, 0, 0);
+  const GltfMeshLOD &meshLOD = mMeshLODs.at(lodLevel);
+  vkCmdDrawIndexed(renderData.rdCommandBuffer, meshLOD.indexCount, instanceCount,
+    meshLOD.firstIndex, 0, firstInstance);
 }
 
 void GltfModel::cleanup(VkRenderData &renderData) {
-  for (int i = 0; i < 5 ; ++i) {
-    VertexBuffer::cleanup(renderData, mGltfRenderData.rdGltfVertexBufferData.at(i));
-  }
+  VertexBuffer::cleanup(renderData, mGltfRenderData.rdGltfVertexBufferData);
 
   IndexBuffer::cleanup(renderData, mGltfRenderData.rdGltfIndexBufferData);
 
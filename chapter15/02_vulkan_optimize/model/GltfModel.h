@@ -3,28 +3,36 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <map>
 #include <vulkan/vulkan.h>
 #include <tiny_gltf.h>
 
 #include "Texture.h"
-#include "GltfNode.h"
+#include "GltfSkeleton.h"
 #include "GltfAnimationClip.h"
+#include "GltfVertexPacking.h"
+#include "GltfMeshOptimizer.h"
+#include "GltfMeshSimplifier.h"
 
 #include "VkRenderData.h"
 #include "ModelSettings.h"
 
-struct GltfNodeData {
-    std::shared_ptr<GltfNode> rootNode;
-    std::vector<std::shared_ptr<GltfNode>> nodeList;
+/* range of one distance level inside the shared index buffer */
+struct GltfMeshLOD {
+  uint32_t firstIndex = 0;
+  uint32_t indexCount = 0;
 };
 
 class GltfModel {
   public:
+    /* full mesh plus three levels, each with about half of the triangles of the previous one */
+    static constexpr int NUM_MESH_LODS = 4;
+
     bool loadModel(VkRenderData &renderData, std::string modelFilename,
       std::string textureFilename);
     void draw(VkRenderData &renderData);
-    void drawInstanced(VkRenderData &renderData, int instanceCount);
+    /* gl_InstanceIndex of the shaders starts at firstInstance */
+    void drawInstanced(VkRenderData &renderData, int instanceCount, int lodLevel,
+      int firstInstance);
     void cleanup(VkRenderData &renderData);
     void uploadVertexBuffers(VkRenderData& renderData);
     void uploadIndexBuffer(VkRenderData& renderData);
@@ -32,28 +40,38 @@ class GltfModel {
 
     std::string getModelFilename();
     int getNodeCount();
-    GltfNodeData getGltfNodes();
+    std::shared_ptr<GltfSkeleton> getSkeleton();
+    /* largest distance of a vertex from its main joint, grows the node bounds to the mesh */
+    float getBoundsPadding();
     int getTriangleCount();
+    int getLODTriangleCount(int lodLevel);
 
-    std::vector<glm::mat4> getInverseBindMatrices();
-    std::vector<int> getNodeToJoint();
 
     std::vector<std::shared_ptr<GltfAnimationClip>> getAnimClips();
-
-    void resetNodeData(std::shared_ptr<GltfNode> treeNode);
+    /* UI data, stored once per model instead of in the settings of every instance */
+    const std::vector<std::string> &getClipNames();
+    /* indexed by the glTF node number, "(invalid)" for nodes outside of the skeleton */
+    const std::vector<std::string> &getSkeletonNodeNames();
+    void setUseBakedClips(bool useBakedClips);
 
   private:
-    void createVertexBuffers(VkRenderData& renderData);
-    void createIndexBuffer(VkRenderData& renderData);
+    bool createVertexBuffers(VkRenderData& renderData);
+    bool createIndexBuffer(VkRenderData& renderData);
+    /* welds the vertices, reorders triangles and vertices and logs the cache efficiency */
+    void optimizeMesh(bool optimizeOverdraw);
+    /* simplified index lists of the optimized mesh, appended to the full index list */
+    void createMeshLODs();
 
     void getJointData();
     void getWeightData();
     void getInvBindMatrices();
-    void getAnimations();
-    void getNodes(std::shared_ptr<GltfNode> treeNode);
-    void getNodeData(std::shared_ptr<GltfNode> treeNode);
-    std::vector<std::shared_ptr<GltfNode>> getNodeList(std::vector<std::shared_ptr<GltfNode>>
-      &nodeList, int nodeNum);
+    void calculateBoundsPadding();
+    /* keyTolerance 0 keeps the channels as loaded */
+    void getAnimations(float keyTolerance);
+    void optimizeAnimations(float keyTolerance);
+    void compressAnimations(float maxError);
+    void createSkeleton();
+    void addSkeletonNodes(int nodeNum, int parentIndex);
 
     int mNodeCount = 0;
     std::string mModelFilename;
@@ -62,15 +80,24 @@ class GltfModel {
 
     std::vector<glm::tvec4<uint16_t>> mJointVec{};
     std::vector<glm::vec4> mWeightVec{};
-    std::vector<glm::mat4> mInverseBindMatrices{};
+    float mBoundsPadding = 0.0f;
 
-    std::vector<int> mAttribAccessors{};
-    std::vector<int> mNodeToJoint{};
+    /* all attributes interleaved in one stream, converted when the model is loaded */
+    std::vector<GltfPackedVertex> mPackedVertices{};
+    /* triangle list of the packed vertices, uploaded with 16 bit if the vertex count fits */
+    std::vector<uint32_t> mIndices{};
+    std::vector<GltfMeshLOD> mMeshLODs{};
+    VkIndexType mIndexType = VK_INDEX_TYPE_UINT32;
 
     std::vector<std::shared_ptr<GltfAnimationClip>> mAnimClips{};
+    /* resample rate of the baked clips, matches the 30 fps keys of the model */
+    float mClipBakeFrameRate = 30.0f;
 
-    VkGltfRenderData mGltfRenderData{};
+    /* shared by all instances, they only store their own pose */
+    std::shared_ptr<GltfSkeleton> mSkeleton = nullptr;
 
-    std::map<std::string, GLint> attributes =
-      {{"POSITION", 0}, {"NORMAL", 1}, {"TEXCOORD_0", 2}, {"JOINTS_0", 3}, {"WEIGHTS_0", 4}};
+    std::vector<std::string> mClipNames{};
+    std::vector<std::string> mSkeletonNodeNames{};
+
+    VkGltfRenderData mGltfRenderData{};
 };
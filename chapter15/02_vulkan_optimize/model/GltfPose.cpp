@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <glm/gtx/quaternion.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+
+#include "GltfPose.h"
+#include "SimdMath.h"
+#include "Logger.h"
+
+void GltfPose::init(std::shared_ptr<GltfSkeleton> skeleton) {
+  mSkeleton = skeleton;
+  mNodeMatrices.resize(mSkeleton->getNodeCount());
+  resetToBindPose();
+}
+
+void GltfPose::resetToBindPose() {
+  mLocalPose.translations = mSkeleton->getBindTranslations();
+  mLocalPose.rotations = mSkeleton->getBindRotations();
+  mLocalPose.scales = mSkeleton->getBindScales();
+}
+
+GltfLocalPose &GltfPose::getLocalPose() {
+  return mLocalPose;
+}
+
+void GltfPose::blendRotation(int index, glm::quat rotation, float blendFactor) {
+  float factor = std::clamp(blendFactor, 0.0f, 1.0f);
+  mLocalPose.rotations[index] = glm::slerp(mLocalPose.rotations[index], rotation, factor);
+}
+
+glm::quat GltfPose::getLocalRotation(int index) {
+  return mLocalPose.rotations.at(index);
+}
+
+glm::quat GltfPose::getGlobalRotation(int index) {
+  glm::quat orientation;
+  glm::vec3 scale;
+  glm::vec3 translation;
+  glm::vec3 skew;
+  glm::vec4 perspective;
+
+  if (!glm::decompose(mNodeMatrices.at(index), scale, orientation, translation, skew,
+      perspective)) {
+    Logger::log(1, "%s error: could not decompose matrix for node %i\n", __FUNCTION__,
+      mSkeleton->getGltfNodeNum(index));
+    return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+  }
+
+  return glm::inverse(orientation);
+}
+
+glm::vec3 GltfPose::getGlobalPosition(int index) {
+  /* node matrices have no projective part, translation is the last column */
+  return glm::vec3(mNodeMatrices.at(index)[3]);
+}
+
+void GltfPose::setWorldPosition(glm::vec3 worldPos) {
+  mWorldPosition = worldPos;
+  mWorldTRMatrix = glm::translate(glm::mat4(1.0f), mWorldPosition) *
+    glm::mat4_cast(mWorldRotation);
+}
+
+void GltfPose::setWorldRotation(glm::vec3 worldRot) {
+  mWorldRotation = glm::quat(glm::vec3(
+    glm::radians(worldRot.x),
+    glm::radians(worldRot.y),
+    glm::radians(worldRot.z)
+  ));
+  mWorldTRMatrix = glm::translate(glm::mat4(1.0f), mWorldPosition) *
+    glm::mat4_cast(mWorldRotation);
+}
+
+void GltfPose::updateNodeMatrices() {
+  updateNodeMatrixRange(0, mNodeMatrices.size());
+}
+
+void GltfPose::updateNodeMatrices(int index) {
+  updateNodeMatrixRange(index, mSkeleton->getSubtreeEnd(index));
+}
+
+void GltfPose::updateLODNodeMatrices(int level) {
+  /* the parent of the first node of a range is evaluated in an earlier range */
+  for (const auto &range : mSkeleton->getLODNodeRanges(level)) {
+    updateNodeMatrixRange(range.first, range.second);
+  }
+}
+
+void GltfPose::updateNodeMatrixRange(int startIndex, int endIndex) {
+  const std::vector<int> &parentIndex = mSkeleton->getParentIndices();
+
+  /* local T * R * S matrices of the whole range in one batch, made global in place */
+  SimdMath::composeTRSMatrices(mLocalPose.translations.data() + startIndex,
+    mLocalPose.rotations.data() + startIndex, mLocalPose.scales.data() + startIndex,
+    mNodeMatrices.data() + startIndex, endIndex - startIndex);
+
+  for (int i = startIndex; i < endIndex; ++i) {
+    /* parents are always stored before their children */
+    int parent = parentIndex[i];
+    if (parent < 0) {
+      mNodeMatrices[i] = mWorldTRMatrix * mNodeMatrices[i];
+    } else {
+      mNodeMatrices[i] = mNodeMatrices[parent] * mNodeMatrices[i];
+    }
+  }
+}
+
+glm::mat4 GltfPose::getNodeMatrix(int index) {
+  return mNodeMatrices.at(index);
+}
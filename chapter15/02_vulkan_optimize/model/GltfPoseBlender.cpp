@@ -0,0 +1,55 @@
+#include <algorithm>
+
+#include "GltfPoseBlender.h"
+#include "SimdMath.h"
+
+namespace {
+  /* nodes per batch, the weights and factors of a batch stay on the stack */
+  constexpr int BLEND_BATCH_SIZE = 64;
+}
+
+void GltfPoseBlender::blendPoses(const GltfBlendLayer *layers, int numLayers,
+    GltfLocalPose &result) {
+  const GltfLocalPose &firstPose = *layers[0].pose;
+  int nodeCount = firstPose.rotations.size();
+
+  result.translations.resize(nodeCount);
+  result.rotations.resize(nodeCount);
+  result.scales.resize(nodeCount);
+
+  float totalWeights[BLEND_BATCH_SIZE];
+  float factors[BLEND_BATCH_SIZE];
+
+  /* one pass over the nodes, all layers are blended into a batch while it is in the cache */
+  for (int start = 0; start < nodeCount; start += BLEND_BATCH_SIZE) {
+    int count = std::min(nodeCount - start, BLEND_BATCH_SIZE);
+
+    std::copy_n(firstPose.translations.begin() + start, count,
+      result.translations.begin() + start);
+    std::copy_n(firstPose.rotations.begin() + start, count, result.rotations.begin() + start);
+    std::copy_n(firstPose.scales.begin() + start, count, result.scales.begin() + start);
+    for (int i = 0; i < count; ++i) {
+      totalWeights[i] = layers[0].nodeWeights ?
+        layers[0].weight * layers[0].nodeWeights[start + i] : layers[0].weight;
+    }
+
+    /* the running result has the weight of the layers so far, interpolating to the next
+     * layer by its share of the new total keeps the weighted average */
+    for (int l = 1; l < numLayers; ++l) {
+      for (int i = 0; i < count; ++i) {
+        float weight = layers[l].nodeWeights ?
+          layers[l].weight * layers[l].nodeWeights[start + i] : layers[l].weight;
+        totalWeights[i] += weight;
+        factors[i] = totalWeights[i] > 0.0f ? weight / totalWeights[i] : 0.0f;
+      }
+
+      const GltfLocalPose &pose = *layers[l].pose;
+      SimdMath::lerpVec3s(result.translations.data() + start, pose.translations.data() + start,
+        factors, result.translations.data() + start, count);
+      SimdMath::slerpQuats(result.rotations.data() + start, pose.rotations.data() + start,
+        factors, result.rotations.data() + start, count);
+      SimdMath::lerpVec3s(result.scales.data() + start, pose.scales.data() + start,
+        factors, result.scales.data() + start, count);
+    }
+  }
+}
@@ -0,0 +1,18 @@
+/* weighted blend of any number of local poses in a single pass over the nodes */
+#pragma once
+#include "GltfLocalPose.h"
+
+struct GltfBlendLayer {
+  const GltfLocalPose *pose = nullptr;
+  float weight = 1.0f;
+  /* per node factor of the weight, nullptr uses the weight for all nodes */
+  const float *nodeWeights = nullptr;
+};
+
+class GltfPoseBlender {
+  public:
+    /* the weights of a node are normalized, each layer is interpolated into the result by
+     * its share of the weight so far (slerp for rotations, exact for two layers), nodes
+     * without weight copy the first layer, the result must not be one of the layer poses */
+    static void blendPoses(const GltfBlendLayer *layers, int numLayers, GltfLocalPose &result);
+};
@@ -0,0 +1,251 @@
+#include <algorithm>
+
+#include "GltfSkeleton.h"
+#include "Logger.h"
+
+namespace {
+  /* end chains smaller than this part of the skeleton size are removed, per level; the
+   * last level stays below hands, feet and head, only fingers, toes and face joints go */
+  constexpr float LOD_SUBTREE_SIZES[GltfSkeleton::NUM_LOD_LEVELS] = { 0.0f, 0.02f, 0.05f, 0.08f };
+}
+
+int GltfSkeleton::addNode(int gltfNodeNum, int parentIndex, std::string name, int jointNum) {
+  int index = mParentIndex.size();
+
+  if (parentIndex >= index) {
+    Logger::log(1, "%s error: parent %i of node %i must be added before the node\n",
+      __FUNCTION__, parentIndex, gltfNodeNum);
+    return -1;
+  }
+
+  mParentIndex.push_back(parentIndex);
+  mSubtreeEnd.push_back(index + 1);
+  mGltfNodeNum.push_back(gltfNodeNum);
+  mJointNum.push_back(jointNum);
+  mNodeNames.push_back(name);
+
+  if (gltfNodeNum >= static_cast<int>(mNodeIndex.size())) {
+    mNodeIndex.resize(gltfNodeNum + 1, -1);
+  }
+  mNodeIndex.at(gltfNodeNum) = index;
+
+  /* depth-first order: the new node ends the subtree of all its parents */
+  for (int parent = parentIndex; parent >= 0; parent = mParentIndex.at(parent)) {
+    mSubtreeEnd.at(parent) = index + 1;
+  }
+
+  mBindTranslations.push_back(glm::vec3(0.0f));
+  mBindRotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+  mBindScales.push_back(glm::vec3(1.0f));
+
+  return index;
+}
+
+void GltfSkeleton::setBindPose(int index, glm::vec3 translation, glm::quat rotation,
+    glm::vec3 scale) {
+  mBindTranslations.at(index) = translation;
+  mBindRotations.at(index) = rotation;
+  mBindScales.at(index) = scale;
+}
+
+void GltfSkeleton::setInverseBindMatrices(std::vector<glm::mat4> inverseBindMatrices) {
+  mInverseBindMatrices = inverseBindMatrices;
+}
+
+int GltfSkeleton::getNodeCount() const {
+  return mParentIndex.size();
+}
+
+int GltfSkeleton::getJointCount() const {
+  return mInverseBindMatrices.size();
+}
+
+int GltfSkeleton::getNodeIndex(int gltfNodeNum) const {
+  if (gltfNodeNum < 0 || gltfNodeNum >= static_cast<int>(mNodeIndex.size())) {
+    return -1;
+  }
+  return mNodeIndex.at(gltfNodeNum);
+}
+
+int GltfSkeleton::getGltfNodeNum(int index) const {
+  return mGltfNodeNum.at(index);
+}
+
+int GltfSkeleton::getParentIndex(int index) const {
+  return mParentIndex.at(index);
+}
+
+int GltfSkeleton::getSubtreeEnd(int index) const {
+  return mSubtreeEnd.at(index);
+}
+
+int GltfSkeleton::getJointNum(int index) const {
+  return mJointNum.at(index);
+}
+
+std::string GltfSkeleton::getNodeName(int index) const {
+  return mNodeNames.at(index);
+}
+
+const std::vector<int> &GltfSkeleton::getParentIndices() const {
+  return mParentIndex;
+}
+
+const std::vector<glm::vec3> &GltfSkeleton::getBindTranslations() const {
+  return mBindTranslations;
+}
+
+const std::vector<glm::quat> &GltfSkeleton::getBindRotations() const {
+  return mBindRotations;
+}
+
+const std::vector<glm::vec3> &GltfSkeleton::getBindScales() const {
+  return mBindScales;
+}
+
+const glm::mat4 &GltfSkeleton::getInverseBindMatrix(int jointNum) const {
+  return mInverseBindMatrices.at(jointNum);
+}
+
+std::vector<glm::vec4> GltfSkeleton::createBoneLines(int startNode) const {
+  std::vector<glm::vec4> boneLines{};
+  for (int i = startNode + 1; i < getSubtreeEnd(startNode); ++i) {
+    int parentJointNum = getJointNum(getParentIndex(i));
+    int jointNum = getJointNum(i);
+    /* nodes without a joint have no data in the joint buffers */
+    if (parentJointNum < 0 || jointNum < 0) {
+      continue;
+    }
+
+    /* the joint matrix moves the bind pose origin of the joint to the posed node */
+    glm::vec3 parentPos = glm::vec3(glm::inverse(getInverseBindMatrix(parentJointNum))[3]);
+    glm::vec3 childPos = glm::vec3(glm::inverse(getInverseBindMatrix(jointNum))[3]);
+    boneLines.emplace_back(parentPos, static_cast<float>(parentJointNum));
+    boneLines.emplace_back(childPos, static_cast<float>(jointNum));
+  }
+  Logger::log(1, "%s: created %i bone lines\n", __FUNCTION__, boneLines.size() / 2);
+  return boneLines;
+}
+
+void GltfSkeleton::createLODLevels() {
+  int nodeCount = getNodeCount();
+
+  /* node positions of the bind pose, parents are always stored before their children */
+  std::vector<glm::mat4> bindMatrices(nodeCount);
+  std::vector<glm::vec3> bindPositions(nodeCount);
+  for (int i = 0; i < nodeCount; ++i) {
+    glm::mat4 localMatrix = glm::translate(glm::mat4(1.0f), mBindTranslations.at(i)) *
+      glm::mat4_cast(mBindRotations.at(i)) * glm::scale(glm::mat4(1.0f), mBindScales.at(i));
+    int parent = mParentIndex.at(i);
+    bindMatrices.at(i) = parent < 0 ? localMatrix : bindMatrices.at(parent) * localMatrix;
+    bindPositions.at(i) = glm::vec3(bindMatrices.at(i)[3]);
+  }
+
+  glm::vec3 minPos = bindPositions.at(0);
+  glm::vec3 maxPos = minPos;
+  for (const auto &position : bindPositions) {
+    minPos = glm::min(minPos, position);
+    maxPos = glm::max(maxPos, position);
+  }
+  float skeletonSize = glm::length(maxPos - minPos);
+
+  /* largest distance from a node to the nodes of its subtree */
+  std::vector<float> subtreeSizes(nodeCount, 0.0f);
+  for (int i = 0; i < nodeCount; ++i) {
+    for (int j = i + 1; j < mSubtreeEnd.at(i); ++j) {
+      subtreeSizes.at(i) = std::max(subtreeSizes.at(i),
+        glm::length(bindPositions.at(j) - bindPositions.at(i)));
+    }
+  }
+
+  /* unbranched chains ending in a leaf, in depth-first order a single child follows its
+   * parent directly */
+  std::vector<int> childCounts(nodeCount, 0);
+  for (int i = 1; i < nodeCount; ++i) {
+    ++childCounts.at(mParentIndex.at(i));
+  }
+  std::vector<bool> endChains(nodeCount, false);
+  for (int i = nodeCount - 1; i >= 0; --i) {
+    endChains.at(i) = childCounts.at(i) == 0 || (childCounts.at(i) == 1 && endChains.at(i + 1));
+  }
+
+  mLODMaxLevels.assign(nodeCount, NUM_LOD_LEVELS - 1);
+  for (int level = 0; level < NUM_LOD_LEVELS; ++level) {
+    float minSubtreeSize = LOD_SUBTREE_SIZES[level] * skeletonSize;
+
+    /* nearest evaluated node, the node itself if it is evaluated */
+    std::vector<int> sourceNodes(nodeCount);
+    for (int i = 0; i < nodeCount; ++i) {
+      sourceNodes.at(i) = i;
+      int parent = mParentIndex.at(i);
+      if (parent < 0) {
+        continue;
+      }
+
+      /* the joints of a removed subtree need an evaluated joint to copy from */
+      if (sourceNodes.at(parent) != parent) {
+        sourceNodes.at(i) = sourceNodes.at(parent);
+      } else if (mLODMaxLevels.at(i) < level || (endChains.at(i) &&
+          subtreeSizes.at(i) < minSubtreeSize && mJointNum.at(parent) >= 0)) {
+        sourceNodes.at(i) = parent;
+      }
+      if (sourceNodes.at(i) != i) {
+        mLODMaxLevels.at(i) = std::min(mLODMaxLevels.at(i), level - 1);
+      }
+    }
+
+    mLODNodeRanges[level].clear();
+    mLODJointCopies[level].clear();
+    mLODNodeCounts[level] = 0;
+    mLODBoundsPadding[level] = 0.0f;
+    for (int i = 0; i < nodeCount; ++i) {
+      int source = sourceNodes.at(i);
+      if (source == i) {
+        if (mLODNodeRanges[level].empty() || mLODNodeRanges[level].back().second != i) {
+          mLODNodeRanges[level].emplace_back(i, i + 1);
+        } else {
+          ++mLODNodeRanges[level].back().second;
+        }
+        ++mLODNodeCounts[level];
+        continue;
+      }
+
+      if (mJointNum.at(i) >= 0) {
+        mLODJointCopies[level].emplace_back(mJointNum.at(i), mJointNum.at(source));
+      }
+      mLODBoundsPadding[level] = std::max(mLODBoundsPadding[level],
+        glm::length(bindPositions.at(i) - bindPositions.at(source)));
+    }
+
+    Logger::log(1, "%s: skeleton LOD %i evaluates %i of %i nodes in %i ranges\n", __FUNCTION__,
+      level, mLODNodeCounts[level], nodeCount, mLODNodeRanges[level].size());
+  }
+}
+
+int GltfSkeleton::getLODMaxLevel(int index) const {
+  return mLODMaxLevels.at(index);
+}
+
+const std::vector<int> &GltfSkeleton::getLODMaxLevels() const {
+  return mLODMaxLevels;
+}
+
+const std::vector<std::pair<int, int>> &GltfSkeleton::getLODNodeRanges(int level) const {
+  return mLODNodeRanges[level];
+}
+
+const std::vector<std::pair<int, int>> &GltfSkeleton::getLODJointCopies(int level) const {
+  return mLODJointCopies[level];
+}
+
+int GltfSkeleton::getLODNodeCount(int level) const {
+  return mLODNodeCounts[level];
+}
+
+int GltfSkeleton::getLODJointCount(int level) const {
+  return getJointCount() - mLODJointCopies[level].size();
+}
+
+float GltfSkeleton::getLODBoundsPadding(int level) const {
+  return mLODBoundsPadding[level];
+}
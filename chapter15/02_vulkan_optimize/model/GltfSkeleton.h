@@ -0,0 +1,79 @@
+/* flat glTF skeleton, nodes sorted parent before child
+ * created once per model, shared and never changed by the instances */
+#pragma once
+#include <vector>
+#include <string>
+#include <utility>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+class GltfSkeleton {
+  public:
+    /* level 0 evaluates all nodes, every further level removes more of the small end chains */
+    static constexpr int NUM_LOD_LEVELS = 4;
+
+    /* nodes must be added in depth-first order, parent index -1 marks the root */
+    int addNode(int gltfNodeNum, int parentIndex, std::string name, int jointNum);
+    void setBindPose(int index, glm::vec3 translation, glm::quat rotation, glm::vec3 scale);
+    void setInverseBindMatrices(std::vector<glm::mat4> inverseBindMatrices);
+
+    int getNodeCount() const;
+    int getJointCount() const;
+    int getNodeIndex(int gltfNodeNum) const;
+    int getGltfNodeNum(int index) const;
+    int getParentIndex(int index) const;
+    int getSubtreeEnd(int index) const;
+    int getJointNum(int index) const;
+    std::string getNodeName(int index) const;
+
+    const std::vector<int> &getParentIndices() const;
+    const std::vector<glm::vec3> &getBindTranslations() const;
+    const std::vector<glm::quat> &getBindRotations() const;
+    const std::vector<glm::vec3> &getBindScales() const;
+    const glm::mat4 &getInverseBindMatrix(int jointNum) const;
+
+    /* two entries per bone below startNode, the bind pose position of the parent and of the
+     * child joint in xyz and the joint number in w, posed by the joint data in the shaders */
+    std::vector<glm::vec4> createBoneLines(int startNode) const;
+
+    /* done after the bind pose and the inverse bind matrices are set, removes the end chains
+     * that are small compared to the whole skeleton (fingers, toes, face joints) */
+    void createLODLevels();
+    /* highest level that still evaluates the node */
+    int getLODMaxLevel(int index) const;
+    const std::vector<int> &getLODMaxLevels() const;
+    /* ranges of evaluated nodes as [start, end), parents before children */
+    const std::vector<std::pair<int, int>> &getLODNodeRanges(int level) const;
+    /* joint number of a removed node and the joint number it copies the joint data from */
+    const std::vector<std::pair<int, int>> &getLODJointCopies(int level) const;
+    int getLODNodeCount(int level) const;
+    int getLODJointCount(int level) const;
+    /* largest bind pose distance of a removed node to the node it follows */
+    float getLODBoundsPadding(int level) const;
+
+  private:
+    /* topology, index is the position in the depth-first order */
+    std::vector<int> mParentIndex{};
+    std::vector<int> mSubtreeEnd{};
+    std::vector<int> mGltfNodeNum{};
+    std::vector<int> mJointNum{};
+    std::vector<std::string> mNodeNames{};
+
+    /* glTF node number to index, -1 for nodes not in the skeleton */
+    std::vector<int> mNodeIndex{};
+
+    std::vector<glm::vec3> mBindTranslations{};
+    std::vector<glm::quat> mBindRotations{};
+    std::vector<glm::vec3> mBindScales{};
+
+    /* indexed by joint number, not by node */
+    std::vector<glm::mat4> mInverseBindMatrices{};
+
+    /* removed nodes keep their bind values, so their joint matrix is the matrix of the
+     * nearest evaluated ancestor */
+    std::vector<int> mLODMaxLevels{};
+    std::vector<std::pair<int, int>> mLODNodeRanges[NUM_LOD_LEVELS]{};
+    std::vector<std::pair<int, int>> mLODJointCopies[NUM_LOD_LEVELS]{};
+    int mLODNodeCounts[NUM_LOD_LEVELS] = {};
+    float mLODBoundsPadding[NUM_LOD_LEVELS] = {};
+};
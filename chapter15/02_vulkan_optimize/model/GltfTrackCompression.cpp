@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cmath>
+
+#include "GltfTrackCompression.h"
+
+namespace {
+  /* the three smaller components of a unit quaternion are within +-1/sqrt(2) */
+  constexpr float SMALLEST_THREE_RANGE = 0.70710678f;
+  constexpr float QUAT_COMPONENT_MAX = 32767.0f;
+  constexpr float VALUE_MAX = 65535.0f;
+
+  uint32_t quantize(float value, float rangeStart, float rangeExtent, float maxValue) {
+    if (rangeExtent <= 0.0f) {
+      return 0;
+    }
+    float normalized = std::clamp((value - rangeStart) / rangeExtent, 0.0f, 1.0f);
+    return static_cast<uint32_t>(normalized * maxValue + 0.5f);
+  }
+
+  float dequantize(uint32_t value, float rangeStart, float rangeExtent, float maxValue) {
+    return rangeStart + value / maxValue * rangeExtent;
+  }
+}
+
+GltfPackedQuat GltfTrackCompression::packQuat(glm::quat rotation) {
+  rotation = glm::normalize(rotation);
+
+  int largest = 0;
+  for (int i = 1; i < 4; ++i) {
+    if (std::fabs(rotation[i]) > std::fabs(rotation[largest])) {
+      largest = i;
+    }
+  }
+
+  /* sqrt() rebuilds a positive largest component, the sign bit restores the original
+   * hemisphere, neighbouring baked frames must not flip */
+  bool negative = rotation[largest] < 0.0f;
+  if (negative) {
+    rotation = -rotation;
+  }
+
+  uint64_t bits = largest;
+  for (int i = 0; i < 4; ++i) {
+    if (i == largest) {
+      continue;
+    }
+    bits = (bits << 15) | quantize(rotation[i], -SMALLEST_THREE_RANGE,
+      2.0f * SMALLEST_THREE_RANGE, QUAT_COMPONENT_MAX);
+  }
+
+  /* 2 + 3 * 15 + 1 = 48 bits */
+  bits = (bits << 1) | (negative ? 1 : 0);
+
+  GltfPackedQuat packed{};
+  packed.data[0] = static_cast<uint16_t>(bits >> 32);
+  packed.data[1] = static_cast<uint16_t>(bits >> 16);
+  packed.data[2] = static_cast<uint16_t>(bits);
+  return packed;
+}
+
+glm::quat GltfTrackCompression::unpackQuat(const GltfPackedQuat &packed) {
+  uint64_t bits = (static_cast<uint64_t>(packed.data[0]) << 32) |
+    (static_cast<uint64_t>(packed.data[1]) << 16) | packed.data[2];
+  bool negative = (bits & 1) != 0;
+  bits >>= 1;
+
+  int largest = static_cast<int>(bits >> 45);
+
+  glm::quat rotation;
+  float sumSquares = 0.0f;
+  int shift = 30;
+  for (int i = 0; i < 4; ++i) {
+    if (i == largest) {
+      continue;
+    }
+    float component = dequantize((bits >> shift) & 0x7fff, -SMALLEST_THREE_RANGE,
+      2.0f * SMALLEST_THREE_RANGE, QUAT_COMPONENT_MAX);
+    rotation[i] = component;
+    sumSquares += component * component;
+    shift -= 15;
+  }
+  rotation[largest] = std::sqrt(std::max(1.0f - sumSquares, 0.0f));
+
+  return negative ? -rotation : rotation;
+}
+
+GltfPackedVec3 GltfTrackCompression::packVec3(glm::vec3 value, glm::vec3 rangeMin,
+    glm::vec3 rangeExtent) {
+  GltfPackedVec3 packed{};
+  for (int i = 0; i < 3; ++i) {
+    packed.data[i] = static_cast<uint16_t>(quantize(value[i], rangeMin[i], rangeExtent[i],
+      VALUE_MAX));
+  }
+  return packed;
+}
+
+glm::vec3 GltfTrackCompression::unpackVec3(const GltfPackedVec3 &packed, glm::vec3 rangeMin,
+    glm::vec3 rangeExtent) {
+  return glm::vec3(
+    dequantize(packed.data[0], rangeMin.x, rangeExtent.x, VALUE_MAX),
+    dequantize(packed.data[1], rangeMin.y, rangeExtent.y, VALUE_MAX),
+    dequantize(packed.data[2], rangeMin.z, rangeExtent.z, VALUE_MAX));
+}
+
+float GltfTrackCompression::getQuatError(glm::quat a, glm::quat b) {
+  if (glm::dot(a, b) < 0.0f) {
+    b = -b;
+  }
+  float difference = 0.0f;
+  for (int i = 0; i < 4; ++i) {
+    difference = std::max(difference, std::fabs(a[i] - b[i]));
+  }
+  return difference;
+}
+
+float GltfTrackCompression::getVec3Error(glm::vec3 a, glm::vec3 b) {
+  glm::vec3 difference = glm::abs(a - b);
+  return std::max(difference.x, std::max(difference.y, difference.z));
+}
+
+uint16_t GltfTrackCompression::packTime(float time, float rangeStart, float rangeExtent) {
+  return static_cast<uint16_t>(quantize(time, rangeStart, rangeExtent, VALUE_MAX));
+}
+
+float GltfTrackCompression::unpackTime(uint16_t packed, float rangeStart, float rangeExtent) {
+  return dequantize(packed, rangeStart, rangeExtent, VALUE_MAX);
+}
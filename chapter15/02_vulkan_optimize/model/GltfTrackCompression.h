@@ -0,0 +1,33 @@
+/* quantized key formats for animation tracks, decoded while sampling */
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/* smallest three: index of the dropped largest component in the top two bits,
+ * the other three components with 15 bits each, the sign of the quaternion in the last bit */
+struct GltfPackedQuat {
+  uint16_t data[3];
+};
+
+/* 16 bits per component, relative to the value range of the track */
+struct GltfPackedVec3 {
+  uint16_t data[3];
+};
+
+class GltfTrackCompression {
+  public:
+    static GltfPackedQuat packQuat(glm::quat rotation);
+    static glm::quat unpackQuat(const GltfPackedQuat &packed);
+
+    static GltfPackedVec3 packVec3(glm::vec3 value, glm::vec3 rangeMin, glm::vec3 rangeExtent);
+    static glm::vec3 unpackVec3(const GltfPackedVec3 &packed, glm::vec3 rangeMin,
+      glm::vec3 rangeExtent);
+
+    /* largest component difference, q and -q are the same rotation */
+    static float getQuatError(glm::quat a, glm::quat b);
+    static float getVec3Error(glm::vec3 a, glm::vec3 b);
+
+    static uint16_t packTime(float time, float rangeStart, float rangeExtent);
+    static float unpackTime(uint16_t packed, float rangeStart, float rangeExtent);
+};
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+#include "GltfVertexPacking.h"
+#include "Logger.h"
+
+namespace {
+  constexpr float SNORM16_MAX = 32767.0f;
+  constexpr float UNORM8_MAX = 255.0f;
+  /* joint numbers are stored in a single byte */
+  constexpr unsigned int MAX_PACKED_JOINT = 255;
+
+  float signNotZero(float value) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+  }
+
+  int16_t quantizeSnorm16(float value) {
+    return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * SNORM16_MAX));
+  }
+
+  /* start of the accessor data and the distance between two elements */
+  const unsigned char *getAccessorData(const tinygltf::Model &model,
+      const tinygltf::Accessor &accessor, size_t elementSize, size_t &stride) {
+    const tinygltf::BufferView &bufferView = model.bufferViews.at(accessor.bufferView);
+    const tinygltf::Buffer &buffer = model.buffers.at(bufferView.buffer);
+
+    stride = bufferView.byteStride != 0 ? bufferView.byteStride : elementSize;
+    return buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
+  }
+}
+
+bool GltfVertexPacking::packVertices(const tinygltf::Model &model,
+    std::vector<GltfPackedVertex> &vertices) {
+  const tinygltf::Primitive &primitive = model.meshes.at(0).primitives.at(0);
+
+  std::vector<float> positions;
+  std::vector<float> normals;
+  std::vector<float> texCoords;
+  std::vector<float> weights;
+  std::vector<glm::uvec4> joints;
+
+  if (!getFloatData(model, primitive, "POSITION", 3, positions) ||
+      !getFloatData(model, primitive, "NORMAL", 3, normals) ||
+      !getFloatData(model, primitive, "TEXCOORD_0", 2, texCoords) ||
+      !getFloatData(model, primitive, "WEIGHTS_0", 4, weights) ||
+      !getJointData(model, primitive, joints)) {
+    return false;
+  }
+
+  size_t vertexCount = positions.size() / 3;
+  if (normals.size() / 3 != vertexCount || texCoords.size() / 2 != vertexCount ||
+      weights.size() / 4 != vertexCount || joints.size() != vertexCount) {
+    Logger::log(1, "%s error: attributes of the %i vertices differ in size\n", __FUNCTION__,
+      vertexCount);
+    return false;
+  }
+
+  vertices.resize(vertexCount);
+  for (size_t i = 0; i < vertexCount; ++i) {
+    GltfPackedVertex &vertex = vertices.at(i);
+    vertex.position = glm::vec3(positions.at(i * 3), positions.at(i * 3 + 1),
+      positions.at(i * 3 + 2));
+
+    packNormal(glm::vec3(normals.at(i * 3), normals.at(i * 3 + 1), normals.at(i * 3 + 2)),
+      vertex.normal);
+
+    vertex.texCoord[0] = glm::packHalf1x16(texCoords.at(i * 2));
+    vertex.texCoord[1] = glm::packHalf1x16(texCoords.at(i * 2 + 1));
+
+    glm::vec4 vertexWeights = glm::vec4(weights.at(i * 4), weights.at(i * 4 + 1),
+      weights.at(i * 4 + 2), weights.at(i * 4 + 3));
+    packWeights(vertexWeights, vertex.weights);
+
+    for (int j = 0; j < 4; ++j) {
+      /* unused influences may reference any joint, they do not need to fit */
+      if (vertex.weights[j] == 0) {
+        vertex.joints[j] = 0;
+        continue;
+      }
+      if (joints.at(i)[j] > MAX_PACKED_JOINT) {
+        Logger::log(1, "%s error: joint %i of vertex %i does not fit into a byte\n",
+          __FUNCTION__, joints.at(i)[j], i);
+        return false;
+      }
+      vertex.joints[j] = static_cast<uint8_t>(joints.at(i)[j]);
+    }
+  }
+
+  Logger::log(1, "%s: packed %i vertices into %i bytes (%i bytes per vertex)\n", __FUNCTION__,
+    vertexCount, vertexCount * sizeof(GltfPackedVertex), sizeof(GltfPackedVertex));
+  return true;
+}
+
+bool GltfVertexPacking::getIndices(const tinygltf::Model &model,
+    std::vector<uint32_t> &indices) {
+  const tinygltf::Primitive &primitive = model.meshes.at(0).primitives.at(0);
+  const tinygltf::Accessor &accessor = model.accessors.at(primitive.indices);
+  indices.resize(accessor.count);
+  size_t stride = 0;
+
+  switch (accessor.componentType) {
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+      const unsigned char *source = getAccessorData(model, accessor, sizeof(uint8_t), stride);
+      for (size_t i = 0; i < accessor.count; ++i) {
+        indices.at(i) = source[i * stride];
+      }
+      break;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+      const unsigned char *source = getAccessorData(model, accessor, sizeof(uint16_t), stride);
+      for (size_t i = 0; i < accessor.count; ++i) {
+        uint16_t index;
+        std::memcpy(&index, source + i * stride, sizeof(index));
+        indices.at(i) = index;
+      }
+      break;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: {
+      const unsigned char *source = getAccessorData(model, accessor, sizeof(uint32_t), stride);
+      for (size_t i = 0; i < accessor.count; ++i) {
+        std::memcpy(&indices.at(i), source + i * stride, sizeof(uint32_t));
+      }
+      break;
+    }
+    default:
+      Logger::log(1, "%s error: accessor %i uses unknown data type %i\n", __FUNCTION__,
+        primitive.indices, accessor.componentType);
+      return false;
+  }
+  return true;
+}
+
+void GltfVertexPacking::packNormal(glm::vec3 normal, int16_t packed[2]) {
+  float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+  if (length == 0.0f) {
+    packed[0] = 0;
+    packed[1] = 0;
+    return;
+  }
+  normal /= length;
+
+  /* the lower hemisphere is folded over the diagonals of the octahedron */
+  glm::vec2 encoded = glm::vec2(normal.x, normal.y);
+  if (normal.z < 0.0f) {
+    encoded.x = (1.0f - std::fabs(normal.y)) * signNotZero(normal.x);
+    encoded.y = (1.0f - std::fabs(normal.x)) * signNotZero(normal.y);
+  }
+
+  packed[0] = quantizeSnorm16(encoded.x);
+  packed[1] = quantizeSnorm16(encoded.y);
+}
+
+glm::vec3 GltfVertexPacking::unpackNormal(const int16_t packed[2]) {
+  glm::vec2 encoded = glm::vec2(std::max(packed[0] / SNORM16_MAX, -1.0f),
+    std::max(packed[1] / SNORM16_MAX, -1.0f));
+
+  /* same as the vertex shaders */
+  glm::vec3 normal = glm::vec3(encoded.x, encoded.y,
+    1.0f - std::fabs(encoded.x) - std::fabs(encoded.y));
+  float fold = std::max(-normal.z, 0.0f);
+  normal.x += normal.x >= 0.0f ? -fold : fold;
+  normal.y += normal.y >= 0.0f ? -fold : fold;
+  return glm::normalize(normal);
+}
+
+void GltfVertexPacking::packWeights(glm::vec4 weights, uint8_t packed[4]) {
+  float sum = weights.x + weights.y + weights.z + weights.w;
+  if (sum <= 0.0f) {
+    packed[0] = static_cast<uint8_t>(UNORM8_MAX);
+    packed[1] = packed[2] = packed[3] = 0;
+    return;
+  }
+  weights /= sum;
+
+  int largest = 0;
+  int quantizedSum = 0;
+  for (int i = 0; i < 4; ++i) {
+    packed[i] = static_cast<uint8_t>(std::round(std::clamp(weights[i], 0.0f, 1.0f) *
+      UNORM8_MAX));
+    quantizedSum += packed[i];
+    if (weights[i] > weights[largest]) {
+      largest = i;
+    }
+  }
+
+  /* the rounding error goes to the largest weight, the skinned vertex must not scale */
+  packed[largest] = static_cast<uint8_t>(packed[largest] +
+    static_cast<int>(UNORM8_MAX) - quantizedSum);
+}
+
+bool GltfVertexPacking::getFloatData(const tinygltf::Model &model,
+    const tinygltf::Primitive &primitive, std::string attribType, int numComponents,
+    std::vector<float> &data) {
+  const auto attrib = primitive.attributes.find(attribType);
+  if (attrib == primitive.attributes.end()) {
+    Logger::log(1, "%s error: attribute %s not found\n", __FUNCTION__, attribType.c_str());
+    return false;
+  }
+
+  const tinygltf::Accessor &accessor = model.accessors.at(attrib->second);
+  if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) {
+    Logger::log(1, "%s error: accessor %i uses unknown data type %i\n", __FUNCTION__,
+      attrib->second, accessor.componentType);
+    return false;
+  }
+
+  size_t elementSize = numComponents * sizeof(float);
+  size_t stride = 0;
+  const unsigned char *source = getAccessorData(model, accessor, elementSize, stride);
+
+  data.resize(accessor.count * numComponents);
+  for (size_t i = 0; i < accessor.count; ++i) {
+    std::memcpy(&data.at(i * numComponents), source + i * stride, elementSize);
+  }
+  return true;
+}
+
+bool GltfVertexPacking::getJointData(const tinygltf::Model &model,
+    const tinygltf::Primitive &primitive, std::vector<glm::uvec4> &data) {
+  const auto attrib = primitive.attributes.find("JOINTS_0");
+  if (attrib == primitive.attributes.end()) {
+    Logger::log(1, "%s error: attribute JOINTS_0 not found\n", __FUNCTION__);
+    return false;
+  }
+
+  const tinygltf::Accessor &accessor = model.accessors.at(attrib->second);
+  data.resize(accessor.count);
+  size_t stride = 0;
+
+  switch (accessor.componentType) {
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+      const unsigned char *source = getAccessorData(model, accessor, sizeof(uint8_t) * 4,
+        stride);
+      for (size_t i = 0; i < accessor.count; ++i) {
+        glm::tvec4<uint8_t> joints;
+        std::memcpy(&joints, source + i * stride, sizeof(joints));
+        data.at(i) = glm::uvec4(joints);
+      }
+      break;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+      const unsigned char *source = getAccessorData(model, accessor, sizeof(uint16_t) * 4,
+        stride);
+      for (size_t i = 0; i < accessor.count; ++i) {
+        glm::tvec4<uint16_t> joints;
+        std::memcpy(&joints, source + i * stride, sizeof(joints));
+        data.at(i) = glm::uvec4(joints);
+      }
+      break;
+    }
+    default:
+      Logger::log(1, "%s error: accessor %i uses unknown data type %i\n", __FUNCTION__,
+        attrib->second, accessor.componentType);
+      return false;
+  }
+  return true;
+}
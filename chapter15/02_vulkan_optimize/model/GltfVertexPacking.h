@@ -0,0 +1,39 @@
+/* interleaved vertex format of the skinned mesh, converted from the glTF attributes */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <tiny_gltf.h>
+
+/* 28 bytes instead of the 56 bytes of the five separate glTF streams */
+struct GltfPackedVertex {
+  glm::vec3 position;
+  /* octahedral encoded unit normal, 2x snorm16 */
+  int16_t normal[2];
+  /* 2x half float */
+  uint16_t texCoord[2];
+  uint8_t joints[4];
+  /* 4x unorm8, the quantized weights always sum up to 255 */
+  uint8_t weights[4];
+};
+
+class GltfVertexPacking {
+  public:
+    /* reads the attributes of the first primitive of the first mesh */
+    static bool packVertices(const tinygltf::Model &model,
+      std::vector<GltfPackedVertex> &vertices);
+    /* index list of the same primitive, widened to 32 bit */
+    static bool getIndices(const tinygltf::Model &model, std::vector<uint32_t> &indices);
+
+    static void packNormal(glm::vec3 normal, int16_t packed[2]);
+    static glm::vec3 unpackNormal(const int16_t packed[2]);
+    static void packWeights(glm::vec4 weights, uint8_t packed[4]);
+
+  private:
+    /* float attributes only, returns false if the accessor is missing or uses another type */
+    static bool getFloatData(const tinygltf::Model &model, const tinygltf::Primitive &primitive,
+      std::string attribType, int numComponents, std::vector<float> &data);
+    static bool getJointData(const tinygltf::Model &model, const tinygltf::Primitive &primitive,
+      std::vector<glm::uvec4> &data);
+};
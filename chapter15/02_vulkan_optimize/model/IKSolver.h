@@ -4,30 +4,30 @@
 #include <memory>
 #include <glm/glm.hpp>
 
-#include "GltfNode.h"
+#include "GltfPose.h"
 
 class IKSolver {
   public:
     IKSolver();
     IKSolver(unsigned int iterations);
-    void setNodes(std::vector<std::shared_ptr<GltfNode>> nodes);
-    std::shared_ptr<GltfNode> getIkChainRootNode();
+    void setNodes(GltfPose &pose, std::vector<int> nodes);
+    int getIkChainRootNode();
 
     void setNumIterations(unsigned int iterations);
 
-    bool solveCCD(glm::vec3 target);
-    bool solveFABRIK(glm::vec3 target);
+    bool solveCCD(GltfPose &pose, glm::vec3 target);
+    bool solveFABRIK(GltfPose &pose, glm::vec3 target);
 
   private:
-    /* nodes from effector (at index 0) to IK chain root node (last index) */
-    std::vector<std::shared_ptr<GltfNode>> mNodes{};
+    /* skeleton nodes from effector (at index 0) to IK chain root node (last index) */
+    std::vector<int> mNodes{};
     std::vector<float> mBoneLengths{};
 
-    void calculateBoneLengths();
+    void calculateBoneLengths(GltfPose &pose);
 
     void solveFABRIKForward(glm::vec3 target);
     void solveFABRIKBackward(glm::vec3 base);
-    void adjustFABRIKNodes();
+    void adjustFABRIKNodes(GltfPose &pose);
     std::vector<glm::vec3> mFABRIKNodePositions{};
 
     unsigned int mIterations = 0;
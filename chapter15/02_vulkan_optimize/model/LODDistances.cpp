@@ -0,0 +1,29 @@
+#include <algorithm>
+#include <cmath>
+
+#include "LODDistances.h"
+
+LODDistances::LODDistances(float lod1Distance, float lod2Distance, float lod3Distance) {
+  setDistances(lod1Distance, lod2Distance, lod3Distance);
+}
+
+void LODDistances::setDistances(float lod1Distance, float lod2Distance, float lod3Distance) {
+  mDistances[0] = lod1Distance;
+  mDistances[1] = std::max(lod2Distance, lod1Distance);
+  mDistances[2] = std::max(lod3Distance, mDistances[1]);
+}
+
+float LODDistances::getFieldOfViewScale(int fieldOfView) {
+  return std::tan(glm::radians(fieldOfView / 2.0f)) / std::tan(glm::radians(30.0f));
+}
+
+int LODDistances::getLevel(glm::vec2 worldPos, glm::vec3 cameraPos, float fovScale) const {
+  float distance = glm::length(glm::vec3(worldPos.x, 0.0f, worldPos.y) - cameraPos) *
+    fovScale;
+  for (int level = NUM_LOD_LEVELS - 1; level > 0; --level) {
+    if (distance >= mDistances[level - 1]) {
+      return level;
+    }
+  }
+  return 0;
+}
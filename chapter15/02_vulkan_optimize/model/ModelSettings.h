@@ -1,4 +1,8 @@
 #pragma once
+#include <type_traits>
+
+/* per-frame state of an instance, only plain values to keep copies cheap, the
+ * clip and node names for the UI are stored once in the GltfModel */
 struct ModelSettings {
   glm::vec2 msWorldPosition = glm::vec2(0.0f);
   glm::vec3 msWorldRotation = glm::vec3(0.0f);
@@ -20,10 +24,6 @@ struct ModelSettings {
   float msAnimCrossBlendFactor = 0.0f;
   int msSkelSplitNode = 0;
 
-  std::vector<std::string> msClipNames{};
-  /* saved per instance as the node list is created here */
-  std::vector<std::string> msSkelNodeNames{};
-
   ikMode msIkMode = ikMode::off;
   int msIkIterations = 10;
   glm::vec3 msIkTargetPos = glm::vec3(0.0f, 3.0f, 1.0f);
@@ -32,3 +32,5 @@ struct ModelSettings {
   int msIkRootNode = 0;
 };
 
+static_assert(std::is_trivially_copyable_v<ModelSettings>,
+  "ModelSettings must stay a plain value struct");
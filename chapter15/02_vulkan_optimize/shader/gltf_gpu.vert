@@ -1,7 +1,7 @@
 #version 460 core
 #extension GL_EXT_scalar_block_layout : enable
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 1) in vec2 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 layout (location = 3) in uvec4 aJointNum;
 layout (location = 4) in vec4 aJointWeight;
@@ -22,6 +22,15 @@ layout (std430, set = 2, binding = 0) readonly buffer JointMatrices {
     mat4 jointMat[];
 };
 
+// octahedral encoded normal, the lower hemisphere is folded over the diagonals
+vec3 decodeNormal(vec2 encoded) {
+  vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  float fold = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -fold : fold;
+  n.y += n.y >= 0.0 ? -fold : fold;
+  return normalize(n);
+}
+
 void main() {
   mat4 skinMat =
     aJointWeight.x * jointMat[aJointNum.x + gl_InstanceIndex * aModelStride] +
@@ -29,7 +38,7 @@ void main() {
     aJointWeight.z * jointMat[aJointNum.z + gl_InstanceIndex * aModelStride] +
     aJointWeight.w * jointMat[aJointNum.w + gl_InstanceIndex * aModelStride];
   gl_Position = projection * view * skinMat * vec4(aPos, 1.0);
-  normal = vec3(transpose(inverse(skinMat)) * vec4(aNormal, 1.0));
+  normal = vec3(transpose(inverse(skinMat)) * vec4(decodeNormal(aNormal), 1.0));
   texCoord = aTexCoord;
 }
 
@@ -0,0 +1,30 @@
+#version 460 core
+// two entries per bone, bind pose position in xyz and joint number in w
+layout (location = 0) in vec4 aBone;
+// joint data slot of the instance
+layout (location = 1) in int aJointSlot;
+
+layout (location = 0) out vec4 lineColor;
+layout (location = 1) out vec2 texCoord;
+
+layout (push_constant) uniform Constants {
+  int aModelStride;
+};
+
+layout (set = 1, binding = 0) uniform Matrices {
+    mat4 view;
+    mat4 projection;
+};
+
+layout (std430, set = 2, binding = 0) readonly buffer JointMatrices {
+    mat4 jointMat[];
+};
+
+void main() {
+  mat4 jointMatrix = jointMat[int(aBone.w) + aJointSlot * aModelStride];
+
+  gl_Position = projection * view * jointMatrix * vec4(aBone.xyz, 1.0);
+  // parent end cyan, child end blue
+  lineColor = gl_VertexIndex % 2 == 0 ? vec4(0.0, 1.0, 1.0, 1.0) : vec4(0.0, 0.0, 1.0, 1.0);
+  texCoord = vec2(0.0);
+}
@@ -0,0 +1,39 @@
+#version 460 core
+// two entries per bone, bind pose position in xyz and joint number in w
+layout (location = 0) in vec4 aBone;
+// joint data slot of the instance
+layout (location = 1) in int aJointSlot;
+
+layout (location = 0) out vec4 lineColor;
+layout (location = 1) out vec2 texCoord;
+
+layout (push_constant) uniform Constants {
+  int aModelStride;
+};
+
+layout (set = 1, binding = 0) uniform Matrices {
+    mat4 view;
+    mat4 projection;
+};
+
+layout (std430, set = 3, binding = 0) readonly buffer JointDualQuats {
+  mat2x4 jointDQs[];
+};
+
+vec3 transformPosition(mat2x4 dq, vec3 pos) {
+  vec4 r = dq[0]; // rotation
+  vec4 t = dq[1]; // translation
+
+  vec3 rotated = pos + 2.0 * cross(r.xyz, cross(r.xyz, pos) + r.w * pos);
+  vec3 translation = 2.0 * (r.w * t.xyz - t.w * r.xyz + cross(r.xyz, t.xyz));
+  return rotated + translation;
+}
+
+void main() {
+  mat2x4 jointDQ = jointDQs[int(aBone.w) + aJointSlot * aModelStride];
+
+  gl_Position = projection * view * vec4(transformPosition(jointDQ, aBone.xyz), 1.0);
+  // parent end cyan, child end blue
+  lineColor = gl_VertexIndex % 2 == 0 ? vec4(0.0, 1.0, 1.0, 1.0) : vec4(0.0, 0.0, 1.0, 1.0);
+  texCoord = vec2(0.0);
+}
@@ -0,0 +1,60 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationTracker.h"
+
+namespace {
+  /* plain globals, operator new may run before any other static is constructed */
+  std::atomic<bool> trackingEnabled = false;
+  std::atomic<size_t> allocationCount = 0;
+  std::atomic<size_t> allocatedBytes = 0;
+}
+
+void AllocationTracker::setEnabled(bool enabled) {
+  trackingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::isEnabled() {
+  return trackingEnabled.load(std::memory_order_relaxed);
+}
+
+size_t AllocationTracker::getAllocationCount() {
+  return allocationCount.load(std::memory_order_relaxed);
+}
+
+size_t AllocationTracker::getAllocatedBytes() {
+  return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::resetCounters() {
+  allocationCount.store(0, std::memory_order_relaxed);
+  allocatedBytes.store(0, std::memory_order_relaxed);
+}
+
+void AllocationTracker::countAllocation(size_t size) {
+  if (!trackingEnabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+/* the array and nothrow versions of the standard library forward to these two, the
+ * aligned versions are not counted, ImGui and the C libraries use malloc directly */
+void *operator new(size_t size) {
+  AllocationTracker::countAllocation(size);
+  void *ptr = std::malloc(size > 0 ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+  std::free(ptr);
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+
+#include "WorkerPool.h"
+#include "Logger.h"
+
+WorkerPool::~WorkerPool() {
+  cleanup();
+}
+
+void WorkerPool::init(unsigned int numThreads) {
+  cleanup();
+
+  mShutdown = false;
+  numThreads = std::max(numThreads, 1u);
+
+  /* the calling thread does its share of the work too */
+  for (unsigned int i = 0; i < numThreads - 1; ++i) {
+    mThreads.emplace_back(&WorkerPool::workerLoop, this, mGeneration);
+  }
+
+  Logger::log(1, "%s: worker pool uses %i threads\n", __FUNCTION__, numThreads);
+}
+
+void WorkerPool::setNumThreads(unsigned int numThreads) {
+  if (numThreads == getNumThreads()) {
+    return;
+  }
+  init(numThreads);
+}
+
+unsigned int WorkerPool::getNumThreads() {
+  return mThreads.size() + 1;
+}
+
+void WorkerPool::runJob(size_t numItems, void *job, JobCall jobCall, bool onEachThread) {
+  if (numItems == 0) {
+    return;
+  }
+
+  /* nothing to split */
+  if (mThreads.empty()) {
+    jobCall(job, 0, numItems);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mJob = job;
+    mJobCall = jobCall;
+    mOnEachThread = onEachThread;
+    mNumItems = numItems;
+    /* some chunks per thread to even out differently expensive instances */
+    mChunkSize = std::max<size_t>(numItems / (getNumThreads() * 4), 1);
+    mNextItem = 0;
+    mActiveWorkers = mThreads.size();
+    ++mGeneration;
+  }
+  mStartCondition.notify_all();
+
+  if (onEachThread) {
+    jobCall(job, 0, 1);
+  } else {
+    runChunks();
+  }
+
+  std::unique_lock<std::mutex> lock(mMutex);
+  mDoneCondition.wait(lock, [this]() { return mActiveWorkers == 0; });
+}
+
+void WorkerPool::runChunks() {
+  while (true) {
+    size_t start = mNextItem.fetch_add(mChunkSize);
+    if (start >= mNumItems) {
+      break;
+    }
+    mJobCall(mJob, start, std::min(start + mChunkSize, mNumItems));
+  }
+}
+
+void WorkerPool::workerLoop(unsigned int startGeneration) {
+  unsigned int lastGeneration = startGeneration;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mStartCondition.wait(lock, [&]() { return mShutdown || mGeneration != lastGeneration; });
+      if (mShutdown) {
+        return;
+      }
+      lastGeneration = mGeneration;
+    }
+
+    if (mOnEachThread) {
+      mJobCall(mJob, 0, 1);
+    } else {
+      runChunks();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (--mActiveWorkers == 0) {
+        mDoneCondition.notify_one();
+      }
+    }
+  }
+}
+
+void WorkerPool::cleanup() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mShutdown = true;
+  }
+  mStartCondition.notify_all();
+
+  for (auto &thread : mThreads) {
+    thread.join();
+  }
+  mThreads.clear();
+}
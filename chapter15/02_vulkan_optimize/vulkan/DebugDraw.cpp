@@ -0,0 +1,132 @@
+#include <cmath>
+
+#include "DebugDraw.h"
+#include "Logger.h"
+
+bool DebugDraw::init(VkRenderData &renderData, unsigned int maxVertices) {
+  mMaxVertices = maxVertices;
+  mVertexCount = 0;
+  mCurrentRegion = 0;
+
+  VkBufferCreateInfo bufferInfo{};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size = static_cast<VkDeviceSize>(mMaxVertices) * renderData.rdMaxFramesInFlight *
+    sizeof(VkVertex);
+  bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+  bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  /* the vertex fetch reads host memory, but the lines are only read once per frame */
+  VmaAllocationCreateInfo vmaAllocInfo{};
+  vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+  vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+  VmaAllocationInfo allocInfo{};
+  if (vmaCreateBuffer(renderData.rdAllocator, &bufferInfo, &vmaAllocInfo, &mVertexBuffer,
+      &mVertexBufferAlloc, &allocInfo) != VK_SUCCESS) {
+    Logger::log(1, "%s error: could not allocate debug line buffer via VMA\n", __FUNCTION__);
+    return false;
+  }
+  mMappedData = static_cast<VkVertex*>(allocInfo.pMappedData);
+
+  mCirclePoints.resize(SPHERE_SEGMENTS);
+  for (int i = 0; i < SPHERE_SEGMENTS; ++i) {
+    float angle = glm::radians(360.0f) * i / SPHERE_SEGMENTS;
+    mCirclePoints.at(i) = glm::vec2(std::cos(angle), std::sin(angle));
+  }
+
+  Logger::log(1, "%s: debug line buffer (%i x %i vertices) initialized\n", __FUNCTION__,
+    renderData.rdMaxFramesInFlight, mMaxVertices);
+  return true;
+}
+
+void DebugDraw::beginFrame(VkRenderData &renderData) {
+  mCurrentRegion = renderData.rdCurrentFrame;
+  mVertexCount = 0;
+}
+
+VkVertex *DebugDraw::allocateVertices(unsigned int vertexCount) {
+  if (mVertexCount + vertexCount > mMaxVertices) {
+    if (!mOverflowLogged) {
+      Logger::log(1, "%s error: more than %i debug line vertices in one frame, lines dropped\n",
+        __FUNCTION__, mMaxVertices);
+      mOverflowLogged = true;
+    }
+    return nullptr;
+  }
+
+  VkVertex *vertices = mMappedData + mCurrentRegion * mMaxVertices + mVertexCount;
+  mVertexCount += vertexCount;
+  return vertices;
+}
+
+void DebugDraw::addLine(glm::vec3 start, glm::vec3 end, glm::vec3 color) {
+  VkVertex *vertices = allocateVertices(2);
+  if (!vertices) {
+    return;
+  }
+  vertices[0] = { start, color, glm::vec2(0.0f) };
+  vertices[1] = { end, color, glm::vec2(0.0f) };
+}
+
+void DebugDraw::addLines(const VkMesh &lines, glm::quat rotation, glm::vec3 translation,
+    float colorScale) {
+  VkVertex *vertices = allocateVertices(lines.vertices.size());
+  if (!vertices) {
+    return;
+  }
+  for (const auto &vertex : lines.vertices) {
+    *vertices++ = { rotation * vertex.position + translation, vertex.color * colorScale,
+      vertex.uv };
+  }
+}
+
+void DebugDraw::addSphere(glm::vec4 sphere, glm::vec3 color) {
+  VkVertex *vertices = allocateVertices(SPHERE_VERTEX_COUNT);
+  if (!vertices) {
+    return;
+  }
+
+  glm::vec3 center = glm::vec3(sphere);
+  for (int i = 0; i < SPHERE_SEGMENTS; ++i) {
+    glm::vec2 start = mCirclePoints.at(i) * sphere.w;
+    glm::vec2 end = mCirclePoints.at((i + 1) % SPHERE_SEGMENTS) * sphere.w;
+
+    /* XY, XZ and YZ planes */
+    *vertices++ = { center + glm::vec3(start.x, start.y, 0.0f), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(end.x, end.y, 0.0f), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(start.x, 0.0f, start.y), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(end.x, 0.0f, end.y), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(0.0f, start.x, start.y), color, glm::vec2(0.0f) };
+    *vertices++ = { center + glm::vec3(0.0f, end.x, end.y), color, glm::vec2(0.0f) };
+  }
+}
+
+unsigned int DebugDraw::getVertexCount() {
+  return mVertexCount;
+}
+
+void DebugDraw::flush(VkRenderData &renderData) {
+  if (mVertexCount == 0) {
+    return;
+  }
+  /* no-op for host coherent memory */
+  vmaFlushAllocation(renderData.rdAllocator, mVertexBufferAlloc,
+    static_cast<VkDeviceSize>(mCurrentRegion) * mMaxVertices * sizeof(VkVertex),
+    mVertexCount * sizeof(VkVertex));
+}
+
+void DebugDraw::draw(VkRenderData &renderData) {
+  if (mVertexCount == 0) {
+    return;
+  }
+  VkDeviceSize offset = static_cast<VkDeviceSize>(mCurrentRegion) * mMaxVertices *
+    sizeof(VkVertex);
+  vkCmdBindVertexBuffers(renderData.rdCommandBuffer, 0, 1, &mVertexBuffer, &offset);
+  vkCmdDraw(renderData.rdCommandBuffer, mVertexCount, 1, 0, 0);
+}
+
+void DebugDraw::cleanup(VkRenderData &renderData) {
+  vmaDestroyBuffer(renderData.rdAllocator, mVertexBuffer, mVertexBufferAlloc);
+  mVertexBuffer = VK_NULL_HANDLE;
+  mMappedData = nullptr;
+}
@@ -0,0 +1,52 @@
+/* batched debug lines, written straight into a persistently mapped ring buffer
+ * every frame in flight fills its own region, free again after the fence of the frame */
+#pragma once
+#include <vector>
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "VkRenderData.h"
+
+class DebugDraw {
+  public:
+    /* three circles around the axes per sphere */
+    static constexpr int SPHERE_SEGMENTS = 16;
+    static constexpr unsigned int SPHERE_VERTEX_COUNT = 3 * SPHERE_SEGMENTS * 2;
+
+    /* maxVertices per frame, one region per possible frame in flight, never resized */
+    bool init(VkRenderData &renderData, unsigned int maxVertices);
+    /* selects the region of the current frame, call after waiting for the frame fence */
+    void beginFrame(VkRenderData &renderData);
+
+    void addLine(glm::vec3 start, glm::vec3 end, glm::vec3 color);
+    /* line list, rotated and moved into place, the colors are scaled */
+    void addLines(const VkMesh &lines, glm::quat rotation, glm::vec3 translation,
+      float colorScale);
+    /* xyz is the center and w the radius */
+    void addSphere(glm::vec4 sphere, glm::vec3 color);
+
+    unsigned int getVertexCount();
+    /* makes the lines visible on non-coherent memory, before submitting the frame */
+    void flush(VkRenderData &renderData);
+    /* records the draw of the lines, the line pipeline must be bound */
+    void draw(VkRenderData &renderData);
+    void cleanup(VkRenderData &renderData);
+
+  private:
+    /* returns nullptr if the region of the frame is full */
+    VkVertex *allocateVertices(unsigned int vertexCount);
+
+    VkBuffer mVertexBuffer = VK_NULL_HANDLE;
+    VmaAllocation mVertexBufferAlloc = nullptr;
+    VkVertex *mMappedData = nullptr;
+
+    unsigned int mMaxVertices = 0;
+    unsigned int mVertexCount = 0;
+    bool mOverflowLogged = false;
+
+    int mCurrentRegion = 0;
+
+    /* unit circle, avoids the trigonometry per sphere */
+    std::vector<glm::vec2> mCirclePoints{};
+};
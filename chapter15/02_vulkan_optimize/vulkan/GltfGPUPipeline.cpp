@@ -1,6 +1,8 @@
 #include <vector>
+#include <cstddef>
 
 #include "GltfGPUPipeline.h"
+#include "GltfVertexPacking.h"
 #include "Logger.h"
 #include "Shader.h"
 
@@ -36,60 +38,49 @@ bool GltfGPUPipeline::init(VkRenderData& renderData, VkPipelineLayout& pipelineL
   VkPipelineShaderStageCreateInfo shaderStagesInfo[] = { vertexStageInfo, fragmentStageInfo };
 
   /* assemble the graphics pipeline itself */
-  VkVertexInputBindingDescription vertexBindings[5];
-  vertexBindings[0].binding = 0;
-  vertexBindings[0].stride = sizeof(glm::vec3);
-  vertexBindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-  vertexBindings[1].binding = 1;
-  vertexBindings[1].stride = sizeof(glm::vec3);
-  vertexBindings[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-  vertexBindings[2].binding = 2;
-  vertexBindings[2].stride = sizeof(glm::vec2);
-  vertexBindings[2].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-  vertexBindings[3].binding = 3;
-  vertexBindings[3].stride = sizeof(uint16_t) * 4; // 4x unsigned short
-  vertexBindings[3].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-  vertexBindings[4].binding = 4;
-  vertexBindings[4].stride = sizeof(glm::vec4);
-  vertexBindings[4].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+  /* one interleaved stream, see GltfPackedVertex */
+  VkVertexInputBindingDescription vertexBinding{};
+  vertexBinding.binding = 0;
+  vertexBinding.stride = sizeof(GltfPackedVertex);
+  vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
   VkVertexInputAttributeDescription positionAttribute{};
   positionAttribute.binding = 0;
   positionAttribute.location = 0;
   positionAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-  positionAttribute.offset = 0;
+  positionAttribute.offset = offsetof(GltfPackedVertex, position);
 
   VkVertexInputAttributeDescription normalAttribute{};
-  normalAttribute.binding = 1;
+  normalAttribute.binding = 0;
   normalAttribute.location = 1;
-  normalAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-  normalAttribute.offset = 0;
+  normalAttribute.format = VK_FORMAT_R16G16_SNORM; // octahedral encoded
+  normalAttribute.offset = offsetof(GltfPackedVertex, normal);
 
   VkVertexInputAttributeDescription uvAttribute{};
-  uvAttribute.binding = 2;
+  uvAttribute.binding = 0;
   uvAttribute.location = 2;
-  uvAttribute.format = VK_FORMAT_R32G32_SFLOAT;
-  uvAttribute.offset = 0;
+  uvAttribute.format = VK_FORMAT_R16G16_SFLOAT;
+  uvAttribute.offset = offsetof(GltfPackedVertex, texCoord);
 
   VkVertexInputAttributeDescription jointsAttribute{};
-  jointsAttribute.binding = 3;
+  jointsAttribute.binding = 0;
   jointsAttribute.location = 3;
-  jointsAttribute.format = VK_FORMAT_R16G16B16A16_UINT; // 4x unsigned short
-  jointsAttribute.offset = 0;
+  jointsAttribute.format = VK_FORMAT_R8G8B8A8_UINT; // 4x unsigned byte
+  jointsAttribute.offset = offsetof(GltfPackedVertex, joints);
 
   VkVertexInputAttributeDescription weightAttribute{};
-  weightAttribute.binding = 4;
+  weightAttribute.binding = 0;
   weightAttribute.location = 4;
-  weightAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-  weightAttribute.offset = 0;
+  weightAttribute.format = VK_FORMAT_R8G8B8A8_UNORM;
+  weightAttribute.offset = offsetof(GltfPackedVertex, weights);
 
   VkVertexInputAttributeDescription attributes[] =
     { positionAttribute, normalAttribute, uvAttribute, jointsAttribute, weightAttribute };
 
   VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
   vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-  vertexInputInfo.vertexBindingDescriptionCount = 5;
-  vertexInputInfo.pVertexBindingDescriptions = vertexBindings;
+  vertexInputInfo.vertexBindingDescriptionCount = 1;
+  vertexInputInfo.pVertexBindingDescriptions = &vertexBinding;
   vertexInputInfo.vertexAttributeDescriptionCount = 5;
   vertexInputInfo.pVertexAttributeDescriptions = attributes;
 
@@ -33,36 +33,38 @@ bool GltfSkeletonPipeline::init(VkRenderData& renderData, VkPipelineLayout& pipe
   VkPipelineShaderStageCreateInfo shaderStagesInfo[] = { vertexStageInfo, fragmentStageInfo };
 
   /* assemble the graphics pipeline itself */
-  VkVertexInputBindingDescription mainBinding{};
-  mainBinding.binding = 0;
-  mainBinding.stride = sizeof(VkVertex);
-  mainBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-  VkVertexInputAttributeDescription positionAttribute{};
-  positionAttribute.binding = 0;
-  positionAttribute.location = 0;
-  positionAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-  positionAttribute.offset = offsetof(VkVertex, position);
-
-  VkVertexInputAttributeDescription colorAttribute{};
-  colorAttribute.binding = 0;
-  colorAttribute.location = 1;
-  colorAttribute.format = VK_FORMAT_R32G32B32_SFLOAT;
-  colorAttribute.offset = offsetof(VkVertex, color);
-
-  VkVertexInputAttributeDescription uvAttribute{};
-  uvAttribute.binding = 0;
-  uvAttribute.location = 2;
-  uvAttribute.format = VK_FORMAT_R32G32_SFLOAT;
-  uvAttribute.offset = offsetof(VkVertex, uv);
-
-  VkVertexInputAttributeDescription attributes[] = { positionAttribute, colorAttribute, uvAttribute };
+  /* bone lines per vertex, the joint data slot per skeleton instance */
+  VkVertexInputBindingDescription boneBinding{};
+  boneBinding.binding = 0;
+  boneBinding.stride = sizeof(glm::vec4);
+  boneBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+  VkVertexInputBindingDescription instanceBinding{};
+  instanceBinding.binding = 1;
+  instanceBinding.stride = sizeof(int);
+  instanceBinding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+  VkVertexInputBindingDescription bindings[] = { boneBinding, instanceBinding };
+
+  VkVertexInputAttributeDescription boneAttribute{};
+  boneAttribute.binding = 0;
+  boneAttribute.location = 0;
+  boneAttribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+  boneAttribute.offset = 0;
+
+  VkVertexInputAttributeDescription jointSlotAttribute{};
+  jointSlotAttribute.binding = 1;
+  jointSlotAttribute.location = 1;
+  jointSlotAttribute.format = VK_FORMAT_R32_SINT;
+  jointSlotAttribute.offset = 0;
+
+  VkVertexInputAttributeDescription attributes[] = { boneAttribute, jointSlotAttribute };
 
   VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
   vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-  vertexInputInfo.vertexBindingDescriptionCount = 1;
-  vertexInputInfo.pVertexBindingDescriptions = &mainBinding;
-  vertexInputInfo.vertexAttributeDescriptionCount = 3;
+  vertexInputInfo.vertexBindingDescriptionCount = 2;
+  vertexInputInfo.pVertexBindingDescriptions = bindings;
+  vertexInputInfo.vertexAttributeDescriptionCount = 2;
   vertexInputInfo.pVertexAttributeDescriptions = attributes;
 
   VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
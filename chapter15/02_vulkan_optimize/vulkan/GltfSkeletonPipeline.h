@@ -1,4 +1,4 @@
-/* Vulkan graphics pipeline with shaders, depth test disabled */
+/* Vulkan graphics pipeline for the instanced skeleton lines, depth test disabled */
 #pragma once
 
 #include <string>
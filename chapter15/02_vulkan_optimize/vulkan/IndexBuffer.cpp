@@ -44,23 +44,28 @@ bool IndexBuffer::init(VkRenderData &renderData, VkIndexBufferData &indexBufferD
 
 bool IndexBuffer::uploadData(VkRenderData &renderData, VkIndexBufferData &indexBufferData,
   const tinygltf::Buffer &buffer, const tinygltf::BufferView &bufferView) {
+  return uploadData(renderData, indexBufferData, &buffer.data.at(0) + bufferView.byteOffset,
+    bufferView.byteLength);
+}
 
+bool IndexBuffer::uploadData(VkRenderData &renderData, VkIndexBufferData &indexBufferData,
+    const void *indexData, size_t indexDataSize) {
   /* buffer too small, resize */
-  if (indexBufferData.rdIndexBufferSize < bufferView.byteLength) {
+  if (indexBufferData.rdIndexBufferSize < indexDataSize) {
     cleanup(renderData, indexBufferData);
 
-    if (!init(renderData, indexBufferData, bufferView.byteLength)) {
-      Logger::log(1, "%s error: could not create index buffer of size %i bytes\n", __FUNCTION__, bufferView.byteLength);
+    if (!init(renderData, indexBufferData, indexDataSize)) {
+      Logger::log(1, "%s error: could not create index buffer of size %i bytes\n", __FUNCTION__, indexDataSize);
       return false;
     }
-    Logger::log(1, "%s: index buffer resize to %i bytes\n", __FUNCTION__, bufferView.byteLength);
-    indexBufferData.rdIndexBufferSize = bufferView.byteLength;
+    Logger::log(1, "%s: index buffer resize to %i bytes\n", __FUNCTION__, indexDataSize);
+    indexBufferData.rdIndexBufferSize = indexDataSize;
   }
 
   /* copy data to staging buffer*/
   void* data;
   vmaMapMemory(renderData.rdAllocator, indexBufferData.rdStagingBufferAlloc, &data);
-  std::memcpy(data, &buffer.data.at(0) + bufferView.byteOffset, bufferView.byteLength);
+  std::memcpy(data, indexData, indexDataSize);
   vmaUnmapMemory(renderData.rdAllocator, indexBufferData.rdStagingBufferAlloc);
 
   VkBufferMemoryBarrier vertexBufferBarrier{};
@@ -12,5 +12,8 @@ class IndexBuffer {
       size_t bufferSize);
     static bool uploadData(VkRenderData &renderData, VkIndexBufferData &indexBufferData,
       const tinygltf::Buffer &buffer, const tinygltf::BufferView &bufferView);
+    /* raw data, the glTF overload ends here */
+    static bool uploadData(VkRenderData &renderData, VkIndexBufferData &indexBufferData,
+      const void *indexData, size_t indexDataSize);
     static void cleanup(VkRenderData &renderData, VkIndexBufferData &IndexBufferData);
 };
@@ -10,10 +10,12 @@ bool PipelineLayout::init(VkRenderData &renderData, VkTextureData &textureData,
   pushConstants.size = sizeof(VkPushConstants);
   pushConstants.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
+  /* the layouts of all frames are identical, and therefore compatible */
+  VkFrameData &frameData = renderData.rdFrames.at(0);
   VkDescriptorSetLayout layouts [] = { textureData.texTextureDescriptorLayout,
-    renderData.rdPerspViewMatrixUBO.rdUBODescriptorLayout,
-    renderData.rdJointMatrixSSBO.rdSSBODescriptorLayout,
-    renderData.rdJointDualQuatSSBO.rdSSBODescriptorLayout };
+    frameData.rdPerspViewMatrixUBO.rdUBODescriptorLayout,
+    frameData.rdJointMatrixSSBO.rdSSBODescriptorLayout,
+    frameData.rdJointDualQuatSSBO.rdSSBODescriptorLayout };
 
   VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
   pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -12,12 +12,15 @@ bool ShaderStorageBuffer::init(VkRenderData& renderData, VkShaderStorageBufferDa
 
   VmaAllocationCreateInfo vmaAllocInfo{};
   vmaAllocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+  vmaAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 
+  VmaAllocationInfo allocInfo{};
   if (vmaCreateBuffer(renderData.rdAllocator, &bufferInfo, &vmaAllocInfo,
-    &SSBOData.rdSsboBuffer, &SSBOData.rdSsboBufferAlloc, nullptr) != VK_SUCCESS) {
+    &SSBOData.rdSsboBuffer, &SSBOData.rdSsboBufferAlloc, &allocInfo) != VK_SUCCESS) {
     Logger::log(1, "%s error: could not allocate shader storage buffer via VMA\n", __FUNCTION__);
     return false;
   }
+  SSBOData.rdSsboMappedData = allocInfo.pMappedData;
 
   VkDescriptorSetLayoutBinding ssboBind{};
   ssboBind.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
@@ -85,28 +88,14 @@ bool ShaderStorageBuffer::init(VkRenderData& renderData, VkShaderStorageBufferDa
 	return true;
 }
 
-void ShaderStorageBuffer::uploadData(VkRenderData &renderData,
-    VkShaderStorageBufferData &SSBOData, std::vector<glm::mat4> matricesToUpload) {
-  if (matricesToUpload.size() == 0) {
+void ShaderStorageBuffer::flushData(VkRenderData &renderData,
+    VkShaderStorageBufferData &SSBOData, size_t dataSize) {
+  if (dataSize == 0) {
     return;
   }
 
-  void* data;
-  vmaMapMemory(renderData.rdAllocator, SSBOData.rdSsboBufferAlloc, &data);
-  std::memcpy(data, matricesToUpload.data(), SSBOData.rdSsboBufferSize);
-  vmaUnmapMemory(renderData.rdAllocator, SSBOData.rdSsboBufferAlloc);
-}
-
-void ShaderStorageBuffer::uploadData(VkRenderData &renderData,
-    VkShaderStorageBufferData &SSBOData, std::vector<glm::mat2x4> matricesToUpload) {
-  if (matricesToUpload.size() == 0) {
-    return;
-  }
-
-  void* data;
-  vmaMapMemory(renderData.rdAllocator, SSBOData.rdSsboBufferAlloc, &data);
-  std::memcpy(data, matricesToUpload.data(), SSBOData.rdSsboBufferSize);
-  vmaUnmapMemory(renderData.rdAllocator, SSBOData.rdSsboBufferAlloc);
+  /* no-op for host coherent memory */
+  vmaFlushAllocation(renderData.rdAllocator, SSBOData.rdSsboBufferAlloc, 0, dataSize);
 }
 
 void ShaderStorageBuffer::cleanup(VkRenderData& renderData, VkShaderStorageBufferData &SSBOData) {
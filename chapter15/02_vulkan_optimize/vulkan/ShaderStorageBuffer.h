@@ -1,9 +1,9 @@
 /* Vulkan shader storage buffer object */
 #pragma once
 
+#include <cstddef>
 #include <vector>
 #include <vulkan/vulkan.h>
-#include <glm/glm.hpp>
 
 #include "VkRenderData.h"
 
@@ -11,9 +11,8 @@ class ShaderStorageBuffer {
   public:
     static bool init(VkRenderData &renderData, VkShaderStorageBufferData &SSBOData,
       size_t bufferSize);
-    static void uploadData(VkRenderData &renderData, VkShaderStorageBufferData &SSBOData,
-      std::vector<glm::mat4> matricesToUpload);
-    static void uploadData(VkRenderData &renderData, VkShaderStorageBufferData &SSBOData,
-      std::vector<glm::mat2x4> matricesToUpload);
+    /* makes writes to rdSsboMappedData visible on non-coherent memory */
+    static void flushData(VkRenderData &renderData, VkShaderStorageBufferData &SSBOData,
+      size_t dataSize);
     static void cleanup(VkRenderData &renderData, VkShaderStorageBufferData &SSBOData);
 };
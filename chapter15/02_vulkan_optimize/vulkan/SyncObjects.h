@@ -7,6 +7,6 @@
 
 class SyncObjects {
   public:
-    static bool init(VkRenderData &renderData);
-    static void cleanup(VkRenderData &renderData);
+    static bool init(VkRenderData &renderData, VkFrameData &frameData);
+    static void cleanup(VkRenderData &renderData, VkFrameData &frameData);
 };
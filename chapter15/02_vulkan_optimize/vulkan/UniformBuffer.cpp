@@ -86,7 +86,7 @@ bool UniformBuffer::init(VkRenderData& renderData, VkUniformBufferData &UBOData,
 }
 
 void UniformBuffer::uploadData(VkRenderData &renderData, VkUniformBufferData &UBOData,
-      std::vector<glm::mat4> matricesToUpload) {
+      const std::vector<glm::mat4> &matricesToUpload) {
   if (matricesToUpload.size() == 0) {
     return;
   }
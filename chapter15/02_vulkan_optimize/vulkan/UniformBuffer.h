@@ -11,6 +11,6 @@ class UniformBuffer {
     static bool init(VkRenderData &renderData, VkUniformBufferData &UBOData,
       size_t bufferSize);
     static void uploadData(VkRenderData &renderData, VkUniformBufferData &UBOData,
-      std::vector<glm::mat4> matricesToUpload);
+      const std::vector<glm::mat4> &matricesToUpload);
     static void cleanup(VkRenderData &renderData, VkUniformBufferData &UBOData);
 };
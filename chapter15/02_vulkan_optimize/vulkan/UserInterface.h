@@ -1,6 +1,7 @@
 /* Dear ImGui */
 #pragma once
 #include <vector>
+#include <string>
 
 #include "VkRenderData.h"
 #include "ModelSettings.h"
@@ -8,7 +9,9 @@
 class UserInterface {
   public:
     bool init(VkRenderData& renderData);
-    void createFrame(VkRenderData& renderData, ModelSettings &settings);
+    /* the names are owned by the model, the settings only store the indices */
+    void createFrame(VkRenderData& renderData, ModelSettings &settings,
+      const std::vector<std::string> &clipNames, const std::vector<std::string> &nodeNames);
     void render(VkRenderData& renderData);
     void cleanup(VkRenderData& renderData);
 
@@ -40,4 +43,7 @@ class UserInterface {
 
     std::vector<float> mUiDrawValues{};
     int mNumUiDrawValues = 90;
+
+    /* averaged frame time for every frames in flight setting used so far */
+    std::vector<float> mFramesInFlightTimes{};
 };
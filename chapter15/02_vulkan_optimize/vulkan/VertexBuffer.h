@@ -12,10 +12,13 @@ class VertexBuffer {
     static bool init(VkRenderData &renderData, VkVertexBufferData &vertexBufferData,
       unsigned int bufferSize);
     static bool uploadData(VkRenderData& renderData, VkVertexBufferData &vertexBufferData,
-      VkMesh vertexData);
+      const VkMesh &vertexData);
     static bool uploadData(VkRenderData &renderData, VkVertexBufferData &vertexBufferData,
-      std::vector<glm::vec3> vetrexData);
+      const std::vector<glm::vec3> &vetrexData);
     static bool uploadData(VkRenderData &renderData, VkVertexBufferData &vertexBufferData,
       const tinygltf::Buffer &buffer, const tinygltf::BufferView &bufferView);
+    /* raw data, the typed overloads end here */
+    static bool uploadData(VkRenderData &renderData, VkVertexBufferData &vertexBufferData,
+      const void *vertexData, unsigned int vertexDataSize);
     static void cleanup(VkRenderData &renderData, VkVertexBufferData &vertexBufferData);
 };
@@ -83,12 +83,30 @@ struct VkShaderStorageBufferData {
   size_t rdSsboBufferSize = 0;
   VkBuffer rdSsboBuffer = VK_NULL_HANDLE;
   VmaAllocation rdSsboBufferAlloc = nullptr;
+  /* persistently mapped, written directly by the renderer */
+  void *rdSsboMappedData = nullptr;
 
   VkDescriptorPool rdSSBODescriptorPool = VK_NULL_HANDLE;
   VkDescriptorSetLayout rdSSBODescriptorLayout = VK_NULL_HANDLE;
   VkDescriptorSet rdSSBODescriptorSet = VK_NULL_HANDLE;
 };
 
+/* everything a frame touches while the GPU may still work on another frame */
+struct VkFrameData {
+  VkCommandBuffer rdCommandBuffer = VK_NULL_HANDLE;
+
+  VkSemaphore rdPresentSemaphore = VK_NULL_HANDLE;
+  VkSemaphore rdRenderSemaphore = VK_NULL_HANDLE;
+  VkFence rdRenderFence = VK_NULL_HANDLE;
+
+  /* joint data slots of the instances showing their skeleton */
+  VkVertexBufferData rdSkeletonInstanceBufferData{};
+
+  VkUniformBufferData rdPerspViewMatrixUBO{};
+  VkShaderStorageBufferData rdJointMatrixSSBO{};
+  VkShaderStorageBufferData rdJointDualQuatSSBO{};
+};
+
 struct VkPushConstants {
   int pkModelStride;
 };
@@ -109,9 +127,15 @@ struct VkRenderData {
   float rdIKTime = 0.0f;
   float rdUploadToVBOTime = 0.0f;
   float rdUploadToUBOTime = 0.0f;
+  float rdWaitForGPUTime = 0.0f;
   float rdUIGenerateTime = 0.0f;
   float rdUIDrawTime = 0.0f;
 
+  /* heap allocations of the last frame, a steady state frame has none */
+  bool rdTrackAllocations = false;
+  size_t rdFrameAllocations = 0;
+  size_t rdFrameAllocatedBytes = 0;
+
   int rdMoveForward = 0;
   int rdMoveRight = 0;
   int rdMoveUp = 0;
@@ -125,6 +149,69 @@ struct VkRenderData {
   int rdNumberOfInstances = 0;
   int rdCurrentSelectedInstance = 0;
 
+  bool rdUseWorkerThreads = true;
+  int rdNumWorkerThreads = 1;
+  int rdMaxWorkerThreads = 1;
+
+  bool rdUseBakedClips = true;
+  /* constant tracks and redundant keys are removed when the model is loaded */
+  bool rdOptimizeClips = true;
+  float rdClipKeyTolerance = 0.0001f;
+  /* quantized keyframes and baked frames, applied when the model is loaded,
+   * the max error is a load time default, only the benchmark sets it (--max-error) */
+  bool rdCompressClips = true;
+  float rdClipCompressionMaxError = 0.0005f;
+  /* welded vertices in vertex cache order, applied when the model is loaded */
+  bool rdOptimizeMesh = true;
+  /* outer triangle clusters first, only kept if the vertex cache order barely suffers */
+  bool rdOptimizeOverdraw = true;
+
+  /* far instances update every 2nd, 4th or 8th frame beyond the three distances */
+  bool rdUseAnimationLOD = true;
+  float rdAnimLODDistance1 = 30.0f;
+  float rdAnimLODDistance2 = 60.0f;
+  float rdAnimLODDistance3 = 90.0f;
+  /* maximum number of animated instances per frame, 0 is unlimited */
+  int rdAnimUpdateBudget = 0;
+  /* per LOD level, filled by the renderer */
+  std::vector<int> rdAnimLODInstances{};
+  std::vector<int> rdAnimLODUpdates{};
+
+  /* far instances are drawn with the simplified meshes beyond the three distances */
+  bool rdUseMeshLOD = true;
+  float rdMeshLODDistance1 = 20.0f;
+  float rdMeshLODDistance2 = 40.0f;
+  float rdMeshLODDistance3 = 70.0f;
+  /* per mesh LOD level, filled by the renderer, rdTriangleCount is the sum of all levels */
+  std::vector<int> rdMeshLODInstances{};
+  std::vector<unsigned int> rdMeshLODTriangles{};
+
+  /* instances skip fingers, toes and face joints on the mesh LOD levels */
+  bool rdUseSkeletonLOD = true;
+  /* evaluated joints per skeleton LOD level and the updates of the level in this frame */
+  std::vector<int> rdSkeletonLODJoints{};
+  std::vector<int> rdSkeletonLODUpdates{};
+
+  /* instances with their bounds outside of the view are not uploaded and not drawn */
+  bool rdUseFrustumCulling = true;
+  /* culled instances update every 8th frame, like the last LOD level */
+  bool rdReduceCulledUpdates = true;
+  int rdVisibleInstances = 0;
+  int rdCulledInstances = 0;
+  float rdCullingTime = 0.0f;
+  /* estimate, not measured: the joint data upload time per drawn instance times the
+   * number of culled instances */
+  float rdCullingTimeSavedEstimate = 0.0f;
+
+  /* coordinate arrows are always drawn, the bounds of the visible instances on request */
+  bool rdDrawBoundingSpheres = false;
+  unsigned int rdDebugLineVertices = 0;
+
+  /* all frames are created at init, the setting only changes how many are used */
+  int rdFramesInFlight = 2;
+  int rdMaxFramesInFlight = 3;
+  int rdCurrentFrame = 0;
+
   VmaAllocator rdAllocator = nullptr;
 
   vkb::Instance rdVkbInstance{};
@@ -150,25 +237,19 @@ struct VkRenderData {
   VkPipeline rdGltfGPUPipeline = VK_NULL_HANDLE;
   VkPipeline rdGltfGPUDQPipeline = VK_NULL_HANDLE;
   VkPipeline rdGltfSkeletonPipeline = VK_NULL_HANDLE;
+  VkPipeline rdGltfSkeletonDQPipeline = VK_NULL_HANDLE;
 
   VkCommandPool rdCommandPool = VK_NULL_HANDLE;
+  /* command buffer of the frame currently recorded */
   VkCommandBuffer rdCommandBuffer = VK_NULL_HANDLE;
 
-  VkSemaphore rdPresentSemaphore = VK_NULL_HANDLE;
-  VkSemaphore rdRenderSemaphore = VK_NULL_HANDLE;
-  VkFence rdRenderFence = VK_NULL_HANDLE;
-
-  VkVertexBufferData rdVertexBufferData{};
-
-  VkUniformBufferData rdPerspViewMatrixUBO{};
-  VkShaderStorageBufferData rdJointMatrixSSBO{};
-  VkShaderStorageBufferData rdJointDualQuatSSBO{};
+  std::vector<VkFrameData> rdFrames{};
 
   VkDescriptorPool rdImguiDescriptorPool = VK_NULL_HANDLE;
 };
 
 struct VkGltfRenderData {
-  std::vector<VkVertexBufferData> rdGltfVertexBufferData{};
+  VkVertexBufferData rdGltfVertexBufferData{};
   VkIndexBufferData rdGltfIndexBufferData{};
 	VkTextureData rdGltfModelTexture{};
 };
@@ -1,9 +1,12 @@
+#include <algorithm>
+
 #include <imgui_impl_glfw.h>
 
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <ctime>
 #include <cstdlib>
+#include <thread>
 
 #define VMA_IMPLEMENTATION
 #include <vk_mem_alloc.h>
@@ -11,6 +14,13 @@
 #include "VkRenderer.h"
 #include "ModelSettings.h"
 #include "Logger.h"
+#include "GltfPosePool.h"
+
+namespace {
+  /* instances drawn with the same pipeline and joint data buffer */
+  constexpr int MATRIX_GROUP = 0;
+  constexpr int DUAL_QUAT_GROUP = 1;
+}
 
 VkRenderer::VkRenderer(GLFWwindow *window) {
   mRenderData.rdWindow = window;
@@ -52,6 +62,15 @@ bool VkRenderer::init(unsigned int width, unsigned int height) {
     return false;
   }
 
+  /* ImGui reuses its buffers after one round through the swapchain images */
+  mRenderData.rdMaxFramesInFlight = std::min(mRenderData.rdMaxFramesInFlight,
+    static_cast<int>(mRenderData.rdVkbSwapchain.image_count));
+  mRenderData.rdFramesInFlight = std::min(mRenderData.rdFramesInFlight,
+    mRenderData.rdMaxFramesInFlight);
+  mRenderData.rdFrames.resize(mRenderData.rdMaxFramesInFlight);
+  Logger::log(1, "%s: using %i of %i frames in flight\n", __FUNCTION__,
+    mRenderData.rdFramesInFlight, mRenderData.rdMaxFramesInFlight);
+
   if (!createCommandPool()) {
     return false;
   }
@@ -100,6 +119,10 @@ bool VkRenderer::init(unsigned int width, unsigned int height) {
       return false;
   }
 
+  if (!createGltfSkeletonDQPipeline()) {
+      return false;
+  }
+
   if (!createGltfGPUPipeline()) {
       return false;
   }
@@ -120,9 +143,22 @@ bool VkRenderer::init(unsigned int width, unsigned int height) {
     return false;
   }
 
-  /* valid, but emtpy */
-  mLineMesh = std::make_shared<VkMesh>();
-  Logger::log(1, "%s: line mesh storage initialized\n", __FUNCTION__);
+  /* the main thread does a share of the animation work too */
+  mRenderData.rdMaxWorkerThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  mRenderData.rdNumWorkerThreads = mRenderData.rdMaxWorkerThreads;
+  mWorkerPool.init(mRenderData.rdNumWorkerThreads);
+
+  mInstanceJointSlots.resize(mGltfInstances.size());
+  mInstanceVisible.resize(mGltfInstances.size(), true);
+  mSkeletonJointSlots.reserve(mGltfInstances.size());
+
+  /* room for the two coordinate arrows and the bounds of all instances */
+  unsigned int maxDebugVertices = 2 * mCoordArrowsModel.getVertexData().vertices.size() +
+    mGltfInstances.size() * DebugDraw::SPHERE_VERTEX_COUNT;
+  if (!mDebugDraw.init(mRenderData, maxDebugVertices)) {
+    Logger::log(1, "%s error: could not init debug lines\n", __FUNCTION__);
+    return false;
+  }
 
   mFrameTimer.start();
 
@@ -308,9 +344,19 @@ bool VkRenderer::recreateSwapchain() {
 }
 
 bool VkRenderer::createVBO() {
-  /* init with arbitrary size here */
-  if (!VertexBuffer::init(mRenderData, mRenderData.rdVertexBufferData, 2000)) {
-    Logger::log(1, "%s error: could not create vertex buffer\n", __FUNCTION__);
+  for (auto &frame : mRenderData.rdFrames) {
+    if (!VertexBuffer::init(mRenderData, frame.rdSkeletonInstanceBufferData,
+        mGltfInstances.size() * sizeof(int))) {
+      Logger::log(1, "%s error: could not create skeleton instance buffer\n", __FUNCTION__);
+      return false;
+    }
+  }
+
+  /* the bones are the same for all instances, only the joint data differs */
+  mSkeletonBoneLines = mGltfModel->getSkeleton()->createBoneLines(1);
+  if (!VertexBuffer::init(mRenderData, mSkeletonBoneBufferData,
+      mSkeletonBoneLines.size() * sizeof(glm::vec4))) {
+    Logger::log(1, "%s error: could not create skeleton bone buffer\n", __FUNCTION__);
     return false;
   }
   return true;
@@ -318,9 +364,11 @@ bool VkRenderer::createVBO() {
 
 bool VkRenderer::createUBO() {
   size_t matrixSize = mPerspViewMatrices.size() * sizeof(glm::mat4);
-  if (!UniformBuffer::init(mRenderData, mRenderData.rdPerspViewMatrixUBO, matrixSize)) {
-    Logger::log(1, "%s error: could not create uniform buffers\n", __FUNCTION__);
-    return false;
+  for (auto &frame : mRenderData.rdFrames) {
+    if (!UniformBuffer::init(mRenderData, frame.rdPerspViewMatrixUBO, matrixSize)) {
+      Logger::log(1, "%s error: could not create uniform buffers\n", __FUNCTION__);
+      return false;
+    }
   }
   return true;
 }
@@ -330,9 +378,11 @@ bool VkRenderer::createMatrixSSBO() {
     mRenderData.rdNumberOfInstances * mGltfInstances.at(0)->getJointMatrixSize() *
     sizeof(glm::mat4);
 
-  if (!ShaderStorageBuffer::init(mRenderData, mRenderData.rdJointMatrixSSBO, modelJointMatrixBufferSize)) {
-    Logger::log(1, "%s error: could not create shader storage buffers\n", __FUNCTION__);
-    return false;
+  for (auto &frame : mRenderData.rdFrames) {
+    if (!ShaderStorageBuffer::init(mRenderData, frame.rdJointMatrixSSBO, modelJointMatrixBufferSize)) {
+      Logger::log(1, "%s error: could not create shader storage buffers\n", __FUNCTION__);
+      return false;
+    }
   }
   return true;
 }
@@ -342,9 +392,11 @@ bool VkRenderer::createDQSSBO() {
     mRenderData.rdNumberOfInstances * mGltfInstances.at(0)->getJointDualQuatsSize() *
     sizeof(glm::mat2x4);
 
-  if (!ShaderStorageBuffer::init(mRenderData, mRenderData.rdJointDualQuatSSBO, modelJointDualQuatBufferSize)) {
-    Logger::log(1, "%s error: could not create shader storage buffers\n", __FUNCTION__);
-    return false;
+  for (auto &frame : mRenderData.rdFrames) {
+    if (!ShaderStorageBuffer::init(mRenderData, frame.rdJointDualQuatSSBO, modelJointDualQuatBufferSize)) {
+      Logger::log(1, "%s error: could not create shader storage buffers\n", __FUNCTION__);
+      return false;
+    }
   }
 
   return true;
@@ -378,7 +430,7 @@ bool VkRenderer::createLinePipeline() {
 }
 
 bool VkRenderer::createGltfSkeletonPipeline() {
-  std::string vertexShaderFile = "shader/line.vert.spv";
+  std::string vertexShaderFile = "shader/skeleton.vert.spv";
   std::string fragmentShaderFile = "shader/line.frag.spv";
   if (!GltfSkeletonPipeline::init(mRenderData, mRenderData.rdGltfPipelineLayout,
       mRenderData.rdGltfSkeletonPipeline, VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
@@ -389,6 +441,19 @@ bool VkRenderer::createGltfSkeletonPipeline() {
   return true;
 }
 
+bool VkRenderer::createGltfSkeletonDQPipeline() {
+  std::string vertexShaderFile = "shader/skeleton_dquat.vert.spv";
+  std::string fragmentShaderFile = "shader/line.frag.spv";
+  if (!GltfSkeletonPipeline::init(mRenderData, mRenderData.rdGltfPipelineLayout,
+      mRenderData.rdGltfSkeletonDQPipeline, VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+      vertexShaderFile, fragmentShaderFile)) {
+    Logger::log(1, "%s error: could not init gltf skeleton dual quat shader pipeline\n",
+      __FUNCTION__);
+    return false;
+  }
+  return true;
+}
+
 bool VkRenderer::createGltfGPUPipeline() {
   std::string vertexShaderFile = "shader/gltf_gpu.vert.spv";
   std::string fragmentShaderFile = "shader/gltf_gpu.frag.spv";
@@ -430,17 +495,21 @@ bool VkRenderer::createCommandPool() {
 }
 
 bool VkRenderer::createCommandBuffer() {
-  if (!CommandBuffer::init(mRenderData, mRenderData.rdCommandBuffer)) {
-    Logger::log(1, "%s error: could not create command buffers\n", __FUNCTION__);
-    return false;
+  for (auto &frame : mRenderData.rdFrames) {
+    if (!CommandBuffer::init(mRenderData, frame.rdCommandBuffer)) {
+      Logger::log(1, "%s error: could not create command buffers\n", __FUNCTION__);
+      return false;
+    }
   }
   return true;
 }
 
 bool VkRenderer::createSyncObjects() {
-  if (!SyncObjects::init(mRenderData)) {
-    Logger::log(1, "%s error: could not create sync objects\n", __FUNCTION__);
-    return false;
+  for (auto &frame : mRenderData.rdFrames) {
+    if (!SyncObjects::init(mRenderData, frame)) {
+      Logger::log(1, "%s error: could not create sync objects\n", __FUNCTION__);
+      return false;
+    }
   }
   return true;
 }
@@ -491,6 +560,16 @@ bool VkRenderer::createInstances() {
   mRenderData.rdTriangleCount = numTriangles;
   mRenderData.rdNumberOfInstances = mGltfInstances.size();
 
+  mAnimationLOD.init(mRenderData.rdNumberOfInstances);
+  mRenderData.rdAnimLODInstances.resize(AnimationLOD::NUM_LOD_LEVELS);
+  mRenderData.rdAnimLODUpdates.resize(AnimationLOD::NUM_LOD_LEVELS);
+  mRenderData.rdMeshLODInstances.resize(MeshLOD::NUM_LOD_LEVELS);
+  mRenderData.rdMeshLODTriangles.resize(MeshLOD::NUM_LOD_LEVELS);
+  mRenderData.rdSkeletonLODUpdates.resize(GltfSkeleton::NUM_LOD_LEVELS);
+  for (int i = 0; i < GltfSkeleton::NUM_LOD_LEVELS; ++i) {
+    mRenderData.rdSkeletonLODJoints.push_back(mGltfModel->getSkeleton()->getLODJointCount(i));
+  }
+
   if (!mGltfInstances.size()) {
     Logger::log(1, "%s: glTF instance creation failed\n", __FUNCTION__);
     return false;
@@ -502,25 +581,34 @@ bool VkRenderer::createInstances() {
 void VkRenderer::cleanup() {
   vkDeviceWaitIdle(mRenderData.rdVkbDevice.device);
 
+  mWorkerPool.cleanup();
+
   mGltfModel->cleanup(mRenderData);
   mGltfModel.reset();
 
   mUserInterface.cleanup(mRenderData);
+  mDebugDraw.cleanup(mRenderData);
 
-  SyncObjects::cleanup(mRenderData);
-  CommandBuffer::cleanup(mRenderData, mRenderData.rdCommandBuffer);
+  for (auto &frame : mRenderData.rdFrames) {
+    SyncObjects::cleanup(mRenderData, frame);
+    CommandBuffer::cleanup(mRenderData, frame.rdCommandBuffer);
+  }
   CommandPool::cleanup(mRenderData);
   Framebuffer::cleanup(mRenderData);
   GltfGPUPipeline::cleanup(mRenderData, mRenderData.rdGltfGPUDQPipeline);
   GltfGPUPipeline::cleanup(mRenderData, mRenderData.rdGltfGPUPipeline);
+  GltfSkeletonPipeline::cleanup(mRenderData, mRenderData.rdGltfSkeletonDQPipeline);
   GltfSkeletonPipeline::cleanup(mRenderData, mRenderData.rdGltfSkeletonPipeline);
   Pipeline::cleanup(mRenderData, mRenderData.rdLinePipeline);
   PipelineLayout::cleanup(mRenderData, mRenderData.rdGltfPipelineLayout);
   Renderpass::cleanup(mRenderData);
-  UniformBuffer::cleanup(mRenderData, mRenderData.rdPerspViewMatrixUBO);
-  ShaderStorageBuffer::cleanup(mRenderData, mRenderData.rdJointDualQuatSSBO);
-  ShaderStorageBuffer::cleanup(mRenderData, mRenderData.rdJointMatrixSSBO);
-  VertexBuffer::cleanup(mRenderData, mRenderData.rdVertexBufferData);
+  for (auto &frame : mRenderData.rdFrames) {
+    UniformBuffer::cleanup(mRenderData, frame.rdPerspViewMatrixUBO);
+    ShaderStorageBuffer::cleanup(mRenderData, frame.rdJointDualQuatSSBO);
+    ShaderStorageBuffer::cleanup(mRenderData, frame.rdJointMatrixSSBO);
+    VertexBuffer::cleanup(mRenderData, frame.rdSkeletonInstanceBufferData);
+  }
+  VertexBuffer::cleanup(mRenderData, mSkeletonBoneBufferData);
 
   vkDestroyImageView(mRenderData.rdVkbDevice.device, mRenderData.rdDepthImageView, nullptr);
   vmaDestroyImage(mRenderData.rdAllocator, mRenderData.rdDepthImage, mRenderData.rdDepthImageAlloc);
@@ -653,6 +741,13 @@ void VkRenderer::handleMovementKeys() {
   }
 }
 
+void VkRenderer::drawModelLODs(int drawGroup) {
+  for (int level = 0; level < MeshLOD::NUM_LOD_LEVELS; ++level) {
+    mGltfModel->drawInstanced(mRenderData, mLODInstances[drawGroup][level], level,
+      mLODFirstInstances[drawGroup][level]);
+  }
+}
+
 bool VkRenderer::draw() {
   /* get time difference for movement */
   double tickTime = glfwGetTime();
@@ -661,18 +756,103 @@ bool VkRenderer::draw() {
   mRenderData.rdFrameTime = mFrameTimer.stop();
   mFrameTimer.start();
 
+  /* counts of the last frame, including the UI and the event handling */
+  AllocationTracker::setEnabled(mRenderData.rdTrackAllocations);
+  mRenderData.rdFrameAllocations = AllocationTracker::getAllocationCount();
+  mRenderData.rdFrameAllocatedBytes = AllocationTracker::getAllocatedBytes();
+  AllocationTracker::resetCounters();
+
   handleMovementKeys();
 
-  if (vkWaitForFences(mRenderData.rdVkbDevice.device, 1, &mRenderData.rdRenderFence, VK_TRUE, UINT64_MAX) != VK_SUCCESS) {
+  /* the number of frames in flight may have been lowered by the UI */
+  if (mRenderData.rdCurrentFrame >= mRenderData.rdFramesInFlight) {
+    mRenderData.rdCurrentFrame = 0;
+  }
+  VkFrameData &frame = mRenderData.rdFrames.at(mRenderData.rdCurrentFrame);
+
+  mMatrixGenerateTimer.start();
+
+  /* clips are only read during the update, switch the sampling before */
+  mGltfModel->setUseBakedClips(mRenderData.rdUseBakedClips);
+
+  /* animation runs on CPU data only, and overlaps with the GPU still drawing older frames */
+  mWorkerPool.setNumThreads(mRenderData.rdUseWorkerThreads ?
+    mRenderData.rdNumWorkerThreads : 1);
+
+  /* new threads get their blend scratch memory before they animate the first instance */
+  if (mScratchThreads != mWorkerPool.getNumThreads()) {
+    std::shared_ptr<GltfSkeleton> skeleton = mGltfModel->getSkeleton();
+    mWorkerPool.runOnEachThread([&]() { GltfPosePool::reserve(skeleton); });
+    mScratchThreads = mWorkerPool.getNumThreads();
+  }
+
+  /* far instances skip frames, their joint data stays from the last update */
+  mAnimationLOD.setEnabled(mRenderData.rdUseAnimationLOD);
+  mAnimationLOD.setDistances(mRenderData.rdAnimLODDistance1, mRenderData.rdAnimLODDistance2,
+    mRenderData.rdAnimLODDistance3);
+  mAnimationLOD.setUpdateBudget(mRenderData.rdAnimUpdateBudget);
+  mAnimationLOD.setReduceCulledUpdates(mRenderData.rdUseFrustumCulling &&
+    mRenderData.rdReduceCulledUpdates);
+  mAnimationLOD.selectInstances(mGltfInstances, mInstanceVisible,
+    mRenderData.rdCameraWorldPosition, mRenderData.rdFieldOfView, mRenderData.rdTickDiff,
+    mRenderData.rdCurrentSelectedInstance);
+
+  for (int i = 0; i < AnimationLOD::NUM_LOD_LEVELS; ++i) {
+    mRenderData.rdAnimLODInstances.at(i) = mAnimationLOD.getInstanceCount(i);
+    mRenderData.rdAnimLODUpdates.at(i) = mAnimationLOD.getUpdateCount(i);
+  }
+
+  /* the mesh and the skeleton LOD share the distance levels, either one needs them */
+  mMeshLOD.setEnabled(mRenderData.rdUseMeshLOD || mRenderData.rdUseSkeletonLOD);
+  mMeshLOD.setDistances(mRenderData.rdMeshLODDistance1, mRenderData.rdMeshLODDistance2,
+    mRenderData.rdMeshLODDistance3);
+  mMeshLOD.selectLevels(mGltfInstances, mRenderData.rdCameraWorldPosition,
+    mRenderData.rdFieldOfView, mRenderData.rdCurrentSelectedInstance);
+
+  /* all instances advance by the same clock, skipped frames are added to the next update */
+  const std::vector<int> &animUpdateList = mAnimationLOD.getUpdateList();
+  mWorkerPool.parallelFor(animUpdateList.size(), [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      int index = animUpdateList.at(i);
+      mGltfInstances.at(index)->setSkeletonLODLevel(mRenderData.rdUseSkeletonLOD ?
+        mMeshLOD.getLevel(index) : 0);
+      mGltfInstances.at(index)->updateAnimation(mAnimationLOD.getDeltaTime(index));
+    }
+  });
+
+  std::fill(mRenderData.rdSkeletonLODUpdates.begin(), mRenderData.rdSkeletonLODUpdates.end(), 0);
+  for (const auto index : animUpdateList) {
+    ++mRenderData.rdSkeletonLODUpdates.at(mGltfInstances.at(index)->getSkeletonLODLevel());
+  }
+
+  mIKTimer.start();
+  mWorkerPool.parallelFor(animUpdateList.size(), [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      mGltfInstances.at(animUpdateList.at(i))->solveIK();
+    }
+  });
+  mRenderData.rdIKTime = mIKTimer.stop();
+
+  /* save value to avoid changes during later calls */
+  int selectedInstance = mRenderData.rdCurrentSelectedInstance;
+  glm::vec2 modelWorldPos = mGltfInstances.at(selectedInstance)->getWorldPosition();
+  glm::quat modelWorldRot = mGltfInstances.at(selectedInstance)->getWorldRotation();
+
+  mRenderData.rdMatrixGenerateTime = mMatrixGenerateTimer.stop();
+
+  /* only the resources of this frame must be free again, newer frames may still be drawn */
+  mWaitForGPUTimer.start();
+  if (vkWaitForFences(mRenderData.rdVkbDevice.device, 1, &frame.rdRenderFence, VK_TRUE, UINT64_MAX) != VK_SUCCESS) {
     Logger::log(1, "%s error: waiting for fence failed\n", __FUNCTION__);
     return false;
   }
+  mRenderData.rdWaitForGPUTime = mWaitForGPUTimer.stop();
 
   uint32_t imageIndex = 0;
   VkResult result = vkAcquireNextImageKHR(mRenderData.rdVkbDevice.device,
       mRenderData.rdVkbSwapchain.swapchain,
       UINT64_MAX,
-      mRenderData.rdPresentSemaphore,
+      frame.rdPresentSemaphore,
       VK_NULL_HANDLE,
       &imageIndex);
 
@@ -685,11 +865,14 @@ bool VkRenderer::draw() {
     }
   }
 
-  if (vkResetFences(mRenderData.rdVkbDevice.device, 1, &mRenderData.rdRenderFence) != VK_SUCCESS) {
+  if (vkResetFences(mRenderData.rdVkbDevice.device, 1, &frame.rdRenderFence) != VK_SUCCESS) {
     Logger::log(1, "%s error:  fence reset failed\n", __FUNCTION__);
     return false;
   }
 
+  /* all recording functions use the command buffer of the render data */
+  mRenderData.rdCommandBuffer = frame.rdCommandBuffer;
+
   VkClearValue colorClearValue;
   colorClearValue.color = { { 0.25f, 0.25f, 0.25f, 1.0f } };
 
@@ -723,78 +906,12 @@ bool VkRenderer::draw() {
   scissor.offset = { 0, 0 };
   scissor.extent = mRenderData.rdVkbSwapchain.extent;
 
-  mMatrixGenerateTimer.start();
-
   mPerspViewMatrices.at(0) = mCamera.getViewMatrix(mRenderData);
   mPerspViewMatrices.at(1) = glm::perspective(
     glm::radians(static_cast<float>(mRenderData.rdFieldOfView)),
     static_cast<float>(mRenderData.rdVkbSwapchain.extent.width) /
     static_cast<float>(mRenderData.rdVkbSwapchain.extent.height), 0.01f, 500.0f);
 
-  /* animate and update inverse kinematics */
-  mRenderData.rdIKTime = 0.0f;
-  for (auto &instance : mGltfInstances) {
-    instance->updateAnimation();
-
-    mIKTimer.start();
-    instance->solveIK();
-    mRenderData.rdIKTime += mIKTimer.stop();
-  }
-
-  /* save value to avoid changes during later calls */
-  int selectedInstance = mRenderData.rdCurrentSelectedInstance;
-  glm::vec2 modelWorldPos = mGltfInstances.at(selectedInstance)->getWorldPosition();
-  glm::quat modelWorldRot = mGltfInstances.at(selectedInstance)->getWorldRotation();
-
-  mLineMesh->vertices.clear();
-
-  /* get gltTF skeleton */
-  mSkeletonLineIndexCount = 0;
-  for (const auto &instance : mGltfInstances) {
-    ModelSettings settings = instance->getInstanceSettings();
-    if (settings.msDrawSkeleton) {
-      std::shared_ptr<VkMesh> mesh = instance->getSkeleton();
-      mSkeletonLineIndexCount += mesh->vertices.size();
-      mLineMesh->vertices.insert(mLineMesh->vertices.begin(),
-        mesh->vertices.begin(), mesh->vertices.end());
-    }
-  }
-
-  /* get coordinate arrows for the IK target of current instance only */
-  mCoordArrowsLineIndexCount = 0;
-  {
-    ModelSettings ikSettings = mGltfInstances.at(selectedInstance)->getInstanceSettings();
-    if (ikSettings.msIkMode == ikMode::ccd ||
-        ikSettings.msIkMode == ikMode::fabrik) {
-      mCoordArrowsMesh = mCoordArrowsModel.getVertexData();
-      mCoordArrowsLineIndexCount += mCoordArrowsMesh.vertices.size();
-      std::for_each(mCoordArrowsMesh.vertices.begin(), mCoordArrowsMesh.vertices.end(),
-        [=](auto &n){
-          n.color /= 2.0f;
-          n.position = modelWorldRot * n.position;
-          n.position += ikSettings.msIkTargetWorldPos;
-      });
-
-      mLineMesh->vertices.insert(mLineMesh->vertices.end(),
-        mCoordArrowsMesh.vertices.begin(), mCoordArrowsMesh.vertices.end());
-    }
-  }
-
-  /* draw coordiante arrows*/
-  mCoordArrowsMesh = mCoordArrowsModel.getVertexData();
-  mCoordArrowsLineIndexCount += mCoordArrowsMesh.vertices.size();
-  std::for_each(mCoordArrowsMesh.vertices.begin(), mCoordArrowsMesh.vertices.end(),
-    [=](auto &n){
-      n.color /= 2.0f;
-      n.position = modelWorldRot * n.position;
-      n.position += glm::vec3(modelWorldPos.x, 0.0f, modelWorldPos.y);
-  });
-
-  mLineMesh->vertices.insert(mLineMesh->vertices.end(),
-    mCoordArrowsMesh.vertices.begin(), mCoordArrowsMesh.vertices.end());
-
-  mRenderData.rdMatrixGenerateTime = mMatrixGenerateTimer.stop();
-
   /* prepare command buffer */
   if (vkResetCommandBuffer(mRenderData.rdCommandBuffer, 0) != VK_SUCCESS) {
     Logger::log(1, "%s error: failed to reset command buffer\n", __FUNCTION__);
@@ -810,51 +927,187 @@ bool VkRenderer::draw() {
     return false;
   }
 
-  /* upload data to VBO */
+  /* test the bounds of the current poses against the frustum of this frame */
+  mCullingTimer.start();
+  mFrustum.update(mPerspViewMatrices.at(1), mPerspViewMatrices.at(0));
+
+  int culledInstances = 0;
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    bool visible = !mRenderData.rdUseFrustumCulling ||
+      mFrustum.isSphereVisible(mGltfInstances.at(i)->getBoundingSphere());
+    mInstanceVisible.at(i) = visible;
+    if (!visible) {
+      ++culledInstances;
+    }
+  }
+  mRenderData.rdVisibleInstances = mGltfInstances.size() - culledInstances;
+  mRenderData.rdCulledInstances = culledInstances;
+  mRenderData.rdCullingTime = mCullingTimer.stop();
+
+  /* upload data to VBO, the debug lines go straight into the mapped region of this frame */
   mUploadToVBOTimer.start();
+  mDebugDraw.beginFrame(mRenderData);
 
-  if (mLineMesh->vertices.size() > 0) {
-    VertexBuffer::uploadData(mRenderData, mRenderData.rdVertexBufferData, *mLineMesh);
+  /* coordinate arrows for the IK target of current instance only */
+  const ModelSettings &ikSettings = mGltfInstances.at(selectedInstance)->getInstanceSettings();
+  if (ikSettings.msIkMode == ikMode::ccd || ikSettings.msIkMode == ikMode::fabrik) {
+    mDebugDraw.addLines(mCoordArrowsModel.getVertexData(), modelWorldRot,
+      ikSettings.msIkTargetWorldPos, 0.5f);
   }
 
+  mDebugDraw.addLines(mCoordArrowsModel.getVertexData(), modelWorldRot,
+    glm::vec3(modelWorldPos.x, 0.0f, modelWorldPos.y), 0.5f);
+
+  if (mRenderData.rdDrawBoundingSpheres) {
+    for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+      if (mInstanceVisible.at(i)) {
+        mDebugDraw.addSphere(mGltfInstances.at(i)->getBoundingSphere(),
+          glm::vec3(0.0f, 0.5f, 0.0f));
+      }
+    }
+  }
+  mDebugDraw.flush(mRenderData);
+  mRenderData.rdDebugLineVertices = mDebugDraw.getVertexCount();
+
   if (mModelUploadRequired) {
     /* upload glTF model data */
     mGltfModel->uploadVertexBuffers(mRenderData);
     mGltfModel->uploadIndexBuffer(mRenderData);
+    VertexBuffer::uploadData(mRenderData, mSkeletonBoneBufferData, mSkeletonBoneLines.data(),
+      mSkeletonBoneLines.size() * sizeof(glm::vec4));
     mModelUploadRequired = false;
   }
 
   mRenderData.rdUploadToVBOTime = mUploadToVBOTimer.stop();
 
-  /* prepare the vectors with matrix and dual quat data, update triangle count */
-  mModelJointMatrices.clear();
-  mModelJointDualQuats.clear();
+  /* assign the SSBO positions of the drawn instances, update triangle count */
+  mUploadToUBOTimer.start();
+
+  /* far instances are drawn with the simplified meshes */
+  for (auto &groupInstances : mLODInstances) {
+    std::fill(std::begin(groupInstances), std::end(groupInstances), 0);
+  }
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    const ModelSettings &settings = mGltfInstances.at(i)->getInstanceSettings();
+    if (!settings.msDrawModel || !mInstanceVisible.at(i)) {
+      continue;
+    }
+    int group = settings.msVertexSkinningMode == skinningMode::dualQuat ? DUAL_QUAT_GROUP :
+      MATRIX_GROUP;
+    int meshLevel = mRenderData.rdUseMeshLOD ? mMeshLOD.getLevel(i) : 0;
+    ++mLODInstances[group][meshLevel];
+  }
 
-  unsigned int matrixInstances = 0;
-  unsigned int dualQuatInstances = 0;
+  /* the levels of a group follow each other, nearest level first */
+  unsigned int groupInstances[NUM_DRAW_GROUPS] = {};
+  unsigned int nextInstances[NUM_DRAW_GROUPS][MeshLOD::NUM_LOD_LEVELS] = {};
   unsigned int numTriangles = 0;
+  std::fill(mRenderData.rdMeshLODInstances.begin(), mRenderData.rdMeshLODInstances.end(), 0);
+  std::fill(mRenderData.rdMeshLODTriangles.begin(), mRenderData.rdMeshLODTriangles.end(), 0);
+  for (int group = 0; group < NUM_DRAW_GROUPS; ++group) {
+    for (int level = 0; level < MeshLOD::NUM_LOD_LEVELS; ++level) {
+      unsigned int levelInstances = mLODInstances[group][level];
+      mLODFirstInstances[group][level] = groupInstances[group];
+      nextInstances[group][level] = groupInstances[group];
+      groupInstances[group] += levelInstances;
+
+      unsigned int levelTriangles = levelInstances * mGltfModel->getLODTriangleCount(level);
+      mRenderData.rdMeshLODInstances.at(level) += levelInstances;
+      mRenderData.rdMeshLODTriangles.at(level) += levelTriangles;
+      numTriangles += levelTriangles;
+    }
+  }
 
-  for (const auto &instance : mGltfInstances) {
-    ModelSettings settings = instance->getInstanceSettings();
-    if (!settings.msDrawModel) {
+  /* instances of the same skinning mode are packed in draw order, sorted by their LOD level */
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    const ModelSettings &settings = mGltfInstances.at(i)->getInstanceSettings();
+    if (!settings.msDrawModel || !mInstanceVisible.at(i)) {
+      mInstanceJointSlots.at(i) = -1;
       continue;
     }
+    int group = settings.msVertexSkinningMode == skinningMode::dualQuat ? DUAL_QUAT_GROUP :
+      MATRIX_GROUP;
+    int meshLevel = mRenderData.rdUseMeshLOD ? mMeshLOD.getLevel(i) : 0;
+    mInstanceJointSlots.at(i) = nextInstances[group][meshLevel]++;
+  }
 
-    if (settings.msVertexSkinningMode == skinningMode::dualQuat) {
-      std::vector<glm::mat2x4> quats = instance->getJointDualQuats();
-      mModelJointDualQuats.insert(mModelJointDualQuats.end(),
-        quats.begin(), quats.end());
-      ++dualQuatInstances;
-    } else {
-      std::vector<glm::mat4> mats = instance->getJointMatrices();
-      mModelJointMatrices.insert(mModelJointMatrices.end(),
-        mats.begin(), mats.end());
-      ++matrixInstances;
+  unsigned int matrixInstances = groupInstances[MATRIX_GROUP];
+  unsigned int dualQuatInstances = groupInstances[DUAL_QUAT_GROUP];
+  mRenderData.rdTriangleCount = numTriangles;
+
+  /* skeletons are posed from the joint data, instances showing only the skeleton
+   * get a slot behind the drawn instances */
+  unsigned int matrixSlots = matrixInstances;
+  unsigned int dualQuatSlots = dualQuatInstances;
+  mSkeletonJointSlots.clear();
+
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    const ModelSettings &settings = mGltfInstances.at(i)->getInstanceSettings();
+    if (!settings.msDrawSkeleton || !mInstanceVisible.at(i) ||
+        settings.msVertexSkinningMode == skinningMode::dualQuat) {
+      continue;
     }
-    numTriangles += mGltfModel->getTriangleCount();
+    if (!settings.msDrawModel) {
+      mInstanceJointSlots.at(i) = matrixSlots++;
+    }
+    mSkeletonJointSlots.emplace_back(mInstanceJointSlots.at(i));
   }
+  unsigned int skeletonMatrixInstances = mSkeletonJointSlots.size();
 
-  mRenderData.rdTriangleCount = numTriangles;
+  for (size_t i = 0; i < mGltfInstances.size(); ++i) {
+    const ModelSettings &settings = mGltfInstances.at(i)->getInstanceSettings();
+    if (!settings.msDrawSkeleton || !mInstanceVisible.at(i) ||
+        settings.msVertexSkinningMode != skinningMode::dualQuat) {
+      continue;
+    }
+    if (!settings.msDrawModel) {
+      mInstanceJointSlots.at(i) = dualQuatSlots++;
+    }
+    mSkeletonJointSlots.emplace_back(mInstanceJointSlots.at(i));
+  }
+  unsigned int skeletonDualQuatInstances = mSkeletonJointSlots.size() - skeletonMatrixInstances;
+
+  if (!mSkeletonJointSlots.empty()) {
+    VertexBuffer::uploadData(mRenderData, frame.rdSkeletonInstanceBufferData,
+      mSkeletonJointSlots.data(), mSkeletonJointSlots.size() * sizeof(int));
+  }
+
+  /* instances write directly into the mapped SSBOs of this frame */
+  int jointMatrixSize = mGltfInstances.at(0)->getJointMatrixSize();
+  int jointDualQuatSize = mGltfInstances.at(0)->getJointDualQuatsSize();
+  glm::mat4 *jointMatrices =
+    static_cast<glm::mat4*>(frame.rdJointMatrixSSBO.rdSsboMappedData);
+  glm::mat2x4 *jointDualQuats =
+    static_cast<glm::mat2x4*>(frame.rdJointDualQuatSSBO.rdSsboMappedData);
+
+  mWorkerPool.parallelFor(mGltfInstances.size(), [&](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      int slot = mInstanceJointSlots.at(i);
+      if (slot < 0) {
+        continue;
+      }
+      if (mGltfInstances.at(i)->getInstanceSettings().msVertexSkinningMode ==
+          skinningMode::dualQuat) {
+        mGltfInstances.at(i)->copyJointDualQuats(jointDualQuats + slot * jointDualQuatSize);
+      } else {
+        mGltfInstances.at(i)->copyJointMatrices(jointMatrices + slot * jointMatrixSize);
+      }
+    }
+  });
+
+  ShaderStorageBuffer::flushData(mRenderData, frame.rdJointMatrixSSBO,
+    matrixSlots * jointMatrixSize * sizeof(glm::mat4));
+  ShaderStorageBuffer::flushData(mRenderData, frame.rdJointDualQuatSSBO,
+    dualQuatSlots * jointDualQuatSize * sizeof(glm::mat2x4));
+
+  UniformBuffer::uploadData(mRenderData, frame.rdPerspViewMatrixUBO, mPerspViewMatrices);
+
+  mRenderData.rdUploadToUBOTime = mUploadToUBOTimer.stop();
+
+  /* estimate only, assumes the culled instances would have cost the same as the drawn ones */
+  unsigned int drawnInstances = matrixInstances + dualQuatInstances;
+  mRenderData.rdCullingTimeSavedEstimate = drawnInstances > 0 ?
+    mRenderData.rdUploadToUBOTime / drawnInstances * culledInstances : 0.0f;
 
   /* the rendering itself happens here */
   vkCmdBeginRenderPass(mRenderData.rdCommandBuffer, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
@@ -866,68 +1119,78 @@ bool VkRenderer::draw() {
   /* UBOs */
   vkCmdBindDescriptorSets(mRenderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
     mRenderData.rdGltfPipelineLayout, 1, 1,
-      &mRenderData.rdPerspViewMatrixUBO.rdUBODescriptorSet, 0, nullptr);
+      &frame.rdPerspViewMatrixUBO.rdUBODescriptorSet, 0, nullptr);
   vkCmdBindDescriptorSets(mRenderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-    mRenderData.rdGltfPipelineLayout, 2, 1, &mRenderData.rdJointMatrixSSBO.rdSSBODescriptorSet,
+    mRenderData.rdGltfPipelineLayout, 2, 1, &frame.rdJointMatrixSSBO.rdSSBODescriptorSet,
     0, nullptr);
   vkCmdBindDescriptorSets(mRenderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
     mRenderData.rdGltfPipelineLayout, 3, 1,
-      &mRenderData.rdJointDualQuatSSBO.rdSSBODescriptorSet, 0, nullptr);
-
-  /* line and box vertex buffer */
-  VkDeviceSize offset = 0;
-  vkCmdBindVertexBuffers(mRenderData.rdCommandBuffer, 0, 1,
-    &mRenderData.rdVertexBufferData.rdVertexBuffer, &offset);
+      &frame.rdJointDualQuatSSBO.rdSSBODescriptorSet, 0, nullptr);
 
   /* draw the glTF models */
-  unsigned int jointMatrixSize = mGltfInstances.at(0)->getJointMatrixSize();
-  unsigned int matrixPos = 0;
-
   VkPushConstants modelStride;
 
   vkCmdBindPipeline(mRenderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
    mRenderData.rdGltfGPUPipeline);
   /* set position inside the SSBO */
-  modelStride.pkModelStride = mGltfInstances.at(0)->getJointMatrixSize();
+  modelStride.pkModelStride = jointMatrixSize;
   vkCmdPushConstants(mRenderData.rdCommandBuffer, mRenderData.rdGltfPipelineLayout,
     VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VkPushConstants), &modelStride);
-  mGltfModel->drawInstanced(mRenderData, matrixInstances);
+  drawModelLODs(MATRIX_GROUP);
 
 
   vkCmdBindPipeline(mRenderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
     mRenderData.rdGltfGPUDQPipeline);
-  modelStride.pkModelStride = mGltfInstances.at(0)->getJointDualQuatsSize();
+  modelStride.pkModelStride = jointDualQuatSize;
   vkCmdPushConstants(mRenderData.rdCommandBuffer, mRenderData.rdGltfPipelineLayout,
     VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VkPushConstants), &modelStride);
-  mGltfModel->drawInstanced(mRenderData, dualQuatInstances);
+  drawModelLODs(DUAL_QUAT_GROUP);
 
-  if (mCoordArrowsLineIndexCount > 0 || mSkeletonLineIndexCount > 0) {
-    vkCmdBindVertexBuffers(mRenderData.rdCommandBuffer, 0, 1,
-      &mRenderData.rdVertexBufferData.rdVertexBuffer, &offset);
+  if (mDebugDraw.getVertexCount() > 0 || !mSkeletonJointSlots.empty()) {
     vkCmdSetLineWidth(mRenderData.rdCommandBuffer, 3.0f);
   }
 
-  /* draw the coordinate arrow WITH depth buffer */
-  if (mCoordArrowsLineIndexCount > 0) {
+  /* draw the debug lines WITH depth buffer */
+  if (mDebugDraw.getVertexCount() > 0) {
     vkCmdBindPipeline(mRenderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
       mRenderData.rdLinePipeline);
-    vkCmdDraw(mRenderData.rdCommandBuffer, mCoordArrowsLineIndexCount, 1,
-      mSkeletonLineIndexCount, 0);
+    mDebugDraw.draw(mRenderData);
   }
 
-  /* draw the skeleton last, disable depth test to overlay */
-  if (mSkeletonLineIndexCount > 0) {
+  /* draw the skeletons last, one instance per skeleton, disable depth test to overlay */
+  if (!mSkeletonJointSlots.empty()) {
+    VkBuffer skeletonBuffers[] = { mSkeletonBoneBufferData.rdVertexBuffer,
+      frame.rdSkeletonInstanceBufferData.rdVertexBuffer };
+    VkDeviceSize skeletonOffsets[] = { 0, 0 };
+    vkCmdBindVertexBuffers(mRenderData.rdCommandBuffer, 0, 2, skeletonBuffers, skeletonOffsets);
+  }
+  if (skeletonMatrixInstances > 0) {
     vkCmdBindPipeline(mRenderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
       mRenderData.rdGltfSkeletonPipeline);
-    vkCmdDraw(mRenderData.rdCommandBuffer, mSkeletonLineIndexCount, 1, 0, 0);
+    modelStride.pkModelStride = jointMatrixSize;
+    vkCmdPushConstants(mRenderData.rdCommandBuffer, mRenderData.rdGltfPipelineLayout,
+      VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VkPushConstants), &modelStride);
+    vkCmdDraw(mRenderData.rdCommandBuffer, mSkeletonBoneLines.size(), skeletonMatrixInstances,
+      0, 0);
+  }
+  if (skeletonDualQuatInstances > 0) {
+    vkCmdBindPipeline(mRenderData.rdCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+      mRenderData.rdGltfSkeletonDQPipeline);
+    modelStride.pkModelStride = jointDualQuatSize;
+    vkCmdPushConstants(mRenderData.rdCommandBuffer, mRenderData.rdGltfPipelineLayout,
+      VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VkPushConstants), &modelStride);
+    vkCmdDraw(mRenderData.rdCommandBuffer, mSkeletonBoneLines.size(),
+      skeletonDualQuatInstances, 0, skeletonMatrixInstances);
   }
 
   /* imgui overlay */
   mUIGenerateTimer.start();
 
-  ModelSettings settings = mGltfInstances.at(selectedInstance)->getInstanceSettings();
-  mUserInterface.createFrame(mRenderData, settings);
-  mGltfInstances.at(selectedInstance)->setInstanceSettings(settings);
+  /* plain values only, the UI edits a copy and the names come from the model */
+  mSelectedSettings = mGltfInstances.at(selectedInstance)->getInstanceSettings();
+  mUserInterface.createFrame(mRenderData, mSelectedSettings, mGltfModel->getClipNames(),
+    mGltfModel->getSkeletonNodeNames());
+  mGltfInstances.at(selectedInstance)->setInstanceSettings(mSelectedSettings);
   mGltfInstances.at(selectedInstance)->checkForUpdates();
 
   mRenderData.rdUIGenerateTime = mUIGenerateTimer.stop();
@@ -943,16 +1206,6 @@ bool VkRenderer::draw() {
     return false;
   }
 
-  /* upload UBO data after commands are created */
-  mUploadToUBOTimer.start();
-
-  UniformBuffer::uploadData(mRenderData, mRenderData.rdPerspViewMatrixUBO, mPerspViewMatrices);
-
-  ShaderStorageBuffer::uploadData(mRenderData, mRenderData.rdJointDualQuatSSBO, mModelJointDualQuats);
-  ShaderStorageBuffer::uploadData(mRenderData, mRenderData.rdJointMatrixSSBO, mModelJointMatrices);
-
-  mRenderData.rdUploadToUBOTime = mUploadToUBOTimer.stop();
-
   /* submit command buffer */
   VkSubmitInfo submitInfo{};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -961,23 +1214,26 @@ bool VkRenderer::draw() {
   submitInfo.pWaitDstStageMask = &waitStage;
 
   submitInfo.waitSemaphoreCount = 1;
-  submitInfo.pWaitSemaphores = &mRenderData.rdPresentSemaphore;
+  submitInfo.pWaitSemaphores = &frame.rdPresentSemaphore;
 
   submitInfo.signalSemaphoreCount = 1;
-  submitInfo.pSignalSemaphores = &mRenderData.rdRenderSemaphore;
+  submitInfo.pSignalSemaphores = &frame.rdRenderSemaphore;
 
   submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &mRenderData.rdCommandBuffer;
+  submitInfo.pCommandBuffers = &frame.rdCommandBuffer;
 
-  if (vkQueueSubmit(mRenderData.rdGraphicsQueue, 1, &submitInfo, mRenderData.rdRenderFence) != VK_SUCCESS) {
+  if (vkQueueSubmit(mRenderData.rdGraphicsQueue, 1, &submitInfo, frame.rdRenderFence) != VK_SUCCESS) {
     Logger::log(1, "%s error: failed to submit draw command buffer\n", __FUNCTION__);
     return false;
   }
 
+  /* the next frame uses the next set of resources */
+  mRenderData.rdCurrentFrame = (mRenderData.rdCurrentFrame + 1) % mRenderData.rdFramesInFlight;
+
   VkPresentInfoKHR presentInfo{};
   presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
   presentInfo.waitSemaphoreCount = 1;
-  presentInfo.pWaitSemaphores = &mRenderData.rdRenderSemaphore;
+  presentInfo.pWaitSemaphores = &frame.rdRenderSemaphore;
 
   presentInfo.swapchainCount = 1;
   presentInfo.pSwapchains = &mRenderData.rdVkbSwapchain.swapchain;
@@ -13,6 +13,8 @@
 #include <vk_mem_alloc.h>
 
 #include "Timer.h"
+#include "AllocationTracker.h"
+#include "WorkerPool.h"
 #include "Renderpass.h"
 #include "Pipeline.h"
 #include "GltfPipeline.h"
@@ -27,12 +29,16 @@
 #include "UniformBuffer.h"
 #include "ShaderStorageBuffer.h"
 #include "VertexBuffer.h"
+#include "DebugDraw.h"
 #include "IndexBuffer.h"
 #include "UserInterface.h"
 #include "Camera.h"
+#include "Frustum.h"
 #include "CoordArrowsModel.h"
 #include "GltfModel.h"
 #include "GltfInstance.h"
+#include "AnimationLOD.h"
+#include "MeshLOD.h"
 
 #include "VkRenderData.h"
 
@@ -54,20 +60,33 @@ class VkRenderer {
 
     UserInterface mUserInterface{};
     Camera mCamera{};
+    Frustum mFrustum{};
+    WorkerPool mWorkerPool{};
+    AnimationLOD mAnimationLOD{};
+    MeshLOD mMeshLOD{};
 
     std::shared_ptr<GltfModel> mGltfModel = nullptr;
     bool mModelUploadRequired = true;
 
     std::vector<std::shared_ptr<GltfInstance>> mGltfInstances{};
 
-    std::vector<glm::mat4> mModelJointMatrices{};
-    std::vector<glm::mat2x4> mModelJointDualQuats{};
+    /* position of the instance joint data inside the SSBOs, -1 if not drawn */
+    std::vector<int> mInstanceJointSlots{};
+    /* matrix and dual quaternion instances, one instanced draw per mesh LOD level, the
+     * instances of a level are packed behind each other */
+    static constexpr int NUM_DRAW_GROUPS = 2;
+    unsigned int mLODInstances[NUM_DRAW_GROUPS][MeshLOD::NUM_LOD_LEVELS] = {};
+    unsigned int mLODFirstInstances[NUM_DRAW_GROUPS][MeshLOD::NUM_LOD_LEVELS] = {};
+    /* frustum test result of the last frame, the animation LOD of the next frame uses it */
+    std::vector<bool> mInstanceVisible{};
 
     CoordArrowsModel mCoordArrowsModel{};
-    VkMesh mCoordArrowsMesh{};
-    std::shared_ptr<VkMesh> mLineMesh = nullptr;
-    unsigned int mSkeletonLineIndexCount = 0;
-    unsigned int mCoordArrowsLineIndexCount = 0;
+    DebugDraw mDebugDraw{};
+    /* bone lines of the model, drawn instanced for all instances showing their skeleton */
+    std::vector<glm::vec4> mSkeletonBoneLines{};
+    VkVertexBufferData mSkeletonBoneBufferData{};
+    /* matrix skinned skeletons first, dual quaternion skeletons behind them */
+    std::vector<int> mSkeletonJointSlots{};
 
     bool mMouseLock = false;
     int mMouseXPos = 0;
@@ -76,6 +95,7 @@ class VkRenderer {
     double mLastTickTime = 0.0;
 
     void handleMovementKeys();
+    void drawModelLODs(int drawGroup);
     int mCameraForward = 0;
     int mCameraStrafe = 0;
     int mCameraUpDown = 0;
@@ -83,10 +103,12 @@ class VkRenderer {
     Timer mFrameTimer{};
     Timer mMatrixGenerateTimer{};
     Timer mIKTimer{};
+    Timer mCullingTimer{};
     Timer mUploadToVBOTimer{};
     Timer mUploadToUBOTimer{};
     Timer mUIGenerateTimer{};
     Timer mUIDrawTimer{};
+    Timer mWaitForGPUTimer{};
 
     VkSurfaceKHR mSurface = VK_NULL_HANDLE;
 
@@ -94,6 +116,11 @@ class VkRenderer {
 
     std::vector<glm::mat4> mPerspViewMatrices{};
 
+    /* copy of the selected instance settings for the UI, reused every frame */
+    ModelSettings mSelectedSettings{};
+    /* worker threads with reserved scratch poses */
+    unsigned int mScratchThreads = 0;
+
     bool deviceInit();
     bool getQueue();
     bool createDepthBuffer();
@@ -106,6 +133,7 @@ class VkRenderer {
     bool createGltfPipelineLayout();
     bool createLinePipeline();
     bool createGltfSkeletonPipeline();
+    bool createGltfSkeletonDQPipeline();
     bool createGltfGPUPipeline();
     bool createGltfGPUDQPipeline();
     bool createFramebuffer();